@@ -0,0 +1,250 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef ORDERBOOK_BUILD_TYPE
+#define ORDERBOOK_BUILD_TYPE "unknown"
+#endif
+
+namespace bench {
+
+/**
+ * @brief Throughput and latency distribution of one benchmark
+ *
+ * Latencies are per operation. For operations timed in batches (batch > 1)
+ * each sample is a batch's mean, so the tail is of batch means.
+ */
+struct Result {
+    std::string name;
+    uint64_t ops = 0;
+    size_t batch = 1;
+    int64_t elapsed_ns = 0;   // Time spent in the timed operations
+    double mean_ns = 0;
+    int64_t p50_ns = 0;
+    int64_t p99_ns = 0;
+    int64_t p999_ns = 0;
+    int64_t max_ns = 0;
+
+    double opsPerSecond() const { return elapsed_ns > 0 ? ops * 1e9 / elapsed_ns : 0.0; }
+};
+
+inline int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Collects latency samples and reduces them to a Result
+ */
+class LatencyRecorder {
+public:
+    explicit LatencyRecorder(size_t expected = 0) { samples_.reserve(expected); }
+
+    void record(int64_t ns) { samples_.push_back(ns); }
+    size_t size() const { return samples_.size(); }
+
+    /**
+     * @param ops Operations the samples cover
+     * @param elapsed_ns Time the operations took (0: the sum of the samples times the batch)
+     */
+    Result summarize(const std::string& name, uint64_t ops, size_t batch = 1, int64_t elapsed_ns = 0) {
+        Result result;
+        result.name = name;
+        result.ops = ops;
+        result.batch = batch;
+        if (samples_.empty()) {
+            return result;
+        }
+        std::sort(samples_.begin(), samples_.end());
+        int64_t total = 0;
+        for (int64_t sample : samples_) {
+            total += sample;
+        }
+        result.elapsed_ns = elapsed_ns > 0 ? elapsed_ns : total * static_cast<int64_t>(batch);
+        result.mean_ns = static_cast<double>(total) / samples_.size();
+        result.p50_ns = percentile(0.50);
+        result.p99_ns = percentile(0.99);
+        result.p999_ns = percentile(0.999);
+        result.max_ns = samples_.back();
+        return result;
+    }
+
+private:
+    std::vector<int64_t> samples_;
+
+    // Nearest rank of the sorted samples
+    int64_t percentile(double p) const {
+        size_t rank = static_cast<size_t>(p * samples_.size() + 0.999999);
+        return samples_[std::min(samples_.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+};
+
+/**
+ * @brief Time op(i) for i in [0, count), batch operations per clock read
+ *
+ * A clock read costs tens of nanoseconds, so operations that cost about
+ * as much (reads of the book) should be batched; anything slower is
+ * timed one at a time to keep its tail.
+ */
+template <typename Op>
+Result timeEach(const std::string& name, size_t count, size_t batch, Op&& op) {
+    LatencyRecorder recorder(count / batch + 1);
+    size_t i = 0;
+    int64_t total = 0;
+    while (i < count) {
+        size_t n = std::min(batch, count - i);
+        int64_t start = now();
+        for (size_t end = i + n; i < end; ++i) {
+            op(i);
+        }
+        int64_t elapsed = now() - start;
+        recorder.record(elapsed / static_cast<int64_t>(n));
+        total += elapsed;
+    }
+    return recorder.summarize(name, count, batch, total);
+}
+
+/**
+ * @brief Command line, console table and JSON results of a benchmark program
+ *
+ * Usage: <program> [count] [--json FILE] [--filter TEXT]
+ *
+ * count sets the operations per benchmark; --filter runs only the
+ * benchmarks whose names contain TEXT. With --json the results are also
+ * written to FILE, one benchmark per line, with the build type, compiler
+ * and clock overhead, so the files of two builds can be compared with
+ * bench/compare_bench.py (or diffed).
+ */
+class Suite {
+public:
+    Suite(const std::string& name, int argc, char** argv, size_t default_count) : name_(name), count_(default_count) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--json" && i + 1 < argc) {
+                json_path_ = argv[++i];
+            } else if (arg == "--filter" && i + 1 < argc) {
+                filter_ = argv[++i];
+            } else if (!arg.empty() && arg[0] != '-') {
+                count_ = std::stoul(arg);
+            } else {
+                throw std::invalid_argument("Usage: " + std::string(argv[0]) + " [count] [--json FILE] [--filter TEXT]");
+            }
+        }
+        clock_overhead_ns_ = measureClockOverhead();
+
+        std::cout << name_ << " (" << count_ << " operations, " << ORDERBOOK_BUILD_TYPE << " build, clock read "
+                  << clock_overhead_ns_ << " ns)" << std::endl;
+        std::cout << std::left << std::setw(22) << "benchmark" << std::right << std::setw(10) << "Mops/s"
+                  << std::setw(11) << "mean" << std::setw(11) << "p50" << std::setw(11) << "p99"
+                  << std::setw(11) << "p99.9" << std::setw(11) << "max" << "  (ns/op)" << std::endl;
+    }
+
+    ~Suite() {
+        try {
+            writeJson();
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+
+    Suite(const Suite&) = delete;
+    Suite& operator=(const Suite&) = delete;
+
+    size_t count() const { return count_; }
+
+    bool enabled(const std::string& benchmark) const {
+        return filter_.empty() || benchmark.find(filter_) != std::string::npos;
+    }
+
+    void add(const Result& result) {
+        std::cout << std::left << std::setw(22) << result.name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << result.opsPerSecond() / 1e6 << std::setprecision(1)
+                  << std::setw(11) << result.mean_ns << std::setw(11) << result.p50_ns << std::setw(11) << result.p99_ns
+                  << std::setw(11) << result.p999_ns << std::setw(11) << result.max_ns;
+        if (result.batch > 1) {
+            std::cout << "  (batches of " << result.batch << ")";
+        }
+        std::cout << std::endl;
+        results_.push_back(result);
+    }
+
+    /**
+     * @brief Write the JSON results, if asked for (also done on destruction)
+     */
+    void writeJson() {
+        if (json_path_.empty() || written_) {
+            return;
+        }
+        written_ = true;
+        std::ofstream out(json_path_);
+        if (!out) {
+            throw std::runtime_error("Cannot write benchmark results to " + json_path_);
+        }
+        out << "{\n"
+            << "  \"suite\": \"" << name_ << "\",\n"
+            << "  \"build_type\": \"" << ORDERBOOK_BUILD_TYPE << "\",\n"
+            << "  \"compiler\": \"" << compiler() << "\",\n"
+            << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+            << "  \"count\": " << count_ << ",\n"
+            << "  \"clock_overhead_ns\": " << clock_overhead_ns_ << ",\n"
+            << "  \"results\": [\n";
+        for (size_t i = 0; i < results_.size(); ++i) {
+            const auto& r = results_[i];
+            char line[512];
+            std::snprintf(line, sizeof(line),
+                          "    {\"name\": \"%s\", \"ops\": %llu, \"batch\": %zu, \"ops_per_sec\": %.0f, "
+                          "\"mean_ns\": %.1f, \"p50_ns\": %lld, \"p99_ns\": %lld, \"p999_ns\": %lld, \"max_ns\": %lld}%s\n",
+                          r.name.c_str(), static_cast<unsigned long long>(r.ops), r.batch, r.opsPerSecond(), r.mean_ns,
+                          static_cast<long long>(r.p50_ns), static_cast<long long>(r.p99_ns),
+                          static_cast<long long>(r.p999_ns), static_cast<long long>(r.max_ns),
+                          i + 1 < results_.size() ? "," : "");
+            out << line;
+        }
+        out << "  ]\n}\n";
+        if (!out) {
+            throw std::runtime_error("Cannot write benchmark results to " + json_path_);
+        }
+        std::cout << "Results written to " << json_path_ << std::endl;
+    }
+
+private:
+    std::string name_;
+    size_t count_;
+    std::string json_path_;
+    std::string filter_;
+    int64_t clock_overhead_ns_ = 0;
+    std::vector<Result> results_;
+    bool written_ = false;
+
+    static int64_t measureClockOverhead() {
+        constexpr int kReads = 100000;
+        int64_t start = now();
+        int64_t last = start;
+        for (int i = 0; i < kReads; ++i) {
+            last = now();
+        }
+        return (last - start) / kReads;
+    }
+
+    static std::string compiler() {
+#if defined(__clang__)
+        return "clang " __clang_version__;
+#elif defined(__GNUC__)
+        return "gcc " __VERSION__;
+#else
+        return "unknown";
+#endif
+    }
+};
+
+} // namespace bench
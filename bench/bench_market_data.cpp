@@ -0,0 +1,592 @@
+#include "orderbook/market_data_handler.h"
+#include "orderbook/spsc_queue.h"
+#include "orderbook/market_data_feed.h"
+#include "orderbook/market_data_file.h"
+#include "orderbook/multicast.h"
+#include "orderbook/market_data_json.h"
+#include "orderbook/websocket.h"
+#include "orderbook/fix_parser.h"
+#include "orderbook/book_snapshot.h"
+#include "orderbook/journal.h"
+#include "orderbook/tick_store.h"
+#include <queue>
+#include <condition_variable>
+#include <thread>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+using namespace orderbook;
+using namespace std::chrono;
+
+namespace {
+
+// The previous dispatch path: string-keyed book lookup and dynamic_cast to
+// the concrete message class, with every message allocated on the heap.
+class PolymorphicHandler : public MarketDataHandler {
+public:
+    void registerOrderBook(const std::string& symbol, std::shared_ptr<OrderBook> book) {
+        books_[symbol] = std::move(book);
+    }
+
+    void handleMessage(const MarketDataMessage& message) override {
+        try {
+            switch (message.getType()) {
+                case MarketDataMessage::Type::ORDER_ADD: {
+                    const auto& add = dynamic_cast<const OrderAddMessage&>(message);
+                    if (auto book = find(add.getSymbol())) {
+                        book->addOrder(Order(add.getId(), book->getSymbolId(), add.getPrice(), add.getQuantity(),
+                                             add.getSide(), add.getType(),
+                                             high_resolution_clock::now().time_since_epoch()));
+                    }
+                    break;
+                }
+                case MarketDataMessage::Type::ORDER_MODIFY: {
+                    const auto& modify = dynamic_cast<const OrderModifyMessage&>(message);
+                    if (auto book = find(modify.getSymbol())) {
+                        book->modifyOrder(modify.getId(), modify.getNewPrice(), modify.getNewQuantity());
+                    }
+                    break;
+                }
+                case MarketDataMessage::Type::ORDER_CANCEL: {
+                    const auto& cancel = dynamic_cast<const OrderCancelMessage&>(message);
+                    if (auto book = find(cancel.getSymbol())) {
+                        book->cancelOrder(cancel.getId());
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+
+    std::shared_ptr<OrderBook> route(const std::string& symbol) { return find(symbol); }
+
+private:
+    std::unordered_map<std::string, std::shared_ptr<OrderBook>> books_;
+    std::mutex mutex_;
+
+    std::shared_ptr<OrderBook> find(const std::string& symbol) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = books_.find(symbol);
+        return it != books_.end() ? it->second : nullptr;
+    }
+};
+
+const std::vector<std::string> kSymbols = {"AAPL", "MSFT", "GOOG", "AMZN", "NVDA", "META", "TSLA", "AMD"};
+
+// Adds, modifies and cancels spread across a handful of symbols, mostly passive
+std::vector<MarketDataEvent> makeEvents(size_t count, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::geometric_distribution<int> distance(0.2);
+    std::uniform_int_distribution<int> size(1, 500);
+    std::uniform_int_distribution<size_t> symbol(0, kSymbols.size() - 1);
+
+    std::vector<MarketDataEvent> events;
+    std::vector<std::vector<Order::OrderId>> live(kSymbols.size());
+    events.reserve(count);
+
+    Order::OrderId next_id = 1;
+    for (size_t i = 0; i < count; ++i) {
+        size_t s = symbol(rng);
+        auto symbol_id = SymbolRegistry::instance().intern(kSymbols[s]);
+        auto& ids = live[s];
+        double roll = uniform(rng);
+        auto side = uniform(rng) < 0.5 ? Side::BUY : Side::SELL;
+
+        if (roll < 0.35 && !ids.empty()) {
+            std::uniform_int_distribution<size_t> pick(0, ids.size() - 1);
+            size_t idx = pick(rng);
+            events.push_back(MarketDataEvent::orderCancel(symbol_id, ids[idx], nanoseconds(i)));
+            ids[idx] = ids.back();
+            ids.pop_back();
+        } else if (roll < 0.45 && !ids.empty()) {
+            std::uniform_int_distribution<size_t> pick(0, ids.size() - 1);
+            events.push_back(MarketDataEvent::orderModify(symbol_id, ids[pick(rng)], 0, 0, nanoseconds(i)));
+            events.back().modify.quantity = size(rng);
+            events.back().modify.price = 0;  // Filled in below from the order's side
+        } else {
+            Order::Price offset = 1 + distance(rng);
+            Order::Price price = side == Side::BUY ? 10000 - offset : 10000 + offset;
+            ids.push_back(next_id);
+            events.push_back(MarketDataEvent::orderAdd(symbol_id, next_id++, price, size(rng), side,
+                                                       OrderType::LIMIT, nanoseconds(i)));
+        }
+    }
+
+    // Modifies keep each order on its own side of the book
+    std::unordered_map<Order::OrderId, Order::Price> prices;
+    for (auto& event : events) {
+        if (event.type == MarketDataEvent::Type::ORDER_ADD) {
+            prices[event.add.order_id] = event.add.price;
+        } else if (event.type == MarketDataEvent::Type::ORDER_MODIFY) {
+            event.modify.price = prices[event.modify.order_id];
+        }
+    }
+    return events;
+}
+
+std::unique_ptr<MarketDataMessage> toMessage(const MarketDataEvent& event) {
+    const auto& symbol = SymbolRegistry::instance().name(event.symbol_id);
+    switch (event.type) {
+        case MarketDataEvent::Type::ORDER_ADD:
+            return std::make_unique<OrderAddMessage>(symbol, event.add.order_id, event.add.price,
+                                                     event.add.quantity, event.add.side, event.add.order_type);
+        case MarketDataEvent::Type::ORDER_MODIFY:
+            return std::make_unique<OrderModifyMessage>(symbol, event.modify.order_id,
+                                                        event.modify.price, event.modify.quantity);
+        default:
+            return std::make_unique<OrderCancelMessage>(symbol, event.cancel.order_id);
+    }
+}
+
+std::vector<std::shared_ptr<OrderBook>> makeBooks() {
+    std::vector<std::shared_ptr<OrderBook>> books;
+    for (const auto& symbol : kSymbols) {
+        books.push_back(std::make_shared<OrderBook>(symbol));
+    }
+    return books;
+}
+
+void report(const char* name, size_t count, int64_t elapsed) {
+    std::cout << std::left << std::setw(14) << name
+              << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << static_cast<double>(elapsed) / count << " ns/msg"
+              << std::setw(10) << count * 1e3 / elapsed << " M msgs/s" << std::endl;
+}
+
+// Keeps the consumers' reads from being optimised away
+volatile uint64_t sink = 0;
+
+// Producer-to-consumer handoff through the old mutex and condition variable queue
+int64_t mutexHandoff(const std::vector<MarketDataEvent>& events) {
+    std::queue<std::unique_ptr<MarketDataEvent>> queue;
+    std::mutex mutex;
+    std::condition_variable condition;
+    uint64_t checksum = 0;
+
+    auto start = steady_clock::now();
+    std::thread consumer([&] {
+        for (size_t received = 0; received < events.size();) {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&queue] { return !queue.empty(); });
+            while (!queue.empty()) {
+                checksum += queue.front()->timestamp.count();
+                queue.pop();
+                ++received;
+            }
+        }
+    });
+    for (const auto& event : events) {
+        auto message = std::make_unique<MarketDataEvent>(event);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push(std::move(message));
+        }
+        condition.notify_one();
+    }
+    consumer.join();
+    auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    sink = checksum;
+    return elapsed;
+}
+
+// The same handoff through the SPSC ring, yielding when full or empty
+int64_t ringHandoff(const std::vector<MarketDataEvent>& events) {
+    SpscQueue<MarketDataEvent> queue(65536);
+    uint64_t checksum = 0;
+
+    auto start = steady_clock::now();
+    std::thread consumer([&] {
+        MarketDataEvent batch[64];
+        for (size_t received = 0; received < events.size();) {
+            size_t count = queue.popBatch(batch, 64);
+            for (size_t i = 0; i < count; ++i) {
+                checksum += batch[i].timestamp.count();
+            }
+            received += count;
+            if (count == 0) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (const auto& event : events) {
+        while (!queue.tryPush(event)) {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+    auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    sink = checksum;
+    return elapsed;
+}
+
+// Counts delivered events without touching a book
+class CountingHandler : public MarketDataHandler {
+public:
+    void handleMessage(const MarketDataMessage&) override {}
+    void handleEvent(const MarketDataEvent& event) override { checksum += event.timestamp.count(); }
+    uint64_t checksum = 0;
+};
+
+// Replays a recorded file at full speed into handler
+int64_t replayFile(const std::string& path, MarketDataHandler& handler) {
+    FileReplayFeed feed(path);
+    feed.registerHandler(&handler);
+    auto start = steady_clock::now();
+    feed.start();
+    while (!feed.finished()) {
+        std::this_thread::yield();
+    }
+    auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    feed.stop();
+    return elapsed;
+}
+
+// Receive cost of a multicast feed: each round queues datagrams in the socket while the feed is
+// stopped, then times the ingest thread draining them into the event queue. Returns the total drain time and what was lost.
+int64_t multicastLoopback(const std::vector<MarketDataEvent>& events, size_t batch, uint64_t& missed) {
+    constexpr size_t kRound = 2000;  // Datagrams that fit in the socket buffer
+
+    MulticastConfig multicast;
+    multicast.line_a = "127.0.0.1:39501";
+    multicast.batch = batch;
+    MulticastMarketDataFeed feed(multicast);
+    CountingHandler counter;
+    feed.registerHandler(&counter);
+
+    PublisherConfig config;
+    config.line_a = multicast.line_a;
+    config.events_per_packet = 1;  // Small datagrams, where the per-call cost shows
+    MulticastPublisher publisher(config);
+
+    int64_t elapsed = 0;
+    for (size_t sent = 0; sent < events.size(); sent += kRound) {
+        size_t n = std::min(kRound, events.size() - sent);
+        publisher.send(events.data() + sent, n);
+        auto start = steady_clock::now();
+        feed.start();
+        while (feed.getStats().published < sent + n && steady_clock::now() < start + seconds(5)) {
+            std::this_thread::yield();
+        }
+        elapsed += duration_cast<nanoseconds>(steady_clock::now() - start).count();
+        feed.stop();
+    }
+    missed = events.size() - feed.getStats().published;
+    sink = counter.checksum;
+    return elapsed;
+}
+
+// JSON messages of up to per_message events each, as a WebSocket feed would receive them
+std::vector<std::string> toJson(const std::vector<MarketDataEvent>& events, size_t per_message) {
+    std::vector<std::string> messages;
+    for (size_t i = 0; i < events.size(); i += per_message) {
+        size_t n = std::min(per_message, events.size() - i);
+        std::string message = n > 1 ? "[" : "";
+        for (size_t j = 0; j < n; ++j) {
+            if (j > 0) {
+                message += ',';
+            }
+            appendJson(message, events[i + j], 2);
+        }
+        if (n > 1) {
+            message += ']';
+        }
+        messages.push_back(std::move(message));
+    }
+    return messages;
+}
+
+// A local server pushes the messages over loopback; timed until the feed has published every event
+int64_t webSocketLoopback(const std::vector<std::string>& messages, size_t count) {
+    WebSocketServer server;
+    WebSocketConfig websocket;
+    websocket.price_decimals = 2;
+    WebSocketMarketDataFeed feed(server.url(), websocket);
+    CountingHandler counter;
+    feed.registerHandler(&counter);
+    feed.start();
+    server.waitForClients(1, seconds(5));
+
+    auto start = steady_clock::now();
+    server.replay(messages);
+    while (feed.getStats().published < count && steady_clock::now() < start + seconds(30)) {
+        std::this_thread::yield();
+    }
+    auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    feed.stop();
+    sink = counter.checksum;
+    return elapsed;
+}
+
+// Frames, checksums and decodes a stream of FIX messages as the FIX feed does; returns the time taken
+int64_t decodeFix(const std::string& stream, FixIsa isa, size_t& decoded) {
+    FixDecoder decoder(2, isa);
+    uint64_t checksum = 0;
+    decoded = 0;
+    auto start = steady_clock::now();
+    std::string_view rest(stream);
+    while (!rest.empty()) {
+        size_t length = fixMessageLength(rest);
+        auto message = rest.substr(0, length);
+        if (checkFixChecksum(message, isa)) {
+            decoded += decoder.decode(message, [&checksum](const MarketDataEvent& event) { checksum += event.sequence; });
+        }
+        rest.remove_prefix(length);
+    }
+    auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    sink = checksum;
+    return elapsed;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    auto events = makeEvents(count, 7);
+
+    std::cout << "Market data dispatch benchmark (" << count << " messages)" << std::endl;
+
+    {
+        PolymorphicHandler handler;
+        auto books = makeBooks();
+        for (size_t i = 0; i < kSymbols.size(); ++i) {
+            handler.registerOrderBook(kSymbols[i], books[i]);
+        }
+        auto start = steady_clock::now();
+        for (const auto& event : events) {
+            auto message = toMessage(event);
+            handler.handleMessage(*message);
+        }
+        report("polymorphic", count, duration_cast<nanoseconds>(steady_clock::now() - start).count());
+    }
+
+    {
+        MarketDataHandlerImpl handler;
+        auto books = makeBooks();
+        for (size_t i = 0; i < kSymbols.size(); ++i) {
+            handler.registerOrderBook(kSymbols[i], books[i]);
+        }
+        auto start = steady_clock::now();
+        for (const auto& event : events) {
+            handler.handleEvent(event);
+        }
+        report("event record", count, duration_cast<nanoseconds>(steady_clock::now() - start).count());
+    }
+
+    {
+        ShardedHandlerConfig config;
+        config.shards = 4;
+        ShardedMarketDataHandler handler(config);
+        for (const auto& symbol : kSymbols) {
+            handler.addSymbol(symbol);
+        }
+        auto start = steady_clock::now();
+        for (const auto& event : events) {
+            handler.handleEvent(event);
+        }
+        handler.drain();
+        report("sharded x4", count, duration_cast<nanoseconds>(steady_clock::now() - start).count());
+    }
+
+    // Routing alone: string-keyed map under a mutex vs the flat SymbolId table
+    {
+        PolymorphicHandler handler;
+        auto books = makeBooks();
+        for (size_t i = 0; i < kSymbols.size(); ++i) {
+            handler.registerOrderBook(kSymbols[i], books[i]);
+        }
+        std::vector<const std::string*> names;
+        for (const auto& event : events) {
+            names.push_back(&SymbolRegistry::instance().name(event.symbol_id));
+        }
+        uint64_t found = 0;
+        auto start = steady_clock::now();
+        for (const auto* name : names) {
+            found += handler.route(*name) != nullptr;
+        }
+        sink = found;
+        report("route: map", count, duration_cast<nanoseconds>(steady_clock::now() - start).count());
+    }
+
+    {
+        EpochDomain epoch;
+        SymbolTable<OrderBook> table(epoch);
+        auto books = makeBooks();
+        for (auto& book : books) {
+            table.set(book->getSymbolId(), book.get());
+        }
+        uint64_t found = 0;
+        auto start = steady_clock::now();
+        for (const auto& event : events) {
+            auto guard = epoch.read();
+            found += table.find(event.symbol_id) != nullptr;
+        }
+        sink = found;
+        report("route: table", count, duration_cast<nanoseconds>(steady_clock::now() - start).count());
+    }
+
+    report("mutex queue", count, mutexHandoff(events));
+    report("spsc ring", count, ringHandoff(events));
+
+    // File replay: the mapped file dispatched in batches, alone and into the books
+    {
+        std::string path = "/tmp/bench_market_data.events";
+        {
+            EventFileWriter writer(path);
+            writer.write(events.data(), events.size());
+        }
+        CountingHandler counter;
+        report("replay: count", count, replayFile(path, counter));
+        sink = counter.checksum;
+
+        MarketDataHandlerImpl handler;
+        auto books = makeBooks();
+        for (size_t i = 0; i < kSymbols.size(); ++i) {
+            handler.registerOrderBook(kSymbols[i], books[i]);
+        }
+        report("replay: books", count, replayFile(path, handler));
+        std::remove(path.c_str());
+    }
+
+    // Loopback multicast, one datagram per receive call vs recvmmsg batches
+    for (size_t batch : {size_t(1), size_t(32)}) {
+        uint64_t missed = 0;
+        auto elapsed = multicastLoopback(events, batch, missed);
+        report(batch == 1 ? "udp: batch 1" : "udp: batch 32", count, elapsed);
+        std::cout << std::setw(14) << "" << "  missed " << missed << " of " << count << std::endl;
+    }
+
+    // JSON over WebSocket: decoding alone, then end to end from a loopback server
+    {
+        auto messages = toJson(events, 16);
+        JsonEventDecoder decoder(2);
+        uint64_t checksum = 0;
+        auto start = steady_clock::now();
+        for (const auto& message : messages) {
+            decoder.decode(message, [&checksum](const MarketDataEvent& event) { checksum += event.sequence; });
+        }
+        sink = checksum;
+        report("json decode", count, duration_cast<nanoseconds>(steady_clock::now() - start).count());
+        report("websocket", count, webSocketLoopback(messages, count));
+    }
+
+    // FIX tag=value: the same stream through the scalar and SIMD field scanners
+    {
+        std::string stream;
+        for (size_t i = 0; i < events.size(); i += 4) {
+            appendFixIncrementalRefresh(stream, events.data() + i, std::min<size_t>(4, events.size() - i), i / 4 + 1, 2);
+        }
+        for (FixIsa isa : {FixIsa::SCALAR, FixIsa::SSE2, FixIsa::AVX2}) {
+            if (isa > bestFixIsa()) {
+                continue;
+            }
+            size_t decoded = 0;
+            auto elapsed = decodeFix(stream, isa, decoded);
+            report((std::string("fix: ") + fixIsaName(isa)).c_str(), decoded, elapsed);
+        }
+    }
+
+    // Warm start: a book of count resting orders rebuilt order by order vs loaded from a snapshot
+    {
+        std::mt19937_64 rng(7);
+        std::vector<Order> orders;
+        orders.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            bool buy = rng() & 1;
+            Order::Price price = buy ? 10000 - static_cast<Order::Price>(rng() % 1000)
+                                     : 10001 + static_cast<Order::Price>(rng() % 1000);
+            orders.emplace_back(i + 1, "AAPL", price, 1 + rng() % 100, buy ? Side::BUY : Side::SELL,
+                                OrderType::LIMIT, nanoseconds(i));
+        }
+
+        OrderBook book("AAPL");
+        auto start = steady_clock::now();
+        for (const auto& order : orders) {
+            book.addOrder(order);
+        }
+        report("book: add", count, duration_cast<nanoseconds>(steady_clock::now() - start).count());
+
+        std::string data;
+        start = steady_clock::now();
+        book.saveSnapshot(data);
+        report("snapshot save", count, duration_cast<nanoseconds>(steady_clock::now() - start).count());
+
+        OrderBook restored("AAPL");
+        start = steady_clock::now();
+        restored.loadSnapshot(data);
+        auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+        report("snapshot load", count, elapsed);
+        std::cout << std::setw(14) << "" << "  " << data.size() / (1 << 20) << " MiB, loaded in "
+                  << elapsed / 1000000 << " ms" << std::endl;
+
+        // The same adds recorded in a journal, then the journal replayed into a new book
+        auto path = (std::filesystem::temp_directory_path() / "bench_market_data.journal").string();
+        {
+            OrderBook journaled("AAPL");
+            auto journal = std::make_shared<BookJournal>(path);
+            journaled.setJournal(journal);
+            start = steady_clock::now();
+            for (const auto& order : orders) {
+                journaled.addOrder(order);
+            }
+            report("book: journal", count, duration_cast<nanoseconds>(steady_clock::now() - start).count());
+            journal->close();
+            auto stats = journal->getStats();
+            std::cout << std::setw(14) << "" << "  " << stats.commits << " commits, " << stats.full_waits
+                      << " waits for the writer" << std::endl;
+        }
+        JournalReplayer replayer;
+        start = steady_clock::now();
+        replayer.applyFile(path);
+        report("journal replay", count, duration_cast<nanoseconds>(steady_clock::now() - start).count());
+        std::filesystem::remove(path);
+    }
+
+    // Tick store: a day of trades appended to column files, then mapped and scanned for VWAP
+    {
+        auto root = (std::filesystem::temp_directory_path() / "bench_market_data_ticks").string();
+        std::filesystem::remove_all(root);
+        const int64_t day_start = 1709251200LL * 1000000000LL;
+        std::mt19937_64 rng(11);
+        std::vector<Trade> trades;
+        trades.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            trades.emplace_back(i + 1, "AAPL", 10000 + static_cast<Order::Price>(rng() % 100), 1 + rng() % 100,
+                                i, i + 1, nanoseconds(day_start + static_cast<int64_t>(i) * 1000),
+                                rng() & 1 ? Side::BUY : Side::SELL);
+        }
+
+        auto start = steady_clock::now();
+        {
+            TickStore store(root);
+            for (const auto& trade : trades) {
+                store.recordTrade(trade);
+            }
+        }
+        report("ticks: write", count, duration_cast<nanoseconds>(steady_clock::now() - start).count());
+
+        start = steady_clock::now();
+        TickDay day(root, "AAPL", TickStore::dayOf(nanoseconds(day_start)));
+        auto columns = day.trades();
+        int64_t notional = 0;
+        uint64_t volume = 0;
+        for (size_t i = 0; i < columns.rows; ++i) {
+            notional += columns.price[i] * static_cast<int64_t>(columns.size[i]);
+            volume += columns.size[i];
+        }
+        sink = static_cast<uint64_t>(notional / static_cast<int64_t>(volume));
+        report("ticks: vwap", columns.rows, duration_cast<nanoseconds>(steady_clock::now() - start).count());
+        std::filesystem::remove_all(root);
+    }
+
+    return 0;
+}
@@ -0,0 +1,353 @@
+#include "bench_harness.h"
+#include "orderbook/order_book.h"
+#include "orderbook/market_data_handler.h"
+#include "orderbook/market_data_feed.h"
+#include "orderbook/flow_generator.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace orderbook;
+using namespace std::chrono;
+
+namespace {
+
+constexpr Order::Price kMid = 10000;
+
+// Keeps the results of reads from being optimised away
+volatile uint64_t sink = 0;
+
+OrderBookConfig bookConfig(size_t orders) {
+    OrderBookConfig config;
+    config.order_capacity = orders;
+    return config;
+}
+
+// Resting limit orders a few ticks either side of the mid
+std::vector<Order> passiveOrders(const OrderBook& book, size_t count, uint64_t seed, Order::OrderId first_id = 1) {
+    std::mt19937_64 rng(seed);
+    std::geometric_distribution<int> distance(0.15);
+    std::uniform_int_distribution<int> size(1, 500);
+    std::vector<Order> orders;
+    orders.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto side = rng() & 1 ? Side::BUY : Side::SELL;
+        Order::Price offset = 1 + distance(rng);
+        orders.emplace_back(first_id + i, book.getSymbolId(), side == Side::BUY ? kMid - offset : kMid + offset,
+                            size(rng), side, OrderType::LIMIT, nanoseconds(i));
+    }
+    return orders;
+}
+
+void benchAdds(bench::Suite& suite) {
+    size_t count = suite.count();
+    if (suite.enabled("add: passive")) {
+        OrderBook book("BENCH", bookConfig(count));
+        auto orders = passiveOrders(book, count, 1);
+        suite.add(bench::timeEach("add: passive", count, 1, [&](size_t i) { book.addOrder(orders[i]); }));
+    }
+
+    // Each buy fills the order at the head of the best ask level in full
+    if (suite.enabled("add: aggressive")) {
+        OrderBook book("BENCH", bookConfig(count));
+        for (size_t i = 0; i < count; ++i) {
+            book.addOrder(Order(i + 1, book.getSymbolId(), kMid + 1 + static_cast<Order::Price>(i % 100), 100,
+                                Side::SELL, OrderType::LIMIT, nanoseconds(i)));
+        }
+        std::vector<Order> takers;
+        takers.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            takers.emplace_back(count + i + 1, book.getSymbolId(), kMid + 1000, 100, Side::BUY, OrderType::LIMIT,
+                                nanoseconds(count + i));
+        }
+        uint64_t trades = 0;
+        suite.add(bench::timeEach("add: aggressive", count, 1, [&](size_t i) { trades += book.addOrder(takers[i]).size(); }));
+        sink = trades;
+    }
+}
+
+// Cancels in random order from a book whose levels each start with depth orders
+void benchCancels(bench::Suite& suite) {
+    size_t count = suite.count();
+    for (size_t depth : {size_t(1), size_t(10), size_t(100), size_t(1000)}) {
+        std::string name = "cancel: depth " + std::to_string(depth);
+        if (!suite.enabled(name) || depth > count) {
+            continue;
+        }
+        OrderBook book("BENCH", bookConfig(count));
+        size_t levels = count / depth;
+        size_t resting = levels * depth;
+        for (size_t i = 0; i < resting; ++i) {
+            auto level = static_cast<Order::Price>(i / depth);
+            bool buy = level % 2 == 0;
+            Order::Price price = buy ? kMid - 1 - level / 2 : kMid + 1 + level / 2;
+            book.addOrder(Order(i + 1, book.getSymbolId(), price, 100, buy ? Side::BUY : Side::SELL,
+                                OrderType::LIMIT, nanoseconds(i)));
+        }
+        std::vector<Order::OrderId> ids(resting);
+        for (size_t i = 0; i < resting; ++i) {
+            ids[i] = i + 1;
+        }
+        std::shuffle(ids.begin(), ids.end(), std::mt19937_64(depth));
+        suite.add(bench::timeEach(name, resting, 1, [&](size_t i) { book.cancelOrder(ids[i]); }));
+    }
+}
+
+// Size reductions keep queue priority; price changes requeue the order at another level
+void benchModifies(bench::Suite& suite) {
+    size_t count = suite.count();
+    size_t resting = std::min<size_t>(count, 100000);
+    OrderBook book("BENCH", bookConfig(resting));
+    auto orders = passiveOrders(book, resting, 2);
+    for (auto& order : orders) {
+        order = Order(order.getId(), order.getSymbolId(), order.getPrice(), 1000000000, order.getSide(),
+                      OrderType::LIMIT, order.getTimestamp());
+        book.addOrder(order);
+    }
+
+    if (suite.enabled("modify: size")) {
+        suite.add(bench::timeEach("modify: size", count, 1, [&](size_t i) {
+            const auto& order = orders[i % resting];
+            book.modifyOrder(order.getId(), order.getPrice(),
+                             order.getQuantity() - 1 - static_cast<Order::Quantity>(i / resting));
+        }));
+    }
+
+    if (suite.enabled("modify: price")) {
+        std::mt19937_64 rng(3);
+        std::vector<Order::Price> prices(count);
+        for (size_t i = 0; i < count; ++i) {
+            Order::Price offset = 1 + static_cast<Order::Price>(rng() % 20);
+            prices[i] = orders[i % resting].getSide() == Side::BUY ? kMid - offset : kMid + offset;
+        }
+        suite.add(bench::timeEach("modify: price", count, 1, [&](size_t i) {
+            book.modifyOrder(orders[i % resting].getId(), prices[i], 1000);
+        }));
+    }
+}
+
+// Queries of a static book of passive orders; batched, since each costs about a clock read
+void benchReads(bench::Suite& suite) {
+    size_t count = suite.count();
+    size_t resting = std::min<size_t>(count, 100000);
+    OrderBook book("BENCH", bookConfig(resting));
+    for (const auto& order : passiveOrders(book, resting, 4)) {
+        book.addOrder(order);
+    }
+
+    uint64_t total = 0;
+    if (suite.enabled("top of book")) {
+        suite.add(bench::timeEach("top of book", count, 64, [&](size_t) { total += book.getTopOfBook().bid_size; }));
+    }
+    if (suite.enabled("depth: 10")) {
+        suite.add(bench::timeEach("depth: 10", count, 16, [&](size_t) { total += book.getDepth(10).first.size(); }));
+    }
+    if (suite.enabled("depth: 10 into array")) {
+        PriceLevel levels[10];
+        suite.add(bench::timeEach("depth: 10 into array", count, 64, [&](size_t) {
+            total += book.getDepth(Side::BUY, levels, 10) + book.getDepth(Side::SELL, levels, 10);
+        }));
+    }
+    // Depth 5 reads the running sums; depth 20 is past the depth cache and walks the book
+    for (size_t depth : {size_t(5), size_t(20)}) {
+        std::string name = "ofi: " + std::to_string(depth);
+        if (suite.enabled(name)) {
+            suite.add(bench::timeEach(name, count, depth > book.getConfig().depth_levels ? 16 : 64, [&](size_t) {
+                total += static_cast<uint64_t>(book.calculateOrderFlowImbalance(depth) * 1000 + 1000);
+            }));
+        }
+    }
+    sink = total;
+}
+
+const std::vector<std::string> kSymbols = {"AAPL", "MSFT", "GOOG", "AMZN", "NVDA", "META", "TSLA", "AMD"};
+
+// Adds, modifies and cancels across a handful of symbols, with some adds crossing the spread
+std::vector<MarketDataEvent> makeEvents(size_t count, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::geometric_distribution<int> distance(0.2);
+    std::uniform_int_distribution<int> size(1, 500);
+
+    struct Live {
+        Order::OrderId id;
+        Order::Price price;
+    };
+    std::vector<std::vector<Live>> live(kSymbols.size());
+    std::vector<MarketDataEvent> events;
+    events.reserve(count);
+
+    Order::OrderId next_id = 1;
+    for (size_t i = 0; i < count; ++i) {
+        size_t s = rng() % kSymbols.size();
+        auto symbol_id = SymbolRegistry::instance().intern(kSymbols[s]);
+        auto& orders = live[s];
+        double roll = uniform(rng);
+        auto side = uniform(rng) < 0.5 ? Side::BUY : Side::SELL;
+
+        if (roll < 0.35 && !orders.empty()) {
+            size_t idx = rng() % orders.size();
+            events.push_back(MarketDataEvent::orderCancel(symbol_id, orders[idx].id, nanoseconds(i)));
+            orders[idx] = orders.back();
+            orders.pop_back();
+        } else if (roll < 0.45 && !orders.empty()) {
+            const auto& order = orders[rng() % orders.size()];
+            events.push_back(MarketDataEvent::orderModify(symbol_id, order.id, order.price, size(rng), nanoseconds(i)));
+        } else if (roll < 0.50) {
+            Order::Price price = side == Side::BUY ? kMid + 2 : kMid - 2;
+            events.push_back(MarketDataEvent::orderAdd(symbol_id, next_id++, price, size(rng), side,
+                                                       OrderType::IOC, nanoseconds(i)));
+        } else {
+            Order::Price offset = 1 + distance(rng);
+            Order::Price price = side == Side::BUY ? kMid - offset : kMid + offset;
+            orders.push_back({next_id, price});
+            events.push_back(MarketDataEvent::orderAdd(symbol_id, next_id++, price, size(rng), side,
+                                                       OrderType::LIMIT, nanoseconds(i)));
+        }
+        events.back().sequence = i + 1;
+    }
+    return events;
+}
+
+void registerBooks(MarketDataHandlerImpl& handler) {
+    for (const auto& symbol : kSymbols) {
+        handler.registerOrderBook(symbol, std::make_shared<OrderBook>(symbol));
+    }
+}
+
+// Publishes a list of events through the feed's queue, noting when each was sent;
+// a nonzero interval spaces the events out instead of sending them as fast as possible
+class SourceFeed : public BaseMarketDataFeed {
+public:
+    SourceFeed(const std::vector<MarketDataEvent>& events, std::vector<int64_t>& sent, int64_t interval_ns)
+        : events_(events), sent_(sent), interval_ns_(interval_ns) {}
+    ~SourceFeed() override { stop(); }
+
+protected:
+    void processMessages() override {
+        int64_t next = bench::now();
+        for (size_t i = 0; i < events_.size() && running_; ++i) {
+            if (interval_ns_ > 0) {
+                while (bench::now() < next) {
+                    std::this_thread::yield();
+                }
+                next += interval_ns_;
+            }
+            sent_[i] = bench::now();
+            publish(events_[i]);
+        }
+        while (running_) {
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+    }
+
+private:
+    const std::vector<MarketDataEvent>& events_;
+    std::vector<int64_t>& sent_;
+    int64_t interval_ns_;
+};
+
+// Applies events to the books and records how long after being sent each one was applied
+class TimedHandler : public MarketDataHandler {
+public:
+    TimedHandler(MarketDataHandlerImpl& books, const std::vector<int64_t>& sent, bench::LatencyRecorder& latency)
+        : books_(books), sent_(sent), latency_(latency) {}
+
+    void handleEvent(const MarketDataEvent& event) override {
+        books_.handleEvent(event);
+        latency_.record(bench::now() - sent_[event.sequence - 1]);
+        applied.store(event.sequence, std::memory_order_release);
+    }
+
+    std::atomic<uint64_t> applied{0};
+
+private:
+    MarketDataHandlerImpl& books_;
+    const std::vector<int64_t>& sent_;
+    bench::LatencyRecorder& latency_;
+};
+
+// From the handler to the books, and from a feed through its queue and dispatch thread to the books
+void benchEndToEnd(bench::Suite& suite) {
+    size_t count = suite.count();
+    auto events = makeEvents(count, 7);
+
+    if (suite.enabled("e2e: handler")) {
+        MarketDataHandlerImpl handler;
+        registerBooks(handler);
+        suite.add(bench::timeEach("e2e: handler", count, 1, [&](size_t i) { handler.handleEvent(events[i]); }));
+    }
+
+    // Latency runs from publish() to the event having been applied. Flat out it is mostly time
+    // queued behind other events; paced at 100k events/s it is the cost of one trip through the feed.
+    for (int64_t interval : {int64_t(0), int64_t(10000)}) {
+        std::string name = interval == 0 ? "e2e: feed" : "e2e: feed paced";
+        if (!suite.enabled(name)) {
+            continue;
+        }
+        size_t n = interval == 0 ? count : std::min<size_t>(count, 100000);
+        std::vector<MarketDataEvent> sending(events.begin(), events.begin() + n);
+        MarketDataHandlerImpl books;
+        registerBooks(books);
+        std::vector<int64_t> sent(n);
+        bench::LatencyRecorder latency(n);
+        TimedHandler handler(books, sent, latency);
+        SourceFeed feed(sending, sent, interval);
+        feed.registerHandler(&handler);
+
+        int64_t start = bench::now();
+        feed.start();
+        while (handler.applied.load(std::memory_order_acquire) < n) {
+            std::this_thread::yield();
+        }
+        int64_t elapsed = bench::now() - start;
+        feed.stop();
+        suite.add(latency.summarize(name, n, 1, elapsed));
+    }
+}
+
+// Synthetic flow across a thousand symbols: making it, and applying it to one book per symbol
+void benchFlow(bench::Suite& suite) {
+    size_t count = suite.count();
+    uint64_t total = 0;
+    if (suite.enabled("flow: generate")) {
+        OrderFlowGenerator generator;
+        suite.add(bench::timeEach("flow: generate", count, 64, [&](size_t) { total += generator.next().sequence; }));
+    }
+    if (suite.enabled("flow: apply")) {
+        OrderFlowGenerator generator;
+        std::vector<MarketDataEvent> events(count);
+        generator.generate(events.data(), count);
+        MarketDataHandlerImpl handler;
+        for (auto symbol_id : generator.symbolIds()) {
+            const auto& symbol = SymbolRegistry::instance().name(symbol_id);
+            handler.registerOrderBook(symbol, std::make_shared<OrderBook>(symbol));
+        }
+        suite.add(bench::timeEach("flow: apply", count, 1, [&](size_t i) { handler.handleEvent(events[i]); }));
+    }
+    sink = total;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        bench::Suite suite("Order book benchmark", argc, argv, 1000000);
+        benchAdds(suite);
+        benchCancels(suite);
+        benchModifies(suite);
+        benchReads(suite);
+        benchEndToEnd(suite);
+        benchFlow(suite);
+        suite.writeJson();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include "orderbook/order_book.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+
+using namespace orderbook;
+using namespace std::chrono;
+
+namespace {
+
+struct Operation {
+    enum class Kind { ADD, CANCEL, AGGRESS } kind;
+    Order order;
+    Order::OrderId cancel_id = 0;
+};
+
+// Churn near the touch: passive adds a few ticks from the mid, cancels of
+// live orders and the occasional marketable order that sweeps a level.
+std::vector<Operation> makeWorkload(size_t count, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::geometric_distribution<int> distance(0.15);
+    std::uniform_int_distribution<int> size(1, 500);
+
+    const Order::Price mid = 10000;
+    std::vector<Operation> ops;
+    std::vector<Order::OrderId> live;
+    ops.reserve(count);
+    live.reserve(count);
+
+    Order::OrderId next_id = 1;
+    for (size_t i = 0; i < count; ++i) {
+        double roll = uniform(rng);
+        auto side = uniform(rng) < 0.5 ? Side::BUY : Side::SELL;
+        auto ts = nanoseconds(i);
+
+        if (roll < 0.45 && !live.empty()) {
+            std::uniform_int_distribution<size_t> pick(0, live.size() - 1);
+            size_t idx = pick(rng);
+            ops.push_back({Operation::Kind::CANCEL, Order(), live[idx]});
+            live[idx] = live.back();
+            live.pop_back();
+        } else if (roll < 0.55) {
+            Order::Price price = side == Side::BUY ? mid + 2 : mid - 2;
+            ops.push_back({Operation::Kind::AGGRESS,
+                           Order(next_id++, "BENCH", price, size(rng), side, OrderType::LIMIT, ts)});
+        } else {
+            Order::Price offset = 1 + distance(rng);
+            Order::Price price = side == Side::BUY ? mid - offset : mid + offset;
+            live.push_back(next_id);
+            ops.push_back({Operation::Kind::ADD,
+                           Order(next_id++, "BENCH", price, size(rng), side, OrderType::LIMIT, ts)});
+        }
+    }
+    return ops;
+}
+
+void run(const char* name, const OrderBookConfig& config, const std::vector<Operation>& ops) {
+    OrderBook book("BENCH", config);
+
+    auto start = steady_clock::now();
+    for (const auto& op : ops) {
+        if (op.kind == Operation::Kind::CANCEL) {
+            book.cancelOrder(op.cancel_id);
+        } else {
+            book.addOrder(op.order);
+        }
+    }
+    auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+
+    const size_t tob_reads = 1000000;
+    Order::Quantity sink = 0;
+    auto tob_start = steady_clock::now();
+    for (size_t i = 0; i < tob_reads; ++i) {
+        sink += book.getTopOfBook().bid_size;
+    }
+    auto tob_elapsed = duration_cast<nanoseconds>(steady_clock::now() - tob_start).count();
+
+    std::cout << std::left << std::setw(8) << name
+              << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << static_cast<double>(elapsed) / ops.size() << " ns/op"
+              << std::setw(10) << ops.size() * 1e3 / elapsed << " Mops/s"
+              << std::setw(10) << static_cast<double>(tob_elapsed) / tob_reads << " ns/tob"
+              << "  (" << sink % 10 << ")" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 2000000;
+    auto ops = makeWorkload(count, 42);
+
+    std::cout << "Price level storage benchmark (" << count << " operations)" << std::endl;
+
+    OrderBookConfig map_config;
+    map_config.storage = BookStorage::MAP;
+    run("map", map_config, ops);
+
+    OrderBookConfig array_config;
+    array_config.storage = BookStorage::ARRAY;
+    run("array", array_config, ops);
+
+    return 0;
+}
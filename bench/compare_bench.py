@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""Compare two benchmark result files written with --json.
+
+Usage: compare_bench.py BEFORE.json AFTER.json [--threshold PERCENT]
+
+Prints the change in throughput and latency percentiles of every benchmark
+the two files have in common. Exits with status 1 if any benchmark lost
+more than the threshold (default 10%) of its throughput or gained more than
+it at p50 or p99, so the script can gate a build.
+"""
+
+import argparse
+import json
+import sys
+
+LATENCIES = ["p50_ns", "p99_ns", "p999_ns", "max_ns"]
+GATED = ["p50_ns", "p99_ns"]
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    return data, {result["name"]: result for result in data["results"]}
+
+
+def change(before, after):
+    return (after - before) * 100.0 / before if before else 0.0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two benchmark result files")
+    parser.add_argument("before")
+    parser.add_argument("after")
+    parser.add_argument("--threshold", type=float, default=10.0, help="regression threshold in percent")
+    args = parser.parse_args()
+
+    before_run, before = load(args.before)
+    after_run, after = load(args.after)
+    for key in ("build_type", "compiler", "hardware_threads", "count"):
+        if before_run.get(key) != after_run.get(key):
+            print(f"note: {key} differs: {before_run.get(key)} -> {after_run.get(key)}")
+
+    print(f"{'benchmark':22}{'Mops/s':>10}{'':>8}{'p50':>10}{'p99':>10}{'p99.9':>10}{'max':>10}  (% change)")
+    regressions = []
+    for name, old in before.items():
+        new = after.get(name)
+        if new is None:
+            continue
+        throughput = change(old["ops_per_sec"], new["ops_per_sec"])
+        latencies = {key: change(old[key], new[key]) for key in LATENCIES}
+        print(f"{name:22}{new['ops_per_sec'] / 1e6:>10.2f}{throughput:>+8.1f}"
+              + "".join(f"{latencies[key]:>+10.1f}" for key in LATENCIES))
+        if throughput < -args.threshold or any(latencies[key] > args.threshold for key in GATED):
+            regressions.append(name)
+
+    for name in sorted(set(before) ^ set(after)):
+        print(f"{name:22}  only in {'before' if name in before else 'after'}")
+
+    if regressions:
+        print(f"regressed by more than {args.threshold:g}%: " + ", ".join(regressions))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,62 @@
+#include "orderbook/book_snapshot.h"
+#include "orderbook/journal.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace orderbook;
+
+namespace {
+
+// The symbol a snapshot file was saved from, so a book can be made for it
+std::string snapshotSymbol(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    BookSnapshotHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw std::runtime_error("Cannot read snapshot " + path);
+    }
+    std::string symbol(header.symbol_length, '\0');
+    if (!in.read(&symbol[0], static_cast<std::streamsize>(symbol.size()))) {
+        throw std::runtime_error("Cannot read snapshot " + path);
+    }
+    return symbol;
+}
+
+} // namespace
+
+// Rebuilds the books recorded in a BookJournal and checks that they make
+// the recorded trades. Snapshot files give the state the journal started from.
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <journal-file> [snapshot-file...]" << std::endl;
+        return 1;
+    }
+
+    try {
+        JournalReplayer replayer;
+        for (int i = 2; i < argc; ++i) {
+            auto book = std::make_shared<OrderBook>(snapshotSymbol(argv[i]));
+            readBookSnapshot(argv[i], *book);
+            replayer.addBook(book);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        replayer.applyFile(argv[1]);
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "Replayed " << replayer.records() << " records in " << elapsed << " s"
+                  << (replayer.truncated() ? " (journal ends early)" : "") << std::endl;
+        for (const auto& book : replayer.getOrderBooks()) {
+            auto top = book->getTopOfBook();
+            std::cout << "  " << book->getSymbol() << ": " << book->getAllOrders().size() << " orders, bid "
+                      << top.bid_size << " @ " << top.bid_price << ", ask " << top.ask_size << " @ "
+                      << top.ask_price << std::endl;
+        }
+        std::cout << replayer.trades() << " trades, " << replayer.mismatches() << " mismatches" << std::endl;
+        return replayer.mismatches() == 0 ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
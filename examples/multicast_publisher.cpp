@@ -0,0 +1,50 @@
+#include "orderbook/market_data_file.h"
+#include "orderbook/multicast.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace orderbook;
+
+// Replays a recorded event file as sequenced datagrams, for feeding a
+// "multicast" MarketDataFeed on the same host or network.
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <events-file> <group:port>[,<group:port>] [events-per-second] [interface] [loops]" << std::endl
+                  << "  events-per-second  0 (default) sends as fast as possible" << std::endl
+                  << "  interface          Local address to send multicast from (default 127.0.0.1)" << std::endl;
+        return 1;
+    }
+
+    try {
+        MappedEventFile capture(argv[1]);
+
+        PublisherConfig config;
+        std::string lines = argv[2];
+        auto comma = lines.find(',');
+        config.line_a = lines.substr(0, comma);
+        config.line_b = comma == std::string::npos ? std::string() : lines.substr(comma + 1);
+        config.rate = argc > 3 ? std::stod(argv[3]) : 0.0;
+        if (argc > 4) {
+            config.interface = argv[4];
+        }
+        int loops = argc > 5 ? std::stoi(argv[5]) : 1;
+
+        MulticastPublisher publisher(config);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < loops; ++i) {
+            publisher.send(capture.data(), capture.size());
+        }
+        publisher.heartbeat();
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        uint64_t events = static_cast<uint64_t>(capture.size()) * loops;
+        std::cout << "Sent " << events << " events in " << publisher.packetsSent() << " packets per line in "
+                  << elapsed << " s (" << events / elapsed << " events/s)" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -5,6 +5,7 @@ Simple example demonstrating the use of the orderbook Python API.
 
 import time
 import datetime
+import tempfile
 
 # Try to import optional dependencies
 try:
@@ -117,6 +118,42 @@ def main():
     else:
         print("\nVisualization skipped due to missing dependencies.")
 
+    record_ticks()
+
+
+def record_ticks():
+    """Record a book's trades and quotes in a tick store and read them back as arrays"""
+    from orderbook.core import OrderBookConfig, UpdateNotification, TickStore, TickDay
+
+    print("\nRecording to a tick store...")
+
+    # Quote rows for every change of the best level, stamped with the order time
+    config = OrderBookConfig()
+    config.update_notification = UpdateNotification.ON_CHANGE
+    book = OrderBook("MSFT", config)
+
+    root = tempfile.mkdtemp(prefix="ticks_")
+    store = TickStore(root)
+    store.attach(book)
+
+    start = time.time_ns()
+    for i in range(1000):
+        side = Side.BUY if i % 2 else Side.SELL
+        book.add_order(
+            Order(i + 1, "MSFT", 30000 + i % 7 - 3, 10, side, OrderType.LIMIT, start + i)
+        )
+    store.close()
+
+    # The columns are read-only numpy arrays over the mapped files
+    day = TickDay(root, "MSFT", TickStore.day_of(start))
+    trades = day.trades()
+    quotes = day.quotes()
+    notional = (trades["price"] * trades["size"]).sum()
+    print(
+        f"{len(trades['time'])} trades, VWAP {notional / trades['size'].sum():.2f}; "
+        f"{len(quotes['time'])} quotes in {root}"
+    )
+
 
 def visualize_order_book(book):
     """Create a simple visualization of the order book"""
@@ -0,0 +1,364 @@
+#pragma once
+
+#include "order.h"
+#include "price_ladder.h"
+#include "object_pool.h"
+#include <map>
+#include <vector>
+#include <cstddef>
+
+namespace orderbook {
+
+/**
+ * @brief Aggregated view of a price level: price, total size and order count
+ */
+struct PriceLevel {
+    Order::Price price = 0;
+    Order::Quantity total_quantity = 0;
+    uint32_t order_count = 0;
+};
+
+struct BookLevel;
+
+// MAP storage: levels keyed by price, with tree nodes drawn from a pool
+using LevelMap = std::map<Order::Price, BookLevel*, std::less<Order::Price>,
+                          PoolAllocator<std::pair<const Order::Price, BookLevel*>>>;
+
+/**
+ * @brief A resting order linked into its level's FIFO queue
+ */
+struct OrderNode {
+    Order order;
+    OrderNode* prev = nullptr;
+    OrderNode* next = nullptr;
+    BookLevel* level = nullptr;
+    uint64_t sequence = 0;  // When a parked stop was placed or last modified
+};
+
+/**
+ * @brief Internal price level: an intrusive FIFO of pooled order nodes
+ */
+struct BookLevel {
+    Order::Price price = 0;
+    Order::Quantity total_quantity = 0;
+    size_t order_count = 0;
+    OrderNode* head = nullptr;
+    OrderNode* tail = nullptr;
+    LevelMap::iterator position{};  // The level's map entry (MAP storage only)
+
+    bool empty() const { return head == nullptr; }
+
+    /**
+     * @brief Append a node at the back of the queue
+     */
+    void pushBack(OrderNode* node) {
+        node->level = this;
+        node->next = nullptr;
+        node->prev = tail;
+        if (tail) {
+            tail->next = node;
+        } else {
+            head = node;
+        }
+        tail = node;
+        total_quantity += node->order.getRemainingQuantity();
+        ++order_count;
+    }
+
+    /**
+     * @brief Unlink a node from anywhere in the queue
+     *
+     * The caller is responsible for having removed the node's remaining quantity.
+     */
+    void unlink(OrderNode* node) {
+        if (node->prev) {
+            node->prev->next = node->next;
+        } else {
+            head = node->next;
+        }
+        if (node->next) {
+            node->next->prev = node->prev;
+        } else {
+            tail = node->prev;
+        }
+        node->prev = node->next = nullptr;
+        --order_count;
+    }
+};
+
+/**
+ * @brief Storage used for the price levels of each side of the book
+ */
+enum class BookStorage : uint8_t {
+    MAP = 0,    // Ordered tree keyed by price
+    ARRAY = 1   // Tick-indexed price ladder with an occupancy bitmap
+};
+
+/**
+ * @brief One side (bids or asks) of an order book
+ *
+ * Hides the level storage from the matching code: levels are always
+ * visited best price first, whichever storage is selected. Levels come
+ * from a pool, so their addresses are stable while they are occupied.
+ * With MAP storage the tree nodes are pooled too, and each level keeps
+ * its map position so that removing it needs no search.
+ *
+ * Quantity changes go through the side (pushBack, unlink, reduce) so that
+ * it can keep cumulative depth up to date for fill-or-kill checks, and an
+ * aggregated copy of the best levels in a flat array. A change to a cached
+ * level is applied in place; adding or removing a level inside the cached
+ * range marks the cache dirty until the next refreshDepth(). The refresh
+ * also brings the running size sums over the cached levels up to date.
+ */
+class BookSide {
+public:
+    using Price = Order::Price;
+
+    /**
+     * @brief Construct an empty book side
+     *
+     * @param side BUY visits levels from the highest price down, SELL from the lowest up
+     * @param storage The level storage to use
+     * @param tick_size The minimum price increment (ARRAY storage only)
+     * @param ladder_levels The initial number of ladder slots (ARRAY storage only)
+     * @param max_ladder_levels The number of slots the ladder may grow to (ARRAY storage only)
+     * @param level_capacity The number of levels to preallocate
+     * @param depth_levels The number of best levels to keep in the depth cache
+     */
+    BookSide(Side side, BookStorage storage, Price tick_size, size_t ladder_levels,
+             size_t max_ladder_levels, size_t level_capacity, size_t depth_levels = 0);
+
+    Side side() const { return side_; }
+    BookStorage storage() const { return storage_; }
+
+    bool empty() const;
+    size_t size() const;
+
+    /**
+     * @brief Check whether a price can be stored on this side
+     */
+    bool isValidPrice(Price price) const;
+
+    /**
+     * @brief Check whether a level at a price can be added without passing the ladder's maximum size
+     *
+     * Always true with MAP storage.
+     */
+    bool fits(Price price) const {
+        return storage_ != BookStorage::ARRAY || ladder_.fits(price);
+    }
+
+    /**
+     * @brief Find the level at a price
+     *
+     * @return BookLevel* The level, or nullptr if there is none
+     */
+    BookLevel* find(Price price);
+
+    /**
+     * @brief Get the level at a price, creating an empty one if needed
+     */
+    BookLevel* insert(Price price);
+
+    /**
+     * @brief Add a level behind all existing ones, for bulk loading
+     *
+     * The price must be worse than every level on the side. Orders are
+     * linked with BookLevel::pushBack and the level's total is added to
+     * the side once, by finishLevel(), rather than per order. The depth
+     * cache is rebuilt at the next refreshDepth().
+     */
+    BookLevel* appendLevel(Price price);
+    void finishLevel(BookLevel* level) { addQuantity(level, level->total_quantity); }
+
+    /**
+     * @brief Remove a level and return it to the pool
+     */
+    void erase(BookLevel* level);
+
+    /**
+     * @brief Append a node to a level's queue, adding its remaining quantity
+     */
+    void pushBack(BookLevel* level, OrderNode* node) {
+        level->pushBack(node);
+        addQuantity(level, node->order.getRemainingQuantity());
+        touch(level);
+    }
+
+    /**
+     * @brief Unlink a node from its level, removing its remaining quantity
+     *
+     * The level is left in place even if it becomes empty.
+     */
+    void unlink(OrderNode* node) {
+        auto* level = node->level;
+        level->total_quantity -= node->order.getRemainingQuantity();
+        addQuantity(level, 0 - node->order.getRemainingQuantity());
+        level->unlink(node);
+        touch(level);
+    }
+
+    /**
+     * @brief Remove quantity from a level after a fill or size reduction
+     */
+    void reduce(BookLevel* level, Order::Quantity quantity) {
+        level->total_quantity -= quantity;
+        addQuantity(level, 0 - quantity);
+        touch(level);
+    }
+
+    /**
+     * @brief Get the total resting quantity on this side
+     */
+    Order::Quantity totalQuantity() const { return total_quantity_; }
+
+    /**
+     * @brief Check whether an incoming order could fill completely against this side
+     *
+     * Counts the quantity at prices the incoming order would accept: at or
+     * below the limit for asks, at or above it for bids. Nothing is
+     * modified. With ARRAY storage the answer comes from the ladder's
+     * running sums; with MAP storage it walks level totals, stopping as
+     * soon as enough quantity is found.
+     *
+     * @param limit The incoming order's limit price
+     * @param quantity The quantity that must be available
+     * @param any_price Ignore the limit (market orders)
+     */
+    bool canFill(Price limit, Order::Quantity quantity, bool any_price) const;
+
+    /**
+     * @brief Get the best level (highest bid or lowest ask)
+     *
+     * @return BookLevel* The best level, or nullptr if the side is empty
+     */
+    BookLevel* best();
+    const BookLevel* best() const { return const_cast<BookSide*>(this)->best(); }
+
+    /**
+     * @brief Visit levels in priority order, best price first
+     *
+     * @param f Called with each level; return false to stop
+     */
+    template <typename F>
+    void forEachLevel(F&& f) {
+        auto visit = [&f](BookLevel* level) { return f(*level); };
+        if (storage_ == BookStorage::ARRAY) {
+            if (side_ == Side::BUY) {
+                ladder_.forEachDescending(visit);
+            } else {
+                ladder_.forEachAscending(visit);
+            }
+        } else if (side_ == Side::BUY) {
+            for (auto it = levels_.rbegin(); it != levels_.rend(); ++it) {
+                if (!visit(it->second)) {
+                    return;
+                }
+            }
+        } else {
+            for (auto& entry : levels_) {
+                if (!visit(entry.second)) {
+                    return;
+                }
+            }
+        }
+    }
+
+    template <typename F>
+    void forEachLevel(F&& f) const {
+        const_cast<BookSide*>(this)->forEachLevel([&f](const BookLevel& level) { return f(level); });
+    }
+
+    /**
+     * @brief Rebuild the depth cache if a level was added or removed inside it
+     */
+    void refreshDepth();
+
+    /**
+     * @brief Get the cached best levels, best price first
+     *
+     * Only current as of the last refreshDepth().
+     */
+    const PriceLevel* depth() const { return depth_.data(); }
+    size_t depthSize() const { return depth_size_; }
+    size_t depthCapacity() const { return depth_.size(); }
+
+    /**
+     * @brief Get the total size of the best levels
+     *
+     * O(1) from the running sums within the depth cache; walks the side
+     * for deeper requests. Only current as of the last refreshDepth().
+     */
+    Order::Quantity depthQuantity(size_t levels) const;
+
+    /**
+     * @brief Remove every level
+     *
+     * Order nodes still linked into the levels are not released.
+     */
+    void clear();
+
+private:
+    Side side_;
+    BookStorage storage_;
+    ObjectPool<BookLevel> level_pool_;
+    Order::Quantity total_quantity_ = 0;
+
+    // MAP storage, always in ascending price order
+    NodePool level_nodes_;
+    LevelMap levels_;
+
+    // ARRAY storage
+    PriceLadder<BookLevel*> ladder_;
+
+    // Aggregated copy of the best levels
+    std::vector<PriceLevel> depth_;
+    std::vector<Order::Quantity> depth_sums_;  // depth_sums_[i] = size of levels 0..i
+    size_t depth_size_ = 0;
+    bool depth_dirty_ = false;
+    bool depth_sums_stale_ = false;
+
+    void addQuantity(BookLevel* level, Order::Quantity delta) {
+        total_quantity_ += delta;
+        if (storage_ == BookStorage::ARRAY) {
+            ladder_.addWeight(level->price, delta);
+        }
+    }
+
+    bool accepts(Price limit, Price level_price) const {
+        return side_ == Side::SELL ? level_price <= limit : level_price >= limit;
+    }
+
+    // Index of a price in the depth cache, or depth_size_ if it is not cached
+    size_t depthIndex(Price price) const {
+        size_t i = 0;
+        while (i < depth_size_ && depth_[i].price != price) {
+            ++i;
+        }
+        return i;
+    }
+
+    // Copy a changed level into the depth cache if it is there
+    void touch(const BookLevel* level) {
+        if (depth_dirty_) {
+            return;
+        }
+        size_t i = depthIndex(level->price);
+        if (i < depth_size_) {
+            depth_[i].total_quantity = level->total_quantity;
+            depth_[i].order_count = static_cast<uint32_t>(level->order_count);
+            depth_sums_stale_ = true;
+        }
+    }
+
+    // Whether a new level at this price would land inside the depth cache
+    bool withinDepth(Price price) const {
+        if (depth_size_ < depth_.size()) {
+            return true;
+        }
+        return depth_size_ > 0 && (side_ == Side::BUY ? price > depth_[depth_size_ - 1].price
+                                                      : price < depth_[depth_size_ - 1].price);
+    }
+};
+
+} // namespace orderbook
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "order_book.h"
+#include <cstdint>
+#include <string>
+
+namespace orderbook {
+
+/**
+ * @brief Header of a binary order book snapshot
+ *
+ * Written by OrderBook::saveSnapshot() and read by OrderBook::loadSnapshot().
+ * The header is followed by the symbol (padded to 8 bytes) and then the
+ * four sides in the order bids, asks, buy stops, sell stops. Each side is
+ * its levels in priority order, each level record followed by its orders
+ * in queue order: BookSnapshotOrder records on the bid and ask sides,
+ * BookSnapshotStop records on the stop sides. Everything is in native
+ * byte order, so a snapshot is only meant to be read on the same kind of
+ * machine that wrote it.
+ */
+struct BookSnapshotHeader {
+    static constexpr char kMagic[8] = {'O', 'B', 'S', 'N', 'A', 'P', 'S', 'H'};
+    static constexpr uint32_t kVersion = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t symbol_length;
+    uint64_t sequence;          // Feed sequence number the book reflects, as given to saveSnapshot()
+    uint64_t order_count;       // Orders on all four sides
+    uint32_t level_counts[4];   // Bids, asks, buy stops, sell stops
+    uint64_t next_trade_id;
+    int64_t last_trade_price;
+    int64_t last_trade_time;    // Nanoseconds
+    uint8_t has_last_trade;
+    uint8_t reserved[23];
+};
+
+static_assert(sizeof(BookSnapshotHeader) == 96, "BookSnapshotHeader layout changed");
+
+/**
+ * @brief One price level of a snapshot, followed by order_count orders
+ */
+struct BookSnapshotLevel {
+    int64_t price;              // Stop price on the stop sides
+    uint32_t order_count;
+    uint32_t reserved;
+};
+
+/**
+ * @brief One resting order; its price and side come from the level
+ */
+struct BookSnapshotOrder {
+    uint64_t id;
+    uint64_t quantity;
+    uint64_t remaining;
+    int64_t timestamp;          // Nanoseconds
+};
+
+/**
+ * @brief One parked stop order
+ */
+struct BookSnapshotStop {
+    BookSnapshotOrder order;
+    int64_t price;              // Limit price (STOP_LIMIT)
+    uint8_t type;               // OrderType::STOP or OrderType::STOP_LIMIT
+    uint8_t reserved[7];
+};
+
+static_assert(sizeof(BookSnapshotLevel) == 16 && sizeof(BookSnapshotOrder) == 32 &&
+              sizeof(BookSnapshotStop) == 48, "Book snapshot record layout changed");
+
+/**
+ * @brief Save a book's snapshot to a file
+ *
+ * @throws std::runtime_error If the file cannot be written
+ */
+void writeBookSnapshot(const std::string& path, const OrderBook& book, uint64_t sequence = 0);
+
+/**
+ * @brief Load a book from a snapshot file, reading it through a memory mapping
+ *
+ * @return uint64_t The sequence number stored in the snapshot
+ * @throws std::runtime_error If the file cannot be read or is not a valid snapshot
+ * @throws std::invalid_argument If the snapshot is of another symbol
+ * @throws std::logic_error If the book has a journal attached
+ */
+uint64_t readBookSnapshot(const std::string& path, OrderBook& book);
+
+} // namespace orderbook
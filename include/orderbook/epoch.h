@@ -0,0 +1,263 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace orderbook {
+
+/**
+ * @brief Epoch-based reclamation for data published through atomic pointers
+ *
+ * Readers bracket each read-side critical section with enter() and
+ * exit() on a slot of their own, or hold a Guard from read(). Inside it
+ * they may load published pointers and use what they point to without
+ * locks. A writer that replaces a published object passes the old one to
+ * retire(); it is deleted once every reader that might still see it has
+ * left its critical section. synchronize() instead waits for that point,
+ * for callers that must know no reader is still using the old object
+ * (e.g. before destroying something it referred to).
+ *
+ * A dedicated reader thread can claim a slot with registerReader(); any
+ * other thread gets one on first use of read(), which it keeps until it
+ * exits. Critical sections may nest. enter() and exit() are a couple of
+ * stores to the reader's own cache line; writers pay for the scan over
+ * the slots.
+ */
+class EpochDomain {
+public:
+    static constexpr size_t kMaxReaders = 128;
+
+    /**
+     * @brief RAII read-side critical section
+     */
+    class Guard {
+    public:
+        Guard(EpochDomain& domain, size_t slot) : domain_(&domain), slot_(slot) { domain_->enter(slot_); }
+        ~Guard() {
+            if (domain_) {
+                domain_->exit(slot_);
+            }
+        }
+        Guard(Guard&& other) noexcept : domain_(other.domain_), slot_(other.slot_) { other.domain_ = nullptr; }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        Guard& operator=(Guard&&) = delete;
+
+    private:
+        EpochDomain* domain_;
+        size_t slot_;
+    };
+
+    EpochDomain() : slots_(std::make_shared<SlotArray>()), id_(nextDomainId()) {}
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    ~EpochDomain() {
+        for (auto& entry : retired_) {
+            entry.deleter(entry.object);
+        }
+    }
+
+    /**
+     * @brief Claim a reader slot for the calling thread
+     *
+     * @return size_t The slot, to pass to enter() and exit()
+     * @throws std::runtime_error If all kMaxReaders slots are taken
+     */
+    size_t registerReader() { return claim(*slots_); }
+
+    /**
+     * @brief Give back a reader slot (the reader must be outside a critical section)
+     */
+    void unregisterReader(size_t slot) { release(*slots_, slot); }
+
+    /**
+     * @brief Start a read-side critical section on the calling thread's slot
+     */
+    Guard read() { return Guard(*this, threadSlot()); }
+
+    /**
+     * @brief Start a read-side critical section
+     */
+    void enter(size_t slot) {
+        auto& reader = slots_->slots[slot];
+        if (reader.depth++ == 0) {
+            reader.epoch.store(epoch_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    /**
+     * @brief End a read-side critical section
+     */
+    void exit(size_t slot) {
+        auto& reader = slots_->slots[slot];
+        if (--reader.depth == 0) {
+            reader.epoch.store(kIdle, std::memory_order_release);
+        }
+    }
+
+    /**
+     * @brief Wait until no reader can still hold a pointer loaded before this call
+     *
+     * Must not be called from inside a critical section.
+     */
+    void synchronize() {
+        uint64_t target = advance();
+        while (oldestActive() < target) {
+            std::this_thread::yield();
+        }
+        reclaim();
+    }
+
+    /**
+     * @brief Delete an object once no reader can still hold it
+     *
+     * The object must already be unreachable through published pointers.
+     */
+    template <typename T>
+    void retire(const T* object) {
+        uint64_t target = advance();
+        {
+            std::lock_guard<std::mutex> lock(retire_mutex_);
+            retired_.push_back({const_cast<T*>(object), [](void* p) { delete static_cast<T*>(p); }, target});
+            retired_count_.store(retired_.size(), std::memory_order_relaxed);
+        }
+        reclaim();
+    }
+
+    /**
+     * @brief Delete retired objects that no reader can hold any more
+     */
+    void reclaim() {
+        uint64_t oldest = oldestActive();
+        std::lock_guard<std::mutex> lock(retire_mutex_);
+        size_t kept = 0;
+        for (auto& entry : retired_) {
+            if (entry.epoch <= oldest) {
+                entry.deleter(entry.object);
+            } else {
+                retired_[kept++] = entry;
+            }
+        }
+        retired_.resize(kept);
+        retired_count_.store(kept, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Check, without locking, whether anything is waiting to be reclaimed
+     */
+    bool hasRetired() const { return retired_count_.load(std::memory_order_relaxed) > 0; }
+
+private:
+    static constexpr uint64_t kIdle = UINT64_MAX;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{kIdle};
+        std::atomic<bool> in_use{false};
+        uint32_t depth = 0;  // Nesting depth, only touched by the owning thread
+    };
+
+    // Shared with the per-thread slot caches, which may outlive the domain
+    struct SlotArray {
+        Slot slots[kMaxReaders];
+    };
+
+    struct Retired {
+        void* object;
+        void (*deleter)(void*);
+        uint64_t epoch;
+    };
+
+    // Slots the calling thread holds in live domains, released when it exits
+    struct ThreadSlots {
+        struct Entry {
+            uint64_t domain_id;
+            size_t slot;
+            std::weak_ptr<SlotArray> slots;
+        };
+        std::vector<Entry> entries;
+
+        ~ThreadSlots() {
+            for (auto& entry : entries) {
+                if (auto slots = entry.slots.lock()) {
+                    release(*slots, entry.slot);
+                }
+            }
+        }
+    };
+
+    std::shared_ptr<SlotArray> slots_;
+    const uint64_t id_;
+    alignas(64) std::atomic<uint64_t> epoch_{1};
+    std::mutex retire_mutex_;
+    std::vector<Retired> retired_;
+    std::atomic<size_t> retired_count_{0};
+
+    static uint64_t nextDomainId() {
+        static std::atomic<uint64_t> next{1};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static size_t claim(SlotArray& slots) {
+        for (size_t i = 0; i < kMaxReaders; ++i) {
+            bool expected = false;
+            if (slots.slots[i].in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                return i;
+            }
+        }
+        throw std::runtime_error("EpochDomain: too many readers");
+    }
+
+    static void release(SlotArray& slots, size_t slot) {
+        slots.slots[slot].depth = 0;
+        slots.slots[slot].epoch.store(kIdle, std::memory_order_release);
+        slots.slots[slot].in_use.store(false, std::memory_order_release);
+    }
+
+    // The calling thread's slot in this domain, claimed on first use
+    size_t threadSlot() {
+        static thread_local ThreadSlots cache;
+        for (const auto& entry : cache.entries) {
+            if (entry.domain_id == id_) {
+                return entry.slot;
+            }
+        }
+        size_t slot = claim(*slots_);
+        auto& entries = cache.entries;
+        for (size_t i = entries.size(); i-- > 0;) {
+            if (entries[i].slots.expired()) {
+                entries.erase(entries.begin() + i);
+            }
+        }
+        entries.push_back({id_, slot, slots_});
+        return slot;
+    }
+
+    // Start a new epoch; readers that entered before it may hold old pointers
+    uint64_t advance() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return epoch_.fetch_add(1, std::memory_order_seq_cst) + 1;
+    }
+
+    // The oldest epoch any reader is in, or kIdle if none is reading
+    uint64_t oldestActive() const {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t oldest = kIdle;
+        for (const auto& slot : slots_->slots) {
+            uint64_t epoch = slot.epoch.load(std::memory_order_acquire);
+            if (epoch < oldest) {
+                oldest = epoch;
+            }
+        }
+        return oldest;
+    }
+};
+
+} // namespace orderbook
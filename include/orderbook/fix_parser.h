@@ -0,0 +1,285 @@
+#pragma once
+
+#include "market_data_event.h"
+#include "symbol_registry.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace orderbook {
+
+constexpr char kFixSoh = '\x01';
+
+/**
+ * @brief Instruction sets the FIX field scanner can use
+ */
+enum class FixIsa : uint8_t {
+    SCALAR,
+    SSE2,
+    AVX2
+};
+
+/**
+ * @brief The widest scanner this CPU supports
+ */
+FixIsa bestFixIsa();
+
+const char* fixIsaName(FixIsa isa);
+
+/**
+ * @brief One tag=value field; value points into the message
+ */
+struct FixField {
+    uint32_t tag;
+    std::string_view value;
+};
+
+/**
+ * @brief Split a tag=value message into fields
+ *
+ * Bitmasks of the SOH and '=' bytes are built 64 bytes at a time with
+ * SSE2 or AVX2 compares and walked with count-trailing-zeros; the scalar
+ * scanner steps through the bytes instead. A field is everything
+ * up to the next SOH, split at its first '=', so values may contain '='.
+ * Fields with no '=' or a non-numeric tag are skipped, as is any text
+ * after the last SOH.
+ *
+ * @return size_t Number of fields found; stops at max_fields
+ */
+size_t splitFixFields(const char* data, size_t size, FixField* fields, size_t max_fields, FixIsa isa);
+
+/**
+ * @brief Parse an unsigned decimal integer, eight digits at a time
+ *
+ * @return bool False if value is empty, too long or not all digits
+ */
+bool parseFixUnsigned(std::string_view value, uint64_t& result);
+
+/**
+ * @brief Parse a decimal price as an integer scaled by 10^decimals
+ *
+ * Extra fraction digits are dropped. A leading '-' is allowed.
+ *
+ * @return bool False if value is malformed or does not fit in int64_t once scaled
+ */
+bool parseFixPrice(std::string_view value, int decimals, int64_t& result);
+
+/**
+ * @brief Parse a UTCTimestamp ("YYYYMMDD-HH:MM:SS[.fraction]") as nanoseconds since the epoch
+ */
+bool parseFixTime(std::string_view value, int64_t& nanoseconds);
+
+/**
+ * @brief Sum of the bytes modulo 256, as carried in tag 10
+ */
+uint8_t fixChecksum(const char* data, size_t size, FixIsa isa);
+
+/**
+ * @brief Find the end of the message at the front of data
+ *
+ * The message must start with 8= and 9=; the body length is read from
+ * 9 and the trailer ("10=nnn" SOH) is expected straight after the body.
+ *
+ * @return size_t Length of the complete message; 0 if more bytes are needed;
+ *         kFixMalformed if data does not start with a well-formed header
+ */
+size_t fixMessageLength(std::string_view data);
+
+constexpr size_t kFixMalformed = static_cast<size_t>(-1);
+
+/**
+ * @brief Check the checksum in the trailer of a complete message
+ */
+bool checkFixChecksum(std::string_view message, FixIsa isa);
+
+/**
+ * @brief Session fields of a decoded message
+ */
+struct FixHeader {
+    std::string_view msg_type;     // 35
+    uint64_t seq_num = 0;          // 34
+    std::string_view test_req_id;  // 112
+};
+
+/**
+ * @brief Decodes FIX market data into MarketDataEvents
+ *
+ * Each entry of an incremental refresh (35=X) becomes one event:
+ *
+ *     279 MDUpdateAction   0 new, 1 change, 2 delete
+ *     269 MDEntryType      0 bid, 1 offer, 2 trade
+ *     278 MDEntryID        order id (order-level books)
+ *     270 MDEntryPx, 271 MDEntrySize, 55 Symbol, 1003 TradeID,
+ *     83 RptSeq, 60 TransactTime
+ *
+ * so a new bid or offer is an order add, a change is a modify, a delete
+ * is a cancel and a trade entry is a trade print. Adds, changes and
+ * trades need a positive size; a delete is the only way to remove an order. An entry's symbol
+ * defaults to that of the entry before it. The sequence number is RptSeq,
+ * or else MsgSeqNum; the timestamp is TransactTime, or else SendingTime.
+ * Other message types decode to no events but still fill in the header.
+ *
+ * Fields are found by splitFixFields() and read in place: numbers and
+ * prices are converted without strtol and nothing is allocated, except
+ * the first time a symbol is seen.
+ */
+class FixDecoder {
+public:
+    /**
+     * @param price_decimals Decimal places of Order::Price
+     * @param isa Scanner to split fields with
+     */
+    explicit FixDecoder(int price_decimals = 0, FixIsa isa = bestFixIsa());
+
+    /**
+     * @brief Decode one complete message, passing each event to sink
+     *
+     * Entries that cannot be decoded are counted in errors() and skipped;
+     * entry types other than bid, offer and trade are skipped silently.
+     *
+     * @return size_t The number of events decoded
+     */
+    template <typename Sink>
+    size_t decode(std::string_view message, Sink&& sink, FixHeader* header = nullptr) {
+        size_t count = split(message);
+        FixHeader local;
+        FixHeader& head = header ? *header : local;
+
+        Entry entry;
+        int64_t sending_time = 0;
+        SymbolId message_symbol = 0;
+        uint32_t first_tag = 0;  // Tag that starts each entry of the group
+        bool in_group = false;
+        size_t events = 0;
+
+        auto finish = [&] {
+            if (!entry.empty) {
+                int emitted = emit(entry, head, sending_time, sink);
+                events += emitted > 0;
+                errors_ += emitted < 0;
+            }
+            SymbolId symbol = entry.symbol;
+            entry = Entry();
+            entry.symbol = symbol;
+        };
+
+        for (size_t i = 0; i < count; ++i) {
+            const FixField& field = fields_[i];
+            if (field.tag == 10) {
+                break;  // Trailer
+            }
+            if (!in_group) {
+                switch (field.tag) {
+                    case 35: head.msg_type = field.value; break;
+                    case 34: parseFixUnsigned(field.value, head.seq_num); break;
+                    case 112: head.test_req_id = field.value; break;
+                    case 52: parseFixTime(field.value, sending_time); break;
+                    case 55: message_symbol = symbol(field.value); break;
+                    case 268:
+                        in_group = head.msg_type == "X";
+                        entry.symbol = message_symbol;
+                        break;
+                    default: break;
+                }
+                continue;
+            }
+
+            if (first_tag == 0) {
+                first_tag = field.tag;
+            } else if (field.tag == first_tag) {
+                finish();
+            }
+            entry.empty = false;
+            bool ok = true;
+            switch (field.tag) {
+                case 279: ok = field.value.size() == 1 && (entry.action = field.value[0]); break;
+                case 269: ok = field.value.size() == 1 && (entry.type = field.value[0]); break;
+                case 55: entry.symbol = symbol(field.value); break;
+                case 270: ok = parseFixPrice(field.value, price_decimals_, entry.price); break;
+                case 271: ok = parseFixPrice(field.value, 0, entry.size); break;
+                case 278: ok = parseFixUnsigned(field.value, entry.id); break;
+                case 1003: ok = parseFixUnsigned(field.value, entry.trade_id); break;
+                case 83: ok = parseFixUnsigned(field.value, entry.rpt_seq); break;
+                case 60: ok = parseFixTime(field.value, entry.time); break;
+                default: break;
+            }
+            entry.bad = entry.bad || !ok;
+        }
+        if (in_group) {
+            finish();
+        }
+        return events;
+    }
+
+    /**
+     * @brief Get the number of entries that could not be decoded
+     */
+    uint64_t errors() const { return errors_; }
+
+    FixIsa isa() const { return isa_; }
+
+private:
+    struct Entry {
+        char action = '0';
+        char type = 0;
+        SymbolId symbol = 0;
+        int64_t price = 0;
+        int64_t size = 0;
+        uint64_t id = 0;
+        uint64_t trade_id = 0;
+        uint64_t rpt_seq = 0;
+        int64_t time = 0;
+        bool empty = true;
+        bool bad = false;
+    };
+
+    int price_decimals_;
+    FixIsa isa_;
+    uint64_t errors_ = 0;
+    std::vector<FixField> fields_;
+    SymbolCache symbols_;
+
+    size_t split(std::string_view message);
+    SymbolId symbol(std::string_view name) { return symbols_.lookup(name); }
+
+    // 1 if an event was passed to sink, 0 if the entry is not one we map, -1 if it is malformed
+    template <typename Sink>
+    int emit(const Entry& entry, const FixHeader& head, int64_t sending_time, Sink& sink) {
+        MarketDataEvent event;
+        int result = entry.bad ? -1 : toEvent(entry, event);
+        if (result > 0) {
+            event.sequence = entry.rpt_seq ? entry.rpt_seq : head.seq_num;
+            event.timestamp = MarketDataEvent::Timestamp(entry.time ? entry.time : sending_time);
+            sink(event);
+        }
+        return result;
+    }
+
+    static int toEvent(const Entry& entry, MarketDataEvent& event);
+};
+
+/**
+ * @brief Append a complete message: header (8, 9, 35), the body fields and the checksum trailer
+ *
+ * @param body Fields after 35, each ending in SOH
+ */
+void appendFixMessage(std::string& out, std::string_view msg_type, std::string_view body,
+                      std::string_view begin_string = "FIX.4.4");
+
+/**
+ * @brief Append an incremental refresh (35=X) with one entry per event, as read by FixDecoder
+ *
+ * Order adds, modifies and cancels and trade prints are written; other
+ * events are left out.
+ */
+void appendFixIncrementalRefresh(std::string& out, const MarketDataEvent* events, size_t count,
+                                 uint64_t seq_num, int price_decimals = 0);
+
+/**
+ * @brief Format nanoseconds since the epoch as a UTCTimestamp with nanoseconds
+ */
+std::string formatFixTime(int64_t nanoseconds);
+
+} // namespace orderbook
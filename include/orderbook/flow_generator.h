@@ -0,0 +1,250 @@
+#pragma once
+
+#include "market_data_event.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <string>
+#include <vector>
+
+namespace orderbook {
+
+/**
+ * @brief Shape of the order flow made by an OrderFlowGenerator
+ */
+struct OrderFlowConfig {
+    uint64_t seed = 1;
+    size_t symbols = 1000;                    // Named SYM0000, SYM0001, ... unless symbol_names is set
+    std::vector<std::string> symbol_names;    // Symbols to use instead, most active first
+    double symbol_skew = 1.0;                 // Zipf exponent of symbol activity (0: all equally active)
+
+    // Arrivals: self-exciting (Hawkes) per symbol, with an exponentially decaying kernel
+    double base_rate = 100000.0;              // Events per second across all symbols, before excitation
+    double branching_ratio = 0.7;             // Events each event triggers on its symbol, on average (below 1)
+    double decay_rate = 1000.0;               // Per second; a burst dies out over about 1 / decay_rate
+    std::chrono::nanoseconds start_time{};    // Timestamp of the start of the flow
+
+    // Event mix, as relative weights; the cancel weight is for a symbol with target_orders_per_symbol resting
+    double add_weight = 0.46;
+    double cancel_weight = 0.42;
+    double modify_weight = 0.07;
+    double execute_weight = 0.05;
+    size_t target_orders_per_symbol = 200;
+    double marketable_fraction = 0.0;         // Adds that cross the spread as IOC orders
+    double price_change_fraction = 0.3;       // Modifies that move the order rather than resize it
+
+    // Prices
+    Order::Price start_price = 10000;         // Every symbol's starting mid
+    Order::Price tick_size = 1;
+    double touch_weight = 0.35;               // Chance an order joins the touch; each tick further is (1 - this) as likely
+    size_t max_distance = 100;                // Ticks behind the touch at most
+    double price_move = 0.001;                // Chance per event that the symbol's mid moves a tick
+
+    // Sizes: Pareto, rounded down to lots
+    double size_alpha = 1.5;                  // Tail exponent; lower is heavier
+    Order::Quantity min_size = 100;
+    Order::Quantity max_size = 100000;
+    Order::Quantity lot_size = 100;
+};
+
+/**
+ * @brief Counts of the events an OrderFlowGenerator has made
+ */
+struct OrderFlowStats {
+    uint64_t events = 0;
+    uint64_t adds = 0;               // Including marketable adds
+    uint64_t marketable_adds = 0;
+    uint64_t cancels = 0;
+    uint64_t modifies = 0;
+    uint64_t executes = 0;           // Including the executes that clear the way for a price move
+    uint64_t price_moves = 0;
+    uint64_t triggered = 0;          // Arrivals triggered by earlier events rather than the base rate
+    uint64_t live_orders = 0;        // Orders resting at the end of the flow so far
+};
+
+/**
+ * @brief Seeded generator of synthetic venue order flow
+ *
+ * Makes a stream of order adds, cancels, modifies and executes, in the
+ * form a venue's order-by-order feed would carry them, across any number
+ * of symbols:
+ *
+ * - Arrivals follow a Hawkes process per symbol: a base rate split
+ *   across the symbols by Zipf activity, plus an excitation each event
+ *   adds to its own symbol that decays exponentially, so activity comes
+ *   in bursts. It is simulated exactly, with no time stepping, in its
+ *   cluster form: every event triggers a Poisson(branching_ratio) number
+ *   of later events on its symbol, each after an exponential delay of
+ *   mean 1 / decay_rate. The cost per event does not grow with the
+ *   number of symbols.
+ * - Adds rest at the touch or a geometrically distributed number of
+ *   ticks behind it, on either side of the symbol's mid; sizes are
+ *   Pareto distributed.
+ * - Cancels and modifies pick a resting order at random; executes pick a
+ *   resting order near the touch and fill it in part or in full. Every
+ *   resting order is as likely to be cancelled, so the weight of cancels
+ *   grows with a symbol's resting orders, and its book settles around
+ *   the size where adds and removals balance (about
+ *   target_orders_per_symbol with the default mix).
+ * - Each symbol's mid takes a random walk of one tick at a time. Resting
+ *   orders a move leaves at or past the new mid are executed first, as
+ *   if the move traded through them.
+ *
+ * The generator keeps every order it has left resting, so with no
+ * marketable adds each cancel, modify and execute refers to a live order
+ * and the flow never crosses: applied to OrderBooks (applyEvent, or a
+ * MarketDataHandlerImpl with the symbols' books registered) it makes no
+ * trades, and the books end with live_orders orders. Marketable adds
+ * trade against resting orders without the generator knowing which, so
+ * some later events then refer to orders already filled, which the books
+ * ignore.
+ *
+ * The same seed and config give the same events. Events are numbered
+ * from 1 (sequence) and stamped with the simulated arrival time. Symbols
+ * are interned on construction.
+ */
+class OrderFlowGenerator {
+public:
+    /**
+     * @throws std::invalid_argument If the config is out of range
+     */
+    explicit OrderFlowGenerator(const OrderFlowConfig& config = OrderFlowConfig());
+
+    /**
+     * @brief Make the next event
+     */
+    MarketDataEvent next() {
+        if (pending_head_ == pending_.size()) {
+            step();
+        }
+        return pending_[pending_head_++];
+    }
+
+    /**
+     * @brief Make the next count events
+     */
+    void generate(MarketDataEvent* out, size_t count);
+
+    /**
+     * @brief SYMBOL records naming each symbol's ID, numbered 1 to the number of symbols
+     */
+    std::vector<MarketDataEvent> symbolRecords() const;
+
+    /**
+     * @brief Write the symbol records and the next count events to an event file
+     *
+     * The events are renumbered to follow the symbol records, so the file
+     * replays in any process through JournalReplayer, as well as through
+     * a FileReplayFeed in this one.
+     *
+     * @throws std::runtime_error If the file cannot be written
+     */
+    void writeFile(const std::string& path, size_t count);
+
+    const std::vector<SymbolId>& symbolIds() const { return symbol_ids_; }
+    const OrderFlowStats& getStats() const { return stats_; }
+    const OrderFlowConfig& getConfig() const { return config_; }
+
+private:
+    // xoshiro256** (same sequence on every platform, unlike the std distributions)
+    class Random {
+    public:
+        explicit Random(uint64_t seed);
+        uint64_t next() {
+            uint64_t result = rotl(s_[1] * 5, 7) * 9;
+            uint64_t t = s_[1] << 17;
+            s_[2] ^= s_[0];
+            s_[3] ^= s_[1];
+            s_[1] ^= s_[2];
+            s_[0] ^= s_[3];
+            s_[2] ^= t;
+            s_[3] = rotl(s_[3], 45);
+            return result;
+        }
+        double uniform() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }       // [0, 1)
+        double positive() { return static_cast<double>((next() >> 11) + 1) * 0x1.0p-53; } // (0, 1]
+        size_t below(size_t n) { return static_cast<size_t>((static_cast<unsigned __int128>(next()) * n) >> 64); }
+
+    private:
+        uint64_t s_[4];
+        static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    };
+
+    // Walker alias table: draws an index in proportion to its weight in constant time
+    class AliasTable {
+    public:
+        AliasTable() = default;
+        explicit AliasTable(const std::vector<double>& weights);
+        size_t sample(Random& random) const {
+            size_t i = random.below(probability_.size());
+            return random.uniform() < probability_[i] ? i : alias_[i];
+        }
+        bool empty() const { return probability_.empty(); }
+
+    private:
+        std::vector<double> probability_;
+        std::vector<uint32_t> alias_;
+    };
+
+    struct LiveOrder {
+        Order::OrderId id;
+        Order::Price price;
+        Order::Quantity quantity;
+    };
+
+    struct SymbolState {
+        Order::Price mid;
+        std::vector<LiveOrder> bids;
+        std::vector<LiveOrder> asks;
+    };
+
+    OrderFlowConfig config_;
+    Random random_;
+    std::vector<SymbolId> symbol_ids_;
+    std::vector<SymbolState> states_;
+
+    // Arrivals
+    struct Child {
+        double time;
+        uint32_t symbol;
+        bool operator>(const Child& other) const { return time > other.time; }
+    };
+    AliasTable base_symbols_;           // Shares of the base rate
+    std::priority_queue<Child, std::vector<Child>, std::greater<Child>> children_;  // Triggered arrivals to come
+    double next_base_time_ = 0;         // Seconds since start_time
+    double time_ = 0;
+    double mean_base_wait_ = 0;         // 1 / base_rate
+    double mean_delay_ = 0;             // 1 / decay_rate
+    double no_children_ = 0;            // exp(-branching_ratio), the chance an event triggers none
+
+    double cancel_per_order_ = 0;       // Cancel weight per resting order of a symbol
+
+    AliasTable distances_;              // Ticks behind the touch
+    AliasTable lots_;                   // Sizes in lots above the smallest, unless there are too many
+    Order::Quantity min_lots_ = 0;
+    double size_exponent_ = 0;          // -1 / size_alpha, for drawing sizes without lots_
+
+    Order::OrderId next_order_id_ = 1;
+    Trade::TradeId next_trade_id_ = 1;
+    uint64_t sequence_ = 0;
+    OrderFlowStats stats_;
+
+    std::vector<MarketDataEvent> pending_;  // Events made by the last step, not yet returned
+    size_t pending_head_ = 0;
+
+    void step();
+    size_t arrive(bool& triggered);
+    void movePrice(size_t symbol, MarketDataEvent::Timestamp timestamp);
+    void add(size_t symbol, MarketDataEvent::Timestamp timestamp);
+    void cancel(size_t symbol, MarketDataEvent::Timestamp timestamp);
+    void modify(size_t symbol, MarketDataEvent::Timestamp timestamp);
+    void execute(size_t symbol, MarketDataEvent::Timestamp timestamp);
+    void emit(MarketDataEvent event);
+
+    Order::Price placePrice(const SymbolState& state, Side side);
+    Order::Quantity drawSize();
+    LiveOrder& pickOrder(SymbolState& state, Side& side, size_t& index);
+};
+
+} // namespace orderbook
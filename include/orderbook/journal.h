@@ -0,0 +1,220 @@
+#pragma once
+
+#include "market_data_event.h"
+#include "market_data_file.h"
+#include "order_book.h"
+#include "spsc_queue.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace orderbook {
+
+/**
+ * @brief Durability settings for a BookJournal
+ */
+struct JournalConfig {
+    size_t queue_capacity = 65536;                   // Records buffered between the books and the writer
+    size_t commit_events = 4096;                     // Sync once this many records are unsynced (0: not by count)
+    std::chrono::microseconds commit_interval{1000}; // Sync once the oldest unsynced record is this old (0: not by time)
+    size_t preallocate = 64 << 20;                   // Bytes of file reserved on disk at a time
+    std::chrono::microseconds poll_interval{50};     // Writer sleep while the queue is empty
+};
+
+/**
+ * @brief Progress of a BookJournal
+ */
+struct JournalStats {
+    uint64_t recorded = 0;    // Records accepted from the books
+    uint64_t written = 0;     // Records handed to the file
+    uint64_t durable = 0;     // Records synced to disk
+    uint64_t commits = 0;     // Syncs
+    uint64_t full_waits = 0;  // Times a book found the queue full and had to wait
+};
+
+/**
+ * @brief Append-only journal of book mutations, written by a background thread
+ *
+ * A book with a journal attached (OrderBook::setJournal) records each
+ * call that changes it, as the MarketDataEvent it would take to repeat
+ * the call, and each trade it makes:
+ *
+ *     SYMBOL          setJournal (the book's symbol name; IDs are only valid in the recording process)
+ *     ORDER_ADD       addOrder (add.trade_limit is the trade buffer size of the bounded overload)
+ *     ORDER_MODIFY    modifyOrder
+ *     ORDER_CANCEL    cancelOrder
+ *     ORDER_EXECUTE   executeOrder
+ *     SNAPSHOT        clear (kSnapshotBegin, no order)
+ *     TRADE           each trade, after the call that made it
+ *
+ * Calls that fail without changing the book are not recorded.
+ * loadSnapshot() cannot be recorded and throws while a journal is
+ * attached: load first, then attach the journal, which then replays
+ * onto a book loaded from the same snapshot. Records are
+ * numbered from 1 in sequence.
+ *
+ * record() stamps the sequence number and pushes the record onto a
+ * single-producer queue; it never makes a system call. The writer thread
+ * drains the queue into the file and syncs it (fdatasync) as configured,
+ * so up to commit_events records or commit_interval of them can be lost
+ * in a crash. The file is an event file (see EventFileHeader) reserved
+ * on disk ahead of the writer; it is trimmed and its record count filled
+ * in by close(). After a crash the count is zero and the reserved tail is
+ * zeros, which end the sequence (see JournalReplayer).
+ *
+ * All books sharing a journal must be mutated from one thread at a time,
+ * e.g. the books of one shard, since that thread is the queue's producer.
+ */
+class BookJournal {
+public:
+    /**
+     * @brief Create or truncate a journal file and start the writer
+     *
+     * @throws std::runtime_error If the file cannot be created or reserved
+     */
+    explicit BookJournal(const std::string& path, const JournalConfig& config = JournalConfig());
+    ~BookJournal();
+
+    BookJournal(const BookJournal&) = delete;
+    BookJournal& operator=(const BookJournal&) = delete;
+
+    /**
+     * @brief Append a record (recording thread only)
+     *
+     * Waits for room if the writer has fallen a whole queue behind.
+     */
+    void record(MarketDataEvent event) {
+        event.sequence = sequence_.load(std::memory_order_relaxed) + 1;
+        sequence_.store(event.sequence, std::memory_order_relaxed);
+        if (!queue_.tryPush(event)) {
+            waitToPush(event);
+        }
+    }
+
+    /**
+     * @brief Wait until every record made so far is on disk
+     *
+     * Call from the recording thread, or once it has stopped recording.
+     *
+     * @throws std::runtime_error If the file could not be written
+     */
+    void flush();
+
+    /**
+     * @brief Write out the remaining records, sync, trim the file and stop the writer
+     *
+     * Nothing may be recorded afterwards.
+     *
+     * @throws std::runtime_error If the file could not be written
+     */
+    void close();
+
+    JournalStats getStats() const;
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+    JournalConfig config_;
+    int fd_ = -1;
+    SpscQueue<MarketDataEvent> queue_;
+
+    // Written by the recording thread
+    alignas(64) std::atomic<uint64_t> sequence_{0};
+    std::atomic<uint64_t> full_waits_{0};
+
+    // Written by the writer thread
+    alignas(64) std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> durable_{0};
+    std::atomic<uint64_t> commits_{0};
+    uint64_t reserved_bytes_ = 0;
+    std::string error_;               // First write error; set before failed_
+    std::atomic<bool> failed_{false};
+
+    std::atomic<bool> running_{true};
+    std::atomic<uint64_t> flush_target_{0};
+    std::mutex flush_mutex_;
+    std::condition_variable flushed_;
+    bool closed_ = false;
+    std::thread writer_;
+
+    void waitToPush(const MarketDataEvent& event);
+    void run();
+    bool append(const MarketDataEvent* events, size_t count);
+    void commit();
+};
+
+/**
+ * @brief Rebuilds books from a journal and checks that they trade as recorded
+ *
+ * Mutations are applied with applyEvent(); bounded adds are repeated
+ * with a trade buffer of the recorded size, so the books end up with the
+ * same orders, queue positions and trade IDs. Each recorded trade is
+ * compared with the next trade the replayed books made. Symbol IDs are
+ * mapped to this process's through the journal's SYMBOL records. Books
+ * are created on demand for each symbol, or supplied up front (e.g.
+ * loaded from the snapshot the journal started from). The replayer
+ * registers its own trade callback on every book.
+ */
+class JournalReplayer {
+public:
+    /**
+     * @param config Options for the books created on demand
+     */
+    explicit JournalReplayer(const OrderBookConfig& config = OrderBookConfig());
+
+    /**
+     * @brief Replay onto an existing book for its symbol (before applying any records)
+     */
+    void addBook(std::shared_ptr<OrderBook> book);
+
+    /**
+     * @brief Apply journal records in order
+     *
+     * Stops at the first record out of sequence, which is where a journal
+     * cut short by a crash ends.
+     *
+     * @return size_t The number of records consumed
+     * @throws std::runtime_error If a record is for a symbol the journal has not named
+     */
+    size_t apply(const MarketDataEvent* events, size_t count);
+
+    /**
+     * @brief Map a journal file and apply all of it
+     *
+     * @throws std::runtime_error If the file cannot be read
+     */
+    size_t applyFile(const std::string& path);
+
+    std::shared_ptr<OrderBook> getOrderBook(SymbolId symbol_id) const;
+    std::vector<std::shared_ptr<OrderBook>> getOrderBooks() const;
+
+    uint64_t records() const { return records_; }        // Records consumed
+    uint64_t trades() const { return trades_; }          // Recorded trades compared
+    uint64_t mismatches() const;                         // Recorded trades not reproduced, and extra trades made
+    bool truncated() const { return truncated_; }        // Apply stopped at a record out of sequence
+
+private:
+    OrderBookConfig config_;
+    std::unordered_map<SymbolId, std::shared_ptr<OrderBook>> books_;  // By local symbol ID
+    std::unordered_map<SymbolId, OrderBook*> recorded_;               // By journal symbol ID
+    std::vector<Trade> made_;   // Trades made by the replay, not yet compared
+    size_t compared_ = 0;       // Index of the next trade in made_ to compare
+    uint64_t records_ = 0;
+    uint64_t trades_ = 0;
+    uint64_t mismatches_ = 0;
+    bool truncated_ = false;
+
+    OrderBook& bookFor(SymbolId recorded_id);
+    OrderBook& bookNamed(const std::string& symbol);
+    void check(const MarketDataEvent& trade, SymbolId symbol_id);
+};
+
+} // namespace orderbook
@@ -0,0 +1,189 @@
+#pragma once
+
+#include "order.h"
+#include "trade.h"
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <string_view>
+#include <type_traits>
+
+namespace orderbook {
+
+/**
+ * @brief Fixed-size market data record
+ *
+ * One cache line holding a common header (type, symbol, sequence number,
+ * timestamp) and a body whose meaning depends on the type. Records are
+ * trivially copyable, so feeds can pass them by value through queues and
+ * buffers without allocating, and handlers route them with a switch on
+ * the type instead of virtual calls or RTTI.
+ */
+struct MarketDataEvent {
+    using Timestamp = std::chrono::nanoseconds;
+
+    enum class Type : uint8_t {
+        ORDER_ADD = 0,      // New order (body: add)
+        ORDER_MODIFY = 1,   // Price and/or size change (body: modify)
+        ORDER_CANCEL = 2,   // Order removed (body: cancel)
+        ORDER_EXECUTE = 3,  // Resting order executed at the venue (body: execute)
+        TRADE = 4,          // Trade print (body: trade)
+        HEARTBEAT = 5,      // No body
+        SNAPSHOT = 6,       // One resting order of a book snapshot (body: snapshot)
+        SYMBOL = 7          // Name of symbol_id for the records after it (body: symbol)
+    };
+
+    // Flags for SNAPSHOT records
+    static constexpr uint8_t kSnapshotBegin = 0x1;  // First record: clear the book before applying it
+    static constexpr uint8_t kSnapshotEnd = 0x2;    // Last record of the snapshot
+
+    struct Add {
+        Order::OrderId order_id;
+        Order::Price price;
+        Order::Quantity quantity;
+        Order::Price stop_price;
+        Side side;
+        OrderType order_type;
+        uint32_t trade_limit;  // Journal records: trade buffer size of a bounded OrderBook::addOrder, 0 if unbounded
+    };
+
+    struct Modify {
+        Order::OrderId order_id;
+        Order::Price price;
+        Order::Quantity quantity;
+    };
+
+    struct Cancel {
+        Order::OrderId order_id;
+    };
+
+    struct Execute {
+        Order::OrderId order_id;
+        Order::Quantity quantity;
+        Trade::TradeId trade_id;
+    };
+
+    struct TradePrint {
+        Trade::TradeId trade_id;
+        Order::Price price;
+        Order::Quantity quantity;
+        Order::OrderId buy_order_id;
+        Order::OrderId sell_order_id;
+    };
+
+    struct SnapshotOrder {
+        Order::OrderId order_id;
+        Order::Price price;
+        Order::Quantity quantity;
+        Side side;
+    };
+
+    struct SymbolName {
+        static constexpr size_t kMaxLength = 40;
+        char name[kMaxLength];  // Not terminated if kMaxLength long
+    };
+
+    Type type = Type::HEARTBEAT;
+    uint8_t flags = 0;
+    SymbolId symbol_id = 0;
+    uint64_t sequence = 0;
+    Timestamp timestamp{};
+
+    union {
+        Add add{};
+        Modify modify;
+        Cancel cancel;
+        Execute execute;
+        TradePrint trade;
+        SnapshotOrder snapshot;
+        SymbolName symbol;
+    };
+
+    static MarketDataEvent orderAdd(SymbolId symbol_id, Order::OrderId order_id, Order::Price price,
+                                    Order::Quantity quantity, Side side, OrderType order_type,
+                                    Timestamp timestamp, Order::Price stop_price = 0) {
+        MarketDataEvent event;
+        event.type = Type::ORDER_ADD;
+        event.symbol_id = symbol_id;
+        event.timestamp = timestamp;
+        event.add = Add{order_id, price, quantity, stop_price, side, order_type, 0};
+        return event;
+    }
+
+    static MarketDataEvent orderModify(SymbolId symbol_id, Order::OrderId order_id, Order::Price price,
+                                       Order::Quantity quantity, Timestamp timestamp) {
+        MarketDataEvent event;
+        event.type = Type::ORDER_MODIFY;
+        event.symbol_id = symbol_id;
+        event.timestamp = timestamp;
+        event.modify = Modify{order_id, price, quantity};
+        return event;
+    }
+
+    static MarketDataEvent orderCancel(SymbolId symbol_id, Order::OrderId order_id, Timestamp timestamp) {
+        MarketDataEvent event;
+        event.type = Type::ORDER_CANCEL;
+        event.symbol_id = symbol_id;
+        event.timestamp = timestamp;
+        event.cancel = Cancel{order_id};
+        return event;
+    }
+
+    static MarketDataEvent orderExecute(SymbolId symbol_id, Order::OrderId order_id, Order::Quantity quantity,
+                                        Trade::TradeId trade_id, Timestamp timestamp) {
+        MarketDataEvent event;
+        event.type = Type::ORDER_EXECUTE;
+        event.symbol_id = symbol_id;
+        event.timestamp = timestamp;
+        event.execute = Execute{order_id, quantity, trade_id};
+        return event;
+    }
+
+    static MarketDataEvent tradePrint(SymbolId symbol_id, Trade::TradeId trade_id, Order::Price price,
+                                      Order::Quantity quantity, Order::OrderId buy_order_id,
+                                      Order::OrderId sell_order_id, Timestamp timestamp) {
+        MarketDataEvent event;
+        event.type = Type::TRADE;
+        event.symbol_id = symbol_id;
+        event.timestamp = timestamp;
+        event.trade = TradePrint{trade_id, price, quantity, buy_order_id, sell_order_id};
+        return event;
+    }
+
+    static MarketDataEvent heartbeat(Timestamp timestamp) {
+        MarketDataEvent event;
+        event.type = Type::HEARTBEAT;
+        event.timestamp = timestamp;
+        return event;
+    }
+
+    static MarketDataEvent snapshotOrder(SymbolId symbol_id, Order::OrderId order_id, Order::Price price,
+                                         Order::Quantity quantity, Side side, uint8_t flags,
+                                         Timestamp timestamp) {
+        MarketDataEvent event;
+        event.type = Type::SNAPSHOT;
+        event.flags = flags;
+        event.symbol_id = symbol_id;
+        event.timestamp = timestamp;
+        event.snapshot = SnapshotOrder{order_id, price, quantity, side};
+        return event;
+    }
+
+    static MarketDataEvent symbolName(SymbolId symbol_id, std::string_view name) {
+        MarketDataEvent event;
+        event.type = Type::SYMBOL;
+        event.symbol_id = symbol_id;
+        event.symbol = SymbolName{};
+        name.copy(event.symbol.name, SymbolName::kMaxLength);
+        return event;
+    }
+
+    std::string_view symbolName() const {
+        return std::string_view(symbol.name, strnlen(symbol.name, SymbolName::kMaxLength));
+    }
+};
+
+static_assert(std::is_trivially_copyable<MarketDataEvent>::value, "MarketDataEvent must be trivially copyable");
+static_assert(sizeof(MarketDataEvent) <= 64, "MarketDataEvent must fit in a cache line");
+
+} // namespace orderbook
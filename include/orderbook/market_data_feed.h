@@ -10,13 +10,25 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
-#include <queue>
 #include "order_book.h"
+#include "market_data_event.h"
+#include "spsc_queue.h"
+#include "wait_strategy.h"
+#include "epoch.h"
+#include "market_data_file.h"
+#include "multicast.h"
+#include "market_data_json.h"
+#include "websocket.h"
+#include "fix_parser.h"
 
 namespace orderbook {
 
 /**
  * @brief Abstract base class for market data messages
+ * 
+ * Feeds deliver MarketDataEvent records. These polymorphic messages are
+ * only built for handlers that still override
+ * MarketDataHandler::handleMessage.
  */
 class MarketDataMessage {
 public:
@@ -38,13 +50,128 @@ private:
     Type type_;
 };
 
+class OrderAddMessage : public MarketDataMessage {
+public:
+    OrderAddMessage(const std::string& symbol, Order::OrderId id, Order::Price price, 
+                   Order::Quantity quantity, Side side, OrderType type)
+        : MarketDataMessage(Type::ORDER_ADD),
+          symbol_(symbol),
+          id_(id),
+          price_(price),
+          quantity_(quantity),
+          side_(side),
+          type_(type) {}
+
+    const std::string& getSymbol() const { return symbol_; }
+    Order::OrderId getId() const { return id_; }
+    Order::Price getPrice() const { return price_; }
+    Order::Quantity getQuantity() const { return quantity_; }
+    Side getSide() const { return side_; }
+    OrderType getType() const { return type_; }
+
+private:
+    std::string symbol_;
+    Order::OrderId id_;
+    Order::Price price_;
+    Order::Quantity quantity_;
+    Side side_;
+    OrderType type_;
+};
+
+class OrderModifyMessage : public MarketDataMessage {
+public:
+    OrderModifyMessage(const std::string& symbol, Order::OrderId id, 
+                      Order::Price new_price, Order::Quantity new_quantity)
+        : MarketDataMessage(Type::ORDER_MODIFY),
+          symbol_(symbol),
+          id_(id),
+          new_price_(new_price),
+          new_quantity_(new_quantity) {}
+
+    const std::string& getSymbol() const { return symbol_; }
+    Order::OrderId getId() const { return id_; }
+    Order::Price getNewPrice() const { return new_price_; }
+    Order::Quantity getNewQuantity() const { return new_quantity_; }
+
+private:
+    std::string symbol_;
+    Order::OrderId id_;
+    Order::Price new_price_;
+    Order::Quantity new_quantity_;
+};
+
+class OrderCancelMessage : public MarketDataMessage {
+public:
+    OrderCancelMessage(const std::string& symbol, Order::OrderId id)
+        : MarketDataMessage(Type::ORDER_CANCEL),
+          symbol_(symbol),
+          id_(id) {}
+
+    const std::string& getSymbol() const { return symbol_; }
+    Order::OrderId getId() const { return id_; }
+
+private:
+    std::string symbol_;
+    Order::OrderId id_;
+};
+
+class TradeMessage : public MarketDataMessage {
+public:
+    TradeMessage(const std::string& symbol, Trade::TradeId id, Trade::Price price,
+                Trade::Quantity quantity, Trade::OrderId buy_order_id, 
+                Trade::OrderId sell_order_id)
+        : MarketDataMessage(Type::TRADE),
+          symbol_(symbol),
+          id_(id),
+          price_(price),
+          quantity_(quantity),
+          buy_order_id_(buy_order_id),
+          sell_order_id_(sell_order_id) {}
+
+    const std::string& getSymbol() const { return symbol_; }
+    Trade::TradeId getId() const { return id_; }
+    Trade::Price getPrice() const { return price_; }
+    Trade::Quantity getQuantity() const { return quantity_; }
+    Trade::OrderId getBuyOrderId() const { return buy_order_id_; }
+    Trade::OrderId getSellOrderId() const { return sell_order_id_; }
+
+private:
+    std::string symbol_;
+    Trade::TradeId id_;
+    Trade::Price price_;
+    Trade::Quantity quantity_;
+    Trade::OrderId buy_order_id_;
+    Trade::OrderId sell_order_id_;
+};
+
 /**
  * @brief Message handler interface
  */
 class MarketDataHandler {
 public:
     virtual ~MarketDataHandler() = default;
-    virtual void handleMessage(const MarketDataMessage& message) = 0;
+
+    /**
+     * @brief Handle one market data event
+     * 
+     * The default implementation adapts the event for handlers written
+     * against the polymorphic messages: it builds the matching message on
+     * the stack and passes it to handleMessage. Events with no polymorphic
+     * equivalent (ORDER_EXECUTE) are dropped. Override this for the direct,
+     * allocation-free path.
+     * 
+     * @param event The event to handle
+     */
+    virtual void handleEvent(const MarketDataEvent& event);
+
+    /**
+     * @brief Handle a polymorphic market data message
+     * 
+     * Only called through the default handleEvent adapter.
+     * 
+     * @param message The message to handle
+     */
+    virtual void handleMessage(const MarketDataMessage& message) { (void)message; }
 };
 
 /**
@@ -85,22 +212,88 @@ public:
      */
     virtual void registerHandler(MarketDataHandler* handler) = 0;
 
+    /**
+     * @brief Unregister a handler
+     * 
+     * Once this returns the handler receives no further messages, unless
+     * it is called from inside a handler on the feed's delivery thread,
+     * in which case delivery stops from the next message.
+     * 
+     * @param handler The handler to unregister
+     * @return bool True if the handler was registered
+     */
+    virtual bool unregisterHandler(MarketDataHandler* handler) = 0;
+
     /**
      * @brief Factory method to create market data feeds
      * 
-     * @param type The type of market data feed to create (e.g., "websocket", "fix", "multicast")
+     * A "file" feed takes the path of a recorded event file, optionally
+     * followed by "?speed=<multiplier>" and/or "&queue=1" (see
+     * FileReplayFeed and ReplayConfig). A "multicast" feed takes
+     * "<group:port>[,<group:port>]" for lines A and B, optionally followed
+     * by "?interface=<address>", "&batch=<datagrams>" and
+     * "&buffer=<bytes>" (see MulticastMarketDataFeed and MulticastConfig).
+     * 
+     * @param type The type of market data feed to create (e.g., "websocket", "file", "fix", "multicast")
      * @param config The configuration string for the feed
      * @return std::unique_ptr<MarketDataFeed> A unique pointer to the created feed
      */
     static std::unique_ptr<MarketDataFeed> create(const std::string& type, const std::string& config);
 };
 
+/**
+ * @brief Configuration for the event queue of a BaseMarketDataFeed
+ */
+struct FeedConfig {
+    size_t queue_capacity = 65536;                    // Rounded up to a power of two
+    WaitStrategy wait_strategy = WaitStrategy::SPIN_YIELD;
+    uint32_t spin_iterations = 1024;                  // Polls before yielding or sleeping
+    bool drop_when_full = false;                      // Drop events instead of waiting for space
+};
+
+/**
+ * @brief Event queue counters of a BaseMarketDataFeed
+ */
+struct FeedStats {
+    uint64_t published = 0;           // Events accepted into the queue
+    uint64_t dispatched = 0;          // Events delivered to the handlers
+    uint64_t backpressure_waits = 0;  // Times the producer found the queue full and waited
+    uint64_t overflows = 0;           // Events dropped because the queue was full
+    size_t queue_depth = 0;           // Events currently queued
+    uint64_t async_dropped = 0;       // Events dropped because an async handler's queue was full
+};
+
+/**
+ * @brief Where a handler runs
+ */
+enum class HandlerMode : uint8_t {
+    INLINE = 0,  // Called on the dispatch thread, in registration order
+    ASYNC = 1    // Called on its own thread, fed through its own queue
+};
+
 /**
  * @brief Base class for market data feeds with common functionality
+ *
+ * The feed runs two threads. The ingest thread runs processMessages(),
+ * which decodes the source and hands each event to publish(). The
+ * dispatch thread drains a single-producer/single-consumer ring of
+ * events in batches and delivers them to the registered handlers. The
+ * ring stores events by value, so the hot path takes no locks and makes
+ * no allocations; how each side waits is set by FeedConfig.
+ *
+ * The handlers are published as an immutable set behind an atomic
+ * pointer. Registering or unregistering copies the set, swaps the
+ * pointer and retires the old copy through an EpochDomain, so the
+ * dispatch thread reads the set without locking and handlers can come
+ * and go while events are flowing. An ASYNC handler gets its own queue
+ * and thread: when it falls behind, its queue overflows (counted in
+ * async_dropped) instead of holding up the INLINE handlers.
+ *
+ * publish() must only be called from the ingest thread.
  */
 class BaseMarketDataFeed : public MarketDataFeed {
 public:
-    BaseMarketDataFeed();
+    explicit BaseMarketDataFeed(const FeedConfig& config = FeedConfig());
     ~BaseMarketDataFeed() override;
 
     void start() override;
@@ -108,46 +301,455 @@ public:
     void subscribe(const std::string& symbol) override;
     void unsubscribe(const std::string& symbol) override;
     void registerHandler(MarketDataHandler* handler) override;
+    bool unregisterHandler(MarketDataHandler* handler) override;
+
+    /**
+     * @brief Register a handler to run inline or on its own thread
+     * 
+     * @param handler The handler to register
+     * @param mode INLINE or ASYNC
+     * @param queue_capacity Capacity of an ASYNC handler's queue (0 uses FeedConfig::queue_capacity)
+     */
+    void registerHandler(MarketDataHandler* handler, HandlerMode mode, size_t queue_capacity = 0);
+
+    /**
+     * @brief Get the event queue counters
+     */
+    FeedStats getStats() const;
+
+    const FeedConfig& getConfig() const { return config_; }
 
 protected:
-    // Helper method to dispatch a message to all registered handlers
-    void dispatchMessage(const MarketDataMessage& message);
+    /**
+     * @brief Queue an event for the dispatch thread (ingest thread only)
+     *
+     * If the queue is full the event is dropped and counted as an
+     * overflow when drop_when_full is set; otherwise the caller waits for
+     * space using the configured wait strategy, which is counted as one
+     * backpressure wait. Waiting gives up, dropping the event, once the
+     * feed is stopping.
+     *
+     * @return bool True if the event was queued
+     */
+    bool publish(const MarketDataEvent& event);
+
+    /**
+     * @brief Deliver events to the current handler set on the calling thread
+     *
+     * Used by the dispatch thread for each batch it takes from the queue.
+     * A feed whose ingest thread already holds events in memory can call
+     * it directly instead of publish(), skipping the queue; it must not
+     * then also publish().
+     */
+    void dispatchBatch(const MarketDataEvent* events, size_t count);
 
-    // Queue for incoming messages
-    std::queue<std::unique_ptr<MarketDataMessage>> message_queue_;
+    /**
+     * @brief Deliver an event to the current handler set (inside dispatchBatch only)
+     */
+    void dispatchEvent(const MarketDataEvent& event);
+
+    FeedConfig config_;
+
+    // Events waiting for the dispatch thread
+    SpscQueue<MarketDataEvent> queue_;
     
     // Thread for processing messages
     std::thread processing_thread_;
     
-    // Synchronization
-    std::mutex mutex_;
-    std::condition_variable condition_;
+    // Thread delivering queued events to the handlers
+    std::thread dispatch_thread_;
+    
+    // Guards subscriptions, handler registration and start/stop; never taken by the dispatch thread
+    mutable std::mutex mutex_;
     std::atomic<bool> running_;
     
     // Subscribed symbols
     std::unordered_set<std::string> subscribed_symbols_;
     
-    // Registered handlers
-    std::vector<MarketDataHandler*> handlers_;
-    
     // Derived classes should implement this method to process messages from the feed
     virtual void processMessages() = 0;
+    
+    // Called by stop() once running_ is cleared; a feed whose ingest thread blocks in a system call wakes it here
+    virtual void interruptIngest() {}
+
+private:
+    struct AsyncHandler;
+    struct HandlerSet;
+
+    struct alignas(64) ProducerCounters {
+        std::atomic<uint64_t> published{0};
+        std::atomic<uint64_t> backpressure_waits{0};
+        std::atomic<uint64_t> overflows{0};
+    };
+
+    struct alignas(64) ConsumerCounters {
+        std::atomic<uint64_t> dispatched{0};
+    };
+
+    ProducerCounters producer_stats_;
+    ConsumerCounters consumer_stats_;
+
+    // Registered handlers: published set, plus the async handlers it refers to (owned)
+    std::atomic<const HandlerSet*> handlers_{nullptr};
+    std::vector<std::unique_ptr<AsyncHandler>> async_handlers_;
+    uint64_t removed_async_dropped_ = 0;
+    EpochDomain epoch_;
+
+    std::atomic<bool> dispatching_{false};
+    QueueWaiter dispatch_waiter_;   // Dispatch thread waiting for events
+    QueueWaiter producer_waiter_;   // Ingest thread waiting for space
+
+    void dispatchLoop();
+    void publishHandlers(HandlerSet* next);
+    bool onDispatchThread() const;
+};
+
+/**
+ * @brief Options for a WebSocketMarketDataFeed
+ */
+struct WebSocketConfig {
+    int price_decimals = 0;                              // Decimal places of Order::Price (see JsonEventDecoder)
+    size_t receive_buffer = 256 * 1024;                  // Initial receive buffer; grows for larger frames
+    size_t max_message = 16 << 20;                       // Larger frames or messages drop the connection
+    std::chrono::milliseconds connect_timeout{2000};
+    std::chrono::milliseconds reconnect_delay{100};      // Doubled after each failed attempt, up to 5 s
+};
+
+/**
+ * @brief Connection and decoding counters of a WebSocketMarketDataFeed
+ */
+struct WebSocketStats {
+    uint64_t connects = 0;        // Completed handshakes
+    uint64_t disconnects = 0;     // Connections lost or dropped
+    uint64_t bytes = 0;           // Bytes received after the handshake
+    uint64_t messages = 0;        // Text messages received
+    uint64_t events = 0;          // Events decoded from them
+    uint64_t decode_errors = 0;   // Objects that could not be decoded
+    uint64_t pings = 0;           // Pings answered
 };
 
 /**
  * @brief WebSocket implementation of market data feed
+ *
+ * Connects to a ws:// URL and keeps the connection up, reconnecting with
+ * backoff. The ingest thread waits in epoll on the non-blocking socket
+ * and on an eventfd used to wake it for subscription changes and stop().
+ * Bytes are read into one reusable buffer, frames are parsed in place
+ * (see WebSocketFrameParser) and text messages are decoded straight into
+ * events by a JsonEventDecoder, with no intermediate strings or objects.
+ *
+ * All subscriptions share the connection: on connect the feed sends
+ * {"op":"subscribe","symbols":[...]} for every subscribed symbol, and
+ * subscribe() and unsubscribe() send the same form for one symbol while
+ * connected.
  */
 class WebSocketMarketDataFeed : public BaseMarketDataFeed {
 public:
-    explicit WebSocketMarketDataFeed(const std::string& url);
+    /**
+     * @throws std::invalid_argument If the URL is not a ws:// URL
+     */
+    explicit WebSocketMarketDataFeed(const std::string& url, const FeedConfig& config = FeedConfig());
+    WebSocketMarketDataFeed(const std::string& url, const WebSocketConfig& websocket,
+                            const FeedConfig& config = FeedConfig());
     ~WebSocketMarketDataFeed() override;
 
+    void subscribe(const std::string& symbol) override;
+    void unsubscribe(const std::string& symbol) override;
+
+    /**
+     * @brief Check whether the handshake has completed on the current connection
+     */
+    bool connected() const { return connected_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Get the connection and decoding counters
+     */
+    WebSocketStats getWebSocketStats() const;
+
 protected:
     void processMessages() override;
+    void interruptIngest() override;
 
 private:
+    struct alignas(64) Counters {
+        std::atomic<uint64_t> connects{0};
+        std::atomic<uint64_t> disconnects{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> messages{0};
+        std::atomic<uint64_t> events{0};
+        std::atomic<uint64_t> decode_errors{0};
+        std::atomic<uint64_t> pings{0};
+    };
+
     std::string url_;
-    // Additional WebSocket-specific members
+    WebSocketUrl endpoint_;
+    WebSocketConfig websocket_;
+    JsonEventDecoder decoder_;
+    WebSocketFrameParser parser_;
+    std::vector<char> buffer_;
+    int wake_fd_ = -1;
+    std::atomic<bool> connected_{false};
+    std::vector<std::string> commands_;  // Subscription messages for the ingest thread, guarded by mutex_
+    Counters counters_;
+
+    int connect();
+    bool session(int fd);
+    bool sendText(int fd, const std::string& text);
+};
+
+/**
+ * @brief Replay options for a FileReplayFeed
+ */
+struct ReplayConfig {
+    double speed = 0.0;          // 0 replays as fast as possible; otherwise a multiple of recorded time
+    bool through_queue = false;  // Publish into the event queue instead of delivering from the mapping
+};
+
+/**
+ * @brief Market data feed that replays a recorded event file
+ *
+ * The file is memory-mapped and its records are handed to the handlers
+ * in place, in batches, straight from the ingest thread; through_queue
+ * sends them through the event queue and dispatch thread instead, as a
+ * live feed would. With a speed set, each event is delivered when its
+ * recorded timestamp, relative to the first event and divided by the
+ * speed, has elapsed since start(); stop() interrupts the wait for the
+ * next one, however far off. The feed stops delivering at the end
+ * of the file; finished() reports when that happens. A feed stopped
+ * before the end resumes from the next undelivered event when started
+ * again.
+ */
+class FileReplayFeed : public BaseMarketDataFeed {
+public:
+    /**
+     * @brief Map a recorded event file
+     *
+     * @throws std::runtime_error If the file cannot be mapped
+     */
+    explicit FileReplayFeed(const std::string& path, const ReplayConfig& replay = ReplayConfig(),
+                            const FeedConfig& config = FeedConfig());
+    ~FileReplayFeed() override;
+
+    /**
+     * @brief Check whether every event in the file has been delivered (or published)
+     */
+    bool finished() const { return finished_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Get the number of events delivered (or published) so far
+     */
+    uint64_t replayed() const { return replayed_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Get the number of events in the file
+     */
+    size_t size() const { return file_.size(); }
+
+protected:
+    void processMessages() override;
+    void interruptIngest() override;
+
+private:
+    MappedEventFile file_;
+    ReplayConfig replay_;
+    std::atomic<uint64_t> replayed_{0};
+    std::atomic<bool> finished_{false};
+
+    // A paced replay waits here for its next event; stop() wakes it however far off that is
+    std::mutex pace_mutex_;
+    std::condition_variable pace_wake_;
+};
+
+/**
+ * @brief Options for a MulticastMarketDataFeed
+ */
+struct MulticastConfig {
+    std::string line_a;                 // "group:port", or a unicast "address:port" (required)
+    std::string line_b;                 // Redundant line; empty for none
+    std::string interface = "0.0.0.0";  // Local address to join the groups on
+    size_t batch = 32;                  // Datagrams per recvmmsg call
+    int receive_buffer = 8 << 20;       // SO_RCVBUF bytes per line
+    uint64_t first_sequence = 0;        // First expected event number; 0 starts from the first packet
+    std::chrono::microseconds gap_timeout{1000};  // How long to wait for the other line to fill a hole
+};
+
+/**
+ * @brief Receive and arbitration counters of a MulticastMarketDataFeed
+ */
+struct MulticastStats {
+    uint64_t packets_a = 0;       // Datagrams received on line A
+    uint64_t packets_b = 0;       // Datagrams received on line B
+    uint64_t won_a = 0;           // Packets whose new events were taken from line A
+    uint64_t won_b = 0;           // Packets whose new events were taken from line B
+    uint64_t duplicates = 0;      // Packets discarded because every event was already delivered
+    uint64_t gaps = 0;            // Sequence gaps seen
+    uint64_t missed = 0;          // Events lost on both lines
+    uint64_t malformed = 0;       // Datagrams that were truncated or not in the packet format
+    uint64_t receive_calls = 0;   // recvmmsg calls that returned datagrams
+    uint64_t next_sequence = 0;   // Next event number expected
+};
+
+/**
+ * @brief Market data feed receiving sequenced datagrams over UDP
+ *
+ * Listens on one line, or on redundant A and B lines carrying the same
+ * packets (see PacketHeader). The ingest thread polls the sockets and
+ * drains each ready one with recvmmsg, up to batch datagrams per call,
+ * into fixed buffers. The datagrams of one receive round are ordered by
+ * sequence number and passed through a PacketArbiter: in the usual case
+ * the first copy of each event is published straight from the receive
+ * buffer and later copies are dropped. Packets that arrive ahead of a
+ * hole are held until the other line fills it; events missing from both
+ * lines, or still missing after gap_timeout, are reported as a gap, to
+ * the gap callback and in the stats. Multicast groups are joined on the
+ * configured interface; unicast addresses are simply bound, which is
+ * convenient for tests.
+ */
+class MulticastMarketDataFeed : public BaseMarketDataFeed {
+public:
+    /**
+     * @brief Called on the ingest thread with the first missing event number and the number missed
+     */
+    using GapCallback = std::function<void(uint64_t first, uint64_t count)>;
+
+    /**
+     * @brief Open and bind the sockets
+     *
+     * @throws std::runtime_error If a socket cannot be set up
+     * @throws std::invalid_argument If an address is malformed
+     */
+    explicit MulticastMarketDataFeed(const MulticastConfig& multicast, const FeedConfig& config = FeedConfig());
+    ~MulticastMarketDataFeed() override;
+
+    /**
+     * @brief Set the gap callback (before start())
+     */
+    void setGapCallback(GapCallback callback) { on_gap_ = std::move(callback); }
+
+    /**
+     * @brief Get the receive and arbitration counters
+     */
+    MulticastStats getMulticastStats() const;
+
+protected:
+    void processMessages() override;
+
+private:
+    struct alignas(64) Counters {
+        std::atomic<uint64_t> packets[2] = {};
+        std::atomic<uint64_t> won[2] = {};
+        std::atomic<uint64_t> duplicates{0};
+        std::atomic<uint64_t> gaps{0};
+        std::atomic<uint64_t> missed{0};
+        std::atomic<uint64_t> malformed{0};
+        std::atomic<uint64_t> receive_calls{0};
+        std::atomic<uint64_t> next_sequence{0};
+    };
+
+    MulticastConfig multicast_;
+    int fds_[2] = {-1, -1};
+    size_t line_count_ = 0;
+    PacketArbiter arbiter_;
+    GapCallback on_gap_;
+    Counters counters_;
+
+    void publishArbiterStats();
+};
+
+/**
+ * @brief Options for a FixMarketDataFeed
+ */
+struct FixConfig {
+    std::string endpoint;                     // "host:port" of the FIX server
+    int price_decimals = 0;                   // Decimal places of Order::Price
+    bool validate_checksum = true;            // Drop messages whose tag 10 does not match
+    std::string sender_comp_id;               // Log on with these when set; otherwise just listen
+    std::string target_comp_id;
+    int heartbeat_interval = 30;              // Seconds, sent in the Logon (108)
+    size_t receive_buffer = 256 * 1024;       // Initial receive buffer; grows for larger messages
+    std::chrono::milliseconds connect_timeout{2000};
+    std::chrono::milliseconds reconnect_delay{100};  // Doubled after each failed attempt, up to 5 s
+    FixIsa isa = bestFixIsa();                // Field scanner
+};
+
+/**
+ * @brief Connection and decoding counters of a FixMarketDataFeed
+ */
+struct FixStats {
+    uint64_t connects = 0;         // Connections established
+    uint64_t disconnects = 0;      // Connections lost
+    uint64_t bytes = 0;            // Bytes received
+    uint64_t messages = 0;         // Complete messages decoded
+    uint64_t events = 0;           // Events decoded from them
+    uint64_t checksum_errors = 0;  // Messages dropped for a bad checksum
+    uint64_t malformed = 0;        // Times the stream had to be resynchronized on the next "8="
+    uint64_t decode_errors = 0;    // Entries that could not be decoded
+    uint64_t test_requests = 0;    // TestRequests answered
+};
+
+/**
+ * @brief Market data feed reading FIX tag=value messages over TCP
+ *
+ * Connects to endpoint and keeps the connection up, reconnecting with
+ * backoff. Like the WebSocket feed, the ingest thread waits in epoll on
+ * the socket and an eventfd and reads into one reusable buffer. Messages
+ * are framed with the body length (tag 9), checksummed with SIMD byte
+ * sums, and decoded in place by a FixDecoder, whose field scanner finds
+ * the SOH and '=' bytes with SSE2 or AVX2: each entry of an incremental
+ * refresh (35=X) is published as an order add, modify, cancel or trade.
+ *
+ * With sender_comp_id set, the feed logs on (35=A, resetting sequence
+ * numbers), answers TestRequests and sends heartbeats when idle;
+ * otherwise it only listens, as for a drop copy that pushes without a
+ * session. Sequence gaps are not recovered with resend requests.
+ */
+class FixMarketDataFeed : public BaseMarketDataFeed {
+public:
+    /**
+     * @throws std::invalid_argument If the endpoint is not host:port
+     */
+    explicit FixMarketDataFeed(const FixConfig& fix, const FeedConfig& config = FeedConfig());
+    ~FixMarketDataFeed() override;
+
+    /**
+     * @brief Check whether the feed is connected (and logged on, if it logs on)
+     */
+    bool connected() const { return connected_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Get the connection and decoding counters
+     */
+    FixStats getFixStats() const;
+
+protected:
+    void processMessages() override;
+    void interruptIngest() override;
+
+private:
+    struct alignas(64) Counters {
+        std::atomic<uint64_t> connects{0};
+        std::atomic<uint64_t> disconnects{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> messages{0};
+        std::atomic<uint64_t> events{0};
+        std::atomic<uint64_t> checksum_errors{0};
+        std::atomic<uint64_t> malformed{0};
+        std::atomic<uint64_t> decode_errors{0};
+        std::atomic<uint64_t> test_requests{0};
+    };
+
+    FixConfig fix_;
+    std::string host_;
+    uint16_t port_ = 0;
+    FixDecoder decoder_;
+    std::vector<char> buffer_;
+    int wake_fd_ = -1;
+    std::atomic<bool> connected_{false};
+    uint64_t out_seq_num_ = 1;
+    Counters counters_;
+
+    void session(int fd);
+    bool sendSession(int fd, std::string_view msg_type, const std::string& fields);
 };
 
 } // namespace orderbook 
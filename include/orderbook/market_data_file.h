@@ -0,0 +1,103 @@
+#pragma once
+
+#include "market_data_event.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace orderbook {
+
+/**
+ * @brief Header of a recorded market data event file
+ *
+ * The header is followed by record_count MarketDataEvent records in
+ * their in-memory layout (native byte order), so a mapped file can be
+ * read in place. The header is one record long, which keeps the records
+ * aligned in the mapping.
+ */
+struct EventFileHeader {
+    static constexpr char kMagic[8] = {'O', 'B', 'E', 'V', 'E', 'N', 'T', 'S'};
+    static constexpr uint32_t kVersion = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;    // sizeof(MarketDataEvent) when written
+    uint64_t record_count;   // 0 if the writer did not finish; readers then use the file size
+    uint8_t reserved[40];
+};
+
+static_assert(sizeof(EventFileHeader) == 64, "EventFileHeader must be one cache line");
+
+/**
+ * @brief Records MarketDataEvents to a file
+ *
+ * Writes are buffered; the record count in the header is filled in by
+ * close() (or the destructor).
+ */
+class EventFileWriter {
+public:
+    /**
+     * @brief Create or truncate a file for writing
+     *
+     * @throws std::runtime_error If the file cannot be opened
+     */
+    explicit EventFileWriter(const std::string& path);
+    ~EventFileWriter();
+
+    EventFileWriter(const EventFileWriter&) = delete;
+    EventFileWriter& operator=(const EventFileWriter&) = delete;
+
+    /**
+     * @brief Append events
+     *
+     * @throws std::runtime_error If the write fails
+     */
+    void write(const MarketDataEvent& event) { write(&event, 1); }
+    void write(const MarketDataEvent* events, size_t count);
+
+    /**
+     * @brief Write the final record count and close the file
+     */
+    void close();
+
+    uint64_t count() const { return count_; }
+
+private:
+    std::string path_;
+    std::FILE* file_ = nullptr;
+    uint64_t count_ = 0;
+};
+
+/**
+ * @brief Read-only memory mapping of a recorded event file
+ *
+ * Records are used in place: data() points into the mapping, and the
+ * kernel is told the file will be read sequentially.
+ */
+class MappedEventFile {
+public:
+    /**
+     * @brief Map a file
+     *
+     * @throws std::runtime_error If the file cannot be mapped or is not an event file
+     */
+    explicit MappedEventFile(const std::string& path);
+    ~MappedEventFile();
+
+    MappedEventFile(const MappedEventFile&) = delete;
+    MappedEventFile& operator=(const MappedEventFile&) = delete;
+
+    const MarketDataEvent* data() const { return records_; }
+    size_t size() const { return count_; }
+    const MarketDataEvent* begin() const { return records_; }
+    const MarketDataEvent* end() const { return records_ + count_; }
+    const MarketDataEvent& operator[](size_t i) const { return records_[i]; }
+
+private:
+    void* mapping_ = nullptr;
+    size_t length_ = 0;
+    const MarketDataEvent* records_ = nullptr;
+    size_t count_ = 0;
+};
+
+} // namespace orderbook
@@ -2,28 +2,59 @@
 
 #include "market_data_feed.h"
 #include "order_book.h"
+#include "book_snapshot.h"
+#include "symbol_table.h"
+#include <atomic>
 #include <memory>
 #include <unordered_map>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace orderbook {
 
+/**
+ * @brief Apply one market data event to a book
+ * 
+ * ORDER_ADD uses the event's timestamp as the order's timestamp. A
+ * SNAPSHOT record flagged kSnapshotBegin clears the book before its
+ * order is added. TRADE prints and heartbeats do not change the book.
+ * Errors from the book are logged, not thrown.
+ * 
+ * @param book The book for the event's symbol
+ * @param event The event to apply
+ */
+void applyEvent(OrderBook& book, const MarketDataEvent& event);
+
 /**
  * @brief Implementation of MarketDataHandler that updates order books based on market data messages
+ * 
+ * Events are routed through a flat table indexed by SymbolId, read
+ * without locks or reference counting inside an epoch critical section.
+ * Registering, replacing or unregistering a book updates the table under
+ * a mutex and retires the handler's reference to the old book through
+ * the epoch domain, so a book is never destroyed while an event is still
+ * being applied to it.
+ * 
+ * A book can be rebuilt after a gap or a restart without replaying the
+ * day: beginRecovery() holds the symbol's events back while a snapshot is
+ * fetched, and completeRecovery() loads the snapshot and then applies the
+ * held events that came after it.
  */
-class MarketDataHandlerImpl : public MarketDataHandler {
+class MarketDataHandlerImpl final : public MarketDataHandler {
 public:
     MarketDataHandlerImpl();
     ~MarketDataHandlerImpl() override = default;
 
     /**
-     * @brief Handle a market data message
+     * @brief Handle a market data event
      * 
-     * This method processes incoming market data messages and updates the appropriate order books.
+     * Applies the event to the book registered for its symbol ID (see
+     * applyEvent). Events for unregistered symbols are ignored.
      * 
-     * @param message The market data message to handle
+     * @param event The market data event to handle
      */
-    void handleMessage(const MarketDataMessage& message) override;
+    void handleEvent(const MarketDataEvent& event) override;
 
     /**
      * @brief Register an order book for a specific symbol
@@ -48,9 +79,218 @@ public:
      */
     std::shared_ptr<OrderBook> getOrderBook(const std::string& symbol);
 
+    /**
+     * @brief Get the order book for a symbol ID
+     * 
+     * @param symbol_id The interned symbol
+     * @return std::shared_ptr<OrderBook> The order book, or nullptr if not found
+     */
+    std::shared_ptr<OrderBook> getOrderBook(SymbolId symbol_id);
+
+    /**
+     * @brief Start buffering a symbol's events instead of applying them
+     * 
+     * Call before requesting the snapshot the book will be rebuilt from,
+     * so that no event later than the snapshot is missed. Calling it again
+     * while the symbol is recovering does nothing.
+     * 
+     * @param symbol_id The symbol whose book is being recovered
+     */
+    void beginRecovery(SymbolId symbol_id);
+
+    /**
+     * @brief Load a snapshot into a recovering symbol's book, then apply the buffered events
+     * 
+     * The book is replaced with OrderBook::loadSnapshot(). Buffered events
+     * at or below the snapshot's sequence number are already reflected in
+     * it and are dropped (unless the snapshot was saved with sequence 0);
+     * the rest are applied in arrival order, on the calling thread, until
+     * none are left and the symbol's events are applied live again.
+     * 
+     * @param symbol_id The recovering symbol
+     * @param snapshot A snapshot written by OrderBook::saveSnapshot()
+     * @return size_t The number of buffered events applied
+     * @throws std::invalid_argument If no book is registered for the symbol or it is not recovering
+     * @throws std::runtime_error If the snapshot cannot be loaded; events stay buffered, so
+     *         completeRecovery() can be retried with another snapshot
+     * @throws std::logic_error If the book has a journal attached (see OrderBook::loadSnapshot);
+     *         events stay buffered
+     */
+    size_t completeRecovery(SymbolId symbol_id, std::string_view snapshot);
+
 private:
-    std::unordered_map<std::string, std::shared_ptr<OrderBook>> order_books_;
+    // Owning references, for registration and lookups by name; guarded by mutex_
+    std::unordered_map<SymbolId, std::shared_ptr<OrderBook>> order_books_;
     std::mutex mutex_;
+
+    // Routing for handleEvent
+    EpochDomain epoch_;
+    SymbolTable<OrderBook> routes_{epoch_};
+
+    // Events held back from recovering symbols; guarded by recovery_mutex_. The
+    // count lets handleEvent skip the lock while nothing is recovering.
+    std::unordered_map<SymbolId, std::vector<MarketDataEvent>> recovery_;
+    std::mutex recovery_mutex_;
+    std::atomic<size_t> recovering_{0};
+
+    void retireBook(std::shared_ptr<OrderBook> book);
+    bool holdForRecovery(const MarketDataEvent& event);
+};
+
+/**
+ * @brief Configuration for a ShardedMarketDataHandler
+ */
+struct ShardedHandlerConfig {
+    size_t shards = 4;
+    std::vector<int> cpus;                 // CPU for shard i; missing or negative entries are not pinned
+    size_t queue_capacity = 65536;         // Events per shard queue
+    WaitStrategy wait_strategy = WaitStrategy::SPIN_YIELD;
+    uint32_t spin_iterations = 1024;
+    OrderBookConfig book_config;           // Books are always created in single-writer mode
+};
+
+/**
+ * @brief Load on one shard of a ShardedMarketDataHandler
+ */
+struct ShardLoad {
+    size_t shard = 0;
+    int cpu = -1;                     // CPU the worker is pinned to, or -1
+    size_t symbols = 0;               // Symbols assigned to the shard
+    uint64_t events = 0;              // Events applied since the last resetLoad()
+    uint64_t backpressure_waits = 0;  // Times the feed thread found the shard's queue full
+    size_t queue_depth = 0;           // Events currently queued
+};
+
+/**
+ * @brief Load from one symbol of a ShardedMarketDataHandler
+ */
+struct SymbolLoad {
+    SymbolId symbol_id = 0;
+    size_t shard = 0;
+    uint64_t events = 0;              // Events applied since the last resetLoad()
+};
+
+/**
+ * @brief Market data handler that spreads symbols over pinned worker threads
+ * 
+ * Each symbol is assigned to one shard. A shard is a worker thread,
+ * optionally pinned to a CPU, that owns the books of its symbols and is
+ * fed through its own single-producer/single-consumer queue. Events for
+ * a symbol therefore keep their order, and the books run in single-writer
+ * mode: only their worker mutates them, while getTopOfBook() and
+ * getDepthSnapshot() can be read from any thread.
+ * 
+ * handleEvent() must be called from one thread at a time (a feed's
+ * dispatch thread). Adding symbols is safe while events flow; moving
+ * symbols between shards is meant for quiet periods between sessions,
+ * when no events for the moved symbols are being delivered.
+ */
+class ShardedMarketDataHandler final : public MarketDataHandler {
+public:
+    explicit ShardedMarketDataHandler(const ShardedHandlerConfig& config = ShardedHandlerConfig());
+    ~ShardedMarketDataHandler() override;
+
+    ShardedMarketDataHandler(const ShardedMarketDataHandler&) = delete;
+    ShardedMarketDataHandler& operator=(const ShardedMarketDataHandler&) = delete;
+
+    /**
+     * @brief Queue an event on the shard that owns its symbol
+     * 
+     * Waits for space if that shard's queue is full. Heartbeats and
+     * events for unknown symbols are ignored.
+     */
+    void handleEvent(const MarketDataEvent& event) override;
+
+    /**
+     * @brief Create the book for a symbol on the shard with the fewest symbols
+     * 
+     * @return std::shared_ptr<OrderBook> The book (the existing one if the symbol was already added)
+     */
+    std::shared_ptr<OrderBook> addSymbol(const std::string& symbol);
+
+    /**
+     * @brief Create the book for a symbol on a given shard
+     * 
+     * @throws std::out_of_range If the shard does not exist
+     */
+    std::shared_ptr<OrderBook> addSymbol(const std::string& symbol, size_t shard);
+
+    /**
+     * @brief Get the book for a symbol, or nullptr if it was not added
+     */
+    std::shared_ptr<OrderBook> getOrderBook(SymbolId symbol_id) const;
+    std::shared_ptr<OrderBook> getOrderBook(const std::string& symbol) const;
+
+    /**
+     * @brief Get the shard that owns a symbol
+     * 
+     * @return size_t The shard, or shardCount() if the symbol was not added
+     */
+    size_t shardOf(SymbolId symbol_id) const;
+
+    size_t shardCount() const { return shards_.size(); }
+
+    /**
+     * @brief Wait until every event queued so far has been applied
+     */
+    void drain();
+
+    /**
+     * @brief Report events applied, queue depth and symbols per shard
+     */
+    std::vector<ShardLoad> getShardLoad() const;
+
+    /**
+     * @brief Report events applied per symbol, busiest first
+     */
+    std::vector<SymbolLoad> getSymbolLoad() const;
+
+    /**
+     * @brief Zero the event counts used by the load reports and rebalance()
+     */
+    void resetLoad();
+
+    /**
+     * @brief Move a symbol and its book to another shard
+     * 
+     * Drains the queues first. No events for the symbol may be delivered
+     * while it moves.
+     * 
+     * @return bool False if the symbol was not added
+     * @throws std::out_of_range If the shard does not exist
+     */
+    bool moveSymbol(SymbolId symbol_id, size_t shard);
+
+    /**
+     * @brief Reassign symbols so that shards carry similar event counts
+     * 
+     * Assigns symbols busiest first, each to the shard with the smallest
+     * total so far, using the counts since the last resetLoad(), then
+     * moves the symbols whose shard changed. Meant to be run between
+     * sessions (see moveSymbol).
+     * 
+     * @return size_t The number of symbols moved
+     */
+    size_t rebalance();
+
+private:
+    struct Shard;
+    struct SymbolState;
+
+    ShardedHandlerConfig config_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    // All symbols, guarded by mutex_
+    std::unordered_map<SymbolId, std::unique_ptr<SymbolState>> symbols_;
+    mutable std::mutex mutex_;
+
+    // Symbol to shard for the feed thread; symbols are never removed, so
+    // the epoch domain only has to cover the table itself
+    EpochDomain epoch_;
+    SymbolTable<SymbolState> routes_{epoch_};
+
+    void runOnShard(Shard& shard, std::function<void()> command);
+    void moveSymbolLocked(SymbolState& state, size_t shard);
 };
 
 /**
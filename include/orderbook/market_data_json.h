@@ -0,0 +1,124 @@
+#pragma once
+
+#include "market_data_event.h"
+#include "symbol_registry.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace orderbook {
+
+/**
+ * @brief Decodes JSON market data messages into MarketDataEvents
+ *
+ * A message is one JSON object, or an array of them, such as
+ *
+ *     {"type":"add","symbol":"AAPL","id":7,"price":"189.25","qty":100,"side":"buy","seq":42,"ts":1700000000000000000}
+ *
+ * with "type" one of add, modify, cancel, execute, trade or heartbeat.
+ * The other keys are: id, price, qty, side ("buy"/"sell"), order_type
+ * ("limit", "market", ...), stop_price, trade_id, buy_id, sell_id, seq
+ * and ts (nanoseconds). Numbers may be quoted, and prices may have a
+ * fraction, which is scaled to price_decimals places. Numbers have at
+ * most 18 whole digits, and only prices may be negative; an object
+ * breaking either rule is malformed. Unknown keys are skipped, whatever
+ * their value.
+ *
+ * The text is scanned once, left to right, and fields are read straight
+ * into the event: no DOM, no strings, no allocation, except the first
+ * time a symbol is seen, when it is interned. String escapes are not
+ * decoded, so keys and symbols are compared as written.
+ */
+class JsonEventDecoder {
+public:
+    /**
+     * @param price_decimals Decimal places of Order::Price (a price of 1.5 is 150 with 2)
+     */
+    explicit JsonEventDecoder(int price_decimals = 0);
+
+    /**
+     * @brief Decode a message, passing each event to sink
+     *
+     * Malformed objects are counted in errors() and skipped; decoding
+     * stops at the first one whose end cannot be found.
+     *
+     * @return size_t The number of events decoded
+     */
+    template <typename Sink>
+    size_t decode(std::string_view text, Sink&& sink) {
+        const char* p = text.data();
+        const char* end = p + text.size();
+        size_t count = 0;
+        MarketDataEvent event;
+
+        skipSpace(p, end);
+        bool array = p < end && *p == '[';
+        if (array) {
+            ++p;
+        }
+        while (p < end) {
+            skipSpace(p, end);
+            if (p == end || (array && *p == ']')) {
+                break;
+            }
+            if (decodeObject(p, end, event)) {
+                sink(event);
+                ++count;
+            } else {
+                ++errors_;
+                if (!skipValue(p, end)) {
+                    break;
+                }
+            }
+            skipSpace(p, end);
+            if (!array) {
+                break;
+            }
+            if (p < end && *p == ',') {
+                ++p;
+            }
+        }
+        return count;
+    }
+
+    /**
+     * @brief Decode a message holding exactly one event
+     *
+     * @return bool True if an event was decoded
+     */
+    bool decodeOne(std::string_view text, MarketDataEvent& event);
+
+    /**
+     * @brief Get the number of malformed objects seen
+     */
+    uint64_t errors() const { return errors_; }
+
+private:
+    int price_decimals_;
+    int64_t price_scale_;
+    uint64_t errors_ = 0;
+    SymbolCache symbols_;
+
+    static void skipSpace(const char*& p, const char* end) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+            ++p;
+        }
+    }
+
+    // Parse one object at p into event, leaving p after it
+    bool decodeObject(const char*& p, const char* end, MarketDataEvent& event);
+
+    // Skip any value at p; false if it does not end before end
+    static bool skipValue(const char*& p, const char* end);
+
+    SymbolId symbol(std::string_view name) { return symbols_.lookup(name); }
+};
+
+/**
+ * @brief Append the JSON form of an event, as read by JsonEventDecoder
+ *
+ * @param price_decimals Decimal places to write prices with
+ */
+void appendJson(std::string& out, const MarketDataEvent& event, int price_decimals = 0);
+
+} // namespace orderbook
@@ -0,0 +1,231 @@
+#pragma once
+
+#include "market_data_event.h"
+#include <cstddef>
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+
+namespace orderbook {
+
+/**
+ * @brief Header of a market data datagram
+ *
+ * A datagram is this header followed by event_count MarketDataEvent
+ * records in their in-memory layout (native byte order), as in a
+ * recorded event file, so a receiver can use the records in place. Events
+ * are numbered consecutively across datagrams: sequence is the number of
+ * the first event, and a datagram with no events is a heartbeat carrying
+ * the next number. Symbol ids are those of the publishing process, so
+ * publisher and receivers must intern their symbols in the same order.
+ */
+struct PacketHeader {
+    static constexpr uint32_t kMagic = 0x4f424d44;  // "OBMD"
+
+    uint32_t magic;
+    uint16_t event_count;
+    uint16_t reserved;
+    uint64_t sequence;
+};
+
+static_assert(sizeof(PacketHeader) == 16, "PacketHeader must keep the records 8-byte aligned");
+
+// Largest datagram without IP fragmentation on a 1500-byte MTU
+constexpr size_t kMaxDatagram = 1472;
+constexpr size_t kMaxEventsPerPacket = (kMaxDatagram - sizeof(PacketHeader)) / sizeof(MarketDataEvent);
+
+/**
+ * @brief Parse "address:port" into a socket address
+ *
+ * @throws std::invalid_argument If the string is not an IPv4 address and port
+ */
+sockaddr_in parseEndpoint(const std::string& endpoint);
+
+/**
+ * @brief Sequence arbitration between redundant lines
+ *
+ * Packets from all lines are offered as they arrive, and events are
+ * delivered once each, in sequence order. The first copy of an event is
+ * delivered and later copies are counted as duplicates. A packet that
+ * starts past the next expected event is copied aside until the missing
+ * events arrive. Each line is assumed to deliver its packets in order, so
+ * the missing events are declared lost (a gap) once every line has sent
+ * something past them. expire() declares them lost earlier, for a line
+ * that has gone quiet, and so does holding more than max_pending packets.
+ * Heartbeats (count 0) only tell the arbiter how far their line has got.
+ *
+ * The deliver callback is called as deliver(line, events, count) and the
+ * gap callback as gap(first_missing, count).
+ */
+class PacketArbiter {
+public:
+    /**
+     * @param lines Number of redundant lines
+     * @param first_sequence The first expected event number (0 to start from the first packet seen)
+     * @param max_pending Packets held back before a gap is forced
+     */
+    explicit PacketArbiter(size_t lines = 1, uint64_t first_sequence = 0, size_t max_pending = 4096)
+        : expected_(first_sequence), line_next_(lines, 0), max_pending_(max_pending) {}
+
+    /**
+     * @brief Offer a packet received on a line
+     */
+    template <typename Deliver, typename Gap>
+    void offer(size_t line, uint64_t sequence, const MarketDataEvent* events, size_t count,
+               Deliver&& deliver, Gap&& gap) {
+        if (expected_ == 0) {
+            expected_ = sequence;
+        }
+        line_next_[line] = std::max(line_next_[line], sequence + count);
+
+        if (count > 0) {
+            if (sequence + count <= expected_) {
+                ++duplicates_;
+            } else if (sequence <= expected_) {
+                size_t skip = static_cast<size_t>(expected_ - sequence);
+                deliver(line, events + skip, count - skip);
+                expected_ = sequence + count;
+                drain(deliver);
+            } else if (!pending_.emplace(sequence, Held{line, std::vector<MarketDataEvent>(events, events + count)}).second) {
+                ++duplicates_;
+            }
+        }
+        resolve(deliver, gap, pending_.size() > max_pending_);
+    }
+
+    /**
+     * @brief Give up on the events the held packets are waiting for
+     */
+    template <typename Deliver, typename Gap>
+    void expire(Deliver&& deliver, Gap&& gap) {
+        resolve(deliver, gap, true);
+    }
+
+    bool holding() const { return !pending_.empty(); }
+    uint64_t expected() const { return expected_; }
+    uint64_t gaps() const { return gaps_; }
+    uint64_t missed() const { return missed_; }
+    uint64_t duplicates() const { return duplicates_; }
+
+private:
+    struct Held {
+        size_t line;
+        std::vector<MarketDataEvent> events;
+    };
+
+    uint64_t expected_;
+    std::vector<uint64_t> line_next_;  // Per line, the sequence after the last event it sent
+    size_t max_pending_;
+    std::map<uint64_t, Held> pending_;
+    uint64_t gaps_ = 0;
+    uint64_t missed_ = 0;
+    uint64_t duplicates_ = 0;
+
+    // Deliver held packets that are now next in sequence
+    template <typename Deliver>
+    void drain(Deliver& deliver) {
+        while (!pending_.empty() && pending_.begin()->first <= expected_) {
+            auto it = pending_.begin();
+            uint64_t end = it->first + it->second.events.size();
+            if (end <= expected_) {
+                ++duplicates_;
+            } else {
+                size_t skip = static_cast<size_t>(expected_ - it->first);
+                deliver(it->second.line, it->second.events.data() + skip, it->second.events.size() - skip);
+                expected_ = end;
+            }
+            pending_.erase(it);
+        }
+    }
+
+    // Declare lost what every line has passed (or, if forced, everything the held packets wait for)
+    template <typename Deliver, typename Gap>
+    void resolve(Deliver& deliver, Gap& gap, bool force) {
+        while (true) {
+            uint64_t passed = *std::min_element(line_next_.begin(), line_next_.end());
+            uint64_t target;
+            if (force && !pending_.empty()) {
+                target = pending_.begin()->first;
+            } else if (passed > expected_) {
+                target = pending_.empty() ? passed : std::min(passed, pending_.begin()->first);
+            } else {
+                return;
+            }
+
+            ++gaps_;
+            missed_ += target - expected_;
+            gap(expected_, target - expected_);
+            expected_ = target;
+            drain(deliver);
+        }
+    }
+};
+
+/**
+ * @brief Options for a MulticastPublisher
+ */
+struct PublisherConfig {
+    std::string line_a;                  // "group:port"
+    std::string line_b;                  // Redundant line; empty for none
+    std::string interface = "127.0.0.1";  // Local address multicast is sent from
+    size_t events_per_packet = kMaxEventsPerPacket;
+    double rate = 0.0;                   // Events per second; 0 sends as fast as possible
+    size_t batch = 32;                   // Datagrams per sendmmsg call
+    uint64_t first_sequence = 1;
+    uint64_t drop_a_every = 0;           // Skip every Nth packet on line A (to exercise arbitration)
+    uint64_t drop_b_every = 0;           // Likewise for line B
+};
+
+/**
+ * @brief Sends events as sequenced datagrams on one or two lines
+ *
+ * A local stand-in for an exchange feed: it packetizes events into the
+ * PacketHeader format and sends every packet on each line with sendmmsg,
+ * optionally at a fixed event rate. Works with unicast addresses as well
+ * as multicast groups.
+ */
+class MulticastPublisher {
+public:
+    /**
+     * @throws std::runtime_error If a socket cannot be set up
+     * @throws std::invalid_argument If an address is malformed
+     */
+    explicit MulticastPublisher(const PublisherConfig& config);
+    ~MulticastPublisher();
+
+    MulticastPublisher(const MulticastPublisher&) = delete;
+    MulticastPublisher& operator=(const MulticastPublisher&) = delete;
+
+    /**
+     * @brief Send events, numbering them on from the last call (blocks until sent)
+     *
+     * @throws std::runtime_error If sending fails
+     */
+    void send(const MarketDataEvent* events, size_t count);
+
+    /**
+     * @brief Send a heartbeat packet carrying the next sequence number on each line
+     */
+    void heartbeat();
+
+    uint64_t nextSequence() const { return sequence_; }
+    uint64_t packetsSent() const { return packets_; }
+
+private:
+    struct Line {
+        int fd = -1;
+        sockaddr_in address{};
+        uint64_t drop_every = 0;
+    };
+
+    PublisherConfig config_;
+    Line lines_[2];
+    size_t line_count_ = 0;
+    uint64_t sequence_;
+    uint64_t packets_ = 0;
+};
+
+} // namespace orderbook
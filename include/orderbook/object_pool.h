@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace orderbook {
+
+/**
+ * @brief Free-list pool of fixed-size objects
+ *
+ * Objects are carved from chunks allocated up front and recycled through a
+ * free list, so acquire() and release() never touch the heap while the pool
+ * has spare capacity. When it runs dry a new chunk as large as all existing
+ * ones is added; object addresses stay stable for the life of the pool.
+ *
+ * @tparam T The pooled type (must be default constructible)
+ */
+template <typename T>
+class ObjectPool {
+public:
+    /**
+     * @brief Construct a pool with room for an initial number of objects
+     */
+    explicit ObjectPool(size_t capacity) {
+        grow(capacity > 0 ? capacity : 1);
+    }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    /**
+     * @brief Take an object from the pool
+     *
+     * The object keeps whatever state it was released with; the caller
+     * is expected to initialise it.
+     */
+    T* acquire() {
+        if (free_.empty()) {
+            grow(capacity_);
+        }
+        T* object = free_.back();
+        free_.pop_back();
+        return object;
+    }
+
+    /**
+     * @brief Return an object to the pool
+     */
+    void release(T* object) {
+        free_.push_back(object);
+    }
+
+    /**
+     * @brief Make sure count more objects can be acquired without growing
+     */
+    void reserve(size_t count) {
+        if (free_.size() < count) {
+            grow(count - free_.size());
+        }
+    }
+
+    size_t capacity() const { return capacity_; }
+    size_t available() const { return free_.size(); }
+    size_t inUse() const { return capacity_ - free_.size(); }
+
+private:
+    std::vector<std::unique_ptr<T[]>> chunks_;
+    std::vector<T*> free_;
+    size_t capacity_ = 0;
+
+    void grow(size_t count) {
+        chunks_.push_back(std::make_unique<T[]>(count));
+        capacity_ += count;
+        free_.reserve(capacity_);
+        T* chunk = chunks_.back().get();
+        // Hand out the lowest addresses first
+        for (size_t i = count; i > 0; --i) {
+            free_.push_back(&chunk[i - 1]);
+        }
+    }
+};
+
+/**
+ * @brief Free-list pool of raw blocks of one size, for node-based containers
+ *
+ * The block size is fixed by the first allocation, since a container only
+ * reveals its node type when it rebinds the allocator. Freed blocks are
+ * threaded onto an intrusive free list. Like ObjectPool, the pool grows by
+ * a chunk as large as all existing ones and never gives memory back early.
+ */
+class NodePool {
+public:
+    /**
+     * @brief Construct a pool that carves room for an initial number of blocks on first use
+     */
+    explicit NodePool(size_t capacity) : initial_(capacity > 0 ? capacity : 1) {}
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    void* allocate(size_t bytes) {
+        if (block_units_ == 0) {
+            block_units_ = (std::max(bytes, sizeof(Block)) + sizeof(Unit) - 1) / sizeof(Unit);
+        }
+        assert(bytes <= block_units_ * sizeof(Unit));
+        if (free_ == nullptr) {
+            grow(capacity_ > 0 ? capacity_ : initial_);
+        }
+        Block* block = free_;
+        free_ = block->next;
+        return block;
+    }
+
+    void deallocate(void* p) {
+        auto* block = static_cast<Block*>(p);
+        block->next = free_;
+        free_ = block;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    using Unit = std::max_align_t;
+    struct Block {
+        Block* next;
+    };
+
+    std::vector<std::unique_ptr<Unit[]>> chunks_;
+    Block* free_ = nullptr;
+    size_t block_units_ = 0;
+    size_t capacity_ = 0;
+    size_t initial_;
+
+    void grow(size_t count) {
+        chunks_.push_back(std::make_unique<Unit[]>(count * block_units_));
+        capacity_ += count;
+        Unit* chunk = chunks_.back().get();
+        // Hand out the lowest addresses first
+        for (size_t i = count; i > 0; --i) {
+            deallocate(chunk + (i - 1) * block_units_);
+        }
+    }
+};
+
+/**
+ * @brief Standard allocator that takes single nodes from a NodePool
+ *
+ * Meant for node-based containers (std::map, std::set, std::list), which
+ * allocate one node at a time. Requests for more than one object go to the
+ * heap. The pool must outlive every container using it.
+ */
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    explicit PoolAllocator(NodePool* pool) : pool_(pool) {}
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& other) : pool_(other.pool()) {}
+
+    T* allocate(size_t n) {
+        if (n == 1) {
+            return static_cast<T*>(pool_->allocate(sizeof(T)));
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        if (n == 1) {
+            pool_->deallocate(p);
+        } else {
+            ::operator delete(p);
+        }
+    }
+
+    NodePool* pool() const { return pool_; }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>& other) const { return pool_ == other.pool(); }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>& other) const { return pool_ != other.pool(); }
+
+private:
+    NodePool* pool_;
+};
+
+} // namespace orderbook
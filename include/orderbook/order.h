@@ -1,8 +1,10 @@
 #pragma once
 
+#include "symbol_registry.h"
 #include <cstdint>
 #include <string>
 #include <chrono>
+#include <type_traits>
 
 namespace orderbook {
 
@@ -37,6 +39,8 @@ enum class OrderStatus : uint8_t {
  * 
  * This class is designed to be as memory-efficient as possible
  * while maintaining all necessary information for order book reconstruction.
+ * The symbol is held as an interned SymbolId, so an Order is trivially
+ * copyable and fits in a single cache line.
  */
 class Order {
 public:
@@ -48,14 +52,20 @@ public:
     // Default constructor
     Order() = default;
 
-    // Constructor for creating a new order
+    // Constructor for creating a new order (stop_price is only used by STOP and STOP_LIMIT)
+    Order(OrderId id, SymbolId symbol_id, Price price, Quantity quantity,
+          Side side, OrderType type, Timestamp timestamp, Price stop_price = 0);
+
+    // Constructor that interns the symbol name
     Order(OrderId id, const std::string& symbol, Price price, Quantity quantity,
-          Side side, OrderType type, Timestamp timestamp);
+          Side side, OrderType type, Timestamp timestamp, Price stop_price = 0);
 
     // Getters
     OrderId getId() const { return id_; }
-    const std::string& getSymbol() const { return symbol_; }
+    SymbolId getSymbolId() const { return symbol_id_; }
+    const std::string& getSymbol() const { return SymbolRegistry::instance().name(symbol_id_); }
     Price getPrice() const { return price_; }
+    Price getStopPrice() const { return stop_price_; }
     Quantity getQuantity() const { return quantity_; }
     Quantity getRemainingQuantity() const { return remaining_quantity_; }
     Side getSide() const { return side_; }
@@ -65,6 +75,9 @@ public:
 
     // Setters
     void setPrice(Price price) { price_ = price; }
+    void setStopPrice(Price stop_price) { stop_price_ = stop_price; }
+    void setType(OrderType type) { type_ = type; }
+    void setTimestamp(Timestamp timestamp) { timestamp_ = timestamp; }
     void setQuantity(Quantity quantity) { 
         quantity_ = quantity;
         remaining_quantity_ = quantity;
@@ -83,14 +96,18 @@ public:
 
 private:
     OrderId id_ = 0;
-    std::string symbol_;
     Price price_ = 0;
+    Price stop_price_ = 0;
     Quantity quantity_ = 0;
     Quantity remaining_quantity_ = 0;
+    Timestamp timestamp_{};
+    SymbolId symbol_id_ = 0;
     Side side_ = Side::BUY;
     OrderType type_ = OrderType::LIMIT;
     OrderStatus status_ = OrderStatus::NEW;
-    Timestamp timestamp_{};
 };
 
+static_assert(std::is_trivially_copyable<Order>::value, "Order must be trivially copyable");
+static_assert(sizeof(Order) <= 64, "Order must fit in a cache line");
+
 } // namespace orderbook 
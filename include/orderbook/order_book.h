@@ -2,10 +2,13 @@
 
 #include "order.h"
 #include "trade.h"
+#include "book_side.h"
+#include "order_flow.h"
+#include "object_pool.h"
+#include "order_index.h"
+#include "seqlock.h"
 #include <string>
-#include <unordered_map>
-#include <map>
-#include <list>
+#include <string_view>
 #include <functional>
 #include <vector>
 #include <memory>
@@ -15,6 +18,8 @@
 
 namespace orderbook {
 
+class BookJournal;
+
 /**
  * @brief Represents the top of the book (best bid and ask)
  */
@@ -27,12 +32,71 @@ struct TopOfBook {
 };
 
 /**
- * @brief Represents a price level in the order book
+ * @brief Aggregated size at one price level
+ */
+using DepthLevel = PriceLevel;
+
+/**
+ * @brief Top of book plus the best levels of each side, as one consistent snapshot
+ */
+struct DepthSnapshot {
+    static constexpr size_t kMaxLevels = 10;
+
+    TopOfBook top;
+    uint32_t bid_count = 0;
+    uint32_t ask_count = 0;
+    DepthLevel bids[kMaxLevels];
+    DepthLevel asks[kMaxLevels];
+};
+
+/**
+ * @brief Event-based order flow imbalance (see EventOrderFlow)
+ */
+struct OrderFlowImbalance {
+    int64_t window = 0;   // Sum over the last OrderBookConfig::ofi_window events
+    int64_t total = 0;    // Sum over every event since construction or clear()
+    uint64_t events = 0;  // Number of best bid/ask changes since construction or clear()
+};
+
+/**
+ * @brief When the book update callbacks fire
  */
-struct PriceLevel {
-    Order::Price price = 0;
-    Order::Quantity total_quantity = 0;
-    std::list<Order> orders;
+enum class UpdateNotification : uint8_t {
+    EVERY_MUTATION = 0,  // After every call that changed the book, stamped with the clock
+    ON_CHANGE = 1        // Only when the watched view changed, stamped with the event time
+};
+
+/**
+ * @brief Construction options for an order book
+ */
+struct OrderBookConfig {
+    BookStorage storage = BookStorage::ARRAY;  // ARRAY keeps cumulative depth for constant-time FOK checks
+    Order::Price tick_size = 1;      // Minimum price increment (ARRAY storage only)
+    size_t ladder_levels = 4096;     // Initial ladder slots per side (ARRAY storage only)
+    size_t max_ladder_levels = size_t(1) << 22;  // Ticks a side's levels may span; wider prices are rejected (ARRAY only)
+    size_t order_capacity = 4096;    // Resting orders preallocated in the order pool
+    size_t level_capacity = 1024;    // Price levels (and MAP tree nodes) preallocated per side
+    size_t depth_levels = 10;        // Levels per side kept in the aggregated depth cache
+    size_t ofi_window = 100;         // Book events summed by the event-based OFI window
+    UpdateNotification update_notification = UpdateNotification::EVERY_MUTATION;
+
+    // Single-writer mode: one owning thread mutates the book without locks and
+    // publishes snapshots that other threads read through a seqlock
+    bool single_writer = false;
+    size_t published_levels = 5;     // Levels per side in each snapshot (at most DepthSnapshot::kMaxLevels)
+};
+
+/**
+ * @brief Non-owning view of a contiguous run of trades
+ */
+struct TradeSpan {
+    const Trade* data = nullptr;
+    size_t size = 0;
+
+    const Trade* begin() const { return data; }
+    const Trade* end() const { return data + size; }
+    bool empty() const { return size == 0; }
+    const Trade& operator[](size_t i) const { return data[i]; }
 };
 
 /**
@@ -45,12 +109,23 @@ using TradeCallback = std::function<void(const Trade&)>;
  */
 using OrderBookUpdateCallback = std::function<void(const TopOfBook&)>;
 
+/**
+ * @brief Callback function type for depth updates
+ */
+using DepthUpdateCallback = std::function<void(const DepthSnapshot&)>;
+
 /**
  * @brief High-performance limit order book implementation
  * 
  * This class maintains a limit order book for a specific symbol.
  * It provides methods for adding, modifying, and canceling orders,
  * as well as matching incoming orders against the book.
+ * 
+ * By default every operation takes a reader/writer lock. In single-writer
+ * mode (OrderBookConfig::single_writer) only the owning thread may call the
+ * mutating methods, getDepth, the order flow imbalance queries and getAllOrders;
+ * getTopOfBook and getDepthSnapshot may be called from any thread and never
+ * block the writer.
  */
 class OrderBook {
 public:
@@ -61,38 +136,132 @@ public:
      */
     explicit OrderBook(const std::string& symbol);
 
+    /**
+     * @brief Construct a new Order Book with explicit storage options
+     * 
+     * With BookStorage::ARRAY every resting price must be a multiple of the tick size.
+     * 
+     * @param symbol The ticker symbol for this order book
+     * @param config The storage options
+     * @throws std::invalid_argument If ARRAY storage has no tick size or ladder slots
+     */
+    OrderBook(const std::string& symbol, const OrderBookConfig& config);
+
     /**
      * @brief Get the symbol for this order book
      */
     const std::string& getSymbol() const { return symbol_; }
 
+    /**
+     * @brief Get the interned ID of this book's symbol
+     */
+    SymbolId getSymbolId() const { return symbol_id_; }
+
+    /**
+     * @brief Get the options this book was constructed with
+     */
+    const OrderBookConfig& getConfig() const { return config_; }
+
     /**
      * @brief Add a new order to the book
      * 
      * If the order matches with existing orders, trades will be generated.
+     * LIMIT orders rest any unfilled quantity. MARKET and IOC orders match
+     * what they can and cancel the rest. FOK orders either fill completely
+     * or leave the book untouched. The check never walks the orders. With
+     * the default BookStorage::ARRAY it reads cumulative depth in about the
+     * time of a top-of-book read. With MAP storage, an order no bigger than
+     * the side's total walks level totals up to its limit, so it costs
+     * O(levels) on a deep book.
+     * 
+     * STOP and STOP_LIMIT orders are parked by stop price until a trade
+     * prints at or through it (at or above for buys, at or below for
+     * sells); they then enter as MARKET or LIMIT orders respectively,
+     * in the order they were placed (or last modified). Trades from stops released this way,
+     * including cascades, are returned along with the order's own trades.
      * 
      * @param order The order to add
      * @return std::vector<Trade> Any trades that were generated
+     * @throws std::invalid_argument If the order is for another symbol, off the tick grid,
+     *         more than max_ladder_levels ticks from the levels on its side (ARRAY storage),
+     *         or has the ID of an order already in the book (or the reserved ID UINT64_MAX)
      */
     std::vector<Trade> addOrder(const Order& order);
 
+    /**
+     * @brief Add a new order, writing any trades into a caller-supplied buffer
+     * 
+     * Matching stops once the buffer is full. Any quantity that could still
+     * have matched is dropped rather than rested, so the book is never left
+     * crossed. A FOK order that might need more trades than the buffer has
+     * room for is killed. Stops released once the buffer is full stay parked
+     * and run at the start of the next add or reprice. This overload does not allocate once the book's pools have
+     * warmed up, with either storage: orders, levels and MAP tree nodes are all pooled.
+     * 
+     * @param order The order to add
+     * @param trades The buffer to write trades into
+     * @param capacity The number of trades the buffer can hold
+     * @return size_t The number of trades written
+     */
+    size_t addOrder(const Order& order, Trade* trades, size_t capacity);
+
+    /**
+     * @brief Add a new order, collecting trades in a reusable per-thread buffer
+     * 
+     * The buffer keeps its capacity between calls, so a steady-state match
+     * does not allocate. The returned span stays valid until the calling
+     * thread's next call to this method or to modifyOrder.
+     * 
+     * @param order The order to add
+     * @return TradeSpan The trades that were generated
+     */
+    TradeSpan addOrderSpan(const Order& order);
+
     /**
      * @brief Cancel an existing order
      * 
+     * Without a timestamp, the journal record and any update notification
+     * carry the time of the book's last timed event.
+     * 
      * @param order_id The ID of the order to cancel
      * @return bool True if the order was found and canceled, false otherwise
      */
     bool cancelOrder(Order::OrderId order_id);
+    bool cancelOrder(Order::OrderId order_id, Order::Timestamp timestamp);
+
+    /**
+     * @brief Apply an execution reported by the venue against a resting order
+     * 
+     * Reduces the order's remaining quantity in place, keeping its queue
+     * priority, and removes it once nothing is left. No trade is generated;
+     * the venue reports the trade.
+     * 
+     * @param order_id The ID of the resting order
+     * @param quantity The quantity executed
+     * @return bool True if the order was found, false otherwise
+     */
+    bool executeOrder(Order::OrderId order_id, Order::Quantity quantity);
+    bool executeOrder(Order::OrderId order_id, Order::Quantity quantity, Order::Timestamp timestamp);
 
     /**
      * @brief Modify an existing order
      * 
+     * A size reduction at the same price is applied in place and keeps the
+     * order's queue priority. A price change or size increase sends the order
+     * to the back of the queue, and a price change may match first. A new
+     * quantity of zero cancels the order. For a parked stop, the new price
+     * is its limit price; the stop price is unchanged and the stop moves
+     * to the back of its trigger queue. Released together with other stops,
+     * it runs after every stop placed before the modify.
+     * 
      * @param order_id The ID of the order to modify
      * @param new_price The new price for the order
      * @param new_quantity The new quantity for the order
      * @return bool True if the order was found and modified, false otherwise
      */
     bool modifyOrder(Order::OrderId order_id, Order::Price new_price, Order::Quantity new_quantity);
+    bool modifyOrder(Order::OrderId order_id, Order::Price new_price, Order::Quantity new_quantity,
+                     Order::Timestamp timestamp);
 
     /**
      * @brief Get the current top of the book
@@ -101,14 +270,41 @@ public:
      */
     TopOfBook getTopOfBook() const;
 
+    /**
+     * @brief Get a consistent snapshot of the top of the book and the best levels
+     * 
+     * In single-writer mode this reads the last published snapshot and is safe
+     * from any thread; otherwise it is built under the shared lock.
+     * 
+     * @return DepthSnapshot Up to OrderBookConfig::published_levels levels per side
+     */
+    DepthSnapshot getDepthSnapshot() const;
+
     /**
      * @brief Get the depth of the book at a specified number of levels
      * 
+     * Levels are aggregated (price, size, order count). Up to
+     * OrderBookConfig::depth_levels they are copied from a cache the book
+     * keeps up to date as it changes; deeper requests walk the book.
+     * 
      * @param levels The number of price levels to return
      * @return std::pair<std::vector<PriceLevel>, std::vector<PriceLevel>> Bid and ask levels
      */
     std::pair<std::vector<PriceLevel>, std::vector<PriceLevel>> getDepth(size_t levels) const;
 
+    /**
+     * @brief Copy the best levels of one side into a caller-supplied array
+     * 
+     * Does not allocate. Within OrderBookConfig::depth_levels this is a
+     * straight copy of the depth cache.
+     * 
+     * @param side BUY for bids, SELL for asks
+     * @param out The array to fill, best price first
+     * @param levels The number of levels the array can hold
+     * @return size_t The number of levels written
+     */
+    size_t getDepth(Side side, PriceLevel* out, size_t levels) const;
+
     /**
      * @brief Register a callback for trade notifications
      * 
@@ -123,17 +319,45 @@ public:
      */
     void registerOrderBookUpdateCallback(OrderBookUpdateCallback callback);
 
+    /**
+     * @brief Register a callback for depth updates
+     * 
+     * Receives the best OrderBookConfig::published_levels levels per side.
+     * With UpdateNotification::ON_CHANGE both update callbacks compare
+     * their view (top of book, or these levels) with the last one they
+     * were sent and fire only if it changed, at most once per addOrder,
+     * cancelOrder, modifyOrder or clear call however many trades or
+     * triggered stops it caused. The event is stamped with the timestamp
+     * of the last order the book received rather than a clock read;
+     * cancels and modifies carry none of their own.
+     * 
+     * @param callback The callback function to be called when the depth changes
+     */
+    void registerDepthUpdateCallback(DepthUpdateCallback callback);
+
     /**
      * @brief Calculate order flow imbalance (OFI) at a specified depth
      * 
      * OFI measures the net aggression of market participants by comparing
-     * the volume of limit orders at the bid vs the ask.
+     * the volume of limit orders at the bid vs the ask. O(1) for depths
+     * within OrderBookConfig::depth_levels, which read running sums.
      * 
      * @param depth The number of price levels to include in the calculation
      * @return double The order flow imbalance value (-1.0 to 1.0)
      */
     double calculateOrderFlowImbalance(size_t depth) const;
 
+    /**
+     * @brief Get the event-based order flow imbalance
+     * 
+     * Sums Cont-Kukanov-Stoikov OFI contributions of the best bid and ask
+     * changes made by this book's updates; positive values mean buying
+     * pressure.
+     * 
+     * @return OrderFlowImbalance The windowed and running sums
+     */
+    OrderFlowImbalance getEventOrderFlowImbalance() const;
+
     /**
      * @brief Get all orders in the book
      * 
@@ -141,37 +365,176 @@ public:
      */
     std::vector<Order> getAllOrders() const;
 
+    /**
+     * @brief Append a binary snapshot of the book's full order-by-order state
+     *
+     * Every resting order and parked stop is written with its remaining
+     * quantity and in queue order, along with the last trade and the next
+     * trade ID (see BookSnapshotHeader for the layout). In single-writer
+     * mode only the owning thread may call this.
+     *
+     * @param out The buffer to append to
+     * @param sequence Feed sequence number the book reflects, returned by loadSnapshot()
+     */
+    void saveSnapshot(std::string& out, uint64_t sequence = 0) const;
+
+    /**
+     * @brief Replace the book's contents with a snapshot
+     *
+     * Levels are built directly from the snapshot, best first, and filled
+     * in queue order; nothing is matched and no trades are generated. The
+     * order pool and index are sized for the whole snapshot up front. The
+     * update callbacks fire once, as for clear(). On error the book is
+     * left empty.
+     *
+     * @param data A snapshot written by saveSnapshot()
+     * @return uint64_t The sequence number stored in the snapshot
+     * @throws std::invalid_argument If the snapshot is of another symbol
+     * @throws std::runtime_error If the snapshot is truncated or inconsistent
+     * @throws std::logic_error If a journal is attached; the book is left unchanged
+     */
+    uint64_t loadSnapshot(std::string_view data);
+
     /**
      * @brief Clear the order book
      */
     void clear();
 
+    /**
+     * @brief Record every change to the book, and its trades, in a journal
+     *
+     * See BookJournal for what is recorded. Attach or detach (nullptr)
+     * only while no other thread is using the book; every book sharing
+     * the journal must be mutated from the same thread.
+     *
+     * @param journal The journal to record into
+     * @throws std::invalid_argument If the symbol is longer than a journal record holds
+     */
+    void setJournal(std::shared_ptr<BookJournal> journal);
+
 private:
     std::string symbol_;
+    SymbolId symbol_id_;
+    OrderBookConfig config_;
     
-    // Bid side (buy orders), sorted in descending order of price
-    std::map<Order::Price, PriceLevel, std::greater<>> bids_;
+    // Bid side (buy orders), best (highest) price first
+    BookSide bids_;
     
-    // Ask side (sell orders), sorted in ascending order of price
-    std::map<Order::Price, PriceLevel, std::less<>> asks_;
+    // Ask side (sell orders), best (lowest) price first
+    BookSide asks_;
+    
+    // Parked stop orders keyed by stop price, next to trigger first:
+    // buy stops from the lowest trigger up, sell stops from the highest down
+    BookSide buy_stops_;
+    BookSide sell_stops_;
+    
+    // Stops released by recent trades, waiting to be executed
+    std::vector<OrderNode*> triggered_;
+    uint64_t stop_sequence_ = 0;
+    Order::Price last_trade_price_ = 0;
+    Order::Timestamp last_trade_time_{};
+    bool has_last_trade_ = false;
+    
+    // Resting order nodes, linked into their level's queue
+    ObjectPool<OrderNode> order_pool_;
     
     // Fast lookup for orders by ID
-    std::unordered_map<Order::OrderId, std::pair<Side, Order::Price>> order_lookup_;
+    OrderIndex<OrderNode*> order_lookup_;
     
     // Callbacks
     TradeCallback trade_callback_;
     OrderBookUpdateCallback update_callback_;
+    DepthUpdateCallback depth_callback_;
+    
+    // Last views sent to the update callbacks (ON_CHANGE mode)
+    TopOfBook last_top_;
+    DepthSnapshot last_depth_;
+    Order::Timestamp last_event_time_{};
     
     // Thread safety
     mutable std::shared_mutex mutex_;
     
-    // Trade ID generator
-    std::atomic<Trade::TradeId> next_trade_id_{1};
+    // Published snapshots (single-writer mode)
+    SeqLock<TopOfBook> published_top_;
+    SeqLock<DepthSnapshot> published_depth_;
+    
+    // Event-based OFI, fed from publish()
+    EventOrderFlow order_flow_;
+    
+    // Trade ID generator (only advanced by the writer)
+    Trade::TradeId next_trade_id_ = 1;
+    
+    // Change journal, recorded under the write lock
+    std::shared_ptr<BookJournal> journal_;
     
     // Helper methods
-    std::vector<Trade> matchOrder(const Order& order);
+    std::unique_lock<std::shared_mutex> writeLock() const;
+    std::shared_lock<std::shared_mutex> readLock() const;
+    BookSide& sideFor(Side side) { return side == Side::BUY ? bids_ : asks_; }
+    const BookSide& sideFor(Side side) const { return side == Side::BUY ? bids_ : asks_; }
+    BookSide& sideOf(const Order& order);
+    static size_t copyDepth(const BookSide& side, PriceLevel* out, size_t levels);
+    TopOfBook buildTopOfBook() const;
+    DepthSnapshot buildDepthSnapshot() const;
+    void publish();
+    
+    // Notifications decided under the lock and delivered after it is released
+    struct BookUpdate {
+        bool top_changed = false;
+        bool depth_changed = false;
+        TopOfBook top;
+        DepthSnapshot depth;
+    };
+    BookUpdate captureUpdate();
+    // Destination for trades produced while matching
+    class TradeSink {
+    public:
+        explicit TradeSink(std::vector<Trade>& trades) : vector_(&trades) {}
+        TradeSink(Trade* trades, size_t capacity) : buffer_(trades), capacity_(capacity) {}
+
+        bool full() const { return vector_ == nullptr && size_ == capacity_; }
+        bool unbounded() const { return vector_ != nullptr; }
+        size_t capacity() const { return capacity_; }
+        size_t remaining() const { return capacity_ - size_; }
+        size_t size() const { return vector_ ? vector_->size() : size_; }
+        const Trade* data() const { return vector_ ? vector_->data() : buffer_; }
+
+        template <typename... Args>
+        void emplace(Args&&... args) {
+            if (vector_) {
+                vector_->emplace_back(std::forward<Args>(args)...);
+            } else {
+                buffer_[size_++] = Trade(std::forward<Args>(args)...);
+            }
+        }
+
+    private:
+        std::vector<Trade>* vector_ = nullptr;
+        Trade* buffer_ = nullptr;
+        size_t capacity_ = 0;
+        size_t size_ = 0;
+    };
+
+    void addOrder(const Order& order, TradeSink& sink);
+    // A null timestamp keeps the time of the last timed event
+    bool cancelOrderAt(Order::OrderId order_id, const Order::Timestamp* timestamp);
+    bool executeOrderAt(Order::OrderId order_id, Order::Quantity quantity, const Order::Timestamp* timestamp);
+    bool modifyOrderAt(Order::OrderId order_id, Order::Price new_price, Order::Quantity new_quantity,
+                       const Order::Timestamp* timestamp);
+    void matchOrder(Order& order, TradeSink& sink);
+    bool canRest(const Order& order, const TradeSink& sink);
+    void triggerStops(Order::Price low, Order::Price high);
+    bool runStops(TradeSink& sink, size_t first_trade);
+    static bool fitsInSink(const BookSide& opposite, const Order& order, const TradeSink& sink);
+    static bool crosses(const Order& order, Order::Price resting_price);
+    void restOrder(const Order& order);
+    void linkOrder(OrderNode* node);
+    void unlinkOrder(OrderNode* node);
+    void removeOrder(OrderNode* node);
+    void clearLevels();
+    uint64_t readSnapshot(std::string_view data);
     void notifyTradeCallback(const Trade& trade);
-    void notifyOrderBookUpdateCallback();
+    void notifyOrderBookUpdateCallback(const BookUpdate& update);
 };
 
 } // namespace orderbook 
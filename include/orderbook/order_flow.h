@@ -0,0 +1,80 @@
+#pragma once
+
+#include "order.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace orderbook {
+
+/**
+ * @brief Event-based order flow imbalance (Cont, Kukanov and Stoikov)
+ *
+ * Each change of the best bid or ask is one event. Its contribution is
+ *
+ *   e = [Pb >= Pb'] qb - [Pb <= Pb'] qb' - [Pa <= Pa'] qa + [Pa >= Pa'] qa'
+ *
+ * where primed values are the previous best prices and sizes. A rising or
+ * growing bid, or a retreating or shrinking ask, is buying pressure. An
+ * empty bid side counts as a price below every other and an empty ask side
+ * as a price above every other, so a side emptying out contributes its
+ * whole last size.
+ *
+ * The sum over the most recent events is kept in a fixed ring alongside
+ * a running total since the last reset. Callers can difference totals
+ * sampled at two times to get the OFI over any time interval.
+ */
+class EventOrderFlow {
+public:
+    /**
+     * @brief Construct an accumulator
+     *
+     * @param window The number of most recent events summed by windowSum()
+     */
+    explicit EventOrderFlow(size_t window);
+
+    /**
+     * @brief Record the best levels after a book change
+     *
+     * Calls that leave both best prices and sizes unchanged are not events
+     * and are ignored. Pass a size of zero for an empty side.
+     */
+    void update(Order::Price bid_price, Order::Quantity bid_size,
+                Order::Price ask_price, Order::Quantity ask_size);
+
+    /**
+     * @brief Get the OFI summed over the last window() events
+     */
+    int64_t windowSum() const { return window_sum_; }
+
+    /**
+     * @brief Get the OFI summed over every event since the last reset
+     */
+    int64_t total() const { return total_; }
+
+    /**
+     * @brief Get the number of events since the last reset
+     */
+    uint64_t events() const { return events_; }
+
+    size_t window() const { return ring_.size(); }
+
+    /**
+     * @brief Forget all events and the previous best levels
+     */
+    void reset();
+
+private:
+    std::vector<int64_t> ring_;
+    size_t next_ = 0;
+    int64_t window_sum_ = 0;
+    int64_t total_ = 0;
+    uint64_t events_ = 0;
+
+    Order::Price bid_price_ = 0;
+    Order::Quantity bid_size_ = 0;
+    Order::Price ask_price_ = 0;
+    Order::Quantity ask_size_ = 0;
+};
+
+} // namespace orderbook
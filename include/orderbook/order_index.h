@@ -0,0 +1,176 @@
+#pragma once
+
+#include "order.h"
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace orderbook {
+
+/**
+ * @brief Open-addressing hash map from order ID to a value
+ *
+ * Linear probing over a flat power-of-two table with backward-shift
+ * deletion, so there are no tombstones and no per-entry allocation.
+ * The table only reallocates when it passes half full. The largest
+ * order ID marks empty slots and cannot be stored.
+ *
+ * @tparam V The mapped value type (must be default constructible and cheap to copy)
+ */
+template <typename V>
+class OrderIndex {
+public:
+    using OrderId = Order::OrderId;
+
+    static constexpr OrderId kEmpty = std::numeric_limits<OrderId>::max();  // Reserved: marks an empty slot
+
+    /**
+     * @brief Construct an index sized for an expected number of orders
+     */
+    explicit OrderIndex(size_t expected = 1024) {
+        size_t capacity = 16;
+        while (capacity < expected * 2) {
+            capacity *= 2;
+        }
+        rehash(capacity);
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    /**
+     * @brief Find the value for an order ID
+     *
+     * @return V* The value, or nullptr if the ID is not present
+     */
+    V* find(OrderId id) {
+        for (size_t slot = home(id);; slot = (slot + 1) & mask_) {
+            auto& entry = entries_[slot];
+            if (entry.id == id) {
+                return &entry.value;
+            }
+            if (entry.id == kEmpty) {
+                return nullptr;
+            }
+        }
+    }
+
+    /**
+     * @brief Start loading the slot an ID hashes to, ahead of a find or insert
+     */
+    void prefetch(OrderId id) const {
+        __builtin_prefetch(&entries_[home(id)], 1);
+    }
+
+    /**
+     * @brief Insert the value for an order ID
+     *
+     * @return bool True if inserted, false if the ID was already present (its value is kept)
+     */
+    bool insert(OrderId id, const V& value) {
+        assert(id != kEmpty);
+        if ((size_ + 1) * 2 > entries_.size()) {
+            rehash(entries_.size() * 2);
+        }
+        for (size_t slot = home(id);; slot = (slot + 1) & mask_) {
+            auto& entry = entries_[slot];
+            if (entry.id == id) {
+                return false;
+            }
+            if (entry.id == kEmpty) {
+                entry.id = id;
+                entry.value = value;
+                ++size_;
+                return true;
+            }
+        }
+    }
+
+    /**
+     * @brief Remove an order ID
+     *
+     * @return bool True if the ID was present
+     */
+    bool erase(OrderId id) {
+        size_t slot = home(id);
+        while (entries_[slot].id != id) {
+            if (entries_[slot].id == kEmpty) {
+                return false;
+            }
+            slot = (slot + 1) & mask_;
+        }
+
+        // Shift later members of the probe run back into the hole
+        size_t hole = slot;
+        for (size_t next = (hole + 1) & mask_; entries_[next].id != kEmpty; next = (next + 1) & mask_) {
+            size_t want = home(entries_[next].id);
+            if (((next - want) & mask_) >= ((next - hole) & mask_)) {
+                entries_[hole] = entries_[next];
+                hole = next;
+            }
+        }
+        entries_[hole].id = kEmpty;
+        --size_;
+        return true;
+    }
+
+    /**
+     * @brief Size the table for an expected number of orders, so inserts up to it never rehash
+     */
+    void reserve(size_t expected) {
+        size_t capacity = entries_.size();
+        while (capacity < expected * 2) {
+            capacity *= 2;
+        }
+        if (capacity != entries_.size()) {
+            rehash(capacity);
+        }
+    }
+
+    /**
+     * @brief Remove every entry, keeping the table
+     */
+    void clear() {
+        for (auto& entry : entries_) {
+            entry.id = kEmpty;
+        }
+        size_ = 0;
+    }
+
+private:
+    struct Entry {
+        OrderId id = kEmpty;
+        V value{};
+    };
+
+    std::vector<Entry> entries_;
+    size_t mask_ = 0;
+    size_t shift_ = 0;
+    size_t size_ = 0;
+
+    // Fibonacci hashing spreads sequential IDs across the table
+    size_t home(OrderId id) const {
+        return static_cast<size_t>((id * 0x9E3779B97F4A7C15ULL) >> shift_);
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Entry> old;
+        old.swap(entries_);
+        entries_.assign(capacity, Entry{});
+        mask_ = capacity - 1;
+        shift_ = 64;
+        for (size_t c = capacity; c > 1; c >>= 1) {
+            --shift_;
+        }
+        size_ = 0;
+        for (const auto& entry : old) {
+            if (entry.id != kEmpty) {
+                insert(entry.id, entry.value);
+            }
+        }
+    }
+};
+
+} // namespace orderbook
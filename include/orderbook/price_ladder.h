@@ -0,0 +1,482 @@
+#pragma once
+
+#include "order.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+
+namespace orderbook {
+
+/**
+ * @brief Contiguous tick-indexed array of price levels
+ *
+ * Slot i holds the level at price base + i * tick. A bitmap of occupied
+ * slots, plus a summary bitmap of non-empty bitmap words, lets the best
+ * level and the next level in either direction be found with a couple of
+ * bit scans instead of walking a tree.
+ *
+ * When a price falls outside the window the ladder is re-centred on the
+ * middle of the occupied range, and only grows when that range no longer
+ * fits. Both are rare, so inserts near the touch never allocate. Growth
+ * stops at a maximum number of slots: a price that would need a wider
+ * window is rejected.
+ *
+ * Each slot also carries a weight (the level's resting quantity) that is
+ * summed per bitmap word and per summary word as it changes. Cumulative
+ * weight up to any price is then a handful of block sums plus at most two
+ * partial words, without visiting the levels themselves.
+ *
+ * @tparam T The level type stored in each slot (must be default constructible)
+ */
+template <typename T>
+class PriceLadder {
+public:
+    using Price = Order::Price;
+
+    /**
+     * @brief Construct an empty ladder
+     *
+     * @param tick_size The minimum price increment
+     * @param capacity The initial number of slots (rounded up to a multiple of 64)
+     * @param max_capacity The number of slots the ladder may grow to
+     */
+    PriceLadder(Price tick_size, size_t capacity, size_t max_capacity = SIZE_MAX)
+        : tick_(tick_size), max_capacity_(std::max(max_capacity, capacity)) {
+        if (tick_size <= 0) {
+            throw std::invalid_argument("Tick size must be positive");
+        }
+        resize((capacity + 63) / 64 * 64);
+    }
+
+    Price tickSize() const { return tick_; }
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    size_t capacity() const { return slots_.size(); }
+    uint64_t totalWeight() const { return total_weight_; }
+
+    /**
+     * @brief Check whether a price is a multiple of the tick size
+     */
+    bool isAligned(Price price) const { return price % tick_ == 0; }
+
+    /**
+     * @brief Check whether a level at a price can be inserted without passing the maximum capacity
+     */
+    bool fits(Price price) const {
+        size_t idx = 0;
+        if (empty() || toIndex(price, idx)) {
+            return true;
+        }
+        return spanWith(price) <= max_capacity_;
+    }
+
+    /**
+     * @brief Find the level at a price
+     *
+     * @return T* The level, or nullptr if the price level is not occupied
+     */
+    T* find(Price price) {
+        size_t idx = 0;
+        if (!toIndex(price, idx) || !test(idx)) {
+            return nullptr;
+        }
+        return &slots_[idx];
+    }
+
+    const T* find(Price price) const {
+        return const_cast<PriceLadder*>(this)->find(price);
+    }
+
+    /**
+     * @brief Get the level at a price, creating an empty one if needed
+     *
+     * @param price The price of the level
+     * @param created Set to true if a new level was occupied
+     * @return T& The level at that price
+     * @throws std::invalid_argument If the price does not fit (see fits())
+     */
+    T& insert(Price price, bool& created) {
+        size_t idx = 0;
+        if (empty()) {
+            base_ = alignDown(price - static_cast<Price>(capacity() / 2) * tick_);
+        }
+        if (!toIndex(price, idx)) {
+            recentre(price);
+            if (!toIndex(price, idx)) {
+                throw std::logic_error("PriceLadder: price outside the ladder after recentring");
+            }
+        }
+        created = !test(idx);
+        if (created) {
+            set(idx);
+            ++count_;
+        }
+        return slots_[idx];
+    }
+
+    /**
+     * @brief Release the level at a price, resetting its slot
+     */
+    void erase(Price price) {
+        size_t idx = 0;
+        if (!toIndex(price, idx) || !test(idx)) {
+            return;
+        }
+        slots_[idx] = T{};
+        addWeight(idx, 0 - slot_weight_[idx]);
+        reset(idx);
+        --count_;
+    }
+
+    /**
+     * @brief Add to the weight of an occupied level (wraps, so subtraction is adding 0 - n)
+     */
+    void addWeight(Price price, uint64_t delta) {
+        size_t idx = 0;
+        if (toIndex(price, idx)) {
+            addWeight(idx, delta);
+        }
+    }
+
+    /**
+     * @brief Get the total weight of levels at or below a price
+     */
+    uint64_t weightAtOrBelow(Price price) const {
+        if (price < base_) {
+            return 0;
+        }
+        Price offset = (price - base_) / tick_ + 1;
+        if (offset >= static_cast<Price>(slots_.size())) {
+            return total_weight_;
+        }
+        return prefixWeight(static_cast<size_t>(offset));
+    }
+
+    /**
+     * @brief Get the total weight of levels at or above a price
+     */
+    uint64_t weightAtOrAbove(Price price) const {
+        if (price <= base_) {
+            return total_weight_;
+        }
+        // Round up so that a price between two slots excludes the lower one
+        Price offset = (price - base_ + tick_ - 1) / tick_;
+        if (offset >= static_cast<Price>(slots_.size())) {
+            return 0;
+        }
+        return total_weight_ - prefixWeight(static_cast<size_t>(offset));
+    }
+
+    /**
+     * @brief Get the highest occupied level
+     */
+    T* highest() {
+        size_t idx = 0;
+        return findPrev(slots_.size(), idx) ? &slots_[idx] : nullptr;
+    }
+
+    /**
+     * @brief Get the lowest occupied level
+     */
+    T* lowest() {
+        size_t idx = 0;
+        return findNext(0, idx) ? &slots_[idx] : nullptr;
+    }
+
+    /**
+     * @brief Get the highest occupied level strictly below a price
+     */
+    T* below(Price price) {
+        size_t idx = 0;
+        Price offset = (price - base_) / tick_;
+        if (offset <= 0) {
+            return nullptr;
+        }
+        size_t limit = std::min(static_cast<size_t>(offset), slots_.size());
+        return findPrev(limit, idx) ? &slots_[idx] : nullptr;
+    }
+
+    /**
+     * @brief Get the lowest occupied level strictly above a price
+     */
+    T* above(Price price) {
+        size_t idx = 0;
+        Price offset = (price - base_) / tick_ + 1;
+        if (offset >= static_cast<Price>(slots_.size())) {
+            return nullptr;
+        }
+        size_t start = offset < 0 ? 0 : static_cast<size_t>(offset);
+        return findNext(start, idx) ? &slots_[idx] : nullptr;
+    }
+
+    /**
+     * @brief Visit occupied levels from the highest price down
+     *
+     * @param f Called with each level; return false to stop
+     */
+    template <typename F>
+    void forEachDescending(F&& f) {
+        size_t idx = slots_.size();
+        while (findPrev(idx, idx)) {
+            if (!f(slots_[idx])) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Visit occupied levels from the lowest price up
+     *
+     * @param f Called with each level; return false to stop
+     */
+    template <typename F>
+    void forEachAscending(F&& f) {
+        size_t idx = 0;
+        while (findNext(idx, idx)) {
+            if (!f(slots_[idx])) {
+                return;
+            }
+            ++idx;
+        }
+    }
+
+    /**
+     * @brief Release every level, keeping the allocated slots
+     */
+    void clear() {
+        forEachAscending([](T& level) {
+            level = T{};
+            return true;
+        });
+        std::fill(occupied_.begin(), occupied_.end(), 0);
+        std::fill(summary_.begin(), summary_.end(), 0);
+        clearWeights();
+        count_ = 0;
+    }
+
+private:
+    Price tick_;
+    size_t max_capacity_;
+    Price base_ = 0;
+    size_t count_ = 0;
+    std::vector<T> slots_;
+    std::vector<uint64_t> occupied_;  // One bit per slot
+    std::vector<uint64_t> summary_;   // One bit per non-zero word of occupied_
+    std::vector<uint64_t> slot_weight_;
+    std::vector<uint64_t> word_weight_;   // Sum over each word of occupied_
+    std::vector<uint64_t> block_weight_;  // Sum over each word of summary_
+    uint64_t total_weight_ = 0;
+
+    static int highestBit(uint64_t word) { return 63 - __builtin_clzll(word); }
+    static int lowestBit(uint64_t word) { return __builtin_ctzll(word); }
+
+    // Slots needed to cover the occupied range and a price (the ladder must not be empty)
+    size_t spanWith(Price price) const {
+        size_t first = 0;
+        size_t last = 0;
+        findNext(0, first);
+        findPrev(slots_.size(), last);
+        Price lo = std::min(price, base_ + static_cast<Price>(first) * tick_);
+        Price hi = std::max(price, base_ + static_cast<Price>(last) * tick_);
+        // Unsigned, so prices far apart cannot overflow the difference
+        return static_cast<size_t>((static_cast<uint64_t>(hi) - static_cast<uint64_t>(lo)) / static_cast<uint64_t>(tick_)) + 1;
+    }
+
+    Price alignDown(Price price) const {
+        Price rem = price % tick_;
+        return rem < 0 ? price - rem - tick_ : price - rem;
+    }
+
+    bool toIndex(Price price, size_t& idx) const {
+        if (price < base_) {
+            return false;
+        }
+        Price offset = (price - base_) / tick_;
+        if (offset >= static_cast<Price>(slots_.size())) {
+            return false;
+        }
+        idx = static_cast<size_t>(offset);
+        return true;
+    }
+
+    bool test(size_t idx) const { return (occupied_[idx >> 6] >> (idx & 63)) & 1; }
+
+    void set(size_t idx) {
+        occupied_[idx >> 6] |= uint64_t{1} << (idx & 63);
+        summary_[idx >> 12] |= uint64_t{1} << ((idx >> 6) & 63);
+    }
+
+    void reset(size_t idx) {
+        size_t word = idx >> 6;
+        occupied_[word] &= ~(uint64_t{1} << (idx & 63));
+        if (occupied_[word] == 0) {
+            summary_[word >> 6] &= ~(uint64_t{1} << (word & 63));
+        }
+    }
+
+    void addWeight(size_t idx, uint64_t delta) {
+        slot_weight_[idx] += delta;
+        word_weight_[idx >> 6] += delta;
+        block_weight_[idx >> 12] += delta;
+        total_weight_ += delta;
+    }
+
+    // Total weight of slots [0, end)
+    uint64_t prefixWeight(size_t end) const {
+        uint64_t sum = 0;
+        size_t word = end >> 6;
+        size_t block = word >> 6;
+        for (size_t b = 0; b < block; ++b) {
+            sum += block_weight_[b];
+        }
+        for (size_t w = block << 6; w < word; ++w) {
+            sum += word_weight_[w];
+        }
+        if (end & 63) {
+            uint64_t bits = occupied_[word] & ~(~uint64_t{0} << (end & 63));
+            while (bits) {
+                sum += slot_weight_[(word << 6) + lowestBit(bits)];
+                bits &= bits - 1;
+            }
+        }
+        return sum;
+    }
+
+    void clearWeights() {
+        std::fill(slot_weight_.begin(), slot_weight_.end(), 0);
+        std::fill(word_weight_.begin(), word_weight_.end(), 0);
+        std::fill(block_weight_.begin(), block_weight_.end(), 0);
+        total_weight_ = 0;
+    }
+
+    // Lowest occupied slot at or above start
+    bool findNext(size_t start, size_t& idx) const {
+        if (start >= slots_.size()) {
+            return false;
+        }
+        size_t word = start >> 6;
+        uint64_t bits = occupied_[word] & (~uint64_t{0} << (start & 63));
+        if (bits) {
+            idx = (word << 6) + lowestBit(bits);
+            return true;
+        }
+        // Find the next non-empty word through the summary
+        size_t next_word = word + 1;
+        size_t sword = next_word >> 6;
+        if (sword >= summary_.size()) {
+            return false;
+        }
+        uint64_t sbits = (next_word & 63) ? summary_[sword] & (~uint64_t{0} << (next_word & 63))
+                                          : summary_[sword];
+        while (!sbits) {
+            if (++sword >= summary_.size()) {
+                return false;
+            }
+            sbits = summary_[sword];
+        }
+        word = (sword << 6) + lowestBit(sbits);
+        idx = (word << 6) + lowestBit(occupied_[word]);
+        return true;
+    }
+
+    // Highest occupied slot strictly below end
+    bool findPrev(size_t end, size_t& idx) const {
+        if (end == 0) {
+            return false;
+        }
+        size_t last = end - 1;
+        size_t word = last >> 6;
+        uint64_t bits = occupied_[word] & (~uint64_t{0} >> (63 - (last & 63)));
+        if (bits) {
+            idx = (word << 6) + highestBit(bits);
+            return true;
+        }
+        if (word == 0) {
+            return false;
+        }
+        // Find the previous non-empty word through the summary
+        size_t prev_word = word - 1;
+        size_t sword = prev_word >> 6;
+        uint64_t sbits = summary_[sword] & (~uint64_t{0} >> (63 - (prev_word & 63)));
+        while (!sbits) {
+            if (sword == 0) {
+                return false;
+            }
+            sbits = summary_[--sword];
+        }
+        word = (sword << 6) + highestBit(sbits);
+        idx = (word << 6) + highestBit(occupied_[word]);
+        return true;
+    }
+
+    void resize(size_t capacity) {
+        slots_.assign(capacity, T{});
+        occupied_.assign(capacity / 64, 0);
+        summary_.assign((occupied_.size() + 63) / 64, 0);
+        slot_weight_.assign(capacity, 0);
+        word_weight_.assign(occupied_.size(), 0);
+        block_weight_.assign(summary_.size(), 0);
+        total_weight_ = 0;
+    }
+
+    // Move the window so that it covers both the occupied range and price
+    void recentre(Price price) {
+        size_t needed = spanWith(price);
+        if (needed > max_capacity_) {
+            throw std::invalid_argument("Price is too far from the other levels for the price ladder");
+        }
+        size_t first = 0;
+        size_t last = 0;
+        findNext(0, first);
+        findPrev(slots_.size(), last);
+        Price lo = std::min(price, base_ + static_cast<Price>(first) * tick_);
+        Price hi = std::max(price, base_ + static_cast<Price>(last) * tick_);
+
+        size_t capacity = std::max<size_t>(slots_.size(), 64);
+        while (capacity < needed + needed / 4) {
+            capacity *= 2;
+        }
+        capacity = std::max(needed, std::min(capacity, max_capacity_));
+        capacity = (capacity + 63) / 64 * 64;
+
+        struct Moved {
+            Price price;
+            T level;
+            uint64_t weight;
+        };
+        std::vector<Moved> levels;
+        levels.reserve(count_);
+        forEachAscending([&](T& level) {
+            size_t idx = static_cast<size_t>(&level - slots_.data());
+            levels.push_back(Moved{base_ + static_cast<Price>(idx) * tick_, std::move(level),
+                                   slot_weight_[idx]});
+            return true;
+        });
+
+        Price mid = lo + ((hi - lo) / tick_ / 2) * tick_;
+        if (capacity != slots_.size()) {
+            resize(capacity);
+        } else {
+            std::fill(slots_.begin(), slots_.end(), T{});
+            std::fill(occupied_.begin(), occupied_.end(), 0);
+            std::fill(summary_.begin(), summary_.end(), 0);
+            clearWeights();
+        }
+        base_ = alignDown(mid - static_cast<Price>(capacity / 2) * tick_);
+
+        for (auto& moved : levels) {
+            size_t idx = 0;
+            if (!toIndex(moved.price, idx)) {
+                throw std::logic_error("PriceLadder: level outside the ladder after recentring");
+            }
+            slots_[idx] = std::move(moved.level);
+            set(idx);
+            addWeight(idx, moved.weight);
+        }
+    }
+};
+
+} // namespace orderbook
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace orderbook {
+
+/**
+ * @brief Single-writer sequence lock around a trivially copyable value
+ *
+ * The writer bumps the sequence to an odd number, stores the value and
+ * bumps it back to even; it never waits for readers. Readers copy the
+ * value and retry if the sequence was odd or changed underneath them, so
+ * any number of threads can take consistent snapshots without blocking
+ * the writer. The value is stored as relaxed atomic words, which keeps
+ * the concurrent copy free of data races.
+ *
+ * @tparam T The published type (must be trivially copyable)
+ */
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock requires a trivially copyable type");
+
+public:
+    SeqLock() {
+        uint64_t words[kWords] = {};
+        T initial{};
+        std::memcpy(words, &initial, sizeof(T));
+        for (size_t i = 0; i < kWords; ++i) {
+            data_[i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Publish a new value (owning writer thread only)
+     */
+    void store(const T& value) {
+        uint64_t words[kWords] = {};
+        std::memcpy(words, &value, sizeof(T));
+
+        uint64_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < kWords; ++i) {
+            data_[i].store(words[i], std::memory_order_relaxed);
+        }
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Take a consistent copy of the latest value (any thread)
+     */
+    T load() const {
+        uint64_t words[kWords];
+        uint64_t before;
+        uint64_t after;
+        do {
+            before = seq_.load(std::memory_order_acquire);
+            for (size_t i = 0; i < kWords; ++i) {
+                words[i] = data_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = seq_.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+    /**
+     * @brief Get the number of values published so far
+     */
+    uint64_t version() const { return seq_.load(std::memory_order_acquire) / 2; }
+
+private:
+    static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    alignas(64) std::atomic<uint64_t> seq_{0};
+    alignas(64) std::atomic<uint64_t> data_[kWords];
+};
+
+} // namespace orderbook
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace orderbook {
+
+/**
+ * @brief Bounded single-producer/single-consumer ring buffer
+ *
+ * Items are stored by value in a power-of-two array. The producer owns
+ * the tail index and the consumer owns the head index. Each side keeps a
+ * cached copy of the other side's index, so the shared cache line is only
+ * read when the ring looks full (producer) or empty (consumer). The
+ * indices sit on separate cache lines so the two threads never write to
+ * the same line.
+ *
+ * Exactly one thread may push and exactly one thread may pop at a time.
+ *
+ * @tparam T The item type (must be trivially copyable)
+ */
+template <typename T>
+class SpscQueue {
+    static_assert(std::is_trivially_copyable<T>::value, "SpscQueue requires a trivially copyable type");
+
+public:
+    /**
+     * @brief Construct an empty queue
+     *
+     * @param capacity The minimum number of items the queue can hold (rounded up to a power of two)
+     */
+    explicit SpscQueue(size_t capacity)
+        : capacity_(roundUp(capacity < 2 ? 2 : capacity)),
+          mask_(capacity_ - 1),
+          items_(new T[capacity_]) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * @brief Append an item (producer thread only)
+     *
+     * @return bool False if the queue is full
+     */
+    bool tryPush(const T& item) {
+        uint64_t tail = producer_.tail.load(std::memory_order_relaxed);
+        if (tail - producer_.cached_head == capacity_) {
+            producer_.cached_head = consumer_.head.load(std::memory_order_acquire);
+            if (tail - producer_.cached_head == capacity_) {
+                return false;
+            }
+        }
+        items_[tail & mask_] = item;
+        producer_.tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove the oldest item (consumer thread only)
+     *
+     * @return bool False if the queue is empty
+     */
+    bool tryPop(T& item) {
+        uint64_t head = consumer_.head.load(std::memory_order_relaxed);
+        if (head == consumer_.cached_tail) {
+            consumer_.cached_tail = producer_.tail.load(std::memory_order_acquire);
+            if (head == consumer_.cached_tail) {
+                return false;
+            }
+        }
+        item = items_[head & mask_];
+        consumer_.head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove up to max_items of the oldest items (consumer thread only)
+     *
+     * Publishes the new head once for the whole batch.
+     *
+     * @return size_t The number of items copied to out
+     */
+    size_t popBatch(T* out, size_t max_items) {
+        uint64_t head = consumer_.head.load(std::memory_order_relaxed);
+        if (consumer_.cached_tail - head < max_items) {
+            consumer_.cached_tail = producer_.tail.load(std::memory_order_acquire);
+        }
+        size_t count = consumer_.cached_tail - head;
+        if (count > max_items) {
+            count = max_items;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = items_[(head + i) & mask_];
+        }
+        if (count > 0) {
+            consumer_.head.store(head + count, std::memory_order_release);
+        }
+        return count;
+    }
+
+    /**
+     * @brief Get the number of queued items
+     *
+     * Exact when called from the producer or consumer thread while the
+     * other side is idle; otherwise a snapshot.
+     */
+    size_t size() const {
+        uint64_t head = consumer_.head.load(std::memory_order_acquire);
+        uint64_t tail = producer_.tail.load(std::memory_order_acquire);
+        return static_cast<size_t>(tail - head);
+    }
+
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    static size_t roundUp(size_t n) {
+        size_t power = 1;
+        while (power < n) {
+            power <<= 1;
+        }
+        return power;
+    }
+
+    struct alignas(64) ProducerState {
+        std::atomic<uint64_t> tail{0};
+        uint64_t cached_head = 0;
+    };
+
+    struct alignas(64) ConsumerState {
+        std::atomic<uint64_t> head{0};
+        uint64_t cached_tail = 0;
+    };
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<T[]> items_;
+
+    ProducerState producer_;
+    ConsumerState consumer_;
+};
+
+} // namespace orderbook
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <shared_mutex>
+
+namespace orderbook {
+
+/**
+ * @brief Compact identifier for an interned symbol
+ */
+using SymbolId = uint32_t;
+
+/**
+ * @brief Process-wide table of interned symbol names
+ * 
+ * Hands out dense SymbolIds so orders, trades and books can carry a
+ * 4-byte ID instead of a string. ID 0 is always the empty symbol.
+ * Names are never removed, so references returned by name() stay valid.
+ */
+class SymbolRegistry {
+public:
+    /**
+     * @brief Get the process-wide registry
+     */
+    static SymbolRegistry& instance();
+
+    /**
+     * @brief Get the ID for a symbol, assigning a new one if needed
+     * 
+     * @param name The symbol name
+     * @return SymbolId The symbol's ID
+     */
+    SymbolId intern(const std::string& name);
+
+    /**
+     * @brief Look up the ID of an already interned symbol
+     * 
+     * @param name The symbol name
+     * @param id Set to the symbol's ID if found
+     * @return bool True if the symbol has been interned
+     */
+    bool find(const std::string& name, SymbolId& id) const;
+
+    /**
+     * @brief Get the name of a symbol
+     * 
+     * @param id The symbol ID
+     * @return const std::string& The name, or the empty string for an unknown ID
+     */
+    const std::string& name(SymbolId id) const;
+
+    /**
+     * @brief Get the number of interned symbols (including the empty symbol)
+     */
+    size_t size() const;
+
+private:
+    SymbolRegistry();
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, SymbolId> ids_;
+    std::deque<std::string> names_;
+};
+
+
+/**
+ * @brief Per-decoder cache from symbol text to SymbolId
+ * 
+ * Feed decoders see the same few symbols over and over as text. This
+ * keeps them in a small open-addressed table keyed by a hash of the
+ * bytes, so a lookup is a hash, usually one probe and a short compare,
+ * with no lock and no allocation. Misses are interned in the registry.
+ * Not thread-safe: each decoder owns one.
+ */
+class SymbolCache {
+public:
+    SymbolCache() : slots_(64) {}
+    
+    /**
+     * @brief Get the ID for a symbol, interning it on first sight
+     */
+    SymbolId lookup(std::string_view name) {
+        uint64_t hash = hashName(name);
+        size_t mask = slots_.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            const Slot& slot = slots_[i];
+            if (!slot.used) {
+                return insert(hash, name);
+            }
+            if (slot.hash == hash && slot.name == name) {
+                return slot.id;
+            }
+        }
+    }
+    
+private:
+    struct Slot {
+        uint64_t hash = 0;
+        std::string name;
+        SymbolId id = 0;
+        bool used = false;
+    };
+    
+    std::vector<Slot> slots_;
+    size_t count_ = 0;
+    
+    static uint64_t hashName(std::string_view name) {
+        uint64_t hash = 14695981039346656037ULL;  // FNV-1a
+        for (char c : name) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+        }
+        return hash;
+    }
+    
+    SymbolId insert(uint64_t hash, std::string_view name);
+};
+
+} // namespace orderbook 
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "epoch.h"
+#include "symbol_registry.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace orderbook {
+
+/**
+ * @brief Flat SymbolId-indexed table of pointers with lock-free lookups
+ *
+ * SymbolRegistry hands out dense IDs, so routing a symbol is one bounds
+ * check and one load from an array. Writers are serialized by an internal
+ * mutex. A slot that fits in the current array is updated in place;
+ * growing copies the array into a larger one, publishes it, and retires
+ * the old one through the EpochDomain.
+ *
+ * find() must be called inside a read-side critical section of that
+ * domain. The table does not own what it points to: a caller that
+ * removes an entry must retire the pointee through the same domain so
+ * that a reader still using it is not left with a dangling pointer.
+ *
+ * @tparam T The pointee type
+ */
+template <typename T>
+class SymbolTable {
+public:
+    explicit SymbolTable(EpochDomain& epoch, size_t initial_capacity = 64)
+        : epoch_(epoch), table_(new Table(initial_capacity < 1 ? 1 : initial_capacity)) {}
+
+    ~SymbolTable() { delete table_.load(std::memory_order_relaxed); }
+
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    /**
+     * @brief Look up a symbol (inside a read-side critical section)
+     *
+     * @return T* The entry, or nullptr if there is none
+     */
+    T* find(SymbolId id) const {
+        const Table* table = table_.load(std::memory_order_acquire);
+        return id < table->capacity ? table->slots[id].load(std::memory_order_acquire) : nullptr;
+    }
+
+    /**
+     * @brief Set the entry for a symbol, growing the table if needed
+     *
+     * @return T* The previous entry, or nullptr
+     */
+    T* set(SymbolId id, T* value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Table* table = table_.load(std::memory_order_relaxed);
+        if (id >= table->capacity) {
+            size_t capacity = table->capacity;
+            while (capacity <= id) {
+                capacity *= 2;
+            }
+            auto* grown = new Table(capacity);
+            for (size_t i = 0; i < table->capacity; ++i) {
+                grown->slots[i].store(table->slots[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+            table_.store(grown, std::memory_order_release);
+            epoch_.retire(table);
+            table = grown;
+        }
+        return table->slots[id].exchange(value, std::memory_order_acq_rel);
+    }
+
+    /**
+     * @brief Clear the entry for a symbol
+     *
+     * @return T* The previous entry, or nullptr
+     */
+    T* erase(SymbolId id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Table* table = table_.load(std::memory_order_relaxed);
+        return id < table->capacity ? table->slots[id].exchange(nullptr, std::memory_order_acq_rel) : nullptr;
+    }
+
+    size_t capacity() const { return table_.load(std::memory_order_acquire)->capacity; }
+
+private:
+    struct Table {
+        explicit Table(size_t capacity) : capacity(capacity), slots(new std::atomic<T*>[capacity]) {
+            for (size_t i = 0; i < capacity; ++i) {
+                slots[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        const size_t capacity;
+        std::unique_ptr<std::atomic<T*>[]> slots;
+    };
+
+    EpochDomain& epoch_;
+    std::atomic<Table*> table_;
+    std::mutex mutex_;
+};
+
+} // namespace orderbook
@@ -0,0 +1,248 @@
+#pragma once
+
+#include "order_book.h"
+#include "trade.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace orderbook {
+
+/**
+ * @brief Header of one column file of a tick store
+ *
+ * The header is followed by row_count rows of width values each, in
+ * native byte order. It is one cache line long, so the values of a mapped
+ * column start cache-line aligned.
+ */
+struct TickColumnHeader {
+    static constexpr char kMagic[8] = {'O', 'B', 'C', 'O', 'L', 'U', 'M', 'N'};
+    static constexpr uint32_t kVersion = 1;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t value_size;     // Bytes per value
+    uint32_t width;          // Values per row (depth levels in the quote price and size columns)
+    uint32_t reserved0;
+    uint64_t row_count;      // Rows written in full; anything after them is an unfinished write
+    uint8_t reserved[32];
+};
+
+static_assert(sizeof(TickColumnHeader) == 64, "TickColumnHeader must be one cache line");
+
+/**
+ * @brief Options for a TickStore
+ */
+struct TickStoreConfig {
+    size_t depth_levels = 1;     // Levels per side in each quote row (1: top of book only)
+    size_t buffer_rows = 4096;   // Rows buffered per table before they are written out
+};
+
+/**
+ * @brief Appends trades and quotes to per-symbol, per-day column files
+ *
+ * Each symbol's day is a directory holding two tables, one file per column:
+ *
+ *     <root>/<symbol>/<yyyymmdd>/trades/{time,price,size,side,id}
+ *     <root>/<symbol>/<yyyymmdd>/quotes/{time,bid_price,bid_size,ask_price,ask_size}
+ *
+ * Days are the UTC days of the row timestamps. A quote row holds
+ * depth_levels bid and ask levels, best first, with zeros past the last
+ * level. Times are in nanoseconds and are kept non-decreasing within a
+ * table: a row stamped earlier than the row before it takes that row's
+ * time, so days can be searched by time (see TickDay).
+ *
+ * Rows are buffered per table and written out a column at a time, each
+ * file's row count updated after its rows, so readers (even of a day
+ * still being written) and a store reopening the day only see whole
+ * rows; a crash loses at most the buffered rows. Files are opened only
+ * while rows are written to them, so any number of symbols can be
+ * recorded. Recording a symbol's new day writes out and drops its older
+ * days' buffers. Not thread-safe: record from one thread, e.g. the thread
+ * that mutates the books, since book callbacks run on it.
+ */
+class TickStore {
+public:
+    /**
+     * @brief Open a store, creating the root directory if needed
+     *
+     * @throws std::runtime_error If the directory cannot be created
+     * @throws std::invalid_argument If depth_levels is 0 or more than DepthSnapshot::kMaxLevels
+     */
+    explicit TickStore(const std::string& root, const TickStoreConfig& config = TickStoreConfig());
+    ~TickStore();
+
+    TickStore(const TickStore&) = delete;
+    TickStore& operator=(const TickStore&) = delete;
+
+    /**
+     * @brief Append a trade to its symbol's day
+     *
+     * @throws std::runtime_error If a column file cannot be opened or written
+     */
+    void recordTrade(const Trade& trade);
+
+    /**
+     * @brief Append a quote to its symbol's day
+     *
+     * @throws std::runtime_error If a column file cannot be opened or written
+     */
+    void recordQuote(SymbolId symbol_id, const TopOfBook& top);
+    void recordQuote(SymbolId symbol_id, const DepthSnapshot& depth);
+
+    /**
+     * @brief Record a book's trades and depth updates
+     *
+     * Registers the book's trade and depth update callbacks, replacing any
+     * already registered. Quote rows take up to depth_levels of the
+     * published levels (OrderBookConfig::published_levels). Books with
+     * UpdateNotification::ON_CHANGE record a row per change of those
+     * levels, stamped with the event time; EVERY_MUTATION books record a
+     * row per mutation, stamped with the clock.
+     */
+    void attach(OrderBook& book);
+
+    /**
+     * @brief Write all buffered rows to the column files
+     */
+    void flush();
+
+    /**
+     * @brief Flush and release every day's buffers
+     *
+     * The store can keep recording afterwards; days are reopened for appending.
+     */
+    void close();
+
+    const std::string& root() const { return root_; }
+    uint64_t tradeCount() const { return trade_count_; }   // Trades recorded by this store
+    uint64_t quoteCount() const { return quote_count_; }   // Quotes recorded by this store
+
+    /**
+     * @brief Get the UTC day of a timestamp as yyyymmdd
+     */
+    static uint32_t dayOf(std::chrono::nanoseconds timestamp);
+
+private:
+    class Table;
+
+    std::string root_;
+    TickStoreConfig config_;
+    std::unordered_map<uint64_t, std::unique_ptr<Table>> trades_;  // By symbol ID and day
+    std::unordered_map<uint64_t, std::unique_ptr<Table>> quotes_;
+    uint64_t trade_count_ = 0;
+    uint64_t quote_count_ = 0;
+
+    // The table of the previous row, which the next one usually goes to
+    Table* last_trades_ = nullptr;
+    Table* last_quotes_ = nullptr;
+
+    Table& tableFor(std::unordered_map<uint64_t, std::unique_ptr<Table>>& tables, Table*& last,
+                    SymbolId symbol_id, int64_t time, bool quotes);
+};
+
+/**
+ * @brief Read-only memory mapping of one tick store column file
+ */
+class MappedColumn {
+public:
+    MappedColumn() = default;
+
+    /**
+     * @brief Map a column file
+     *
+     * @throws std::runtime_error If the file cannot be mapped or is not a column file
+     */
+    explicit MappedColumn(const std::string& path);
+    ~MappedColumn();
+
+    MappedColumn(MappedColumn&& other) noexcept;
+    MappedColumn& operator=(MappedColumn&& other) noexcept;
+    MappedColumn(const MappedColumn&) = delete;
+    MappedColumn& operator=(const MappedColumn&) = delete;
+
+    template <typename T>
+    const T* data() const { return static_cast<const T*>(values_); }
+    size_t rows() const { return rows_; }
+    size_t width() const { return width_; }
+    size_t valueSize() const { return value_size_; }
+
+private:
+    void* mapping_ = nullptr;
+    size_t length_ = 0;
+    const void* values_ = nullptr;
+    size_t rows_ = 0;
+    size_t width_ = 1;
+    size_t value_size_ = 0;
+};
+
+/**
+ * @brief Trade columns of a day, or of a time range of it
+ */
+struct TradeColumns {
+    size_t rows = 0;
+    const int64_t* time = nullptr;             // Nanoseconds
+    const Order::Price* price = nullptr;
+    const Order::Quantity* size = nullptr;
+    const Side* side = nullptr;                // Taker side
+    const Trade::TradeId* id = nullptr;
+
+    TradeColumns slice(size_t first, size_t last) const;
+};
+
+/**
+ * @brief Quote columns of a day, or of a time range of it
+ *
+ * Level l of row r is at [r * levels + l] in the price and size columns.
+ */
+struct QuoteColumns {
+    size_t rows = 0;
+    size_t levels = 0;
+    const int64_t* time = nullptr;             // Nanoseconds
+    const Order::Price* bid_price = nullptr;
+    const Order::Quantity* bid_size = nullptr;
+    const Order::Price* ask_price = nullptr;
+    const Order::Quantity* ask_size = nullptr;
+
+    QuoteColumns slice(size_t first, size_t last) const;
+};
+
+/**
+ * @brief One symbol's day of a tick store, read through memory mappings
+ *
+ * Opening a day maps its column files and reads nothing else; pages are
+ * faulted in as the columns are scanned. Columns are plain arrays, so
+ * scans over them vectorize. A table the day does not have reads as empty.
+ */
+class TickDay {
+public:
+    /**
+     * @param day The day as yyyymmdd
+     * @throws std::runtime_error If a column file is damaged or the columns disagree
+     */
+    TickDay(const std::string& root, const std::string& symbol, uint32_t day);
+
+    TradeColumns trades() const { return trades_; }
+    QuoteColumns quotes() const { return quotes_; }
+
+    /**
+     * @brief Rows with from <= time < to, found by binary search
+     */
+    TradeColumns trades(std::chrono::nanoseconds from, std::chrono::nanoseconds to) const;
+    QuoteColumns quotes(std::chrono::nanoseconds from, std::chrono::nanoseconds to) const;
+
+    /**
+     * @brief List the days stored for a symbol, in order
+     */
+    static std::vector<uint32_t> days(const std::string& root, const std::string& symbol);
+
+private:
+    std::vector<MappedColumn> columns_;
+    TradeColumns trades_;
+    QuoteColumns quotes_;
+};
+
+} // namespace orderbook
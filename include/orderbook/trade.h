@@ -4,13 +4,15 @@
 #include <cstdint>
 #include <string>
 #include <chrono>
+#include <type_traits>
 
 namespace orderbook {
 
 /**
  * @brief Represents a trade execution in the market
  * 
- * A Trade occurs when a buy order matches with a sell order
+ * A Trade occurs when a buy order matches with a sell order.
+ * Like Order, it carries an interned SymbolId and is trivially copyable.
  */
 class Trade {
 public:
@@ -24,29 +26,41 @@ public:
     Trade() = default;
 
     // Constructor for a new trade
+    Trade(TradeId id, SymbolId symbol_id, Price price, Quantity quantity,
+          OrderId maker_order_id, OrderId taker_order_id, Timestamp timestamp,
+          Side taker_side = Side::BUY);
+    
+    // Constructor that interns the symbol name
     Trade(TradeId id, const std::string& symbol, Price price, Quantity quantity,
-          OrderId maker_order_id, OrderId taker_order_id, Timestamp timestamp);
+          OrderId maker_order_id, OrderId taker_order_id, Timestamp timestamp,
+          Side taker_side = Side::BUY);
     
     // Getters
     TradeId getId() const { return id_; }
-    const std::string& getSymbol() const { return symbol_; }
+    SymbolId getSymbolId() const { return symbol_id_; }
+    const std::string& getSymbol() const { return SymbolRegistry::instance().name(symbol_id_); }
     Price getPrice() const { return price_; }
     Quantity getQuantity() const { return quantity_; }
     OrderId getMakerOrderId() const { return maker_order_id_; }
     OrderId getTakerOrderId() const { return taker_order_id_; }
     Timestamp getTimestamp() const { return timestamp_; }
+    Side getTakerSide() const { return taker_side_; }
 
     // Compute trade value (price * quantity)
     int64_t getValue() const { return price_ * quantity_; }
 
 private:
     TradeId id_ = 0;
-    std::string symbol_;
     Price price_ = 0;
     Quantity quantity_ = 0;
     OrderId maker_order_id_ = 0;  // The passive/resting order that was hit
     OrderId taker_order_id_ = 0;  // The aggressive/incoming order that took liquidity
     Timestamp timestamp_{};
+    SymbolId symbol_id_ = 0;
+    Side taker_side_ = Side::BUY;  // The aggressor's side: BUY if the taker bought
 };
 
+static_assert(std::is_trivially_copyable<Trade>::value, "Trade must be trivially copyable");
+static_assert(sizeof(Trade) <= 64, "Trade must fit in a cache line");
+
 } // namespace orderbook 
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace orderbook {
+
+/**
+ * @brief How a thread waits for a queue to become ready
+ */
+enum class WaitStrategy : uint8_t {
+    BUSY_SPIN = 0,   // Spin on the queue; lowest latency, burns a core
+    SPIN_YIELD = 1,  // Spin, then yield the CPU between polls
+    BLOCKING = 2     // Spin, then sleep until the other side signals
+};
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+/**
+ * @brief The waiting side of one queue
+ *
+ * The waiting thread calls idle() each time it finds nothing to do; the
+ * thread that makes progress for it calls notify(). Under BLOCKING the
+ * waiter announces that it is about to sleep and rechecks its condition
+ * under the lock, so notify() only takes the lock when someone is
+ * actually asleep.
+ */
+class QueueWaiter {
+public:
+    QueueWaiter(WaitStrategy strategy, uint32_t spin_iterations)
+        : strategy_(strategy), spin_iterations_(spin_iterations) {}
+
+    /**
+     * @brief Wait a little, or until ready() holds under BLOCKING
+     *
+     * @param spins Polls so far in this idle stretch; reset it after progress
+     * @param ready Condition the other side will notify about
+     */
+    template <typename Ready>
+    void idle(uint32_t& spins, Ready&& ready) {
+        if (strategy_ == WaitStrategy::BUSY_SPIN || spins < spin_iterations_) {
+            ++spins;
+            cpuRelax();
+            return;
+        }
+        if (strategy_ == WaitStrategy::SPIN_YIELD) {
+            std::this_thread::yield();
+            return;
+        }
+
+        sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, ready);
+        }
+        sleeping_.store(false, std::memory_order_relaxed);
+        spins = 0;
+    }
+
+    /**
+     * @brief Wake the waiter if it is asleep (after making progress for it)
+     */
+    void notify() {
+        if (strategy_ != WaitStrategy::BLOCKING) {
+            return;
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping_.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            condition_.notify_all();
+        }
+    }
+
+    /**
+     * @brief Change state the waiter's condition depends on and wake it unconditionally
+     */
+    template <typename Change>
+    void notifyAfter(Change&& change) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        change();
+        condition_.notify_all();
+    }
+
+private:
+    WaitStrategy strategy_;
+    uint32_t spin_iterations_;
+    std::atomic<bool> sleeping_{false};
+    std::mutex mutex_;
+    std::condition_variable condition_;
+};
+
+} // namespace orderbook
@@ -0,0 +1,289 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace orderbook {
+
+/**
+ * @brief Parts of a ws:// URL
+ */
+struct WebSocketUrl {
+    std::string host;
+    uint16_t port = 80;
+    std::string path = "/";
+};
+
+/**
+ * @brief Parse "ws://host[:port][/path]"
+ *
+ * @throws std::invalid_argument For other schemes (wss:// needs TLS, which is not built in) or a bad port
+ */
+WebSocketUrl parseWebSocketUrl(const std::string& url);
+
+/**
+ * @brief The Sec-WebSocket-Accept value for a handshake key (RFC 6455 section 4.2.2)
+ */
+std::string webSocketAccept(std::string_view key);
+
+/**
+ * @brief Build a client's opening handshake request
+ *
+ * @param key Set to the random Sec-WebSocket-Key sent, for checkWebSocketResponse()
+ */
+std::string webSocketRequest(const WebSocketUrl& url, std::string& key);
+
+/**
+ * @brief Check the server's reply to the opening handshake
+ *
+ * @return size_t Length of the reply headers once complete; 0 if more bytes are needed
+ * @throws std::runtime_error If the server refused the upgrade or sent the wrong accept value
+ */
+size_t checkWebSocketResponse(std::string_view response, std::string_view key);
+
+enum class WebSocketOpcode : uint8_t {
+    CONTINUATION = 0x0,
+    TEXT = 0x1,
+    BINARY = 0x2,
+    CLOSE = 0x8,
+    PING = 0x9,
+    PONG = 0xA
+};
+
+/**
+ * @brief Append one complete (FIN) frame
+ *
+ * Clients must mask their frames; servers must not.
+ */
+void appendFrame(std::string& out, WebSocketOpcode opcode, std::string_view payload, bool mask, uint32_t mask_key = 0);
+
+/**
+ * @brief Incremental WebSocket frame parser working in place
+ *
+ * parse() is given the bytes received so far and consumes the complete
+ * frames at the front. An unfragmented message is reported with a
+ * payload pointing into the caller's buffer (unmasked there, if the
+ * sender masked it), so the common case copies nothing. Only fragmented
+ * messages are gathered into an internal buffer. Control frames may
+ * arrive between fragments and are reported as they come.
+ */
+class WebSocketFrameParser {
+public:
+    explicit WebSocketFrameParser(size_t max_message = 16 << 20) : max_message_(max_message) {}
+
+    /**
+     * @brief Consume the complete frames at the front of data
+     *
+     * Calls on_message(opcode, payload) for each control frame and each
+     * complete data message. The payload is only valid during the call.
+     *
+     * @return size_t Bytes consumed; the rest starts an incomplete frame
+     */
+    template <typename OnMessage>
+    size_t parse(char* data, size_t size, OnMessage&& on_message) {
+        size_t offset = 0;
+        needed_ = 0;
+        while (!failed_) {
+            auto* frame = reinterpret_cast<unsigned char*>(data + offset);
+            size_t available = size - offset;
+            if (available < 2) {
+                break;
+            }
+
+            bool fin = frame[0] & 0x80;
+            auto opcode = static_cast<WebSocketOpcode>(frame[0] & 0x0F);
+            bool masked = frame[1] & 0x80;
+            uint64_t length = frame[1] & 0x7F;
+            size_t header = 2;
+            if (length == 126) {
+                if (available < 4) {
+                    break;
+                }
+                length = (uint64_t(frame[2]) << 8) | frame[3];
+                header = 4;
+            } else if (length == 127) {
+                if (available < 10) {
+                    break;
+                }
+                length = 0;
+                for (int i = 0; i < 8; ++i) {
+                    length = (length << 8) | frame[2 + i];
+                }
+                header = 10;
+            }
+            if (length > max_message_) {
+                failed_ = true;
+                break;
+            }
+            size_t mask_offset = header;
+            if (masked) {
+                header += 4;
+            }
+            if (available < header + length) {
+                needed_ = header + length;
+                break;
+            }
+
+            char* payload = data + offset + header;
+            if (masked) {
+                const unsigned char* key = frame + mask_offset;
+                for (size_t i = 0; i < length; ++i) {
+                    payload[i] ^= key[i & 3];
+                }
+            }
+            offset += header + length;
+
+            std::string_view body(payload, length);
+            if (static_cast<uint8_t>(opcode) & 0x8) {
+                on_message(opcode, body);
+            } else if (opcode == WebSocketOpcode::CONTINUATION) {
+                if (!fragmented_ || fragments_.size() + length > max_message_) {
+                    failed_ = true;
+                    break;
+                }
+                fragments_.append(body);
+                if (fin) {
+                    fragmented_ = false;
+                    on_message(fragment_opcode_, std::string_view(fragments_));
+                    fragments_.clear();
+                }
+            } else if (opcode == WebSocketOpcode::TEXT || opcode == WebSocketOpcode::BINARY) {
+                if (fragmented_) {
+                    failed_ = true;
+                    break;
+                }
+                if (fin) {
+                    on_message(opcode, body);
+                } else {
+                    fragmented_ = true;
+                    fragment_opcode_ = opcode;
+                    fragments_.assign(body);
+                }
+            } else {
+                failed_ = true;
+            }
+        }
+        return offset;
+    }
+
+    /**
+     * @brief Size of the incomplete frame at the front of the unconsumed bytes, if its header is known
+     *
+     * Lets a caller grow its buffer for a frame larger than it.
+     */
+    size_t needed() const { return needed_; }
+
+    /**
+     * @brief Check whether the stream broke the protocol (the connection should be dropped)
+     */
+    bool failed() const { return failed_; }
+
+    /**
+     * @brief Forget any partial message (for a new connection)
+     */
+    void reset() {
+        fragments_.clear();
+        fragmented_ = false;
+        failed_ = false;
+        needed_ = 0;
+    }
+
+private:
+    size_t max_message_;
+    std::string fragments_;
+    WebSocketOpcode fragment_opcode_ = WebSocketOpcode::TEXT;
+    bool fragmented_ = false;
+    bool failed_ = false;
+    size_t needed_ = 0;
+};
+
+/**
+ * @brief Minimal local WebSocket server for tests and benchmarks
+ *
+ * Listens on 127.0.0.1, accepts any number of clients and completes their
+ * handshakes on its own thread. Text messages from clients are recorded
+ * (and echoed back if echo is set); pings are answered. send() and
+ * replay() push text messages to every connected client from the calling
+ * thread.
+ */
+class WebSocketServer {
+public:
+    /**
+     * @param port Port to listen on; 0 picks a free one (see port())
+     * @param echo Send clients' text messages back to them
+     *
+     * @throws std::runtime_error If the socket cannot be set up
+     */
+    explicit WebSocketServer(uint16_t port = 0, bool echo = false);
+    ~WebSocketServer();
+
+    WebSocketServer(const WebSocketServer&) = delete;
+    WebSocketServer& operator=(const WebSocketServer&) = delete;
+
+    uint16_t port() const { return port_; }
+
+    /**
+     * @brief The ws:// URL of the server
+     */
+    std::string url(const std::string& path = "/") const;
+
+    /**
+     * @brief Wait until at least count clients have completed the handshake
+     *
+     * @return bool False on timeout
+     */
+    bool waitForClients(size_t count, std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Get the number of connected clients
+     */
+    size_t clients() const;
+
+    /**
+     * @brief Send a text message to every connected client
+     */
+    void send(std::string_view text);
+
+    /**
+     * @brief Send text messages to every client, optionally at a fixed rate (messages per second)
+     */
+    void replay(const std::vector<std::string>& messages, double rate = 0.0);
+
+    /**
+     * @brief Close every client connection (the clients see the server go away)
+     */
+    void disconnectClients();
+
+    /**
+     * @brief Get the text messages received from clients so far
+     */
+    std::vector<std::string> received() const;
+
+private:
+    struct Client;
+
+    int listen_fd_ = -1;
+    int wake_fds_[2] = {-1, -1};
+    uint16_t port_ = 0;
+    bool echo_;
+    std::atomic<bool> running_{true};
+    std::thread thread_;
+
+    mutable std::mutex mutex_;
+    std::vector<std::shared_ptr<Client>> clients_;
+    std::vector<std::string> received_;
+
+    void run();
+    void wake();
+    bool serviceClient(Client& client);
+};
+
+} // namespace orderbook
@@ -0,0 +1,191 @@
+#include "orderbook/book_side.h"
+#include <algorithm>
+
+namespace orderbook {
+
+BookSide::BookSide(Side side, BookStorage storage, Price tick_size, size_t ladder_levels,
+                   size_t max_ladder_levels, size_t level_capacity, size_t depth_levels)
+    : side_(side),
+      storage_(storage),
+      level_pool_(level_capacity),
+      level_nodes_(storage == BookStorage::MAP ? level_capacity : 1),
+      levels_(LevelMap::allocator_type(&level_nodes_)),
+      ladder_(tick_size, storage == BookStorage::ARRAY ? ladder_levels : 0, max_ladder_levels),
+      depth_(depth_levels),
+      depth_sums_(depth_levels) {}
+
+bool BookSide::empty() const {
+    return storage_ == BookStorage::ARRAY ? ladder_.empty() : levels_.empty();
+}
+
+size_t BookSide::size() const {
+    return storage_ == BookStorage::ARRAY ? ladder_.size() : levels_.size();
+}
+
+bool BookSide::isValidPrice(Price price) const {
+    return storage_ != BookStorage::ARRAY || ladder_.isAligned(price);
+}
+
+BookLevel* BookSide::find(Price price) {
+    if (storage_ == BookStorage::ARRAY) {
+        auto* slot = ladder_.find(price);
+        return slot ? *slot : nullptr;
+    }
+    auto it = levels_.find(price);
+    return it != levels_.end() ? it->second : nullptr;
+}
+
+BookLevel* BookSide::insert(Price price) {
+    BookLevel** slot;
+    LevelMap::iterator position{};
+    if (storage_ == BookStorage::ARRAY) {
+        bool created = false;
+        slot = &ladder_.insert(price, created);
+        if (!created) {
+            return *slot;
+        }
+    } else {
+        auto [it, created] = levels_.try_emplace(price, nullptr);
+        if (!created) {
+            return it->second;
+        }
+        slot = &it->second;
+        position = it;
+    }
+
+    auto* level = level_pool_.acquire();
+    *level = BookLevel{};
+    level->price = price;
+    level->position = position;
+    *slot = level;
+    
+    if (!depth_dirty_ && withinDepth(price)) {
+        depth_dirty_ = true;
+    }
+    return level;
+}
+
+BookLevel* BookSide::appendLevel(Price price) {
+    auto* level = level_pool_.acquire();
+    *level = BookLevel{};
+    level->price = price;
+
+    if (storage_ == BookStorage::ARRAY) {
+        bool created = false;
+        ladder_.insert(price, created) = level;
+    } else {
+        // Bids are kept ascending, so the worst bid goes in front
+        level->position = levels_.emplace_hint(side_ == Side::BUY ? levels_.begin() : levels_.end(), price, level);
+    }
+    depth_dirty_ = true;
+    return level;
+}
+
+void BookSide::erase(BookLevel* level) {
+    if (!depth_dirty_ && depthIndex(level->price) < depth_size_) {
+        depth_dirty_ = true;
+    }
+    if (storage_ == BookStorage::ARRAY) {
+        ladder_.erase(level->price);
+    } else {
+        levels_.erase(level->position);
+    }
+    level_pool_.release(level);
+}
+
+void BookSide::refreshDepth() {
+    if (depth_dirty_) {
+        depth_size_ = 0;
+        forEachLevel([this](const BookLevel& level) {
+            if (depth_size_ == depth_.size()) {
+                return false;
+            }
+            auto& entry = depth_[depth_size_++];
+            entry.price = level.price;
+            entry.total_quantity = level.total_quantity;
+            entry.order_count = static_cast<uint32_t>(level.order_count);
+            return true;
+        });
+        depth_dirty_ = false;
+        depth_sums_stale_ = true;
+    }
+    
+    if (depth_sums_stale_) {
+        Order::Quantity sum = 0;
+        for (size_t i = 0; i < depth_size_; ++i) {
+            sum += depth_[i].total_quantity;
+            depth_sums_[i] = sum;
+        }
+        depth_sums_stale_ = false;
+    }
+}
+
+Order::Quantity BookSide::depthQuantity(size_t levels) const {
+    if (levels <= depth_.size()) {
+        size_t count = std::min(levels, depth_size_);
+        return count > 0 ? depth_sums_[count - 1] : 0;
+    }
+    
+    Order::Quantity sum = 0;
+    size_t count = 0;
+    forEachLevel([&](const BookLevel& level) {
+        if (count++ >= levels) return false;
+        sum += level.total_quantity;
+        return true;
+    });
+    return sum;
+}
+
+bool BookSide::canFill(Price limit, Order::Quantity quantity, bool any_price) const {
+    if (total_quantity_ < quantity) {
+        return false;
+    }
+    if (any_price) {
+        return true;
+    }
+    
+    if (storage_ == BookStorage::ARRAY) {
+        auto available = side_ == Side::SELL ? ladder_.weightAtOrBelow(limit)
+                                             : ladder_.weightAtOrAbove(limit);
+        return available >= quantity;
+    }
+    
+    Order::Quantity available = 0;
+    forEachLevel([&](const BookLevel& level) {
+        if (!accepts(limit, level.price)) {
+            return false;
+        }
+        available += level.total_quantity;
+        return available < quantity;
+    });
+    return available >= quantity;
+}
+
+BookLevel* BookSide::best() {
+    if (storage_ == BookStorage::ARRAY) {
+        auto* slot = side_ == Side::BUY ? ladder_.highest() : ladder_.lowest();
+        return slot ? *slot : nullptr;
+    }
+    if (levels_.empty()) {
+        return nullptr;
+    }
+    return side_ == Side::BUY ? levels_.rbegin()->second : levels_.begin()->second;
+}
+
+void BookSide::clear() {
+    forEachLevel([this](BookLevel& level) {
+        level_pool_.release(&level);
+        return true;
+    });
+    if (storage_ == BookStorage::ARRAY) {
+        ladder_.clear();
+    } else {
+        levels_.clear();
+    }
+    total_quantity_ = 0;
+    depth_size_ = 0;
+    depth_dirty_ = false;
+    depth_sums_stale_ = false;
+}
+
+} // namespace orderbook
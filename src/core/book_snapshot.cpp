@@ -0,0 +1,71 @@
+#include "orderbook/book_snapshot.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace orderbook {
+
+namespace {
+
+std::runtime_error fileError(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+void writeBookSnapshot(const std::string& path, const OrderBook& book, uint64_t sequence) {
+    std::string data;
+    book.saveSnapshot(data, sequence);
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        throw fileError("Cannot create snapshot file", path);
+    }
+    bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        throw fileError("Cannot write snapshot file", path);
+    }
+}
+
+uint64_t readBookSnapshot(const std::string& path, OrderBook& book) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw fileError("Cannot open snapshot file", path);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw fileError("Cannot stat snapshot file", path);
+    }
+    size_t length = static_cast<size_t>(st.st_size);
+    if (length == 0) {
+        ::close(fd);
+        throw std::runtime_error("Not a book snapshot: " + path);
+    }
+
+    void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw fileError("Cannot map snapshot file", path);
+    }
+    ::madvise(mapping, length, MADV_SEQUENTIAL);
+
+    try {
+        uint64_t sequence = book.loadSnapshot(std::string_view(static_cast<const char*>(mapping), length));
+        ::munmap(mapping, length);
+        return sequence;
+    } catch (...) {
+        ::munmap(mapping, length);
+        throw;
+    }
+}
+
+} // namespace orderbook
@@ -0,0 +1,660 @@
+#include "orderbook/fix_parser.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ORDERBOOK_FIX_X86 1
+#define ORDERBOOK_TARGET(isa) __attribute__((target(isa)))
+#else
+#define ORDERBOOK_FIX_X86 0
+#define ORDERBOOK_TARGET(isa)
+#endif
+
+#define ORDERBOOK_ALWAYS_INLINE inline __attribute__((always_inline))
+
+namespace orderbook {
+
+namespace {
+
+constexpr size_t kNoSeparator = static_cast<size_t>(-1);
+
+bool parseTag(const char* p, size_t size, uint32_t& tag) {
+    if (size == 0 || size > 9) {
+        return false;
+    }
+    uint32_t value = 0;
+    for (size_t i = 0; i < size; ++i) {
+        unsigned digit = static_cast<unsigned char>(p[i]) - '0';
+        if (digit > 9) {
+            return false;
+        }
+        value = value * 10 + digit;
+    }
+    tag = value;
+    return true;
+}
+
+// The scalar scanner: one byte at a time, looking for the next '=' and then the next SOH
+size_t splitScalar(const char* data, size_t size, FixField* fields, size_t max_fields) {
+    size_t count = 0;
+    size_t start = 0;
+    size_t i = 0;
+    while (i < size && count < max_fields) {
+        size_t separator = kNoSeparator;
+        for (; i < size && data[i] != kFixSoh; ++i) {
+            if (data[i] == '=' && separator == kNoSeparator) {
+                separator = i;
+            }
+        }
+        if (i == size) {
+            break;
+        }
+        uint32_t tag;
+        if (separator != kNoSeparator && parseTag(data + start, separator - start, tag)) {
+            fields[count++] = FixField{tag, std::string_view(data + separator + 1, i - separator - 1)};
+        }
+        start = ++i;
+    }
+    return count;
+}
+
+// Positions of '=' and SOH in a 64-byte block, one bit per byte
+struct BlockMasks {
+    uint64_t equals;
+    uint64_t soh;
+};
+
+#if ORDERBOOK_FIX_X86
+
+ORDERBOOK_TARGET("sse2") inline BlockMasks masksSse2(const char* p) {
+    const __m128i equals = _mm_set1_epi8('=');
+    const __m128i soh = _mm_set1_epi8(kFixSoh);
+    BlockMasks masks{0, 0};
+    for (int i = 0; i < 4; ++i) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * 16));
+        masks.equals |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, equals)))) << (i * 16);
+        masks.soh |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, soh)))) << (i * 16);
+    }
+    return masks;
+}
+
+ORDERBOOK_TARGET("avx2") inline BlockMasks masksAvx2(const char* p) {
+    const __m256i equals = _mm256_set1_epi8('=');
+    const __m256i soh = _mm256_set1_epi8(kFixSoh);
+    __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+    BlockMasks masks;
+    masks.equals = uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, equals)))) |
+                   uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, equals)))) << 32;
+    masks.soh = uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, soh)))) |
+                uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, soh)))) << 32;
+    return masks;
+}
+
+// Walk the masks block by block; flattened into each target-specific caller below
+template <FixIsa kIsa>
+inline size_t splitBlocks(const char* data, size_t size, FixField* fields, size_t max_fields) {
+    size_t count = 0;
+    size_t start = 0;
+    size_t separator = kNoSeparator;
+    for (size_t base = 0; base < size; base += 64) {
+        alignas(64) char tail[64];
+        const char* p = data + base;
+        if (size - base < 64) {
+            std::memset(tail, 0, sizeof(tail));
+            std::memcpy(tail, p, size - base);
+            p = tail;
+        }
+        BlockMasks block;
+        if constexpr (kIsa == FixIsa::AVX2) {
+            block = masksAvx2(p);
+        } else {
+            block = masksSse2(p);
+        }
+
+        while (true) {
+            if (separator == kNoSeparator) {
+                uint64_t next = block.equals | block.soh;
+                if (next == 0) {
+                    break;
+                }
+                unsigned bit = static_cast<unsigned>(__builtin_ctzll(next));
+                uint64_t through = (uint64_t(2) << bit) - 1;
+                if (block.soh & (uint64_t(1) << bit)) {
+                    start = base + bit + 1;  // A field without '='
+                } else {
+                    separator = base + bit;
+                }
+                block.equals &= ~through;
+                block.soh &= ~through;
+            } else {
+                if (block.soh == 0) {
+                    break;
+                }
+                unsigned bit = static_cast<unsigned>(__builtin_ctzll(block.soh));
+                uint64_t through = (uint64_t(2) << bit) - 1;
+                size_t end = base + bit;
+                uint32_t tag;
+                if (parseTag(data + start, separator - start, tag)) {
+                    fields[count++] = FixField{tag, std::string_view(data + separator + 1, end - separator - 1)};
+                    if (count == max_fields) {
+                        return count;
+                    }
+                }
+                start = end + 1;
+                separator = kNoSeparator;
+                block.equals &= ~through;  // Any '=' in the value
+                block.soh &= ~through;
+            }
+        }
+    }
+    return count;
+}
+
+ORDERBOOK_TARGET("sse2") __attribute__((flatten))
+size_t splitSse2(const char* data, size_t size, FixField* fields, size_t max_fields) {
+    return splitBlocks<FixIsa::SSE2>(data, size, fields, max_fields);
+}
+
+ORDERBOOK_TARGET("avx2") __attribute__((flatten))
+size_t splitAvx2(const char* data, size_t size, FixField* fields, size_t max_fields) {
+    return splitBlocks<FixIsa::AVX2>(data, size, fields, max_fields);
+}
+
+// Byte sums with psadbw, 16 or 32 bytes per instruction
+ORDERBOOK_TARGET("sse2") uint64_t sumSse2(const char* data, size_t size) {
+    __m128i total = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        total = _mm_add_epi64(total, _mm_sad_epu8(chunk, _mm_setzero_si128()));
+    }
+    uint64_t sum = uint64_t(_mm_cvtsi128_si64(total)) + uint64_t(_mm_cvtsi128_si64(_mm_unpackhi_epi64(total, total)));
+    for (; i < size; ++i) {
+        sum += static_cast<unsigned char>(data[i]);
+    }
+    return sum;
+}
+
+ORDERBOOK_TARGET("avx2") uint64_t sumAvx2(const char* data, size_t size) {
+    __m256i total = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(chunk, _mm256_setzero_si256()));
+    }
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(total), _mm256_extracti128_si256(total, 1));
+    uint64_t sum = uint64_t(_mm_cvtsi128_si64(half)) + uint64_t(_mm_cvtsi128_si64(_mm_unpackhi_epi64(half, half)));
+    for (; i < size; ++i) {
+        sum += static_cast<unsigned char>(data[i]);
+    }
+    return sum;
+}
+
+#endif
+
+// Eight ASCII digits at once (little-endian): check, then combine pairs, quads and halves
+ORDERBOOK_ALWAYS_INLINE bool eightDigits(const char* p, uint32_t& value) {
+    uint64_t chunk;
+    std::memcpy(&chunk, p, 8);
+    if (((chunk & 0xF0F0F0F0F0F0F0F0) | (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) !=
+        0x3333333333333333) {
+        return false;
+    }
+    chunk -= 0x3030303030303030;
+    chunk = chunk * 10 + (chunk >> 8);
+    chunk = (((chunk & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) +
+             (((chunk >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >> 32;
+    value = static_cast<uint32_t>(chunk);
+    return true;
+}
+
+// Up to 19 digits
+ORDERBOOK_ALWAYS_INLINE bool parseDigits(const char* p, size_t size, uint64_t& result) {
+    if (size == 0 || size > 19) {
+        return false;
+    }
+    uint64_t value = 0;
+    size_t i = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    for (; i + 8 <= size; i += 8) {
+        uint32_t eight;
+        if (!eightDigits(p + i, eight)) {
+            return false;
+        }
+        value = value * 100000000 + eight;
+    }
+#endif
+    for (; i < size; ++i) {
+        unsigned digit = static_cast<unsigned char>(p[i]) - '0';
+        if (digit > 9) {
+            return false;
+        }
+        value = value * 10 + digit;
+    }
+    result = value;
+    return true;
+}
+
+constexpr int64_t kPowers[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+// Howard Hinnant's days_from_civil and civil_from_days
+int64_t daysFromCivil(int64_t year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    unsigned year_of_era = static_cast<unsigned>(year - era * 400);
+    unsigned day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    unsigned day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + static_cast<int64_t>(day_of_era) - 719468;
+}
+
+void civilFromDays(int64_t days, int64_t& year, unsigned& month, unsigned& day) {
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned day_of_era = static_cast<unsigned>(days - era * 146097);
+    unsigned year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    unsigned day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    unsigned mp = (5 * day_of_year + 2) / 153;
+    day = day_of_year - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = static_cast<int64_t>(year_of_era) + era * 400 + (month <= 2);
+}
+
+void appendInteger(std::string& out, uint64_t value) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+void appendPrice(std::string& out, int64_t price, int decimals) {
+    if (price < 0) {
+        out += '-';
+        price = -price;
+    }
+    if (decimals == 0) {
+        appendInteger(out, static_cast<uint64_t>(price));
+        return;
+    }
+    int64_t scale = kPowers[decimals];
+    appendInteger(out, static_cast<uint64_t>(price / scale));
+    out += '.';
+    char fraction[16];
+    int64_t rest = price % scale;
+    for (int i = decimals - 1; i >= 0; --i) {
+        fraction[i] = static_cast<char>('0' + rest % 10);
+        rest /= 10;
+    }
+    out.append(fraction, static_cast<size_t>(decimals));
+}
+
+void appendField(std::string& out, uint32_t tag, std::string_view value) {
+    appendInteger(out, tag);
+    out += '=';
+    out.append(value);
+    out += kFixSoh;
+}
+
+void appendField(std::string& out, uint32_t tag, uint64_t value) {
+    appendInteger(out, tag);
+    out += '=';
+    appendInteger(out, value);
+    out += kFixSoh;
+}
+
+} // namespace
+
+FixIsa bestFixIsa() {
+#if ORDERBOOK_FIX_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return FixIsa::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return FixIsa::SSE2;
+    }
+#endif
+    return FixIsa::SCALAR;
+}
+
+const char* fixIsaName(FixIsa isa) {
+    switch (isa) {
+        case FixIsa::AVX2: return "avx2";
+        case FixIsa::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+size_t splitFixFields(const char* data, size_t size, FixField* fields, size_t max_fields, FixIsa isa) {
+    if (max_fields == 0) {
+        return 0;
+    }
+#if ORDERBOOK_FIX_X86
+    if (isa == FixIsa::AVX2) {
+        return splitAvx2(data, size, fields, max_fields);
+    }
+    if (isa == FixIsa::SSE2) {
+        return splitSse2(data, size, fields, max_fields);
+    }
+#endif
+    return splitScalar(data, size, fields, max_fields);
+}
+
+bool parseFixUnsigned(std::string_view value, uint64_t& result) {
+    return parseDigits(value.data(), value.size(), result);
+}
+
+bool parseFixPrice(std::string_view value, int decimals, int64_t& result) {
+    if (decimals < 0 || decimals > 9) {
+        return false;
+    }
+    bool negative = !value.empty() && value.front() == '-';
+    if (negative) {
+        value.remove_prefix(1);
+    }
+    auto dot = value.find('.');
+    std::string_view whole = value.substr(0, dot);
+    std::string_view fraction = dot == std::string_view::npos ? std::string_view() : value.substr(dot + 1);
+
+    uint64_t whole_value = 0;
+    if (!(whole.empty() && !fraction.empty()) && (whole.size() > 18 || !parseDigits(whole.data(), whole.size(), whole_value))) {
+        return false;
+    }
+    if (dot != std::string_view::npos && fraction.empty() && whole.empty()) {
+        return false;
+    }
+
+    // The first decimals digits of the fraction count; the rest must still be digits
+    uint64_t fraction_value = 0;
+    size_t kept = std::min(fraction.size(), static_cast<size_t>(decimals));
+    if (kept > 0 && !parseDigits(fraction.data(), kept, fraction_value)) {
+        return false;
+    }
+    for (size_t i = kept; i < fraction.size(); ++i) {
+        if (static_cast<unsigned>(static_cast<unsigned char>(fraction[i]) - '0') > 9) {
+            return false;
+        }
+    }
+
+    // Eighteen whole digits still overflow once scaled
+    int64_t scaled = 0;
+    if (__builtin_mul_overflow(static_cast<int64_t>(whole_value), kPowers[decimals], &scaled) ||
+        __builtin_add_overflow(scaled, static_cast<int64_t>(fraction_value) * kPowers[decimals - kept], &scaled)) {
+        return false;
+    }
+    result = negative ? -scaled : scaled;
+    return true;
+}
+
+bool parseFixTime(std::string_view value, int64_t& nanoseconds) {
+    // YYYYMMDD-HH:MM:SS
+    if (value.size() < 17 || value[8] != '-' || value[11] != ':' || value[14] != ':') {
+        return false;
+    }
+    uint64_t date, hours, minutes, seconds;
+    if (!parseDigits(value.data(), 8, date) || !parseDigits(value.data() + 9, 2, hours) ||
+        !parseDigits(value.data() + 12, 2, minutes) || !parseDigits(value.data() + 15, 2, seconds)) {
+        return false;
+    }
+    uint64_t fraction = 0;
+    size_t places = 0;
+    if (value.size() > 17) {
+        if (value[17] != '.') {
+            return false;
+        }
+        places = std::min<size_t>(value.size() - 18, 9);
+        if (places == 0 || !parseDigits(value.data() + 18, places, fraction)) {
+            return false;
+        }
+    }
+    if (hours > 23 || minutes > 59 || seconds > 60) {
+        return false;
+    }
+
+    // Timestamps in a stream share their date, so its day number is kept
+    static thread_local uint64_t last_date = 0;
+    static thread_local int64_t last_days = 0;
+    if (date != last_date) {
+        unsigned month = static_cast<unsigned>(date / 100 % 100);
+        unsigned day = static_cast<unsigned>(date % 100);
+        if (month < 1 || month > 12 || day < 1 || day > 31) {
+            return false;
+        }
+        last_days = daysFromCivil(static_cast<int64_t>(date / 10000), month, day);
+        last_date = date;
+    }
+    int64_t days = last_days;
+    int64_t total = days * 86400 + static_cast<int64_t>(hours * 3600 + minutes * 60 + seconds);
+    nanoseconds = total * 1000000000 + static_cast<int64_t>(fraction) * kPowers[9 - places];
+    return true;
+}
+
+std::string formatFixTime(int64_t nanoseconds) {
+    int64_t seconds = nanoseconds / 1000000000;
+    int64_t fraction = nanoseconds % 1000000000;
+    if (fraction < 0) {
+        fraction += 1000000000;
+        --seconds;
+    }
+    int64_t days = seconds / 86400;
+    int64_t of_day = seconds % 86400;
+    if (of_day < 0) {
+        of_day += 86400;
+        --days;
+    }
+    int64_t year;
+    unsigned month, day;
+    civilFromDays(days, year, month, day);
+
+    char buffer[48];
+    std::snprintf(buffer, sizeof(buffer), "%04lld%02u%02u-%02lld:%02lld:%02lld.%09lld", static_cast<long long>(year),
+                  month, day, static_cast<long long>(of_day / 3600), static_cast<long long>(of_day / 60 % 60),
+                  static_cast<long long>(of_day % 60), static_cast<long long>(fraction));
+    return buffer;
+}
+
+uint8_t fixChecksum(const char* data, size_t size, FixIsa isa) {
+    uint64_t sum = 0;
+#if ORDERBOOK_FIX_X86
+    if (isa == FixIsa::AVX2) {
+        return static_cast<uint8_t>(sumAvx2(data, size));
+    }
+    if (isa == FixIsa::SSE2) {
+        return static_cast<uint8_t>(sumSse2(data, size));
+    }
+#endif
+    (void)isa;
+    for (size_t i = 0; i < size; ++i) {
+        sum += static_cast<unsigned char>(data[i]);
+    }
+    return static_cast<uint8_t>(sum);
+}
+
+size_t fixMessageLength(std::string_view data) {
+    constexpr size_t kMaxHeader = 64;  // "8=FIX.x.y" and "9=n" are short
+    if (data.size() < 2) {
+        return 0;
+    }
+    if (data[0] != '8' || data[1] != '=') {
+        return kFixMalformed;
+    }
+    auto begin_end = data.find(kFixSoh);
+    if (begin_end == std::string_view::npos) {
+        return data.size() > kMaxHeader ? kFixMalformed : 0;
+    }
+    size_t length_start = begin_end + 1;
+    if (data.size() < length_start + 2) {
+        return 0;
+    }
+    if (data[length_start] != '9' || data[length_start + 1] != '=') {
+        return kFixMalformed;
+    }
+    auto length_end = data.find(kFixSoh, length_start);
+    if (length_end == std::string_view::npos) {
+        return data.size() > kMaxHeader ? kFixMalformed : 0;
+    }
+    uint64_t body_length;
+    if (!parseDigits(data.data() + length_start + 2, length_end - length_start - 2, body_length) ||
+        body_length > (64 << 20)) {
+        return kFixMalformed;
+    }
+
+    size_t body_end = length_end + 1 + static_cast<size_t>(body_length);
+    size_t total = body_end + 7;  // "10=nnn" SOH
+    if (data.size() < total) {
+        return 0;
+    }
+    if (data.compare(body_end, 3, "10=") != 0 || data[total - 1] != kFixSoh) {
+        return kFixMalformed;
+    }
+    return total;
+}
+
+bool checkFixChecksum(std::string_view message, FixIsa isa) {
+    if (message.size() < 7) {
+        return false;
+    }
+    uint64_t expected;
+    if (!parseDigits(message.data() + message.size() - 4, 3, expected)) {
+        return false;
+    }
+    return fixChecksum(message.data(), message.size() - 7, isa) == expected;
+}
+
+FixDecoder::FixDecoder(int price_decimals, FixIsa isa)
+    : price_decimals_(price_decimals), isa_(isa), fields_(64) {}
+
+size_t FixDecoder::split(std::string_view message) {
+    while (true) {
+        size_t count = splitFixFields(message.data(), message.size(), fields_.data(), fields_.size(), isa_);
+        if (count < fields_.size()) {
+            return count;
+        }
+        fields_.resize(fields_.size() * 2);
+    }
+}
+
+int FixDecoder::toEvent(const Entry& entry, MarketDataEvent& event) {
+    const MarketDataEvent::Timestamp none(0);
+    if (entry.type == '2') {
+        if (entry.size <= 0) {
+            return -1;
+        }
+        event = MarketDataEvent::tradePrint(entry.symbol, entry.trade_id ? entry.trade_id : entry.id, entry.price,
+                                            static_cast<Order::Quantity>(entry.size), 0, 0, none);
+        return 1;
+    }
+    if (entry.type != 0 && entry.type != '0' && entry.type != '1') {
+        return 0;  // Not a book entry (opening price, imbalance, ...)
+    }
+    if (entry.id == 0) {
+        return -1;
+    }
+    switch (entry.action) {
+        case '0':
+            if (entry.type == 0 || entry.size <= 0) {
+                return -1;
+            }
+            event = MarketDataEvent::orderAdd(entry.symbol, entry.id, entry.price,
+                                              static_cast<Order::Quantity>(entry.size),
+                                              entry.type == '0' ? Side::BUY : Side::SELL, OrderType::LIMIT, none);
+            return 1;
+        case '1':
+            if (entry.size <= 0) {
+                return -1;
+            }
+            event = MarketDataEvent::orderModify(entry.symbol, entry.id, entry.price,
+                                                 static_cast<Order::Quantity>(entry.size), none);
+            return 1;
+        case '2':
+            event = MarketDataEvent::orderCancel(entry.symbol, entry.id, none);
+            return 1;
+        default:
+            return -1;
+    }
+}
+
+void appendFixMessage(std::string& out, std::string_view msg_type, std::string_view body,
+                      std::string_view begin_string) {
+    size_t start = out.size();
+    out += "8=";
+    out.append(begin_string);
+    out += kFixSoh;
+    out += "9=";
+    appendInteger(out, 3 + msg_type.size() + 1 + body.size());
+    out += kFixSoh;
+    out += "35=";
+    out.append(msg_type);
+    out += kFixSoh;
+    out.append(body);
+
+    unsigned checksum = fixChecksum(out.data() + start, out.size() - start, FixIsa::SCALAR);
+    char trailer[8] = {'1', '0', '=', static_cast<char>('0' + checksum / 100),
+                       static_cast<char>('0' + checksum / 10 % 10), static_cast<char>('0' + checksum % 10), kFixSoh};
+    out.append(trailer, 7);
+}
+
+void appendFixIncrementalRefresh(std::string& out, const MarketDataEvent* events, size_t count,
+                                 uint64_t seq_num, int price_decimals) {
+    std::string body;
+    appendField(body, 34, seq_num);
+    size_t entries = 0;
+    for (size_t i = 0; i < count; ++i) {
+        auto type = events[i].type;
+        entries += type == MarketDataEvent::Type::ORDER_ADD || type == MarketDataEvent::Type::ORDER_MODIFY ||
+                   type == MarketDataEvent::Type::ORDER_CANCEL || type == MarketDataEvent::Type::TRADE;
+    }
+    appendField(body, 268, entries);
+
+    std::string price;
+    for (size_t i = 0; i < count; ++i) {
+        const auto& event = events[i];
+        const auto& symbol = SymbolRegistry::instance().name(event.symbol_id);
+        auto appendPriceField = [&](uint32_t tag, int64_t value) {
+            price.clear();
+            appendPrice(price, value, price_decimals);
+            appendField(body, tag, price);
+        };
+        switch (event.type) {
+            case MarketDataEvent::Type::ORDER_ADD:
+                appendField(body, 279, "0");
+                appendField(body, 269, event.add.side == Side::BUY ? "0" : "1");
+                appendField(body, 278, event.add.order_id);
+                appendField(body, 55, symbol);
+                appendPriceField(270, event.add.price);
+                appendField(body, 271, event.add.quantity);
+                break;
+            case MarketDataEvent::Type::ORDER_MODIFY:
+                appendField(body, 279, "1");
+                appendField(body, 278, event.modify.order_id);
+                appendField(body, 55, symbol);
+                appendPriceField(270, event.modify.price);
+                appendField(body, 271, event.modify.quantity);
+                break;
+            case MarketDataEvent::Type::ORDER_CANCEL:
+                appendField(body, 279, "2");
+                appendField(body, 278, event.cancel.order_id);
+                appendField(body, 55, symbol);
+                break;
+            case MarketDataEvent::Type::TRADE:
+                appendField(body, 279, "0");
+                appendField(body, 269, "2");
+                appendField(body, 55, symbol);
+                appendPriceField(270, event.trade.price);
+                appendField(body, 271, event.trade.quantity);
+                appendField(body, 1003, event.trade.trade_id);
+                break;
+            default:
+                continue;
+        }
+        if (event.sequence != 0) {
+            appendField(body, 83, event.sequence);
+        }
+        appendField(body, 60, formatFixTime(event.timestamp.count()));
+    }
+    appendFixMessage(out, "X", body);
+}
+
+} // namespace orderbook
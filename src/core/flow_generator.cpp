@@ -0,0 +1,392 @@
+#include "orderbook/flow_generator.h"
+#include "orderbook/market_data_file.h"
+#include "orderbook/symbol_registry.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+namespace orderbook {
+
+namespace {
+
+// Events made at a time by writeFile
+constexpr size_t kWriteBatch = 4096;
+
+// Resting orders an execute looks at to find one near the touch
+constexpr int kExecuteSamples = 4;
+
+// Largest size distribution drawn from a table; wider ones are drawn with pow()
+constexpr size_t kMaxSizeTable = 65536;
+
+uint64_t splitmix(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+void require(bool condition, const char* message) {
+    if (!condition) {
+        throw std::invalid_argument(std::string("OrderFlowConfig: ") + message);
+    }
+}
+
+} // namespace
+
+OrderFlowGenerator::Random::Random(uint64_t seed) {
+    for (auto& word : s_) {
+        word = splitmix(seed);
+    }
+}
+
+OrderFlowGenerator::AliasTable::AliasTable(const std::vector<double>& weights)
+    : probability_(weights.size()), alias_(weights.size()) {
+    size_t n = weights.size();
+    double total = 0;
+    for (double weight : weights) {
+        total += weight;
+    }
+    std::vector<double> scaled(n);
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (size_t i = 0; i < n; ++i) {
+        scaled[i] = weights[i] * static_cast<double>(n) / total;
+        (scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+    }
+    // Each short column is topped up from a tall one, which may become short in turn
+    while (!small.empty() && !large.empty()) {
+        uint32_t below = small.back();
+        small.pop_back();
+        uint32_t above = large.back();
+        probability_[below] = scaled[below];
+        alias_[below] = above;
+        scaled[above] -= 1.0 - scaled[below];
+        if (scaled[above] < 1.0) {
+            large.pop_back();
+            small.push_back(above);
+        }
+    }
+    // What is left is full, up to rounding
+    for (auto* rest : {&small, &large}) {
+        for (uint32_t i : *rest) {
+            probability_[i] = 1.0;
+            alias_[i] = i;
+        }
+    }
+}
+
+OrderFlowGenerator::OrderFlowGenerator(const OrderFlowConfig& config) : config_(config), random_(config.seed) {
+    size_t symbols = config_.symbol_names.empty() ? config_.symbols : config_.symbol_names.size();
+    require(symbols > 0, "no symbols");
+    require(config_.base_rate > 0, "base_rate must be positive");
+    require(config_.branching_ratio >= 0 && config_.branching_ratio < 1, "branching_ratio must be in [0, 1)");
+    require(config_.decay_rate > 0, "decay_rate must be positive");
+    require(config_.symbol_skew >= 0, "symbol_skew must not be negative");
+    require(config_.add_weight > 0 && config_.cancel_weight >= 0 && config_.modify_weight >= 0 &&
+            config_.execute_weight >= 0, "event weights must not be negative, and adds must be possible");
+    require(config_.tick_size > 0 && config_.start_price % config_.tick_size == 0,
+            "start_price must be a multiple of a positive tick_size");
+    require(config_.start_price > config_.tick_size * static_cast<Order::Price>(config_.max_distance + 1),
+            "start_price leaves no room for bids max_distance behind the touch");
+    require(config_.touch_weight > 0 && config_.touch_weight <= 1, "touch_weight must be in (0, 1]");
+    require(config_.max_distance < 65536, "max_distance must be below 65536");
+    require(config_.size_alpha > 0, "size_alpha must be positive");
+    require(config_.lot_size > 0 && config_.min_size >= config_.lot_size && config_.max_size >= config_.min_size,
+            "sizes must satisfy 0 < lot_size <= min_size <= max_size");
+    require(config_.target_orders_per_symbol > 0, "target_orders_per_symbol must be positive");
+    for (const auto& name : config_.symbol_names) {
+        require(!name.empty() && name.size() <= MarketDataEvent::SymbolName::kMaxLength,
+                "symbol names must be 1 to 40 characters (the length a SYMBOL record holds)");
+    }
+
+    symbol_ids_.reserve(symbols);
+    for (size_t i = 0; i < symbols; ++i) {
+        if (config_.symbol_names.empty()) {
+            char name[32];
+            std::snprintf(name, sizeof(name), "SYM%04zu", i);
+            symbol_ids_.push_back(SymbolRegistry::instance().intern(name));
+        } else {
+            symbol_ids_.push_back(SymbolRegistry::instance().intern(config_.symbol_names[i]));
+        }
+    }
+    states_.resize(symbols);
+    for (auto& state : states_) {
+        state.mid = config_.start_price;
+    }
+
+    std::vector<double> weights(symbols);
+    for (size_t i = 0; i < symbols; ++i) {
+        weights[i] = std::pow(static_cast<double>(i + 1), -config_.symbol_skew);
+    }
+    base_symbols_ = AliasTable(weights);
+    mean_base_wait_ = 1.0 / config_.base_rate;
+    mean_delay_ = 1.0 / config_.decay_rate;
+    no_children_ = std::exp(-config_.branching_ratio);
+    next_base_time_ = std::log(random_.positive()) * -mean_base_wait_;
+
+    cancel_per_order_ = config_.cancel_weight / static_cast<double>(config_.target_orders_per_symbol);
+
+    // Geometric distances, with the tail past max_distance placed at it
+    weights.assign(config_.max_distance + 1, 0.0);
+    double further = 1.0;
+    for (size_t d = 0; d < config_.max_distance; ++d) {
+        weights[d] = further * config_.touch_weight;
+        further *= 1.0 - config_.touch_weight;
+    }
+    weights[config_.max_distance] = further;
+    distances_ = AliasTable(weights);
+
+    // Pareto sizes rounded down to lots, with the tail past max_size placed at it
+    size_exponent_ = -1.0 / config_.size_alpha;
+    min_lots_ = config_.min_size / config_.lot_size;
+    Order::Quantity max_lots = config_.max_size / config_.lot_size;
+    if (max_lots - min_lots_ < kMaxSizeTable) {
+        auto below = [this](double size) {
+            return size <= static_cast<double>(config_.min_size)
+                       ? 0.0 : 1.0 - std::pow(static_cast<double>(config_.min_size) / size, config_.size_alpha);
+        };
+        weights.assign(max_lots - min_lots_ + 1, 0.0);
+        for (Order::Quantity lots = min_lots_; lots <= max_lots; ++lots) {
+            double from = below(static_cast<double>(lots * config_.lot_size));
+            double to = lots == max_lots ? 1.0 : below(static_cast<double>((lots + 1) * config_.lot_size));
+            weights[lots - min_lots_] = to - from;
+        }
+        lots_ = AliasTable(weights);
+    }
+}
+
+void OrderFlowGenerator::generate(MarketDataEvent* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = next();
+    }
+}
+
+std::vector<MarketDataEvent> OrderFlowGenerator::symbolRecords() const {
+    std::vector<MarketDataEvent> records;
+    records.reserve(symbol_ids_.size());
+    for (auto symbol_id : symbol_ids_) {
+        records.push_back(MarketDataEvent::symbolName(symbol_id, SymbolRegistry::instance().name(symbol_id)));
+        records.back().sequence = records.size();
+        records.back().timestamp = config_.start_time;
+    }
+    return records;
+}
+
+void OrderFlowGenerator::writeFile(const std::string& path, size_t count) {
+    EventFileWriter writer(path);
+    auto records = symbolRecords();
+    writer.write(records.data(), records.size());
+
+    std::vector<MarketDataEvent> batch(kWriteBatch);
+    for (size_t written = 0; written < count;) {
+        size_t n = std::min(kWriteBatch, count - written);
+        generate(batch.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            batch[i].sequence += records.size();
+        }
+        writer.write(batch.data(), n);
+        written += n;
+    }
+    writer.close();
+}
+
+void OrderFlowGenerator::step() {
+    pending_.clear();
+    pending_head_ = 0;
+
+    bool triggered = false;
+    size_t symbol = arrive(triggered);
+    stats_.triggered += triggered;
+    auto timestamp = config_.start_time + MarketDataEvent::Timestamp(static_cast<int64_t>(time_ * 1e9 + 0.5));
+
+    if (random_.uniform() < config_.price_move) {
+        movePrice(symbol, timestamp);
+    }
+
+    // Cancels in proportion to the resting orders, which keeps each book near its target size
+    auto& state = states_[symbol];
+    size_t resting = state.bids.size() + state.asks.size();
+    double cancel_weight = cancel_per_order_ * static_cast<double>(resting);
+    double roll = random_.uniform() *
+                  (config_.add_weight + cancel_weight + config_.modify_weight + config_.execute_weight);
+    if (resting == 0 || roll < config_.add_weight) {
+        add(symbol, timestamp);
+    } else if ((roll -= config_.add_weight) < cancel_weight) {
+        cancel(symbol, timestamp);
+    } else if (roll - cancel_weight < config_.modify_weight) {
+        modify(symbol, timestamp);
+    } else {
+        execute(symbol, timestamp);
+    }
+}
+
+// Takes the earlier of the next base arrival and the next triggered one.
+// Every event triggers a Poisson(branching_ratio) number of events on its
+// symbol, each after an exponential delay: the cluster form of a Hawkes
+// process with an exponential kernel, which it reproduces exactly.
+size_t OrderFlowGenerator::arrive(bool& triggered) {
+    size_t symbol;
+    triggered = !children_.empty() && children_.top().time < next_base_time_;
+    if (triggered) {
+        time_ = children_.top().time;
+        symbol = children_.top().symbol;
+        children_.pop();
+    } else {
+        time_ = next_base_time_;
+        symbol = base_symbols_.sample(random_);
+        next_base_time_ += std::log(random_.positive()) * -mean_base_wait_;
+    }
+
+    // Inverse transform of the Poisson distribution; the mean is below one, so this takes a step or two
+    double u = random_.uniform();
+    double probability = no_children_;
+    double cumulative = probability;
+    for (uint32_t k = 1; u > cumulative && probability > 0; ++k) {
+        children_.push({time_ + std::log(random_.positive()) * -mean_delay_, static_cast<uint32_t>(symbol)});
+        probability *= config_.branching_ratio / k;
+        cumulative += probability;
+    }
+    return symbol;
+}
+
+// Moves the mid a tick, first executing the orders the new touch would cross
+void OrderFlowGenerator::movePrice(size_t symbol, MarketDataEvent::Timestamp timestamp) {
+    auto& state = states_[symbol];
+    Order::Price tick = config_.tick_size;
+    bool up = random_.uniform() < 0.5;
+    if (!up && state.mid - 2 * tick <= tick * static_cast<Order::Price>(config_.max_distance)) {
+        up = true;  // Keep bids placed max_distance behind the touch above zero
+    }
+    state.mid += up ? tick : -tick;
+    ++stats_.price_moves;
+
+    // Bids must stay below mid, asks above it
+    auto& crossed = up ? state.asks : state.bids;
+    for (size_t i = 0; i < crossed.size();) {
+        bool through = up ? crossed[i].price <= state.mid : crossed[i].price >= state.mid;
+        if (through) {
+            emit(MarketDataEvent::orderExecute(symbol_ids_[symbol], crossed[i].id, crossed[i].quantity,
+                                               next_trade_id_++, timestamp));
+            ++stats_.executes;
+            --stats_.live_orders;
+            crossed[i] = crossed.back();
+            crossed.pop_back();
+        } else {
+            ++i;
+        }
+    }
+}
+
+void OrderFlowGenerator::add(size_t symbol, MarketDataEvent::Timestamp timestamp) {
+    auto& state = states_[symbol];
+    auto side = random_.uniform() < 0.5 ? Side::BUY : Side::SELL;
+    auto quantity = drawSize();
+    auto id = next_order_id_++;
+    ++stats_.adds;
+
+    if (config_.marketable_fraction > 0 && random_.uniform() < config_.marketable_fraction) {
+        // Priced at the far touch, so it takes what rests there and cancels the rest
+        Order::Price price = side == Side::BUY ? state.mid + config_.tick_size : state.mid - config_.tick_size;
+        emit(MarketDataEvent::orderAdd(symbol_ids_[symbol], id, price, quantity, side, OrderType::IOC, timestamp));
+        ++stats_.marketable_adds;
+        return;
+    }
+
+    Order::Price price = placePrice(state, side);
+    (side == Side::BUY ? state.bids : state.asks).push_back({id, price, quantity});
+    emit(MarketDataEvent::orderAdd(symbol_ids_[symbol], id, price, quantity, side, OrderType::LIMIT, timestamp));
+    ++stats_.live_orders;
+}
+
+void OrderFlowGenerator::cancel(size_t symbol, MarketDataEvent::Timestamp timestamp) {
+    auto& state = states_[symbol];
+    Side side;
+    size_t index;
+    auto& order = pickOrder(state, side, index);
+    emit(MarketDataEvent::orderCancel(symbol_ids_[symbol], order.id, timestamp));
+    auto& orders = side == Side::BUY ? state.bids : state.asks;
+    orders[index] = orders.back();
+    orders.pop_back();
+    ++stats_.cancels;
+    --stats_.live_orders;
+}
+
+void OrderFlowGenerator::modify(size_t symbol, MarketDataEvent::Timestamp timestamp) {
+    auto& state = states_[symbol];
+    Side side;
+    size_t index;
+    auto& order = pickOrder(state, side, index);
+    if (random_.uniform() < config_.price_change_fraction) {
+        order.price = placePrice(state, side);
+    } else {
+        order.quantity = drawSize();
+    }
+    emit(MarketDataEvent::orderModify(symbol_ids_[symbol], order.id, order.price, order.quantity, timestamp));
+    ++stats_.modifies;
+}
+
+void OrderFlowGenerator::execute(size_t symbol, MarketDataEvent::Timestamp timestamp) {
+    auto& state = states_[symbol];
+    Side side;
+    size_t index;
+    pickOrder(state, side, index);
+    auto& orders = side == Side::BUY ? state.bids : state.asks;
+    for (int i = 1; i < kExecuteSamples; ++i) {
+        size_t other = random_.below(orders.size());
+        bool better = side == Side::BUY ? orders[other].price > orders[index].price
+                                        : orders[other].price < orders[index].price;
+        if (better) {
+            index = other;
+        }
+    }
+
+    auto& order = orders[index];
+    auto quantity = std::min(order.quantity, drawSize());
+    emit(MarketDataEvent::orderExecute(symbol_ids_[symbol], order.id, quantity, next_trade_id_++, timestamp));
+    ++stats_.executes;
+    order.quantity -= quantity;
+    if (order.quantity == 0) {
+        orders[index] = orders.back();
+        orders.pop_back();
+        --stats_.live_orders;
+    }
+}
+
+void OrderFlowGenerator::emit(MarketDataEvent event) {
+    event.sequence = ++sequence_;
+    pending_.push_back(event);
+    ++stats_.events;
+}
+
+Order::Price OrderFlowGenerator::placePrice(const SymbolState& state, Side side) {
+    auto distance = static_cast<Order::Price>(distances_.sample(random_));
+    Order::Price offset = config_.tick_size * (1 + distance);
+    return side == Side::BUY ? state.mid - offset : state.mid + offset;
+}
+
+Order::Quantity OrderFlowGenerator::drawSize() {
+    if (!lots_.empty()) {
+        return (min_lots_ + lots_.sample(random_)) * config_.lot_size;
+    }
+    double size = static_cast<double>(config_.min_size) * std::pow(random_.positive(), size_exponent_);
+    if (!(size < static_cast<double>(config_.max_size))) {
+        size = static_cast<double>(config_.max_size);
+    }
+    auto quantity = static_cast<Order::Quantity>(size);
+    return quantity - quantity % config_.lot_size;
+}
+
+OrderFlowGenerator::LiveOrder& OrderFlowGenerator::pickOrder(SymbolState& state, Side& side, size_t& index) {
+    size_t pick = random_.below(state.bids.size() + state.asks.size());
+    if (pick < state.bids.size()) {
+        side = Side::BUY;
+        index = pick;
+        return state.bids[pick];
+    }
+    side = Side::SELL;
+    index = pick - state.bids.size();
+    return state.asks[index];
+}
+
+} // namespace orderbook
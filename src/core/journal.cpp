@@ -0,0 +1,298 @@
+#include "orderbook/journal.h"
+#include "orderbook/market_data_handler.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace orderbook {
+
+namespace {
+
+// Records the writer takes from the queue at a time
+constexpr size_t kJournalBatch = 1024;
+
+EventFileHeader journalHeader(uint64_t count) {
+    EventFileHeader header{};
+    std::memcpy(header.magic, EventFileHeader::kMagic, sizeof(header.magic));
+    header.version = EventFileHeader::kVersion;
+    header.record_size = sizeof(MarketDataEvent);
+    header.record_count = count;
+    return header;
+}
+
+bool writeAt(int fd, const void* data, size_t size, uint64_t offset) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t n = ::pwrite(fd, bytes, size, static_cast<off_t>(offset));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+// Reserve file space; filesystems that cannot are left to allocate as written
+bool reserve(int fd, uint64_t from, uint64_t to) {
+    int result = ::posix_fallocate(fd, static_cast<off_t>(from), static_cast<off_t>(to - from));
+    return result == 0 || result == EOPNOTSUPP || result == EINVAL;
+}
+
+bool sameTrade(const MarketDataEvent& recorded, SymbolId symbol_id, const Trade& made) {
+    const auto& trade = recorded.trade;
+    bool parties = (trade.buy_order_id == made.getMakerOrderId() && trade.sell_order_id == made.getTakerOrderId()) ||
+                   (trade.buy_order_id == made.getTakerOrderId() && trade.sell_order_id == made.getMakerOrderId());
+    return parties && trade.trade_id == made.getId() && trade.price == made.getPrice() &&
+           trade.quantity == made.getQuantity() && symbol_id == made.getSymbolId();
+}
+
+} // namespace
+
+BookJournal::BookJournal(const std::string& path, const JournalConfig& config)
+    : path_(path), config_(config), queue_(config.queue_capacity) {
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Cannot create journal " + path + ": " + std::strerror(errno));
+    }
+
+    auto header = journalHeader(0);
+    reserved_bytes_ = sizeof(header) + config_.preallocate;
+    if (!writeAt(fd_, &header, sizeof(header), 0) || !reserve(fd_, 0, reserved_bytes_)) {
+        std::string error = std::strerror(errno);
+        ::close(fd_);
+        throw std::runtime_error("Cannot reserve journal " + path + ": " + error);
+    }
+    writer_ = std::thread(&BookJournal::run, this);
+}
+
+BookJournal::~BookJournal() {
+    try {
+        close();
+    } catch (...) {
+        // Destructors must not throw; the records that were written are kept
+    }
+}
+
+void BookJournal::waitToPush(const MarketDataEvent& event) {
+    full_waits_.store(full_waits_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    while (!queue_.tryPush(event)) {
+        std::this_thread::yield();
+    }
+}
+
+void BookJournal::flush() {
+    uint64_t target = sequence_.load(std::memory_order_relaxed);
+    flush_target_.store(target, std::memory_order_release);
+    std::unique_lock<std::mutex> lock(flush_mutex_);
+    flushed_.wait(lock, [&] {
+        return durable_.load(std::memory_order_acquire) >= target || failed_.load(std::memory_order_acquire);
+    });
+    if (failed_.load(std::memory_order_acquire)) {
+        throw std::runtime_error(error_);
+    }
+}
+
+void BookJournal::close() {
+    if (closed_) {
+        return;
+    }
+    closed_ = true;
+    running_.store(false, std::memory_order_release);
+    writer_.join();
+
+    bool failed = failed_.load(std::memory_order_acquire);
+    if (!failed) {
+        uint64_t count = written_.load(std::memory_order_relaxed);
+        auto header = journalHeader(count);
+        failed = ::ftruncate(fd_, static_cast<off_t>(sizeof(header) + count * sizeof(MarketDataEvent))) != 0 ||
+                 !writeAt(fd_, &header, sizeof(header), 0) || ::fdatasync(fd_) != 0;
+        if (failed) {
+            error_ = "Cannot finish journal " + path_ + ": " + std::strerror(errno);
+        }
+    }
+    ::close(fd_);
+    fd_ = -1;
+    if (failed) {
+        throw std::runtime_error(error_);
+    }
+}
+
+JournalStats BookJournal::getStats() const {
+    JournalStats stats;
+    stats.recorded = sequence_.load(std::memory_order_relaxed);
+    stats.written = written_.load(std::memory_order_relaxed);
+    stats.durable = durable_.load(std::memory_order_relaxed);
+    stats.commits = commits_.load(std::memory_order_relaxed);
+    stats.full_waits = full_waits_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void BookJournal::run() {
+    std::vector<MarketDataEvent> batch(kJournalBatch);
+    uint64_t unsynced = 0;
+    auto oldest = std::chrono::steady_clock::now();
+
+    while (true) {
+        size_t count = queue_.popBatch(batch.data(), batch.size());
+        if (count > 0) {
+            if (unsynced == 0) {
+                oldest = std::chrono::steady_clock::now();
+            }
+            if (!failed_.load(std::memory_order_relaxed) && append(batch.data(), count)) {
+                unsynced += count;
+            }
+        }
+
+        bool stopping = !running_.load(std::memory_order_acquire);
+        uint64_t target = flush_target_.load(std::memory_order_acquire);
+        uint64_t written = written_.load(std::memory_order_relaxed);
+        bool due = false;
+        if (unsynced > 0) {
+            due = (config_.commit_events > 0 && unsynced >= config_.commit_events) ||
+                  (target > durable_.load(std::memory_order_relaxed) && written >= target) ||
+                  (stopping && queue_.empty()) ||
+                  (config_.commit_interval.count() > 0 &&
+                   std::chrono::steady_clock::now() - oldest >= config_.commit_interval);
+        }
+        if (due) {
+            commit();
+            unsynced = 0;
+        }
+
+        if (count == 0) {
+            if (stopping && queue_.empty()) {
+                break;
+            }
+            std::this_thread::sleep_for(config_.poll_interval);
+        }
+    }
+}
+
+bool BookJournal::append(const MarketDataEvent* events, size_t count) {
+    uint64_t offset = sizeof(EventFileHeader) + written_.load(std::memory_order_relaxed) * sizeof(MarketDataEvent);
+    uint64_t end = offset + count * sizeof(MarketDataEvent);
+    if (end > reserved_bytes_) {
+        uint64_t reserved = std::max<uint64_t>(end, reserved_bytes_ + config_.preallocate);
+        if (!reserve(fd_, reserved_bytes_, reserved)) {
+            error_ = "Cannot reserve journal " + path_ + ": " + std::strerror(errno);
+            failed_.store(true, std::memory_order_release);
+            return false;
+        }
+        reserved_bytes_ = reserved;
+    }
+    if (!writeAt(fd_, events, count * sizeof(MarketDataEvent), offset)) {
+        error_ = "Cannot write journal " + path_ + ": " + std::strerror(errno);
+        failed_.store(true, std::memory_order_release);
+        return false;
+    }
+    written_.store(written_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    return true;
+}
+
+void BookJournal::commit() {
+    if (::fdatasync(fd_) != 0) {
+        error_ = "Cannot sync journal " + path_ + ": " + std::strerror(errno);
+        failed_.store(true, std::memory_order_release);
+    } else {
+        durable_.store(written_.load(std::memory_order_relaxed), std::memory_order_release);
+        commits_.store(commits_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    // Taking the lock orders the store before a flush() that is about to wait
+    { std::lock_guard<std::mutex> lock(flush_mutex_); }
+    flushed_.notify_all();
+}
+
+JournalReplayer::JournalReplayer(const OrderBookConfig& config) : config_(config) {}
+
+void JournalReplayer::addBook(std::shared_ptr<OrderBook> book) {
+    book->registerTradeCallback([this](const Trade& trade) { made_.push_back(trade); });
+    books_[book->getSymbolId()] = std::move(book);
+}
+
+OrderBook& JournalReplayer::bookNamed(const std::string& symbol) {
+    auto symbol_id = SymbolRegistry::instance().intern(symbol);
+    auto it = books_.find(symbol_id);
+    if (it == books_.end()) {
+        addBook(std::make_shared<OrderBook>(symbol, config_));
+        it = books_.find(symbol_id);
+    }
+    return *it->second;
+}
+
+OrderBook& JournalReplayer::bookFor(SymbolId recorded_id) {
+    auto it = recorded_.find(recorded_id);
+    if (it == recorded_.end()) {
+        throw std::runtime_error("Journal record for unnamed symbol " + std::to_string(recorded_id));
+    }
+    return *it->second;
+}
+
+size_t JournalReplayer::apply(const MarketDataEvent* events, size_t count) {
+    size_t i = 0;
+    for (; i < count; ++i) {
+        const auto& event = events[i];
+        if (event.sequence != records_ + 1) {
+            truncated_ = true;
+            break;
+        }
+        ++records_;
+
+        if (event.type == MarketDataEvent::Type::SYMBOL) {
+            recorded_[event.symbol_id] = &bookNamed(std::string(event.symbolName()));
+        } else if (event.type == MarketDataEvent::Type::TRADE) {
+            check(event, bookFor(event.symbol_id).getSymbolId());
+        } else if (event.type != MarketDataEvent::Type::HEARTBEAT) {
+            auto& book = bookFor(event.symbol_id);
+            MarketDataEvent local = event;
+            local.symbol_id = book.getSymbolId();
+            applyEvent(book, local);
+        }
+    }
+    return i;
+}
+
+size_t JournalReplayer::applyFile(const std::string& path) {
+    MappedEventFile journal(path);
+    return apply(journal.data(), journal.size());
+}
+
+void JournalReplayer::check(const MarketDataEvent& trade, SymbolId symbol_id) {
+    ++trades_;
+    if (compared_ == made_.size()) {
+        ++mismatches_;  // Recorded but not made
+        return;
+    }
+    if (!sameTrade(trade, symbol_id, made_[compared_++])) {
+        ++mismatches_;
+    }
+    if (compared_ == made_.size()) {
+        made_.clear();
+        compared_ = 0;
+    }
+}
+
+uint64_t JournalReplayer::mismatches() const {
+    return mismatches_ + (made_.size() - compared_);
+}
+
+std::shared_ptr<OrderBook> JournalReplayer::getOrderBook(SymbolId symbol_id) const {
+    auto it = books_.find(symbol_id);
+    return it != books_.end() ? it->second : nullptr;
+}
+
+std::vector<std::shared_ptr<OrderBook>> JournalReplayer::getOrderBooks() const {
+    std::vector<std::shared_ptr<OrderBook>> books;
+    for (const auto& entry : books_) {
+        books.push_back(entry.second);
+    }
+    return books;
+}
+
+} // namespace orderbook
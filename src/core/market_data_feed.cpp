@@ -1,26 +1,199 @@
 #include "orderbook/market_data_feed.h"
 #include <stdexcept>
 #include <iostream>
+#include <algorithm>
 #include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <random>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 namespace orderbook {
 
+namespace {
+
+// Split "<target>?<key>=<value>&<key>=<value>..." into the target and its options
+std::string splitOptions(const std::string& config, std::vector<std::pair<std::string, std::string>>& options) {
+    auto query = config.find('?');
+    while (query != std::string::npos) {
+        auto next = config.find('&', query + 1);
+        auto option = config.substr(query + 1, next == std::string::npos ? std::string::npos : next - query - 1);
+        auto eq = option.find('=');
+        options.emplace_back(option.substr(0, eq), eq == std::string::npos ? std::string() : option.substr(eq + 1));
+        query = next;
+    }
+    return config.substr(0, config.find('?'));
+}
+
+} // namespace
+
 // Factory method implementation
 std::unique_ptr<MarketDataFeed> MarketDataFeed::create(const std::string& type, const std::string& config) {
     if (type == "websocket") {
         return std::make_unique<WebSocketMarketDataFeed>(config);
     }
+    if (type == "file") {
+        // <path>[?speed=<multiplier>][&queue=1]
+        ReplayConfig replay;
+        std::vector<std::pair<std::string, std::string>> options;
+        std::string path = splitOptions(config, options);
+        for (const auto& [key, value] : options) {
+            if (key == "speed") {
+                replay.speed = std::stod(value);
+            } else if (key == "queue") {
+                replay.through_queue = value != "0";
+            } else {
+                throw std::invalid_argument("Unknown file feed option: " + key);
+            }
+        }
+        return std::make_unique<FileReplayFeed>(path, replay);
+    }
+    if (type == "multicast") {
+        // <group:port>[,<group:port>][?interface=<address>][&batch=<n>][&buffer=<bytes>]
+        MulticastConfig multicast;
+        std::vector<std::pair<std::string, std::string>> options;
+        std::string lines = splitOptions(config, options);
+        auto comma = lines.find(',');
+        multicast.line_a = lines.substr(0, comma);
+        multicast.line_b = comma == std::string::npos ? std::string() : lines.substr(comma + 1);
+        for (const auto& [key, value] : options) {
+            if (key == "interface") {
+                multicast.interface = value;
+            } else if (key == "batch") {
+                multicast.batch = std::stoul(value);
+            } else if (key == "buffer") {
+                multicast.receive_buffer = std::stoi(value);
+            } else {
+                throw std::invalid_argument("Unknown multicast feed option: " + key);
+            }
+        }
+        return std::make_unique<MulticastMarketDataFeed>(multicast);
+    }
+    if (type == "fix") {
+        // <host:port>[?decimals=<n>][&sender=<id>&target=<id>][&checksum=0][&isa=scalar|sse2|avx2]
+        FixConfig fix;
+        std::vector<std::pair<std::string, std::string>> options;
+        fix.endpoint = splitOptions(config, options);
+        for (const auto& [key, value] : options) {
+            if (key == "decimals") {
+                fix.price_decimals = std::stoi(value);
+            } else if (key == "sender") {
+                fix.sender_comp_id = value;
+            } else if (key == "target") {
+                fix.target_comp_id = value;
+            } else if (key == "checksum") {
+                fix.validate_checksum = value != "0";
+            } else if (key == "isa") {
+                if (value == "scalar") {
+                    fix.isa = FixIsa::SCALAR;
+                } else if (value == "sse2") {
+                    fix.isa = std::min(FixIsa::SSE2, bestFixIsa());
+                } else if (value == "avx2") {
+                    fix.isa = bestFixIsa();
+                } else {
+                    throw std::invalid_argument("Unknown FIX scanner: " + value);
+                }
+            } else {
+                throw std::invalid_argument("Unknown FIX feed option: " + key);
+            }
+        }
+        return std::make_unique<FixMarketDataFeed>(fix);
+    }
     // Add other feed types as needed
     
     throw std::invalid_argument("Unknown market data feed type: " + type);
 }
 
+namespace {
+
+// Number of events a dispatch or async handler thread takes from its queue at a time
+constexpr size_t kDispatchBatch = 64;
+
+// Counters have a single writer, so a plain load and store is enough
+inline void bump(std::atomic<uint64_t>& counter, uint64_t by = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+// The feed whose dispatch thread is the calling thread, if any
+thread_local const BaseMarketDataFeed* dispatching_feed = nullptr;
+
+} // namespace
+
+/**
+ * @brief A handler running on its own thread behind its own queue
+ *
+ * The dispatch thread is the only producer. Destroying it lets the
+ * worker finish the events already queued, then joins it.
+ */
+struct BaseMarketDataFeed::AsyncHandler {
+    AsyncHandler(MarketDataHandler* handler, size_t capacity, const FeedConfig& config)
+        : handler(handler),
+          queue(capacity),
+          waiter(config.wait_strategy, config.spin_iterations),
+          worker(&AsyncHandler::run, this) {}
+
+    ~AsyncHandler() {
+        waiter.notifyAfter([this] { running = false; });
+        worker.join();
+    }
+
+    void run() {
+        MarketDataEvent batch[kDispatchBatch];
+        uint32_t spins = 0;
+        while (true) {
+            size_t count = queue.popBatch(batch, kDispatchBatch);
+            if (count == 0) {
+                if (!running.load(std::memory_order_acquire) && queue.empty()) {
+                    break;
+                }
+                waiter.idle(spins, [this] {
+                    return !queue.empty() || !running.load(std::memory_order_relaxed);
+                });
+                continue;
+            }
+            spins = 0;
+            for (size_t i = 0; i < count; ++i) {
+                handler->handleEvent(batch[i]);
+            }
+        }
+    }
+
+    MarketDataHandler* handler;
+    SpscQueue<MarketDataEvent> queue;
+    QueueWaiter waiter;
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> dropped{0};  // Written by the dispatch thread
+    std::thread worker;
+};
+
+/**
+ * @brief Immutable handler set read by the dispatch thread
+ */
+struct BaseMarketDataFeed::HandlerSet {
+    std::vector<MarketDataHandler*> inline_handlers;
+    std::vector<AsyncHandler*> async_handlers;
+};
+
 // Base market data feed implementation
-BaseMarketDataFeed::BaseMarketDataFeed() 
-    : running_(false) {}
+BaseMarketDataFeed::BaseMarketDataFeed(const FeedConfig& config)
+    : config_(config),
+      queue_(config.queue_capacity),
+      running_(false),
+      handlers_(new HandlerSet()),
+      dispatch_waiter_(config.wait_strategy, config.spin_iterations),
+      producer_waiter_(config.wait_strategy, config.spin_iterations) {}
 
 BaseMarketDataFeed::~BaseMarketDataFeed() {
     stop();
+    delete handlers_.load(std::memory_order_relaxed);
+    async_handlers_.clear();
 }
 
 void BaseMarketDataFeed::start() {
@@ -31,6 +204,8 @@ void BaseMarketDataFeed::start() {
     }
     
     running_ = true;
+    dispatching_ = true;
+    dispatch_thread_ = std::thread(&BaseMarketDataFeed::dispatchLoop, this);
     processing_thread_ = std::thread(&BaseMarketDataFeed::processMessages, this);
 }
 
@@ -45,13 +220,18 @@ void BaseMarketDataFeed::stop() {
         running_ = false;
     }
     
-    // Notify the processing thread to check the running flag
-    condition_.notify_all();
-    
-    // Wait for the processing thread to finish
+    // Release a producer waiting for space or in a system call, then wait for it to finish
+    producer_waiter_.notifyAfter([] {});
+    interruptIngest();
     if (processing_thread_.joinable()) {
         processing_thread_.join();
     }
+    
+    // Nothing more can be published: let the dispatch thread drain the queue and exit
+    dispatch_waiter_.notifyAfter([this] { dispatching_ = false; });
+    if (dispatch_thread_.joinable()) {
+        dispatch_thread_.join();
+    }
 }
 
 void BaseMarketDataFeed::subscribe(const std::string& symbol) {
@@ -65,61 +245,1004 @@ void BaseMarketDataFeed::unsubscribe(const std::string& symbol) {
 }
 
 void BaseMarketDataFeed::registerHandler(MarketDataHandler* handler) {
+    registerHandler(handler, HandlerMode::INLINE);
+}
+
+void BaseMarketDataFeed::registerHandler(MarketDataHandler* handler, HandlerMode mode, size_t queue_capacity) {
     std::lock_guard<std::mutex> lock(mutex_);
-    handlers_.push_back(handler);
+    
+    auto* next = new HandlerSet(*handlers_.load(std::memory_order_relaxed));
+    if (mode == HandlerMode::ASYNC) {
+        size_t capacity = queue_capacity > 0 ? queue_capacity : config_.queue_capacity;
+        async_handlers_.push_back(std::make_unique<AsyncHandler>(handler, capacity, config_));
+        next->async_handlers.push_back(async_handlers_.back().get());
+    } else {
+        next->inline_handlers.push_back(handler);
+    }
+    publishHandlers(next);
 }
 
-void BaseMarketDataFeed::dispatchMessage(const MarketDataMessage& message) {
+bool BaseMarketDataFeed::unregisterHandler(MarketDataHandler* handler) {
+    std::unique_ptr<AsyncHandler> removed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        const auto* current = handlers_.load(std::memory_order_relaxed);
+        auto* next = new HandlerSet();
+        bool found = false;
+        for (auto* h : current->inline_handlers) {
+            if (h == handler) {
+                found = true;
+            } else {
+                next->inline_handlers.push_back(h);
+            }
+        }
+        for (auto* async : current->async_handlers) {
+            if (async->handler == handler) {
+                found = true;
+            } else {
+                next->async_handlers.push_back(async);
+            }
+        }
+        if (!found) {
+            delete next;
+            return false;
+        }
+        
+        for (auto it = async_handlers_.begin(); it != async_handlers_.end(); ++it) {
+            if ((*it)->handler == handler) {
+                removed = std::move(*it);
+                async_handlers_.erase(it);
+                break;
+            }
+        }
+        removed_async_dropped_ += removed ? removed->dropped.load(std::memory_order_relaxed) : 0;
+        publishHandlers(next);
+    }
+    
+    if (onDispatchThread()) {
+        // Called from a handler: the dispatch thread may still hold the old set
+        if (removed) {
+            epoch_.retire(removed.release());
+        }
+        return true;
+    }
+    
+    // Wait for the dispatch thread to let go of the old set; an async
+    // handler then finishes its queue before we return
+    epoch_.synchronize();
+    removed.reset();
+    return true;
+}
+
+FeedStats BaseMarketDataFeed::getStats() const {
+    FeedStats stats;
+    stats.published = producer_stats_.published.load(std::memory_order_relaxed);
+    stats.backpressure_waits = producer_stats_.backpressure_waits.load(std::memory_order_relaxed);
+    stats.overflows = producer_stats_.overflows.load(std::memory_order_relaxed);
+    stats.dispatched = consumer_stats_.dispatched.load(std::memory_order_relaxed);
+    stats.queue_depth = queue_.size();
+    
     std::lock_guard<std::mutex> lock(mutex_);
+    stats.async_dropped = removed_async_dropped_;
+    for (const auto& async : async_handlers_) {
+        stats.async_dropped += async->dropped.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+bool BaseMarketDataFeed::publish(const MarketDataEvent& event) {
+    if (!queue_.tryPush(event)) {
+        if (config_.drop_when_full) {
+            bump(producer_stats_.overflows);
+            return false;
+        }
+        
+        bump(producer_stats_.backpressure_waits);
+        uint32_t spins = 0;
+        while (!queue_.tryPush(event)) {
+            if (!running_.load(std::memory_order_acquire)) {
+                bump(producer_stats_.overflows);
+                return false;
+            }
+            producer_waiter_.idle(spins, [this] {
+                return queue_.size() < queue_.capacity() || !running_.load(std::memory_order_relaxed);
+            });
+        }
+    }
+    
+    bump(producer_stats_.published);
+    dispatch_waiter_.notify();
+    return true;
+}
+
+void BaseMarketDataFeed::dispatchEvent(const MarketDataEvent& event) {
+    const auto* handlers = handlers_.load(std::memory_order_acquire);
+    
+    for (auto* handler : handlers->inline_handlers) {
+        handler->handleEvent(event);
+    }
+    for (auto* async : handlers->async_handlers) {
+        if (async->queue.tryPush(event)) {
+            async->waiter.notify();
+        } else {
+            bump(async->dropped);
+        }
+    }
+}
+
+void BaseMarketDataFeed::dispatchBatch(const MarketDataEvent* events, size_t count) {
+    const auto* previous = dispatching_feed;
+    dispatching_feed = this;
+    {
+        // The handler set is reloaded per event, so changes made by a handler apply from the next one
+        auto guard = epoch_.read();
+        for (size_t i = 0; i < count; ++i) {
+            dispatchEvent(events[i]);
+        }
+    }
+    dispatching_feed = previous;
+    consumer_stats_.dispatched.fetch_add(count, std::memory_order_relaxed);
     
-    for (auto handler : handlers_) {
-        handler->handleMessage(message);
+    // Free what handlers unregistered from this thread
+    if (epoch_.hasRetired()) {
+        epoch_.reclaim();
     }
 }
 
+void BaseMarketDataFeed::dispatchLoop() {
+    MarketDataEvent batch[kDispatchBatch];
+    uint32_t spins = 0;
+    
+    while (true) {
+        size_t count = queue_.popBatch(batch, kDispatchBatch);
+        if (count == 0) {
+            if (!dispatching_.load(std::memory_order_acquire) && queue_.empty()) {
+                break;
+            }
+            dispatch_waiter_.idle(spins, [this] {
+                return !queue_.empty() || !dispatching_.load(std::memory_order_relaxed);
+            });
+            continue;
+        }
+        
+        spins = 0;
+        producer_waiter_.notify();
+        dispatchBatch(batch, count);
+    }
+}
+
+void BaseMarketDataFeed::publishHandlers(HandlerSet* next) {
+    const auto* previous = handlers_.exchange(next, std::memory_order_acq_rel);
+    epoch_.retire(previous);
+}
+
+bool BaseMarketDataFeed::onDispatchThread() const {
+    return dispatching_feed == this;
+}
+
+// Stream feed helpers (WebSocket and FIX)
+namespace {
+
+int makeWakeFd() {
+    int fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("Cannot create eventfd: ") + std::strerror(errno));
+    }
+    return fd;
+}
+
+void signalWake(int wake_fd) {
+    uint64_t one = 1;
+    (void)::write(wake_fd, &one, sizeof(one));
+}
+
+void drainWake(int wake_fd) {
+    uint64_t drained;
+    (void)::read(wake_fd, &drained, sizeof(drained));
+}
+
+// Sleep for delay, or until the eventfd is signalled
+void waitForWake(int wake_fd, std::chrono::milliseconds delay) {
+    pollfd wake{wake_fd, POLLIN, 0};
+    if (::poll(&wake, 1, static_cast<int>(delay.count())) > 0) {
+        drainWake(wake_fd);
+    }
+}
+
+// A non-blocking TCP connection to host:port, or -1; gives up early if running is cleared and the eventfd signalled
+int connectTcp(const std::string& host, uint16_t port, int wake_fd, std::chrono::milliseconds timeout,
+               const std::atomic<bool>& running) {
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* resolved = nullptr;
+    if (::getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &resolved) != 0) {
+        return -1;
+    }
+    sockaddr_in address = *reinterpret_cast<const sockaddr_in*>(resolved->ai_addr);
+    ::freeaddrinfo(resolved);
+
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    int nodelay = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        if (errno != EINPROGRESS) {
+            ::close(fd);
+            return -1;
+        }
+        // Wait for the connection; the eventfd only matters if it was stop() that signalled it
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        pollfd polls[2] = {{fd, POLLOUT, 0}, {wake_fd, POLLIN, 0}};
+        bool writable = false;
+        while (!writable && running.load(std::memory_order_relaxed)) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now());
+            if (remaining.count() <= 0 || ::poll(polls, 2, static_cast<int>(remaining.count())) < 0) {
+                break;
+            }
+            writable = polls[0].revents & (POLLOUT | POLLERR | POLLHUP);
+            if (polls[1].revents & POLLIN) {
+                drainWake(wake_fd);
+            }
+        }
+        int error = 0;
+        socklen_t length = sizeof(error);
+        if (!writable || ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) != 0 || error != 0) {
+            ::close(fd);
+            return -1;
+        }
+    }
+    return fd;
+}
+
+// Write everything to a non-blocking socket, waiting for room while running
+bool sendAll(int fd, const std::string& data, const std::atomic<bool>& running) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += static_cast<size_t>(n);
+        } else if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+            if (!running.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            pollfd writable{fd, POLLOUT, 0};
+            ::poll(&writable, 1, 100);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
 // WebSocket market data feed implementation
-WebSocketMarketDataFeed::WebSocketMarketDataFeed(const std::string& url)
-    : BaseMarketDataFeed(), url_(url) {}
+namespace {
+
+std::string subscriptionMessage(const char* op, const std::vector<std::string>& symbols) {
+    std::string message = "{\"op\":\"";
+    message += op;
+    message += "\",\"symbols\":[";
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        message += i ? ",\"" : "\"";
+        message += symbols[i];
+        message += '"';
+    }
+    message += "]}";
+    return message;
+}
+
+} // namespace
+
+WebSocketMarketDataFeed::WebSocketMarketDataFeed(const std::string& url, const FeedConfig& config)
+    : WebSocketMarketDataFeed(url, WebSocketConfig(), config) {}
+
+WebSocketMarketDataFeed::WebSocketMarketDataFeed(const std::string& url, const WebSocketConfig& websocket,
+                                                 const FeedConfig& config)
+    : BaseMarketDataFeed(config),
+      url_(url),
+      endpoint_(parseWebSocketUrl(url)),
+      websocket_(websocket),
+      decoder_(websocket.price_decimals),
+      parser_(websocket.max_message),
+      buffer_(std::max<size_t>(websocket.receive_buffer, 4096)) {
+    wake_fd_ = makeWakeFd();
+}
 
 WebSocketMarketDataFeed::~WebSocketMarketDataFeed() {
     stop();
+    ::close(wake_fd_);
+}
+
+void WebSocketMarketDataFeed::subscribe(const std::string& symbol) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!subscribed_symbols_.insert(symbol).second || !connected_.load(std::memory_order_relaxed)) {
+            return;  // Sent with the others when the connection comes up
+        }
+        commands_.push_back(subscriptionMessage("subscribe", {symbol}));
+    }
+    interruptIngest();
+}
+
+void WebSocketMarketDataFeed::unsubscribe(const std::string& symbol) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (subscribed_symbols_.erase(symbol) == 0 || !connected_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        commands_.push_back(subscriptionMessage("unsubscribe", {symbol}));
+    }
+    interruptIngest();
+}
+
+WebSocketStats WebSocketMarketDataFeed::getWebSocketStats() const {
+    WebSocketStats stats;
+    stats.connects = counters_.connects.load(std::memory_order_relaxed);
+    stats.disconnects = counters_.disconnects.load(std::memory_order_relaxed);
+    stats.bytes = counters_.bytes.load(std::memory_order_relaxed);
+    stats.messages = counters_.messages.load(std::memory_order_relaxed);
+    stats.events = counters_.events.load(std::memory_order_relaxed);
+    stats.decode_errors = counters_.decode_errors.load(std::memory_order_relaxed);
+    stats.pings = counters_.pings.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void WebSocketMarketDataFeed::interruptIngest() {
+    signalWake(wake_fd_);
 }
 
 void WebSocketMarketDataFeed::processMessages() {
-    // TODO: Implement WebSocket connection and message processing
-    // For now, just simulate receiving messages periodically
-    
-    while (running_) {
-        {
-            std::unique_lock<std::mutex> lock(mutex_);
-            
-            // Wait for a new message or stop signal
-            condition_.wait_for(lock, std::chrono::milliseconds(100), 
-                [this] { return !running_ || !message_queue_.empty(); });
-            
-            if (!running_) {
+    auto delay = websocket_.reconnect_delay;
+    while (running_.load(std::memory_order_relaxed)) {
+        int fd = connect();
+        if (fd >= 0) {
+            bool established = session(fd);
+            ::close(fd);
+            if (!running_.load(std::memory_order_relaxed)) {
                 break;
             }
-            
-            // Process all messages in the queue
-            while (!message_queue_.empty()) {
-                auto message = std::move(message_queue_.front());
-                message_queue_.pop();
-                
-                // Dispatch message to handlers
-                dispatchMessage(*message);
+            if (established) {
+                bump(counters_.disconnects);
+                delay = websocket_.reconnect_delay;
+            }
+        }
+        waitForWake(wake_fd_, delay);
+        delay = std::min<std::chrono::milliseconds>(delay * 2, std::chrono::seconds(5));
+    }
+}
+
+int WebSocketMarketDataFeed::connect() {
+    return connectTcp(endpoint_.host, endpoint_.port, wake_fd_, websocket_.connect_timeout, running_);
+}
+
+bool WebSocketMarketDataFeed::sendText(int fd, const std::string& text) {
+    static thread_local std::mt19937 rng(std::random_device{}());
+    std::string frame;
+    appendFrame(frame, WebSocketOpcode::TEXT, text, true, rng());
+    return sendAll(fd, frame, running_);
+}
+
+bool WebSocketMarketDataFeed::session(int fd) {
+    std::string key;
+    if (!sendAll(fd, webSocketRequest(endpoint_, key), running_)) {
+        return false;
+    }
+
+    int epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        return false;
+    }
+    epoll_event watch{};
+    watch.events = EPOLLIN;
+    watch.data.fd = fd;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &watch);
+    watch.data.fd = wake_fd_;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd_, &watch);
+
+    parser_.reset();
+    size_t filled = 0;
+    bool open = false;
+    bool alive = true;
+    const auto handshake_deadline = std::chrono::steady_clock::now() + websocket_.connect_timeout;
+
+    auto on_message = [&](WebSocketOpcode opcode, std::string_view payload) {
+        switch (opcode) {
+            case WebSocketOpcode::TEXT: {
+                bump(counters_.messages);
+                size_t decoded = decoder_.decode(payload, [this](const MarketDataEvent& event) { publish(event); });
+                bump(counters_.events, decoded);
+                break;
+            }
+            case WebSocketOpcode::PING: {
+                static thread_local std::mt19937 rng(std::random_device{}());
+                std::string pong;
+                appendFrame(pong, WebSocketOpcode::PONG, payload, true, rng());
+                alive = sendAll(fd, pong, running_) && alive;
+                bump(counters_.pings);
+                break;
+            }
+            case WebSocketOpcode::CLOSE: {
+                std::string reply;
+                appendFrame(reply, WebSocketOpcode::CLOSE, payload.substr(0, 2), true, 0);
+                sendAll(fd, reply, running_);
+                alive = false;
+                break;
+            }
+            default:
+                break;
+        }
+    };
+
+    epoll_event ready[2];
+    while (alive && running_.load(std::memory_order_relaxed)) {
+        int count = ::epoll_wait(epoll_fd, ready, 2, 100);
+        if (!open && std::chrono::steady_clock::now() > handshake_deadline) {
+            break;
+        }
+
+        bool readable = false;
+        for (int i = 0; i < count; ++i) {
+            if (ready[i].data.fd == wake_fd_) {
+                drainWake(wake_fd_);
+            } else {
+                readable = true;
+            }
+        }
+
+        // Subscription changes made since the last pass
+        if (open) {
+            std::vector<std::string> commands;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                commands.swap(commands_);
+            }
+            for (const auto& command : commands) {
+                alive = alive && sendText(fd, command);
+            }
+        }
+
+        // Drain the socket, parsing as we go
+        while (readable && alive) {
+            if (filled == buffer_.size()) {
+                if (buffer_.size() >= websocket_.max_message + 14) {
+                    alive = false;
+                    break;
+                }
+                buffer_.resize(std::min(buffer_.size() * 2, websocket_.max_message + 14));
+            }
+            ssize_t received = ::recv(fd, buffer_.data() + filled, buffer_.size() - filled, 0);
+            if (received < 0 && (errno == EAGAIN || errno == EINTR)) {
+                break;
+            }
+            if (received <= 0) {
+                alive = false;
+                break;
+            }
+            filled += static_cast<size_t>(received);
+
+            size_t consumed = 0;
+            if (!open) {
+                try {
+                    consumed = checkWebSocketResponse(std::string_view(buffer_.data(), filled), key);
+                } catch (const std::exception& e) {
+                    std::cerr << "WebSocket feed " << url_ << ": " << e.what() << std::endl;
+                    alive = false;
+                    break;
+                }
+                if (consumed == 0) {
+                    continue;
+                }
+                open = true;
+                bump(counters_.connects);
+
+                // Everything subscribed so far goes in one message; later changes are queued as commands
+                std::vector<std::string> symbols;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    symbols.assign(subscribed_symbols_.begin(), subscribed_symbols_.end());
+                    commands_.clear();
+                    connected_.store(true, std::memory_order_release);
+                }
+                std::sort(symbols.begin(), symbols.end());
+                if (!symbols.empty()) {
+                    alive = sendText(fd, subscriptionMessage("subscribe", symbols));
+                }
+            } else {
+                bump(counters_.bytes, static_cast<uint64_t>(received));
+            }
+
+            consumed += parser_.parse(buffer_.data() + consumed, filled - consumed, on_message);
+            if (parser_.failed()) {
+                alive = false;
+                break;
+            }
+            std::memmove(buffer_.data(), buffer_.data() + consumed, filled - consumed);
+            filled -= consumed;
+            if (parser_.needed() > buffer_.size()) {
+                buffer_.resize(parser_.needed());
+            }
+        }
+        counters_.decode_errors.store(decoder_.errors(), std::memory_order_relaxed);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connected_.store(false, std::memory_order_release);
+    }
+    ::close(epoll_fd);
+    return open;
+}
+
+// File replay feed implementation
+FileReplayFeed::FileReplayFeed(const std::string& path, const ReplayConfig& replay, const FeedConfig& config)
+    : BaseMarketDataFeed(config), file_(path), replay_(replay) {}
+
+FileReplayFeed::~FileReplayFeed() {
+    stop();
+}
+
+void FileReplayFeed::interruptIngest() {
+    // Taking the lock orders this after a pacing wait has checked running_, so the wake is not lost
+    std::lock_guard<std::mutex> lock(pace_mutex_);
+    pace_wake_.notify_all();
+}
+
+void FileReplayFeed::processMessages() {
+    const auto* events = file_.data();
+    const size_t total = file_.size();
+    
+    // A restarted feed resumes where it stopped, pacing from its first undelivered event
+    size_t next = replayed_.load(std::memory_order_relaxed);
+    const auto first = next < total ? events[next].timestamp : MarketDataEvent::Timestamp{};
+    const auto start = std::chrono::steady_clock::now();
+    
+    // When an event is due under pacing
+    auto due = [&](size_t i) {
+        std::chrono::duration<double, std::nano> offset(events[i].timestamp - first);
+        return start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset / replay_.speed);
+    };
+    
+    while (next < total && running_.load(std::memory_order_relaxed)) {
+        size_t end = std::min(total, next + kDispatchBatch);
+        if (replay_.speed > 0) {
+            auto when = due(next);
+            if (std::chrono::steady_clock::now() < when) {
+                std::unique_lock<std::mutex> lock(pace_mutex_);
+                if (pace_wake_.wait_until(lock, when, [this] { return !running_.load(std::memory_order_relaxed); })) {
+                    break;
+                }
+            }
+            // Deliver together everything that is already due
+            auto now = std::chrono::steady_clock::now();
+            size_t limit = end;
+            end = next + 1;
+            while (end < limit && due(end) <= now) {
+                ++end;
             }
         }
         
-        // Simulate receiving messages
-        // In a real implementation, this would come from a WebSocket callback
-        if (running_) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (replay_.through_queue) {
+            for (size_t i = next; i < end; ++i) {
+                publish(events[i]);
+            }
+        } else {
+            dispatchBatch(events + next, end - next);
+        }
+        next = end;
+        replayed_.store(next, std::memory_order_release);
+    }
+    
+    if (next == total) {
+        finished_.store(true, std::memory_order_release);
+    }
+}
+
+// Multicast market data feed implementation
+namespace {
+
+// Receive buffer per datagram; larger datagrams are truncated and counted as malformed
+constexpr size_t kReceiveSlot = 2048;
+
+// A non-blocking UDP socket bound to address, joined to its group if it is multicast
+int openReceiver(const sockaddr_in& address, const in_addr& interface, int receive_buffer,
+                 const std::string& endpoint) {
+    int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("Cannot create feed socket: ") + std::strerror(errno));
+    }
+
+    int reuse = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receive_buffer, sizeof(receive_buffer));
+    bool ok = ::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+    if (ok && IN_MULTICAST(ntohl(address.sin_addr.s_addr))) {
+        ip_mreq membership{};
+        membership.imr_multiaddr = address.sin_addr;
+        membership.imr_interface = interface;
+        ok = ::setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) == 0;
+    }
+    if (!ok) {
+        std::string error = "Cannot listen on " + endpoint + ": " + std::strerror(errno);
+        ::close(fd);
+        throw std::runtime_error(error);
+    }
+    return fd;
+}
+
+// A received datagram, parsed in place
+struct Packet {
+    uint64_t sequence;
+    size_t count;
+    const MarketDataEvent* events;
+    size_t line;
+};
+
+} // namespace
+
+MulticastMarketDataFeed::MulticastMarketDataFeed(const MulticastConfig& multicast, const FeedConfig& config)
+    : BaseMarketDataFeed(config),
+      multicast_(multicast),
+      arbiter_(multicast.line_b.empty() ? 1 : 2, multicast.first_sequence) {
+    multicast_.batch = std::max<size_t>(1, multicast_.batch);
+    if (multicast_.line_a.empty()) {
+        throw std::invalid_argument("Multicast feed needs line A");
+    }
+    
+    in_addr interface{};
+    if (::inet_pton(AF_INET, multicast_.interface.c_str(), &interface) != 1) {
+        throw std::invalid_argument("Invalid interface address " + multicast_.interface);
+    }
+    
+    const std::string* endpoints[] = {&multicast_.line_a, &multicast_.line_b};
+    try {
+        for (const auto* endpoint : endpoints) {
+            if (!endpoint->empty()) {
+                fds_[line_count_] = openReceiver(parseEndpoint(*endpoint), interface,
+                                                 multicast_.receive_buffer, *endpoint);
+                ++line_count_;
+            }
+        }
+    } catch (...) {
+        for (size_t i = 0; i < line_count_; ++i) {
+            ::close(fds_[i]);
+        }
+        throw;
+    }
+}
+
+MulticastMarketDataFeed::~MulticastMarketDataFeed() {
+    stop();
+    for (size_t i = 0; i < line_count_; ++i) {
+        ::close(fds_[i]);
+    }
+}
+
+MulticastStats MulticastMarketDataFeed::getMulticastStats() const {
+    MulticastStats stats;
+    stats.packets_a = counters_.packets[0].load(std::memory_order_relaxed);
+    stats.packets_b = counters_.packets[1].load(std::memory_order_relaxed);
+    stats.won_a = counters_.won[0].load(std::memory_order_relaxed);
+    stats.won_b = counters_.won[1].load(std::memory_order_relaxed);
+    stats.duplicates = counters_.duplicates.load(std::memory_order_relaxed);
+    stats.gaps = counters_.gaps.load(std::memory_order_relaxed);
+    stats.missed = counters_.missed.load(std::memory_order_relaxed);
+    stats.malformed = counters_.malformed.load(std::memory_order_relaxed);
+    stats.receive_calls = counters_.receive_calls.load(std::memory_order_relaxed);
+    stats.next_sequence = counters_.next_sequence.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void MulticastMarketDataFeed::processMessages() {
+    const size_t batch = multicast_.batch;
+    const size_t slots = batch * line_count_;
+    
+    // Receive buffers, 8-byte aligned so records can be read in place
+    std::vector<uint64_t> storage(slots * kReceiveSlot / sizeof(uint64_t));
+    std::vector<iovec> iov(slots);
+    std::vector<mmsghdr> messages(slots);
+    std::vector<Packet> packets;
+    packets.reserve(slots);
+    for (size_t i = 0; i < slots; ++i) {
+        iov[i] = {reinterpret_cast<char*>(storage.data()) + i * kReceiveSlot, kReceiveSlot};
+    }
+    
+    pollfd polls[2];
+    for (size_t l = 0; l < line_count_; ++l) {
+        polls[l] = {fds_[l], POLLIN, 0};
+    }
+    
+    auto deliver = [this](size_t line, const MarketDataEvent* events, size_t count) {
+        bump(counters_.won[line]);
+        for (size_t i = 0; i < count; ++i) {
+            publish(events[i]);
+        }
+    };
+    auto gap = [this](uint64_t first, uint64_t count) {
+        if (on_gap_) {
+            on_gap_(first, count);
+        }
+    };
+    
+    bool drained = true;
+    auto holding_since = std::chrono::steady_clock::now();
+    while (running_.load(std::memory_order_relaxed)) {
+        // Only sleep in poll once the sockets have been drained. The timeout bounds stop() latency,
+        // or, while packets are held, how late the gap timeout is noticed.
+        bool holding = arbiter_.holding();
+        if (drained && ::poll(polls, line_count_, holding ? 1 : 100) <= 0) {
+            if (holding && std::chrono::steady_clock::now() - holding_since >= multicast_.gap_timeout) {
+                arbiter_.expire(deliver, gap);
+                publishArbiterStats();
+            }
+            continue;
+        }
+        
+        drained = true;
+        packets.clear();
+        for (size_t l = 0; l < line_count_; ++l) {
+            auto* first = &messages[l * batch];
+            for (size_t i = 0; i < batch; ++i) {
+                first[i] = mmsghdr{};
+                first[i].msg_hdr.msg_iov = &iov[l * batch + i];
+                first[i].msg_hdr.msg_iovlen = 1;
+            }
+            int received = ::recvmmsg(fds_[l], first, static_cast<unsigned>(batch), MSG_DONTWAIT, nullptr);
+            if (received <= 0) {
+                continue;
+            }
+            bump(counters_.receive_calls);
+            bump(counters_.packets[l], static_cast<uint64_t>(received));
+            if (static_cast<size_t>(received) == batch) {
+                drained = false;
+            }
             
-            // TODO: Replace with actual WebSocket message handling
-            std::cout << "WebSocket feed: simulated message processing" << std::endl;
+            for (int i = 0; i < received; ++i) {
+                const auto* data = static_cast<const char*>(first[i].msg_hdr.msg_iov->iov_base);
+                const auto* header = reinterpret_cast<const PacketHeader*>(data);
+                size_t length = first[i].msg_len;
+                if ((first[i].msg_hdr.msg_flags & MSG_TRUNC) || length < sizeof(PacketHeader) ||
+                    header->magic != PacketHeader::kMagic ||
+                    length != sizeof(PacketHeader) + header->event_count * sizeof(MarketDataEvent)) {
+                    bump(counters_.malformed);
+                    continue;
+                }
+                packets.push_back({header->sequence, header->event_count,
+                                   reinterpret_cast<const MarketDataEvent*>(data + sizeof(PacketHeader)), l});
+            }
+        }
+        
+        // Taking the round in sequence order lets one line fill the other's holes without holding packets back
+        std::sort(packets.begin(), packets.end(), [](const Packet& a, const Packet& b) {
+            return a.sequence < b.sequence || (a.sequence == b.sequence && a.line < b.line);
+        });
+        for (const auto& packet : packets) {
+            arbiter_.offer(packet.line, packet.sequence, packet.events, packet.count, deliver, gap);
+        }
+        
+        if (!holding && arbiter_.holding()) {
+            holding_since = std::chrono::steady_clock::now();
+        } else if (arbiter_.holding() &&
+                   std::chrono::steady_clock::now() - holding_since >= multicast_.gap_timeout) {
+            arbiter_.expire(deliver, gap);
+        }
+        publishArbiterStats();
+    }
+}
+
+void MulticastMarketDataFeed::publishArbiterStats() {
+    counters_.duplicates.store(arbiter_.duplicates(), std::memory_order_relaxed);
+    counters_.gaps.store(arbiter_.gaps(), std::memory_order_relaxed);
+    counters_.missed.store(arbiter_.missed(), std::memory_order_relaxed);
+    counters_.next_sequence.store(arbiter_.expected(), std::memory_order_relaxed);
+}
+
+// FIX market data feed implementation
+FixMarketDataFeed::FixMarketDataFeed(const FixConfig& fix, const FeedConfig& config)
+    : BaseMarketDataFeed(config),
+      fix_(fix),
+      decoder_(fix.price_decimals, fix.isa),
+      buffer_(std::max<size_t>(fix.receive_buffer, 4096)) {
+    auto colon = fix_.endpoint.rfind(':');
+    unsigned long port = 0;
+    if (colon != std::string::npos && colon > 0) {
+        try {
+            port = std::stoul(fix_.endpoint.substr(colon + 1));
+        } catch (const std::exception&) {
+            port = 0;
+        }
+    }
+    if (port == 0 || port > 65535) {
+        throw std::invalid_argument("Expected host:port, got " + fix_.endpoint);
+    }
+    host_ = fix_.endpoint.substr(0, colon);
+    port_ = static_cast<uint16_t>(port);
+    wake_fd_ = makeWakeFd();
+}
+
+FixMarketDataFeed::~FixMarketDataFeed() {
+    stop();
+    ::close(wake_fd_);
+}
+
+FixStats FixMarketDataFeed::getFixStats() const {
+    FixStats stats;
+    stats.connects = counters_.connects.load(std::memory_order_relaxed);
+    stats.disconnects = counters_.disconnects.load(std::memory_order_relaxed);
+    stats.bytes = counters_.bytes.load(std::memory_order_relaxed);
+    stats.messages = counters_.messages.load(std::memory_order_relaxed);
+    stats.events = counters_.events.load(std::memory_order_relaxed);
+    stats.checksum_errors = counters_.checksum_errors.load(std::memory_order_relaxed);
+    stats.malformed = counters_.malformed.load(std::memory_order_relaxed);
+    stats.decode_errors = counters_.decode_errors.load(std::memory_order_relaxed);
+    stats.test_requests = counters_.test_requests.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void FixMarketDataFeed::interruptIngest() {
+    signalWake(wake_fd_);
+}
+
+void FixMarketDataFeed::processMessages() {
+    auto delay = fix_.reconnect_delay;
+    while (running_.load(std::memory_order_relaxed)) {
+        int fd = connectTcp(host_, port_, wake_fd_, fix_.connect_timeout, running_);
+        if (fd >= 0) {
+            bump(counters_.connects);
+            session(fd);
+            ::close(fd);
+            if (!running_.load(std::memory_order_relaxed)) {
+                break;
+            }
+            bump(counters_.disconnects);
+            delay = fix_.reconnect_delay;
+        }
+        waitForWake(wake_fd_, delay);
+        delay = std::min<std::chrono::milliseconds>(delay * 2, std::chrono::seconds(5));
+    }
+}
+
+bool FixMarketDataFeed::sendSession(int fd, std::string_view msg_type, const std::string& fields) {
+    auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch());
+    std::string body = "49=" + fix_.sender_comp_id + kFixSoh + "56=" + fix_.target_comp_id + kFixSoh +
+                       "34=" + std::to_string(out_seq_num_++) + kFixSoh +
+                       "52=" + formatFixTime(now.count()) + kFixSoh + fields;
+    std::string message;
+    appendFixMessage(message, msg_type, body);
+    return sendAll(fd, message, running_);
+}
+
+void FixMarketDataFeed::session(int fd) {
+    const bool logon = !fix_.sender_comp_id.empty();
+    out_seq_num_ = 1;
+    if (logon) {
+        std::string fields = "98=0";
+        fields += kFixSoh;
+        fields += "108=" + std::to_string(fix_.heartbeat_interval) + kFixSoh;
+        fields += "141=Y";
+        fields += kFixSoh;
+        if (!sendSession(fd, "A", fields)) {
+            return;
+        }
+    } else {
+        connected_.store(true, std::memory_order_release);
+    }
+
+    int epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        return;
+    }
+    epoll_event watch{};
+    watch.events = EPOLLIN;
+    watch.data.fd = fd;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &watch);
+    watch.data.fd = wake_fd_;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd_, &watch);
+
+    const auto heartbeat = std::chrono::seconds(std::max(1, fix_.heartbeat_interval));
+    auto last_sent = std::chrono::steady_clock::now();
+    auto publisher = [this](const MarketDataEvent& event) { publish(event); };
+    size_t filled = 0;
+    bool alive = true;
+
+    epoll_event ready[2];
+    while (alive && running_.load(std::memory_order_relaxed)) {
+        int count = ::epoll_wait(epoll_fd, ready, 2, 100);
+        bool readable = false;
+        for (int i = 0; i < count; ++i) {
+            if (ready[i].data.fd == wake_fd_) {
+                drainWake(wake_fd_);
+            } else {
+                readable = true;
+            }
+        }
+        if (logon && std::chrono::steady_clock::now() - last_sent >= heartbeat) {
+            alive = sendSession(fd, "0", std::string());
+            last_sent = std::chrono::steady_clock::now();
         }
+
+        // Drain the socket, decoding each complete message in place
+        while (readable && alive) {
+            if (filled == buffer_.size()) {
+                if (buffer_.size() >= (64u << 20)) {
+                    alive = false;  // Nothing frames in 64 MB
+                    break;
+                }
+                buffer_.resize(buffer_.size() * 2);
+            }
+            ssize_t received = ::recv(fd, buffer_.data() + filled, buffer_.size() - filled, 0);
+            if (received < 0 && (errno == EAGAIN || errno == EINTR)) {
+                break;
+            }
+            if (received <= 0) {
+                alive = false;
+                break;
+            }
+            filled += static_cast<size_t>(received);
+            bump(counters_.bytes, static_cast<uint64_t>(received));
+
+            size_t consumed = 0;
+            while (alive) {
+                std::string_view rest(buffer_.data() + consumed, filled - consumed);
+                size_t length = fixMessageLength(rest);
+                if (length == 0) {
+                    break;
+                }
+                if (length == kFixMalformed) {
+                    // Skip to the next message start; keep a tail that could be the start of one
+                    bump(counters_.malformed);
+                    auto next = rest.find("8=FIX", 1);
+                    consumed += next == std::string_view::npos ? rest.size() - std::min<size_t>(rest.size(), 4) : next;
+                    if (next == std::string_view::npos) {
+                        break;
+                    }
+                    continue;
+                }
+
+                std::string_view message = rest.substr(0, length);
+                consumed += length;
+                if (fix_.validate_checksum && !checkFixChecksum(message, fix_.isa)) {
+                    bump(counters_.checksum_errors);
+                    continue;
+                }
+                FixHeader header;
+                size_t events = decoder_.decode(message, publisher, &header);
+                bump(counters_.messages);
+                bump(counters_.events, events);
+
+                if (logon && header.msg_type.size() == 1) {
+                    switch (header.msg_type[0]) {
+                        case 'A':
+                            connected_.store(true, std::memory_order_release);
+                            break;
+                        case '1':
+                            alive = sendSession(fd, "0", "112=" + std::string(header.test_req_id) + kFixSoh);
+                            last_sent = std::chrono::steady_clock::now();
+                            bump(counters_.test_requests);
+                            break;
+                        case '5':
+                            alive = false;  // Logout
+                            break;
+                        default:
+                            break;
+                    }
+                }
+            }
+            std::memmove(buffer_.data(), buffer_.data() + consumed, filled - consumed);
+            filled -= consumed;
+        }
+        counters_.decode_errors.store(decoder_.errors(), std::memory_order_relaxed);
     }
+
+    connected_.store(false, std::memory_order_release);
+    ::close(epoll_fd);
 }
 
 } // namespace orderbook 
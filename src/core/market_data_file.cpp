@@ -0,0 +1,122 @@
+#include "orderbook/market_data_file.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace orderbook {
+
+namespace {
+
+EventFileHeader makeHeader(uint64_t count) {
+    EventFileHeader header{};
+    std::memcpy(header.magic, EventFileHeader::kMagic, sizeof(header.magic));
+    header.version = EventFileHeader::kVersion;
+    header.record_size = sizeof(MarketDataEvent);
+    header.record_count = count;
+    return header;
+}
+
+std::runtime_error fileError(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+EventFileWriter::EventFileWriter(const std::string& path) : path_(path) {
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        throw fileError("Cannot create event file", path);
+    }
+    std::setvbuf(file_, nullptr, _IOFBF, 1 << 20);
+
+    auto header = makeHeader(0);
+    if (std::fwrite(&header, sizeof(header), 1, file_) != 1) {
+        std::fclose(file_);
+        file_ = nullptr;
+        throw fileError("Cannot write event file", path);
+    }
+}
+
+EventFileWriter::~EventFileWriter() {
+    try {
+        close();
+    } catch (...) {
+        // Destructors must not throw; the header keeps a zero count and readers use the file size
+    }
+}
+
+void EventFileWriter::write(const MarketDataEvent* events, size_t count) {
+    if (!file_) {
+        throw std::runtime_error("Event file is closed: " + path_);
+    }
+    if (std::fwrite(events, sizeof(MarketDataEvent), count, file_) != count) {
+        throw fileError("Cannot write event file", path_);
+    }
+    count_ += count;
+}
+
+void EventFileWriter::close() {
+    if (!file_) {
+        return;
+    }
+
+    auto header = makeHeader(count_);
+    bool ok = std::fseek(file_, 0, SEEK_SET) == 0 &&
+              std::fwrite(&header, sizeof(header), 1, file_) == 1;
+    ok = std::fclose(file_) == 0 && ok;
+    file_ = nullptr;
+    if (!ok) {
+        throw fileError("Cannot finish event file", path_);
+    }
+}
+
+MappedEventFile::MappedEventFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw fileError("Cannot open event file", path);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw fileError("Cannot stat event file", path);
+    }
+    length_ = static_cast<size_t>(st.st_size);
+    if (length_ < sizeof(EventFileHeader)) {
+        ::close(fd);
+        throw std::runtime_error("Not an event file: " + path);
+    }
+
+    mapping_ = ::mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping_ == MAP_FAILED) {
+        mapping_ = nullptr;
+        throw fileError("Cannot map event file", path);
+    }
+
+    const auto* header = static_cast<const EventFileHeader*>(mapping_);
+    if (std::memcmp(header->magic, EventFileHeader::kMagic, sizeof(header->magic)) != 0 ||
+        header->version != EventFileHeader::kVersion ||
+        header->record_size != sizeof(MarketDataEvent)) {
+        ::munmap(mapping_, length_);
+        mapping_ = nullptr;
+        throw std::runtime_error("Not a compatible event file: " + path);
+    }
+
+    size_t available = (length_ - sizeof(EventFileHeader)) / sizeof(MarketDataEvent);
+    count_ = header->record_count > 0 && header->record_count < available ? header->record_count : available;
+    records_ = reinterpret_cast<const MarketDataEvent*>(static_cast<const char*>(mapping_) + sizeof(EventFileHeader));
+    ::madvise(mapping_, length_, MADV_SEQUENTIAL);
+}
+
+MappedEventFile::~MappedEventFile() {
+    if (mapping_) {
+        ::munmap(mapping_, length_);
+    }
+}
+
+} // namespace orderbook
@@ -1,147 +1,107 @@
 #include "orderbook/market_data_handler.h"
+#include <algorithm>
+#include <future>
 #include <iostream>
+#include <stdexcept>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace orderbook {
 
-// Define concrete message types
-class OrderAddMessage : public MarketDataMessage {
-public:
-    OrderAddMessage(const std::string& symbol, Order::OrderId id, Order::Price price, 
-                   Order::Quantity quantity, Side side, OrderType type)
-        : MarketDataMessage(Type::ORDER_ADD),
-          symbol_(symbol),
-          id_(id),
-          price_(price),
-          quantity_(quantity),
-          side_(side),
-          type_(type) {}
-
-    const std::string& getSymbol() const { return symbol_; }
-    Order::OrderId getId() const { return id_; }
-    Order::Price getPrice() const { return price_; }
-    Order::Quantity getQuantity() const { return quantity_; }
-    Side getSide() const { return side_; }
-    OrderType getType() const { return type_; }
-
-private:
-    std::string symbol_;
-    Order::OrderId id_;
-    Order::Price price_;
-    Order::Quantity quantity_;
-    Side side_;
-    OrderType type_;
-};
-
-class OrderModifyMessage : public MarketDataMessage {
-public:
-    OrderModifyMessage(const std::string& symbol, Order::OrderId id, 
-                      Order::Price new_price, Order::Quantity new_quantity)
-        : MarketDataMessage(Type::ORDER_MODIFY),
-          symbol_(symbol),
-          id_(id),
-          new_price_(new_price),
-          new_quantity_(new_quantity) {}
-
-    const std::string& getSymbol() const { return symbol_; }
-    Order::OrderId getId() const { return id_; }
-    Order::Price getNewPrice() const { return new_price_; }
-    Order::Quantity getNewQuantity() const { return new_quantity_; }
-
-private:
-    std::string symbol_;
-    Order::OrderId id_;
-    Order::Price new_price_;
-    Order::Quantity new_quantity_;
-};
-
-class OrderCancelMessage : public MarketDataMessage {
-public:
-    OrderCancelMessage(const std::string& symbol, Order::OrderId id)
-        : MarketDataMessage(Type::ORDER_CANCEL),
-          symbol_(symbol),
-          id_(id) {}
-
-    const std::string& getSymbol() const { return symbol_; }
-    Order::OrderId getId() const { return id_; }
-
-private:
-    std::string symbol_;
-    Order::OrderId id_;
-};
-
-class TradeMessage : public MarketDataMessage {
-public:
-    TradeMessage(const std::string& symbol, Trade::TradeId id, Trade::Price price,
-                Trade::Quantity quantity, Trade::OrderId buy_order_id, 
-                Trade::OrderId sell_order_id)
-        : MarketDataMessage(Type::TRADE),
-          symbol_(symbol),
-          id_(id),
-          price_(price),
-          quantity_(quantity),
-          buy_order_id_(buy_order_id),
-          sell_order_id_(sell_order_id) {}
-
-    const std::string& getSymbol() const { return symbol_; }
-    Trade::TradeId getId() const { return id_; }
-    Trade::Price getPrice() const { return price_; }
-    Trade::Quantity getQuantity() const { return quantity_; }
-    Trade::OrderId getBuyOrderId() const { return buy_order_id_; }
-    Trade::OrderId getSellOrderId() const { return sell_order_id_; }
-
-private:
-    std::string symbol_;
-    Trade::TradeId id_;
-    Trade::Price price_;
-    Trade::Quantity quantity_;
-    Trade::OrderId buy_order_id_;
-    Trade::OrderId sell_order_id_;
-};
+// Adapter for handlers that only implement the polymorphic interface
+void MarketDataHandler::handleEvent(const MarketDataEvent& event) {
+    const auto& symbol = SymbolRegistry::instance().name(event.symbol_id);
+    
+    switch (event.type) {
+        case MarketDataEvent::Type::ORDER_ADD:
+            handleMessage(OrderAddMessage(symbol, event.add.order_id, event.add.price,
+                                          event.add.quantity, event.add.side, event.add.order_type));
+            break;
+        case MarketDataEvent::Type::ORDER_MODIFY:
+            handleMessage(OrderModifyMessage(symbol, event.modify.order_id,
+                                             event.modify.price, event.modify.quantity));
+            break;
+        case MarketDataEvent::Type::ORDER_CANCEL:
+            handleMessage(OrderCancelMessage(symbol, event.cancel.order_id));
+            break;
+        case MarketDataEvent::Type::TRADE:
+            handleMessage(TradeMessage(symbol, event.trade.trade_id, event.trade.price, event.trade.quantity,
+                                       event.trade.buy_order_id, event.trade.sell_order_id));
+            break;
+        case MarketDataEvent::Type::HEARTBEAT:
+            handleMessage(MarketDataMessage(MarketDataMessage::Type::HEARTBEAT));
+            break;
+        case MarketDataEvent::Type::SNAPSHOT:
+            handleMessage(MarketDataMessage(MarketDataMessage::Type::SNAPSHOT));
+            break;
+        case MarketDataEvent::Type::ORDER_EXECUTE:
+        case MarketDataEvent::Type::SYMBOL:
+            break;
+    }
+}
 
 MarketDataHandlerImpl::MarketDataHandlerImpl() {}
 
-void MarketDataHandlerImpl::handleMessage(const MarketDataMessage& message) {
+void MarketDataHandlerImpl::handleEvent(const MarketDataEvent& event) {
+    if (event.type == MarketDataEvent::Type::HEARTBEAT) {
+        return;
+    }
+    if (recovering_.load(std::memory_order_acquire) > 0 && holdForRecovery(event)) {
+        return;
+    }
+    
+    auto guard = epoch_.read();
+    auto* book = routes_.find(event.symbol_id);
+    if (book) {
+        applyEvent(*book, event);
+    }
+}
+
+void applyEvent(OrderBook& book, const MarketDataEvent& event) {
     try {
-        switch (message.getType()) {
-            case MarketDataMessage::Type::ORDER_ADD: {
-                const auto& order_add = dynamic_cast<const OrderAddMessage&>(message);
-                auto book = getOrderBook(order_add.getSymbol());
-                if (book) {
-                    Order order(order_add.getId(), order_add.getSymbol(), 
-                               order_add.getPrice(), order_add.getQuantity(),
-                               order_add.getSide(), order_add.getType(), 
-                               std::chrono::high_resolution_clock::now().time_since_epoch());
-                    book->addOrder(order);
+        switch (event.type) {
+            case MarketDataEvent::Type::ORDER_ADD: {
+                const auto& add = event.add;
+                Order order(add.order_id, event.symbol_id, add.price, add.quantity,
+                            add.side, add.order_type, event.timestamp, add.stop_price);
+                if (add.trade_limit > 0) {
+                    // Repeat a bounded add from a journal, which may have stopped matching early
+                    thread_local std::vector<Trade> trades;
+                    trades.resize(add.trade_limit);
+                    book.addOrder(order, trades.data(), trades.size());
+                } else {
+                    book.addOrder(order);
                 }
                 break;
             }
-            case MarketDataMessage::Type::ORDER_MODIFY: {
-                const auto& order_modify = dynamic_cast<const OrderModifyMessage&>(message);
-                auto book = getOrderBook(order_modify.getSymbol());
-                if (book) {
-                    book->modifyOrder(order_modify.getId(), 
-                                     order_modify.getNewPrice(), 
-                                     order_modify.getNewQuantity());
-                }
+            case MarketDataEvent::Type::ORDER_MODIFY:
+                book.modifyOrder(event.modify.order_id, event.modify.price, event.modify.quantity, event.timestamp);
                 break;
-            }
-            case MarketDataMessage::Type::ORDER_CANCEL: {
-                const auto& order_cancel = dynamic_cast<const OrderCancelMessage&>(message);
-                auto book = getOrderBook(order_cancel.getSymbol());
-                if (book) {
-                    book->cancelOrder(order_cancel.getId());
+            case MarketDataEvent::Type::ORDER_CANCEL:
+                book.cancelOrder(event.cancel.order_id, event.timestamp);
+                break;
+            case MarketDataEvent::Type::ORDER_EXECUTE:
+                book.executeOrder(event.execute.order_id, event.execute.quantity, event.timestamp);
+                break;
+            case MarketDataEvent::Type::SNAPSHOT: {
+                const auto& snapshot = event.snapshot;
+                if (event.flags & MarketDataEvent::kSnapshotBegin) {
+                    book.clear();
+                }
+                if (snapshot.quantity > 0) {
+                    book.addOrder(Order(snapshot.order_id, event.symbol_id, snapshot.price, snapshot.quantity,
+                                        snapshot.side, OrderType::LIMIT, event.timestamp));
                 }
                 break;
             }
-            case MarketDataMessage::Type::TRADE: {
+            case MarketDataEvent::Type::TRADE:
                 // Trades are usually handled directly by the matching engine
                 // But for external trades, we might need to update our state
-                const auto& trade_msg = dynamic_cast<const TradeMessage&>(message);
-                // Process the trade as needed
                 break;
-            }
-            default:
-                std::cerr << "Unknown message type" << std::endl;
+            case MarketDataEvent::Type::HEARTBEAT:
+            case MarketDataEvent::Type::SYMBOL:
                 break;
         }
     } catch (const std::exception& e) {
@@ -150,24 +110,469 @@ void MarketDataHandlerImpl::handleMessage(const MarketDataMessage& message) {
 }
 
 void MarketDataHandlerImpl::registerOrderBook(const std::string& symbol, std::shared_ptr<OrderBook> book) {
+    auto symbol_id = SymbolRegistry::instance().intern(symbol);
     std::lock_guard<std::mutex> lock(mutex_);
-    order_books_[symbol] = book;
+    routes_.set(symbol_id, book.get());
+    auto& entry = order_books_[symbol_id];
+    if (entry) {
+        retireBook(std::move(entry));
+    }
+    entry = std::move(book);
 }
 
 void MarketDataHandlerImpl::unregisterOrderBook(const std::string& symbol) {
+    SymbolId symbol_id;
+    if (!SymbolRegistry::instance().find(symbol, symbol_id)) {
+        return;
+    }
     std::lock_guard<std::mutex> lock(mutex_);
-    order_books_.erase(symbol);
+    auto it = order_books_.find(symbol_id);
+    if (it == order_books_.end()) {
+        return;
+    }
+    routes_.erase(symbol_id);
+    retireBook(std::move(it->second));
+    order_books_.erase(it);
+}
+
+bool MarketDataHandlerImpl::holdForRecovery(const MarketDataEvent& event) {
+    std::lock_guard<std::mutex> lock(recovery_mutex_);
+    auto it = recovery_.find(event.symbol_id);
+    if (it == recovery_.end()) {
+        return false;
+    }
+    it->second.push_back(event);
+    return true;
+}
+
+void MarketDataHandlerImpl::beginRecovery(SymbolId symbol_id) {
+    std::lock_guard<std::mutex> lock(recovery_mutex_);
+    if (recovery_.try_emplace(symbol_id).second) {
+        recovering_.fetch_add(1, std::memory_order_release);
+    }
+}
+
+size_t MarketDataHandlerImpl::completeRecovery(SymbolId symbol_id, std::string_view snapshot) {
+    auto book = getOrderBook(symbol_id);
+    if (!book) {
+        throw std::invalid_argument("No order book registered for " + SymbolRegistry::instance().name(symbol_id));
+    }
+    {
+        std::lock_guard<std::mutex> lock(recovery_mutex_);
+        if (recovery_.find(symbol_id) == recovery_.end()) {
+            throw std::invalid_argument("Not recovering " + book->getSymbol());
+        }
+    }
+    
+    // The feed keeps buffering while the snapshot loads and while earlier
+    // batches are applied; the symbol goes live once a batch comes back empty
+    uint64_t sequence = book->loadSnapshot(snapshot);
+    size_t applied = 0;
+    std::vector<MarketDataEvent> pending;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(recovery_mutex_);
+            auto it = recovery_.find(symbol_id);
+            pending.swap(it->second);
+            if (pending.empty()) {
+                recovery_.erase(it);
+                recovering_.fetch_sub(1, std::memory_order_release);
+                break;
+            }
+        }
+        for (const auto& event : pending) {
+            if (sequence == 0 || event.sequence > sequence) {
+                applyEvent(*book, event);
+                ++applied;
+            }
+        }
+        pending.clear();
+    }
+    return applied;
+}
+
+// Drop our reference once no event can still be using the book
+void MarketDataHandlerImpl::retireBook(std::shared_ptr<OrderBook> book) {
+    epoch_.retire(new std::shared_ptr<OrderBook>(std::move(book)));
 }
 
 std::shared_ptr<OrderBook> MarketDataHandlerImpl::getOrderBook(const std::string& symbol) {
+    SymbolId symbol_id;
+    if (!SymbolRegistry::instance().find(symbol, symbol_id)) {
+        return nullptr;
+    }
+    return getOrderBook(symbol_id);
+}
+
+std::shared_ptr<OrderBook> MarketDataHandlerImpl::getOrderBook(SymbolId symbol_id) {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto it = order_books_.find(symbol);
+    auto it = order_books_.find(symbol_id);
     if (it != order_books_.end()) {
         return it->second;
     }
     return nullptr;
 }
 
+namespace {
+
+// Number of events a shard worker takes from its queue at a time
+constexpr size_t kShardBatch = 64;
+
+// Counters have a single writer, so a plain load and store is enough
+inline void bump(std::atomic<uint64_t>& counter, uint64_t by = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+// Pin a thread to one CPU; returns the CPU, or -1 if it was not pinned
+int pinThread(std::thread& thread, int cpu) {
+#ifdef __linux__
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0) {
+            return cpu;
+        }
+    }
+#else
+    (void)thread;
+    (void)cpu;
+#endif
+    return -1;
+}
+
+} // namespace
+
+/**
+ * @brief A symbol's book and where it currently lives
+ */
+struct ShardedMarketDataHandler::SymbolState {
+    std::shared_ptr<OrderBook> book;
+    std::atomic<size_t> shard{0};    // Changed under mutex_; read by the feed thread
+    std::atomic<uint64_t> events{0}; // Written by the owning worker
+    uint64_t load_baseline = 0;      // Guarded by mutex_
+};
+
+/**
+ * @brief One worker thread, its queue and the books it owns
+ */
+struct ShardedMarketDataHandler::Shard {
+    Shard(const ShardedHandlerConfig& config, int cpu_request)
+        : queue(config.queue_capacity),
+          waiter(config.wait_strategy, config.spin_iterations),
+          producer_waiter(config.wait_strategy, config.spin_iterations),
+          worker(&Shard::run, this) {
+        cpu = pinThread(worker, cpu_request);
+    }
+
+    ~Shard() {
+        waiter.notifyAfter([this] { running = false; });
+        worker.join();
+    }
+
+    void run() {
+        MarketDataEvent batch[kShardBatch];
+        uint32_t spins = 0;
+        
+        while (true) {
+            if (commands_pending.load(std::memory_order_acquire)) {
+                runCommands();
+            }
+            
+            size_t count = queue.popBatch(batch, kShardBatch);
+            if (count == 0) {
+                if (!running.load(std::memory_order_acquire) && queue.empty()) {
+                    break;
+                }
+                waiter.idle(spins, [this] {
+                    return !queue.empty() || !running.load(std::memory_order_relaxed) ||
+                           commands_pending.load(std::memory_order_relaxed);
+                });
+                continue;
+            }
+            
+            spins = 0;
+            producer_waiter.notify();
+            for (size_t i = 0; i < count; ++i) {
+                auto it = books.find(batch[i].symbol_id);
+                if (it != books.end()) {
+                    applyEvent(*it->second->book, batch[i]);
+                    bump(it->second->events);
+                }
+            }
+            bump(applied, count);
+        }
+    }
+
+    void runCommands() {
+        std::vector<std::function<void()>> pending;
+        {
+            std::lock_guard<std::mutex> lock(command_mutex);
+            pending.swap(commands);
+            commands_pending.store(false, std::memory_order_relaxed);
+        }
+        for (auto& command : pending) {
+            command();
+        }
+    }
+
+    int cpu = -1;
+    SpscQueue<MarketDataEvent> queue;
+    QueueWaiter waiter;           // Worker waiting for events or commands
+    QueueWaiter producer_waiter;  // Feed thread waiting for space
+    std::atomic<bool> running{true};
+
+    // Control operations run on the worker between batches
+    std::mutex command_mutex;
+    std::vector<std::function<void()>> commands;
+    std::atomic<bool> commands_pending{false};
+
+    // Books owned by this worker; only touched on the worker thread
+    std::unordered_map<SymbolId, SymbolState*> books;
+
+    // Written by the feed thread
+    alignas(64) std::atomic<uint64_t> pushed{0};
+    std::atomic<uint64_t> backpressure_waits{0};
+
+    // Written by the worker
+    alignas(64) std::atomic<uint64_t> applied{0};
+    uint64_t load_baseline = 0;  // Guarded by the handler's mutex_
+
+    std::thread worker;
+};
+
+ShardedMarketDataHandler::ShardedMarketDataHandler(const ShardedHandlerConfig& config)
+    : config_(config) {
+    size_t count = std::max<size_t>(config_.shards, 1);
+    for (size_t i = 0; i < count; ++i) {
+        int cpu = i < config_.cpus.size() ? config_.cpus[i] : -1;
+        shards_.push_back(std::make_unique<Shard>(config_, cpu));
+    }
+}
+
+ShardedMarketDataHandler::~ShardedMarketDataHandler() {
+    // Workers finish their queues before the books they refer to go away
+    shards_.clear();
+}
+
+void ShardedMarketDataHandler::handleEvent(const MarketDataEvent& event) {
+    if (event.type == MarketDataEvent::Type::HEARTBEAT) {
+        return;
+    }
+    
+    Shard* shard;
+    {
+        auto guard = epoch_.read();
+        auto* state = routes_.find(event.symbol_id);
+        if (state == nullptr) {
+            return;
+        }
+        shard = shards_[state->shard.load(std::memory_order_relaxed)].get();
+    }
+    
+    if (!shard->queue.tryPush(event)) {
+        bump(shard->backpressure_waits);
+        uint32_t spins = 0;
+        while (!shard->queue.tryPush(event)) {
+            shard->producer_waiter.idle(spins, [shard] {
+                return shard->queue.size() < shard->queue.capacity();
+            });
+        }
+    }
+    bump(shard->pushed);
+    shard->waiter.notify();
+}
+
+std::shared_ptr<OrderBook> ShardedMarketDataHandler::addSymbol(const std::string& symbol) {
+    auto symbol_id = SymbolRegistry::instance().intern(symbol);
+    size_t shard = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = symbols_.find(symbol_id);
+        if (it != symbols_.end()) {
+            return it->second->book;
+        }
+        
+        std::vector<size_t> counts(shards_.size(), 0);
+        for (const auto& entry : symbols_) {
+            ++counts[entry.second->shard];
+        }
+        shard = std::min_element(counts.begin(), counts.end()) - counts.begin();
+    }
+    return addSymbol(symbol, shard);
+}
+
+std::shared_ptr<OrderBook> ShardedMarketDataHandler::addSymbol(const std::string& symbol, size_t shard) {
+    if (shard >= shards_.size()) {
+        throw std::out_of_range("ShardedMarketDataHandler: no shard " + std::to_string(shard));
+    }
+    
+    auto symbol_id = SymbolRegistry::instance().intern(symbol);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = symbols_.find(symbol_id);
+    if (it != symbols_.end()) {
+        return it->second->book;
+    }
+    
+    auto book_config = config_.book_config;
+    book_config.single_writer = true;
+    auto state = std::make_unique<SymbolState>();
+    state->book = std::make_shared<OrderBook>(symbol, book_config);
+    state->shard = shard;
+    
+    // The worker must own the book before the feed thread can route to it
+    auto* raw = state.get();
+    auto& owner = *shards_[shard];
+    runOnShard(owner, [&owner, symbol_id, raw] { owner.books[symbol_id] = raw; });
+    symbols_.emplace(symbol_id, std::move(state));
+    routes_.set(symbol_id, raw);
+    return raw->book;
+}
+
+std::shared_ptr<OrderBook> ShardedMarketDataHandler::getOrderBook(SymbolId symbol_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = symbols_.find(symbol_id);
+    return it != symbols_.end() ? it->second->book : nullptr;
+}
+
+std::shared_ptr<OrderBook> ShardedMarketDataHandler::getOrderBook(const std::string& symbol) const {
+    SymbolId symbol_id;
+    if (!SymbolRegistry::instance().find(symbol, symbol_id)) {
+        return nullptr;
+    }
+    return getOrderBook(symbol_id);
+}
+
+size_t ShardedMarketDataHandler::shardOf(SymbolId symbol_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = symbols_.find(symbol_id);
+    return it != symbols_.end() ? it->second->shard.load() : shards_.size();
+}
+
+void ShardedMarketDataHandler::drain() {
+    for (auto& shard : shards_) {
+        while (shard->applied.load(std::memory_order_acquire) < shard->pushed.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+std::vector<ShardLoad> ShardedMarketDataHandler::getShardLoad() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<ShardLoad> loads(shards_.size());
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        const auto& shard = *shards_[i];
+        loads[i].shard = i;
+        loads[i].cpu = shard.cpu;
+        loads[i].events = shard.applied.load(std::memory_order_relaxed) - shard.load_baseline;
+        loads[i].backpressure_waits = shard.backpressure_waits.load(std::memory_order_relaxed);
+        loads[i].queue_depth = shard.queue.size();
+    }
+    for (const auto& entry : symbols_) {
+        ++loads[entry.second->shard].symbols;
+    }
+    return loads;
+}
+
+std::vector<SymbolLoad> ShardedMarketDataHandler::getSymbolLoad() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<SymbolLoad> loads;
+    loads.reserve(symbols_.size());
+    for (const auto& entry : symbols_) {
+        const auto& state = *entry.second;
+        loads.push_back({entry.first, state.shard.load(),
+                         state.events.load(std::memory_order_relaxed) - state.load_baseline});
+    }
+    std::sort(loads.begin(), loads.end(), [](const SymbolLoad& a, const SymbolLoad& b) {
+        return a.events != b.events ? a.events > b.events : a.symbol_id < b.symbol_id;
+    });
+    return loads;
+}
+
+void ShardedMarketDataHandler::resetLoad() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& shard : shards_) {
+        shard->load_baseline = shard->applied.load(std::memory_order_relaxed);
+    }
+    for (auto& entry : symbols_) {
+        entry.second->load_baseline = entry.second->events.load(std::memory_order_relaxed);
+    }
+}
+
+bool ShardedMarketDataHandler::moveSymbol(SymbolId symbol_id, size_t shard) {
+    if (shard >= shards_.size()) {
+        throw std::out_of_range("ShardedMarketDataHandler: no shard " + std::to_string(shard));
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = symbols_.find(symbol_id);
+    if (it == symbols_.end()) {
+        return false;
+    }
+    drain();
+    moveSymbolLocked(*it->second, shard);
+    return true;
+}
+
+size_t ShardedMarketDataHandler::rebalance() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    drain();
+    
+    auto loads = std::vector<std::pair<uint64_t, SymbolState*>>();
+    for (auto& entry : symbols_) {
+        auto& state = *entry.second;
+        loads.emplace_back(state.events.load(std::memory_order_relaxed) - state.load_baseline, &state);
+    }
+    std::sort(loads.begin(), loads.end(), [](const auto& a, const auto& b) {
+        if (a.first != b.first) {
+            return a.first > b.first;
+        }
+        return a.second->book->getSymbolId() < b.second->book->getSymbolId();
+    });
+    
+    // Longest-processing-time-first: each symbol goes to the least loaded shard
+    // so far, ties going to the shard with fewer symbols
+    std::vector<std::pair<uint64_t, size_t>> totals(shards_.size());
+    size_t moved = 0;
+    for (auto& [events, state] : loads) {
+        size_t target = std::min_element(totals.begin(), totals.end()) - totals.begin();
+        totals[target].first += events;
+        ++totals[target].second;
+        if (state->shard != target) {
+            moveSymbolLocked(*state, target);
+            ++moved;
+        }
+    }
+    return moved;
+}
+
+void ShardedMarketDataHandler::runOnShard(Shard& shard, std::function<void()> command) {
+    std::promise<void> done;
+    auto finished = done.get_future();
+    {
+        std::lock_guard<std::mutex> lock(shard.command_mutex);
+        shard.commands.push_back([&command, &done] {
+            command();
+            done.set_value();
+        });
+    }
+    shard.waiter.notifyAfter([&shard] { shard.commands_pending = true; });
+    finished.wait();
+}
+
+void ShardedMarketDataHandler::moveSymbolLocked(SymbolState& state, size_t shard) {
+    if (state.shard == shard) {
+        return;
+    }
+    
+    auto symbol_id = state.book->getSymbolId();
+    auto& from = *shards_[state.shard];
+    auto& to = *shards_[shard];
+    runOnShard(from, [&from, symbol_id] { from.books.erase(symbol_id); });
+    runOnShard(to, [&to, symbol_id, &state] { to.books[symbol_id] = &state; });
+    state.shard.store(shard, std::memory_order_relaxed);
+}
+
 std::shared_ptr<MarketDataHandlerImpl> MarketDataHandlerFactory::createHandler(std::shared_ptr<MarketDataFeed> feed) {
     auto handler = std::make_shared<MarketDataHandlerImpl>();
     feed->registerHandler(handler.get());
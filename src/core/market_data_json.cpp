@@ -0,0 +1,412 @@
+#include "orderbook/market_data_json.h"
+#include <charconv>
+
+namespace orderbook {
+
+namespace {
+
+// Read a string at p, without decoding escapes; value excludes the quotes
+bool readString(const char*& p, const char* end, std::string_view& value) {
+    if (p == end || *p != '"') {
+        return false;
+    }
+    const char* start = ++p;
+    while (p < end && *p != '"') {
+        p += *p == '\\' ? 2 : 1;
+    }
+    if (p >= end) {
+        return false;
+    }
+    value = std::string_view(start, static_cast<size_t>(p - start));
+    ++p;
+    return true;
+}
+
+// Whole digits a number may have, so the digits cannot overflow (as for FIX prices)
+constexpr int kMaxWholeDigits = 18;
+
+// Read a number, quoted or not, as an integer scaled by 10^decimals (extra fraction digits are dropped).
+// Fails rather than overflow if the number is too large for int64_t once scaled.
+bool readNumber(const char*& p, const char* end, int decimals, int64_t scale, int64_t& value) {
+    bool quoted = p < end && *p == '"';
+    if (quoted) {
+        ++p;
+    }
+    bool negative = p < end && *p == '-';
+    if (negative) {
+        ++p;
+    }
+
+    const char* digits = p;
+    int64_t whole = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        whole = whole * 10 + (*p++ - '0');
+        if (p - digits > kMaxWholeDigits) {
+            return false;
+        }
+    }
+    if (p == digits) {
+        return false;
+    }
+
+    int64_t fraction = 0;
+    int places = 0;
+    if (p < end && *p == '.') {
+        ++p;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (places < decimals) {
+                fraction = fraction * 10 + (*p - '0');
+                ++places;
+            }
+            ++p;
+        }
+    }
+    for (; places < decimals; ++places) {
+        fraction *= 10;
+    }
+
+    if (quoted) {
+        if (p == end || *p != '"') {
+            return false;
+        }
+        ++p;
+    }
+    if (__builtin_mul_overflow(whole, scale, &value) || __builtin_add_overflow(value, fraction, &value)) {
+        return false;
+    }
+    if (negative) {
+        value = -value;
+    }
+    return true;
+}
+
+// Read an ID, quantity, sequence number or timestamp, which may not be negative
+bool readInteger(const char*& p, const char* end, uint64_t& value) {
+    const char* sign = p < end && *p == '"' ? p + 1 : p;
+    if (sign < end && *sign == '-') {
+        return false;
+    }
+    int64_t number = 0;
+    if (!readNumber(p, end, 0, 1, number)) {
+        return false;
+    }
+    value = static_cast<uint64_t>(number);
+    return true;
+}
+
+bool parseOrderType(std::string_view name, OrderType& type) {
+    if (name == "limit") {
+        type = OrderType::LIMIT;
+    } else if (name == "market") {
+        type = OrderType::MARKET;
+    } else if (name == "stop") {
+        type = OrderType::STOP;
+    } else if (name == "stop_limit") {
+        type = OrderType::STOP_LIMIT;
+    } else if (name == "ioc") {
+        type = OrderType::IOC;
+    } else if (name == "fok") {
+        type = OrderType::FOK;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* orderTypeName(OrderType type) {
+    switch (type) {
+        case OrderType::MARKET: return "market";
+        case OrderType::STOP: return "stop";
+        case OrderType::STOP_LIMIT: return "stop_limit";
+        case OrderType::IOC: return "ioc";
+        case OrderType::FOK: return "fok";
+        default: return "limit";
+    }
+}
+
+void appendInteger(std::string& out, int64_t value) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+void appendPrice(std::string& out, int64_t price, int decimals) {
+    if (decimals == 0) {
+        appendInteger(out, price);
+        return;
+    }
+    int64_t scale = 1;
+    for (int i = 0; i < decimals; ++i) {
+        scale *= 10;
+    }
+    out += '"';
+    if (price < 0) {
+        out += '-';
+        price = -price;
+    }
+    appendInteger(out, price / scale);
+    out += '.';
+    auto fraction = std::to_string(price % scale);
+    out.append(static_cast<size_t>(decimals) - fraction.size(), '0');
+    out += fraction;
+    out += '"';
+}
+
+} // namespace
+
+JsonEventDecoder::JsonEventDecoder(int price_decimals) : price_decimals_(price_decimals), price_scale_(1) {
+    for (int i = 0; i < price_decimals_; ++i) {
+        price_scale_ *= 10;
+    }
+}
+
+bool JsonEventDecoder::decodeOne(std::string_view text, MarketDataEvent& event) {
+    bool found = false;
+    decode(text, [&](const MarketDataEvent& decoded) {
+        if (!found) {
+            event = decoded;
+            found = true;
+        }
+    });
+    return found;
+}
+
+bool JsonEventDecoder::decodeObject(const char*& p, const char* end, MarketDataEvent& event) {
+    const char* start = p;
+    auto fail = [&] {
+        p = start;
+        return false;
+    };
+    if (p == end || *p != '{') {
+        return fail();
+    }
+    ++p;
+
+    std::string_view type;
+    std::string_view symbol_name;
+    std::string_view side_name;
+    std::string_view order_type_name;
+    uint64_t id = 0, quantity = 0, trade_id = 0, buy_id = 0, sell_id = 0, sequence = 0, timestamp = 0;
+    int64_t price = 0, stop_price = 0;
+
+    while (true) {
+        skipSpace(p, end);
+        if (p == end) {
+            return fail();
+        }
+        if (*p == '}') {
+            ++p;
+            break;
+        }
+        if (*p == ',') {
+            ++p;
+            continue;
+        }
+
+        std::string_view key;
+        if (!readString(p, end, key)) {
+            return fail();
+        }
+        skipSpace(p, end);
+        if (p == end || *p != ':') {
+            return fail();
+        }
+        ++p;
+        skipSpace(p, end);
+
+        bool parsed;
+        if (key == "type") {
+            parsed = readString(p, end, type);
+        } else if (key == "symbol") {
+            parsed = readString(p, end, symbol_name);
+        } else if (key == "id") {
+            parsed = readInteger(p, end, id);
+        } else if (key == "price") {
+            parsed = readNumber(p, end, price_decimals_, price_scale_, price);
+        } else if (key == "qty") {
+            parsed = readInteger(p, end, quantity);
+        } else if (key == "side") {
+            parsed = readString(p, end, side_name);
+        } else if (key == "seq") {
+            parsed = readInteger(p, end, sequence);
+        } else if (key == "ts") {
+            parsed = readInteger(p, end, timestamp);
+        } else if (key == "trade_id") {
+            parsed = readInteger(p, end, trade_id);
+        } else if (key == "buy_id") {
+            parsed = readInteger(p, end, buy_id);
+        } else if (key == "sell_id") {
+            parsed = readInteger(p, end, sell_id);
+        } else if (key == "order_type") {
+            parsed = readString(p, end, order_type_name);
+        } else if (key == "stop_price") {
+            parsed = readNumber(p, end, price_decimals_, price_scale_, stop_price);
+        } else {
+            parsed = skipValue(p, end);
+        }
+        if (!parsed) {
+            return fail();
+        }
+    }
+
+    SymbolId symbol_id = symbol_name.empty() ? 0 : symbol(symbol_name);
+    MarketDataEvent::Timestamp ts(static_cast<int64_t>(timestamp));
+    if (type == "add") {
+        Side side;
+        if (side_name == "buy" || side_name == "BUY") {
+            side = Side::BUY;
+        } else if (side_name == "sell" || side_name == "SELL") {
+            side = Side::SELL;
+        } else {
+            return fail();
+        }
+        OrderType order_type = OrderType::LIMIT;
+        if (!order_type_name.empty() && !parseOrderType(order_type_name, order_type)) {
+            return fail();
+        }
+        event = MarketDataEvent::orderAdd(symbol_id, id, price, quantity, side, order_type, ts, stop_price);
+    } else if (type == "modify") {
+        event = MarketDataEvent::orderModify(symbol_id, id, price, quantity, ts);
+    } else if (type == "cancel") {
+        event = MarketDataEvent::orderCancel(symbol_id, id, ts);
+    } else if (type == "execute") {
+        event = MarketDataEvent::orderExecute(symbol_id, id, quantity, trade_id, ts);
+    } else if (type == "trade") {
+        event = MarketDataEvent::tradePrint(symbol_id, trade_id, price, quantity, buy_id, sell_id, ts);
+    } else if (type == "heartbeat") {
+        event = MarketDataEvent::heartbeat(ts);
+        event.symbol_id = symbol_id;
+    } else {
+        return fail();
+    }
+    event.sequence = sequence;
+    return true;
+}
+
+bool JsonEventDecoder::skipValue(const char*& p, const char* end) {
+    skipSpace(p, end);
+    if (p == end) {
+        return false;
+    }
+    if (*p == '"') {
+        std::string_view ignored;
+        return readString(p, end, ignored);
+    }
+    if (*p == '{' || *p == '[') {
+        // Skip to the matching bracket, stepping over strings
+        int depth = 0;
+        while (p < end) {
+            char c = *p;
+            if (c == '"') {
+                std::string_view ignored;
+                if (!readString(p, end, ignored)) {
+                    return false;
+                }
+                continue;
+            }
+            ++p;
+            if (c == '{' || c == '[') {
+                ++depth;
+            } else if ((c == '}' || c == ']') && --depth == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+    // Number, true, false or null
+    const char* start = p;
+    while (p < end && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\n' && *p != '\r' && *p != '\t') {
+        ++p;
+    }
+    return p != start;
+}
+
+void appendJson(std::string& out, const MarketDataEvent& event, int price_decimals) {
+    auto field = [&out](const char* key) {
+        out += ",\"";
+        out += key;
+        out += "\":";
+    };
+
+    out += "{\"type\":\"";
+    switch (event.type) {
+        case MarketDataEvent::Type::ORDER_ADD: out += "add"; break;
+        case MarketDataEvent::Type::ORDER_MODIFY: out += "modify"; break;
+        case MarketDataEvent::Type::ORDER_CANCEL: out += "cancel"; break;
+        case MarketDataEvent::Type::ORDER_EXECUTE: out += "execute"; break;
+        case MarketDataEvent::Type::TRADE: out += "trade"; break;
+        default: out += "heartbeat"; break;
+    }
+    out += '"';
+    if (event.symbol_id != 0) {
+        field("symbol");
+        out += '"';
+        out += SymbolRegistry::instance().name(event.symbol_id);
+        out += '"';
+    }
+
+    switch (event.type) {
+        case MarketDataEvent::Type::ORDER_ADD:
+            field("id");
+            appendInteger(out, static_cast<int64_t>(event.add.order_id));
+            field("price");
+            appendPrice(out, event.add.price, price_decimals);
+            field("qty");
+            appendInteger(out, static_cast<int64_t>(event.add.quantity));
+            field("side");
+            out += event.add.side == Side::BUY ? "\"buy\"" : "\"sell\"";
+            if (event.add.order_type != OrderType::LIMIT) {
+                field("order_type");
+                out += '"';
+                out += orderTypeName(event.add.order_type);
+                out += '"';
+            }
+            if (event.add.stop_price != 0) {
+                field("stop_price");
+                appendPrice(out, event.add.stop_price, price_decimals);
+            }
+            break;
+        case MarketDataEvent::Type::ORDER_MODIFY:
+            field("id");
+            appendInteger(out, static_cast<int64_t>(event.modify.order_id));
+            field("price");
+            appendPrice(out, event.modify.price, price_decimals);
+            field("qty");
+            appendInteger(out, static_cast<int64_t>(event.modify.quantity));
+            break;
+        case MarketDataEvent::Type::ORDER_CANCEL:
+            field("id");
+            appendInteger(out, static_cast<int64_t>(event.cancel.order_id));
+            break;
+        case MarketDataEvent::Type::ORDER_EXECUTE:
+            field("id");
+            appendInteger(out, static_cast<int64_t>(event.execute.order_id));
+            field("qty");
+            appendInteger(out, static_cast<int64_t>(event.execute.quantity));
+            field("trade_id");
+            appendInteger(out, static_cast<int64_t>(event.execute.trade_id));
+            break;
+        case MarketDataEvent::Type::TRADE:
+            field("trade_id");
+            appendInteger(out, static_cast<int64_t>(event.trade.trade_id));
+            field("price");
+            appendPrice(out, event.trade.price, price_decimals);
+            field("qty");
+            appendInteger(out, static_cast<int64_t>(event.trade.quantity));
+            field("buy_id");
+            appendInteger(out, static_cast<int64_t>(event.trade.buy_order_id));
+            field("sell_id");
+            appendInteger(out, static_cast<int64_t>(event.trade.sell_order_id));
+            break;
+        default:
+            break;
+    }
+
+    field("seq");
+    appendInteger(out, static_cast<int64_t>(event.sequence));
+    field("ts");
+    appendInteger(out, event.timestamp.count());
+    out += '}';
+}
+
+} // namespace orderbook
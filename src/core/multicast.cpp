@@ -0,0 +1,190 @@
+#include "orderbook/multicast.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace orderbook {
+
+namespace {
+
+std::runtime_error socketError(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+// Send every message, retrying while the socket buffer is full
+void transmit(int fd, mmsghdr* messages, size_t count) {
+    size_t done = 0;
+    while (done < count) {
+        int sent = ::sendmmsg(fd, messages + done, static_cast<unsigned>(count - done), 0);
+        if (sent < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == ENOBUFS) {
+                std::this_thread::yield();
+                continue;
+            }
+            throw socketError("sendmmsg failed");
+        }
+        done += static_cast<size_t>(sent);
+    }
+}
+
+// A UDP socket connected to address, sending multicast from interface
+int openSender(const sockaddr_in& address, const in_addr& interface, const std::string& endpoint) {
+    int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        throw socketError("Cannot create publisher socket");
+    }
+
+    int buffer = 4 << 20;
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &buffer, sizeof(buffer));
+    bool ok = true;
+    if (IN_MULTICAST(ntohl(address.sin_addr.s_addr))) {
+        unsigned char loop = 1;
+        unsigned char ttl = 1;
+        ok = ::setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &interface, sizeof(interface)) == 0 &&
+             ::setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) == 0 &&
+             ::setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) == 0;
+    }
+    ok = ok && ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+    if (!ok) {
+        auto error = socketError("Cannot set up publisher for " + endpoint);
+        ::close(fd);
+        throw error;
+    }
+    return fd;
+}
+
+} // namespace
+
+sockaddr_in parseEndpoint(const std::string& endpoint) {
+    auto colon = endpoint.rfind(':');
+    if (colon == std::string::npos) {
+        throw std::invalid_argument("Expected address:port, got " + endpoint);
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    if (::inet_pton(AF_INET, endpoint.substr(0, colon).c_str(), &address.sin_addr) != 1) {
+        throw std::invalid_argument("Invalid IPv4 address in " + endpoint);
+    }
+    unsigned long port = 0;
+    try {
+        port = std::stoul(endpoint.substr(colon + 1));
+    } catch (const std::exception&) {
+        port = 0;
+    }
+    if (port == 0 || port > 65535) {
+        throw std::invalid_argument("Invalid port in " + endpoint);
+    }
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    return address;
+}
+
+MulticastPublisher::MulticastPublisher(const PublisherConfig& config)
+    : config_(config), sequence_(config.first_sequence) {
+    config_.events_per_packet = std::max<size_t>(1, std::min(config_.events_per_packet, kMaxEventsPerPacket));
+    config_.batch = std::max<size_t>(1, config_.batch);
+
+    in_addr interface{};
+    if (::inet_pton(AF_INET, config_.interface.c_str(), &interface) != 1) {
+        throw std::invalid_argument("Invalid interface address " + config_.interface);
+    }
+
+    const std::string* endpoints[] = {&config_.line_a, &config_.line_b};
+    const uint64_t drops[] = {config_.drop_a_every, config_.drop_b_every};
+    try {
+        for (size_t i = 0; i < 2; ++i) {
+            if (!endpoints[i]->empty()) {
+                Line line;
+                line.address = parseEndpoint(*endpoints[i]);
+                line.drop_every = drops[i];
+                line.fd = openSender(line.address, interface, *endpoints[i]);
+                lines_[line_count_++] = line;
+            }
+        }
+    } catch (...) {
+        for (size_t i = 0; i < line_count_; ++i) {
+            ::close(lines_[i].fd);
+        }
+        throw;
+    }
+    if (line_count_ == 0) {
+        throw std::invalid_argument("Publisher needs at least one line");
+    }
+}
+
+MulticastPublisher::~MulticastPublisher() {
+    for (size_t i = 0; i < line_count_; ++i) {
+        ::close(lines_[i].fd);
+    }
+}
+
+void MulticastPublisher::send(const MarketDataEvent* events, size_t count) {
+    const size_t per_packet = config_.events_per_packet;
+    const size_t batch = config_.batch;
+    std::vector<PacketHeader> headers(batch);
+    std::vector<iovec> iov(batch * 2);
+    std::vector<mmsghdr> messages(batch);
+
+    const auto start = std::chrono::steady_clock::now();
+    size_t offset = 0;
+    while (offset < count) {
+        if (config_.rate > 0) {
+            auto due = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                   std::chrono::duration<double>(offset / config_.rate));
+            if (std::chrono::steady_clock::now() < due) {
+                std::this_thread::sleep_until(due);
+            }
+        }
+
+        // Packetize the next batch
+        size_t packets = 0;
+        size_t end = offset;
+        while (packets < batch && end < count) {
+            size_t n = std::min(per_packet, count - end);
+            headers[packets] = PacketHeader{PacketHeader::kMagic, static_cast<uint16_t>(n), 0,
+                                            sequence_ + (end - offset)};
+            iov[packets * 2] = {&headers[packets], sizeof(PacketHeader)};
+            iov[packets * 2 + 1] = {const_cast<MarketDataEvent*>(events + end), n * sizeof(MarketDataEvent)};
+            end += n;
+            ++packets;
+        }
+
+        // Each line sends every packet it is not told to drop
+        for (size_t l = 0; l < line_count_; ++l) {
+            size_t kept = 0;
+            for (size_t p = 0; p < packets; ++p) {
+                uint64_t number = packets_ + p + 1;
+                if (lines_[l].drop_every && number % lines_[l].drop_every == 0) {
+                    continue;
+                }
+                messages[kept] = mmsghdr{};
+                messages[kept].msg_hdr.msg_iov = &iov[p * 2];
+                messages[kept].msg_hdr.msg_iovlen = 2;
+                ++kept;
+            }
+            transmit(lines_[l].fd, messages.data(), kept);
+        }
+
+        packets_ += packets;
+        sequence_ += end - offset;
+        offset = end;
+    }
+}
+
+void MulticastPublisher::heartbeat() {
+    PacketHeader header{PacketHeader::kMagic, 0, 0, sequence_};
+    for (size_t l = 0; l < line_count_; ++l) {
+        if (::send(lines_[l].fd, &header, sizeof(header), 0) < 0) {
+            throw socketError("Cannot send heartbeat");
+        }
+    }
+}
+
+} // namespace orderbook
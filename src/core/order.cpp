@@ -3,17 +3,23 @@
 
 namespace orderbook {
 
-Order::Order(OrderId id, const std::string& symbol, Price price, Quantity quantity,
-             Side side, OrderType type, Timestamp timestamp)
+Order::Order(OrderId id, SymbolId symbol_id, Price price, Quantity quantity,
+             Side side, OrderType type, Timestamp timestamp, Price stop_price)
     : id_(id), 
-      symbol_(symbol), 
       price_(price), 
+      stop_price_(stop_price), 
       quantity_(quantity), 
       remaining_quantity_(quantity), 
+      timestamp_(timestamp), 
+      symbol_id_(symbol_id), 
       side_(side), 
       type_(type), 
-      status_(OrderStatus::NEW), 
-      timestamp_(timestamp) {}
+      status_(OrderStatus::NEW) {}
+
+Order::Order(OrderId id, const std::string& symbol, Price price, Quantity quantity,
+             Side side, OrderType type, Timestamp timestamp, Price stop_price)
+    : Order(id, SymbolRegistry::instance().intern(symbol), price, quantity, side, type, timestamp,
+            stop_price) {}
 
 void Order::fill(Quantity fill_quantity) {
     if (fill_quantity > remaining_quantity_) {
@@ -1,240 +1,555 @@
 #include "orderbook/order_book.h"
+#include "orderbook/book_snapshot.h"
+#include "orderbook/journal.h"
+#include <cassert>
 #include <stdexcept>
 #include <algorithm>
 #include <chrono>
+#include <cstring>
+#include <deque>
 
 namespace orderbook {
 
+namespace {
+
+// Per-thread trade buffers that keep their capacity between calls. A call
+// nested through a callback (e.g. a trade callback that modifies an order)
+// takes the next buffer, so it never clobbers trades an outer call is
+// still reporting.
+class ScratchTrades {
+public:
+    ScratchTrades() : depth_(depth()++) {
+        if (depth_ == buffers().size()) {
+            buffers().emplace_back();
+        }
+        buffers()[depth_].clear();
+    }
+
+    ~ScratchTrades() { --depth(); }
+
+    ScratchTrades(const ScratchTrades&) = delete;
+    ScratchTrades& operator=(const ScratchTrades&) = delete;
+
+    std::vector<Trade>& get() { return buffers()[depth_]; }
+
+private:
+    size_t depth_;
+
+    static size_t& depth() {
+        thread_local size_t depth = 0;
+        return depth;
+    }
+
+    static std::deque<std::vector<Trade>>& buffers() {
+        thread_local std::deque<std::vector<Trade>> buffers;
+        return buffers;
+    }
+};
+
+bool isStop(OrderType type) {
+    return type == OrderType::STOP || type == OrderType::STOP_LIMIT;
+}
+
+bool sameTop(const TopOfBook& a, const TopOfBook& b) {
+    return a.bid_price == b.bid_price && a.bid_size == b.bid_size &&
+           a.ask_price == b.ask_price && a.ask_size == b.ask_size;
+}
+
+bool sameLevels(const PriceLevel* a, const PriceLevel* b, uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i) {
+        if (a[i].price != b[i].price || a[i].total_quantity != b[i].total_quantity ||
+            a[i].order_count != b[i].order_count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sameDepth(const DepthSnapshot& a, const DepthSnapshot& b) {
+    return a.bid_count == b.bid_count && a.ask_count == b.ask_count &&
+           sameLevels(a.bids, b.bids, a.bid_count) && sameLevels(a.asks, b.asks, a.ask_count);
+}
+
+// The depth cache also backs the published snapshot, so it covers at least that many levels
+size_t depthCacheLevels(const OrderBookConfig& config) {
+    return std::max(config.depth_levels, std::min(config.published_levels, DepthSnapshot::kMaxLevels));
+}
+
+// The symbol is padded so that the records after it stay 8-byte aligned
+size_t paddedLength(size_t length) {
+    return (length + 7) & ~size_t(7);
+}
+
+// Orders ahead whose index slots are prefetched while loading a snapshot
+constexpr uint32_t kSnapshotPrefetch = 16;
+
+// Level queues walked together while saving a snapshot
+constexpr size_t kSnapshotLanes = 16;
+
+// Reads snapshot records in order, checking that each one is complete
+class SnapshotReader {
+public:
+    explicit SnapshotReader(std::string_view data) : data_(data) {}
+
+    template <typename T>
+    T read() {
+        T value;
+        std::memcpy(&value, skip(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    const char* skip(size_t size) {
+        if (data_.size() - offset_ < size) {
+            throw std::runtime_error("Book snapshot is truncated");
+        }
+        const char* at = data_.data() + offset_;
+        offset_ += size;
+        return at;
+    }
+
+    // A value size bytes ahead, or 0 past the end
+    template <typename T>
+    T peek(size_t ahead) const {
+        T value{};
+        if (data_.size() - offset_ >= ahead + sizeof(T)) {
+            std::memcpy(&value, data_.data() + offset_ + ahead, sizeof(T));
+        }
+        return value;
+    }
+
+    bool done() const { return offset_ == data_.size(); }
+    size_t remaining() const { return data_.size() - offset_; }
+
+private:
+    std::string_view data_;
+    size_t offset_ = 0;
+};
+
+} // namespace
+
 OrderBook::OrderBook(const std::string& symbol) 
-    : symbol_(symbol) {}
+    : OrderBook(symbol, OrderBookConfig{}) {}
 
-std::vector<Trade> OrderBook::addOrder(const Order& order) {
-    if (order.getSymbol() != symbol_) {
-        throw std::invalid_argument("Order symbol does not match order book symbol");
+OrderBook::OrderBook(const std::string& symbol, const OrderBookConfig& config)
+    : symbol_(symbol),
+      symbol_id_(SymbolRegistry::instance().intern(symbol)),
+      config_(config),
+      bids_(Side::BUY, config.storage, config.tick_size, config.ladder_levels, config.max_ladder_levels,
+            config.level_capacity, depthCacheLevels(config)),
+      asks_(Side::SELL, config.storage, config.tick_size, config.ladder_levels, config.max_ladder_levels,
+            config.level_capacity, depthCacheLevels(config)),
+      buy_stops_(Side::SELL, config.storage, config.tick_size, config.ladder_levels, config.max_ladder_levels,
+                 config.level_capacity),
+      sell_stops_(Side::BUY, config.storage, config.tick_size, config.ladder_levels, config.max_ladder_levels,
+                  config.level_capacity),
+      order_pool_(config.order_capacity),
+      order_lookup_(config.order_capacity),
+      order_flow_(config.ofi_window) {
+    if (config.storage == BookStorage::ARRAY && (config.tick_size <= 0 || config.ladder_levels == 0)) {
+        throw std::invalid_argument("ARRAY storage needs a positive tick size and ladder size");
     }
+    config_.published_levels = std::min(config_.published_levels, DepthSnapshot::kMaxLevels);
+}
 
+std::vector<Trade> OrderBook::addOrder(const Order& order) {
     std::vector<Trade> trades;
-    
-    // First check if we can match the incoming order
-    if (order.getType() == OrderType::LIMIT || order.getType() == OrderType::MARKET) {
-        trades = matchOrder(order);
+    TradeSink sink(trades);
+    addOrder(order, sink);
+    return trades;
+}
+
+size_t OrderBook::addOrder(const Order& order, Trade* trades, size_t capacity) {
+    TradeSink sink(trades, capacity);
+    addOrder(order, sink);
+    return sink.size();
+}
+
+TradeSpan OrderBook::addOrderSpan(const Order& order) {
+    ScratchTrades scratch;
+    TradeSink sink(scratch.get());
+    addOrder(order, sink);
+    return TradeSpan{sink.data(), sink.size()};
+}
+
+void OrderBook::addOrder(const Order& order, TradeSink& sink) {
+    if (order.getSymbolId() != symbol_id_) {
+        throw std::invalid_argument("Order symbol does not match order book symbol");
+    }
+    const auto type = order.getType();
+    const bool has_limit = type != OrderType::MARKET && type != OrderType::STOP;
+    if (has_limit && !bids_.isValidPrice(order.getPrice())) {
+        throw std::invalid_argument("Order price is not a multiple of the tick size");
+    }
+    if (isStop(type) && !buy_stops_.isValidPrice(order.getStopPrice())) {
+        throw std::invalid_argument("Stop price is not a multiple of the tick size");
+    }
+    if (order.getId() == OrderIndex<OrderNode*>::kEmpty) {
+        throw std::invalid_argument("Order ID is reserved");
     }
+    if (isStop(type) && order.getRemainingQuantity() == 0) {
+        throw std::invalid_argument("Stop order has no quantity");
+    }
+
+    Order working_order = order;
+    bool rested = false;
+    BookUpdate update;
     
-    // If the order wasn't fully filled and it's a limit order, add it to the book
-    if (order.getRemainingQuantity() > 0 && order.getType() == OrderType::LIMIT) {
-        std::unique_lock<std::shared_mutex> lock(mutex_);
-        
-        auto order_id = order.getId();
-        auto side = order.getSide();
-        auto price = order.getPrice();
+    {
+        auto lock = writeLock();
+        if (order_lookup_.find(order.getId()) != nullptr) {
+            throw std::invalid_argument("Order ID " + std::to_string(order.getId()) + " is already in the book");
+        }
+        // A price too far from the rest of its ladder is rejected before it is journaled
+        if (isStop(type) && !sideOf(order).fits(order.getStopPrice())) {
+            throw std::invalid_argument("Stop price is too far from the other stop levels");
+        }
+        if ((type == OrderType::LIMIT || type == OrderType::STOP_LIMIT) &&
+            !sideFor(order.getSide()).fits(order.getPrice())) {
+            throw std::invalid_argument("Order price is too far from the other levels");
+        }
+        last_event_time_ = order.getTimestamp();
+        if (journal_) {
+            auto event = MarketDataEvent::orderAdd(symbol_id_, order.getId(), order.getPrice(),
+                                                   order.getRemainingQuantity(), order.getSide(), type,
+                                                   order.getTimestamp(), order.getStopPrice());
+            event.add.trade_limit = sink.unbounded() ? 0 : static_cast<uint32_t>(std::min<size_t>(sink.capacity(), UINT32_MAX));
+            journal_->record(event);
+        }
+        auto& opposite = sideFor(order.getSide() == Side::BUY ? Side::SELL : Side::BUY);
         
-        if (side == Side::BUY) {
-            auto& price_level = bids_[price];
-            if (price_level.orders.empty()) {
-                price_level.price = price;
+        // First check if we can match the incoming order. A fill-or-kill order
+        // only matches if the book can fill all of it, so it never needs undoing.
+        // Stops are parked until a trade crosses their trigger; one that the
+        // last trade has already crossed is released straight away.
+        if (isStop(type)) {
+            restOrder(working_order);
+            if (has_last_trade_) {
+                triggerStops(last_trade_price_, last_trade_price_);
             }
-            price_level.orders.push_back(order);
-            price_level.total_quantity += order.getRemainingQuantity();
-        } else {
-            auto& price_level = asks_[price];
-            if (price_level.orders.empty()) {
-                price_level.price = price;
+        } else if (type == OrderType::FOK) {
+            if (opposite.canFill(order.getPrice(), order.getRemainingQuantity(), false) &&
+                fitsInSink(opposite, order, sink)) {
+                matchOrder(working_order, sink);
             }
-            price_level.orders.push_back(order);
-            price_level.total_quantity += order.getRemainingQuantity();
+        } else if (type == OrderType::LIMIT || type == OrderType::MARKET || type == OrderType::IOC) {
+            matchOrder(working_order, sink);
         }
         
-        // Add order to lookup map
-        order_lookup_[order_id] = {side, price};
+        // If the order wasn't fully filled and it's a limit order, add it to the book,
+        // unless the trade buffer ran out while it could still match. Market, IOC and
+        // FOK remainders are cancelled.
+        if (canRest(working_order, sink)) {
+            restOrder(working_order);
+            rested = true;
+        }
         
-        lock.unlock();
+        // Release any stops that the new trades crossed
+        rested |= runStops(sink, 0);
         
-        // Notify listeners about the book update
-        notifyOrderBookUpdateCallback();
+        if (rested || sink.size() > 0) {
+            publish();
+            update = captureUpdate();
+        }
     }
     
-    return trades;
+    // Notify listeners about the trades
+    for (size_t i = 0; i < sink.size(); ++i) {
+        notifyTradeCallback(sink.data()[i]);
+    }
+    
+    // Notify listeners about the book update
+    notifyOrderBookUpdateCallback(update);
 }
 
 bool OrderBook::cancelOrder(Order::OrderId order_id) {
-    std::unique_lock<std::shared_mutex> lock(mutex_);
+    return cancelOrderAt(order_id, nullptr);
+}
+
+bool OrderBook::cancelOrder(Order::OrderId order_id, Order::Timestamp timestamp) {
+    return cancelOrderAt(order_id, &timestamp);
+}
+
+bool OrderBook::cancelOrderAt(Order::OrderId order_id, const Order::Timestamp* timestamp) {
+    BookUpdate update;
     
-    auto it = order_lookup_.find(order_id);
-    if (it == order_lookup_.end()) {
-        return false;
+    {
+        auto lock = writeLock();
+        
+        auto* entry = order_lookup_.find(order_id);
+        if (entry == nullptr) {
+            return false;
+        }
+        
+        if (timestamp) {
+            last_event_time_ = *timestamp;
+        }
+        if (journal_) {
+            journal_->record(MarketDataEvent::orderCancel(symbol_id_, order_id, last_event_time_));
+        }
+        removeOrder(*entry);
+        publish();
+        update = captureUpdate();
     }
     
-    auto [side, price] = it->second;
+    notifyOrderBookUpdateCallback(update);
+    return true;
+}
+
+bool OrderBook::executeOrder(Order::OrderId order_id, Order::Quantity quantity) {
+    return executeOrderAt(order_id, quantity, nullptr);
+}
+
+bool OrderBook::executeOrder(Order::OrderId order_id, Order::Quantity quantity, Order::Timestamp timestamp) {
+    return executeOrderAt(order_id, quantity, &timestamp);
+}
+
+bool OrderBook::executeOrderAt(Order::OrderId order_id, Order::Quantity quantity, const Order::Timestamp* timestamp) {
+    BookUpdate update;
     
-    if (side == Side::BUY) {
-        auto bid_it = bids_.find(price);
-        if (bid_it != bids_.end()) {
-            auto& orders = bid_it->second.orders;
-            auto order_it = std::find_if(orders.begin(), orders.end(),
-                [order_id](const Order& o) { return o.getId() == order_id; });
-            
-            if (order_it != orders.end()) {
-                bid_it->second.total_quantity -= order_it->getRemainingQuantity();
-                orders.erase(order_it);
-                
-                if (orders.empty()) {
-                    bids_.erase(bid_it);
-                }
-                
-                order_lookup_.erase(it);
-                
-                lock.unlock();
-                notifyOrderBookUpdateCallback();
-                return true;
-            }
+    {
+        auto lock = writeLock();
+        
+        auto* entry = order_lookup_.find(order_id);
+        if (entry == nullptr || isStop((*entry)->order.getType())) {
+            return false;
         }
-    } else {
-        auto ask_it = asks_.find(price);
-        if (ask_it != asks_.end()) {
-            auto& orders = ask_it->second.orders;
-            auto order_it = std::find_if(orders.begin(), orders.end(),
-                [order_id](const Order& o) { return o.getId() == order_id; });
-            
-            if (order_it != orders.end()) {
-                ask_it->second.total_quantity -= order_it->getRemainingQuantity();
-                orders.erase(order_it);
-                
-                if (orders.empty()) {
-                    asks_.erase(ask_it);
-                }
-                
-                order_lookup_.erase(it);
-                
-                lock.unlock();
-                notifyOrderBookUpdateCallback();
-                return true;
-            }
+        
+        if (timestamp) {
+            last_event_time_ = *timestamp;
         }
+        if (journal_) {
+            journal_->record(MarketDataEvent::orderExecute(symbol_id_, order_id, quantity, 0, last_event_time_));
+        }
+        auto* node = *entry;
+        if (quantity >= node->order.getRemainingQuantity()) {
+            removeOrder(node);
+        } else {
+            sideFor(node->order.getSide()).reduce(node->level, quantity);
+            node->order.fill(quantity);
+        }
+        publish();
+        update = captureUpdate();
     }
     
-    return false;
+    notifyOrderBookUpdateCallback(update);
+    return true;
 }
 
 bool OrderBook::modifyOrder(Order::OrderId order_id, Order::Price new_price, Order::Quantity new_quantity) {
-    // For simplicity, implement as cancel + add
-    // In a real system, we would optimize this to avoid unnecessary processing
-    
-    std::unique_lock<std::shared_mutex> lock(mutex_);
-    
-    auto it = order_lookup_.find(order_id);
-    if (it == order_lookup_.end()) {
-        return false;
-    }
-    
-    auto [side, price] = it->second;
-    Order modified_order;
+    return modifyOrderAt(order_id, new_price, new_quantity, nullptr);
+}
+
+bool OrderBook::modifyOrder(Order::OrderId order_id, Order::Price new_price, Order::Quantity new_quantity,
+                            Order::Timestamp timestamp) {
+    return modifyOrderAt(order_id, new_price, new_quantity, &timestamp);
+}
+
+bool OrderBook::modifyOrderAt(Order::OrderId order_id, Order::Price new_price, Order::Quantity new_quantity,
+                              const Order::Timestamp* timestamp) {
+    ScratchTrades scratch;
+    auto& trades = scratch.get();
+    TradeSink sink(trades);
+    BookUpdate update;
     
-    if (side == Side::BUY) {
-        auto bid_it = bids_.find(price);
-        if (bid_it != bids_.end()) {
-            auto& orders = bid_it->second.orders;
-            auto order_it = std::find_if(orders.begin(), orders.end(),
-                [order_id](const Order& o) { return o.getId() == order_id; });
-            
-            if (order_it != orders.end()) {
-                modified_order = *order_it;
-                bid_it->second.total_quantity -= order_it->getRemainingQuantity();
-                orders.erase(order_it);
-                
-                if (orders.empty()) {
-                    bids_.erase(bid_it);
-                }
-                
-                order_lookup_.erase(it);
-            } else {
-                return false;
-            }
-        } else {
+    {
+        auto lock = writeLock();
+        
+        auto* entry = order_lookup_.find(order_id);
+        if (entry == nullptr) {
             return false;
         }
-    } else {
-        auto ask_it = asks_.find(price);
-        if (ask_it != asks_.end()) {
-            auto& orders = ask_it->second.orders;
-            auto order_it = std::find_if(orders.begin(), orders.end(),
-                [order_id](const Order& o) { return o.getId() == order_id; });
+        
+        auto* node = *entry;
+        auto& order = node->order;
+        
+        // Validate before changing anything, so a rejected modify is not journaled
+        const bool reprice = new_quantity > 0 && (isStop(order.getType()) ? order.getType() == OrderType::STOP_LIMIT
+                                                                           : new_price != order.getPrice());
+        if (reprice && !bids_.isValidPrice(new_price)) {
+            throw std::invalid_argument("Order price is not a multiple of the tick size");
+        }
+        if (reprice && !sideFor(order.getSide()).fits(new_price)) {
+            throw std::invalid_argument("Order price is too far from the other levels");
+        }
+        if (timestamp) {
+            last_event_time_ = *timestamp;
+        }
+        if (journal_) {
+            journal_->record(MarketDataEvent::orderModify(symbol_id_, order_id, new_price, new_quantity,
+                                                          last_event_time_));
+        }
+        
+        if (new_quantity == 0) {
+            removeOrder(node);
+        } else if (isStop(order.getType())) {
+            // Parked stop: new limit price and size, back of its trigger queue
+            // and behind every other stop when released
+            unlinkOrder(node);
+            order.setPrice(new_price);
+            order.setQuantity(new_quantity);
+            node->sequence = ++stop_sequence_;
+            linkOrder(node);
+        } else if (new_price == order.getPrice() && new_quantity <= order.getRemainingQuantity()) {
+            // Size reduction: update in place and keep queue priority
+            sideFor(order.getSide()).reduce(node->level, order.getRemainingQuantity() - new_quantity);
+            order.setQuantity(new_quantity);
+        } else if (new_price == order.getPrice()) {
+            // Size increase: same level, back of the queue
+            auto& side = sideFor(order.getSide());
+            auto* level = node->level;
+            side.unlink(node);
+            order.setQuantity(new_quantity);
+            side.pushBack(level, node);
+        } else {
+            // Price change: leave the level, match at the new price and requeue any remainder
+            unlinkOrder(node);
+            order.setPrice(new_price);
+            order.setQuantity(new_quantity);
+            matchOrder(order, sink);
             
-            if (order_it != orders.end()) {
-                modified_order = *order_it;
-                ask_it->second.total_quantity -= order_it->getRemainingQuantity();
-                orders.erase(order_it);
-                
-                if (orders.empty()) {
-                    asks_.erase(ask_it);
-                }
-                
-                order_lookup_.erase(it);
+            if (order.getRemainingQuantity() > 0) {
+                linkOrder(node);
             } else {
-                return false;
+                order_lookup_.erase(order_id);
+                order_pool_.release(node);
             }
-        } else {
-            return false;
+            
+            runStops(sink, 0);
         }
+        
+        publish();
+        update = captureUpdate();
     }
     
-    lock.unlock();
-    
-    // Create a new order with the modified parameters
-    modified_order.setPrice(new_price);
-    modified_order.setQuantity(new_quantity);
-    
-    // Add the modified order back to the book
-    addOrder(modified_order);
+    for (const auto& trade : trades) {
+        notifyTradeCallback(trade);
+    }
     
+    notifyOrderBookUpdateCallback(update);
     return true;
 }
 
 TopOfBook OrderBook::getTopOfBook() const {
-    std::shared_lock<std::shared_mutex> lock(mutex_);
-    
     TopOfBook result;
+    
+    if (config_.single_writer) {
+        result = published_top_.load();
+    } else {
+        auto lock = readLock();
+        result = buildTopOfBook();
+    }
+    
     result.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
         std::chrono::high_resolution_clock::now().time_since_epoch());
+    return result;
+}
+
+DepthSnapshot OrderBook::getDepthSnapshot() const {
+    DepthSnapshot result;
+    
+    if (config_.single_writer) {
+        result = published_depth_.load();
+    } else {
+        auto lock = readLock();
+        result = buildDepthSnapshot();
+    }
+    
+    result.top.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::high_resolution_clock::now().time_since_epoch());
+    return result;
+}
+
+TopOfBook OrderBook::buildTopOfBook() const {
+    TopOfBook result;
     
-    if (!bids_.empty()) {
-        const auto& best_bid = bids_.begin()->second;
-        result.bid_price = best_bid.price;
-        result.bid_size = best_bid.total_quantity;
+    if (const auto* best_bid = bids_.best()) {
+        result.bid_price = best_bid->price;
+        result.bid_size = best_bid->total_quantity;
     }
     
-    if (!asks_.empty()) {
-        const auto& best_ask = asks_.begin()->second;
-        result.ask_price = best_ask.price;
-        result.ask_size = best_ask.total_quantity;
+    if (const auto* best_ask = asks_.best()) {
+        result.ask_price = best_ask->price;
+        result.ask_size = best_ask->total_quantity;
     }
     
     return result;
 }
 
-std::pair<std::vector<PriceLevel>, std::vector<PriceLevel>> OrderBook::getDepth(size_t levels) const {
-    std::shared_lock<std::shared_mutex> lock(mutex_);
+DepthSnapshot OrderBook::buildDepthSnapshot() const {
+    DepthSnapshot result;
+    result.top = buildTopOfBook();
     
-    std::vector<PriceLevel> bid_levels;
-    std::vector<PriceLevel> ask_levels;
+    result.bid_count = static_cast<uint32_t>(copyDepth(bids_, result.bids, config_.published_levels));
+    result.ask_count = static_cast<uint32_t>(copyDepth(asks_, result.asks, config_.published_levels));
     
-    bid_levels.reserve(std::min(levels, bids_.size()));
-    ask_levels.reserve(std::min(levels, asks_.size()));
+    return result;
+}
+
+void OrderBook::publish() {
+    bids_.refreshDepth();
+    asks_.refreshDepth();
     
-    size_t count = 0;
-    for (const auto& [price, level] : bids_) {
-        if (count >= levels) break;
-        bid_levels.push_back(level);
-        ++count;
+    const auto* best_bid = bids_.best();
+    const auto* best_ask = asks_.best();
+    order_flow_.update(best_bid ? best_bid->price : 0, best_bid ? best_bid->total_quantity : 0,
+                       best_ask ? best_ask->price : 0, best_ask ? best_ask->total_quantity : 0);
+    
+    if (!config_.single_writer) {
+        return;
     }
     
-    count = 0;
-    for (const auto& [price, level] : asks_) {
-        if (count >= levels) break;
-        ask_levels.push_back(level);
-        ++count;
+    published_top_.store(buildTopOfBook());
+    published_depth_.store(buildDepthSnapshot());
+}
+
+std::unique_lock<std::shared_mutex> OrderBook::writeLock() const {
+    if (config_.single_writer) {
+        return std::unique_lock<std::shared_mutex>(mutex_, std::defer_lock);
+    }
+    return std::unique_lock<std::shared_mutex>(mutex_);
+}
+
+std::shared_lock<std::shared_mutex> OrderBook::readLock() const {
+    if (config_.single_writer) {
+        return std::shared_lock<std::shared_mutex>(mutex_, std::defer_lock);
     }
+    return std::shared_lock<std::shared_mutex>(mutex_);
+}
+
+std::pair<std::vector<PriceLevel>, std::vector<PriceLevel>> OrderBook::getDepth(size_t levels) const {
+    auto lock = readLock();
     
-    return {bid_levels, ask_levels};
+    std::vector<PriceLevel> bid_levels(std::min(levels, bids_.size()));
+    std::vector<PriceLevel> ask_levels(std::min(levels, asks_.size()));
+    
+    bid_levels.resize(copyDepth(bids_, bid_levels.data(), bid_levels.size()));
+    ask_levels.resize(copyDepth(asks_, ask_levels.data(), ask_levels.size()));
+    
+    return {std::move(bid_levels), std::move(ask_levels)};
+}
+
+size_t OrderBook::getDepth(Side side, PriceLevel* out, size_t levels) const {
+    auto lock = readLock();
+    return copyDepth(sideFor(side), out, levels);
+}
+
+size_t OrderBook::copyDepth(const BookSide& side, PriceLevel* out, size_t levels) {
+    if (levels <= side.depthCapacity()) {
+        size_t count = std::min(levels, side.depthSize());
+        std::copy(side.depth(), side.depth() + count, out);
+        return count;
+    }
+    
+    size_t count = 0;
+    side.forEachLevel([&](const BookLevel& level) {
+        if (count >= levels) return false;
+        out[count].price = level.price;
+        out[count].total_quantity = level.total_quantity;
+        out[count].order_count = static_cast<uint32_t>(level.order_count);
+        ++count;
+        return true;
+    });
+    return count;
 }
 
 void OrderBook::registerTradeCallback(TradeCallback callback) {
@@ -245,26 +560,16 @@ void OrderBook::registerOrderBookUpdateCallback(OrderBookUpdateCallback callback
     update_callback_ = std::move(callback);
 }
 
+void OrderBook::registerDepthUpdateCallback(DepthUpdateCallback callback) {
+    depth_callback_ = std::move(callback);
+}
+
 double OrderBook::calculateOrderFlowImbalance(size_t depth) const {
-    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto lock = readLock();
     
     // Calculate OFI as (sum of bid volumes - sum of ask volumes) / (sum of bid volumes + sum of ask volumes)
-    Order::Quantity total_bid_volume = 0;
-    Order::Quantity total_ask_volume = 0;
-    
-    size_t count = 0;
-    for (const auto& [price, level] : bids_) {
-        if (count >= depth) break;
-        total_bid_volume += level.total_quantity;
-        ++count;
-    }
-    
-    count = 0;
-    for (const auto& [price, level] : asks_) {
-        if (count >= depth) break;
-        total_ask_volume += level.total_quantity;
-        ++count;
-    }
+    Order::Quantity total_bid_volume = bids_.depthQuantity(depth);
+    Order::Quantity total_ask_volume = asks_.depthQuantity(depth);
     
     // Calculate imbalance, avoiding division by zero
     double total_volume = static_cast<double>(total_bid_volume + total_ask_volume);
@@ -275,165 +580,526 @@ double OrderBook::calculateOrderFlowImbalance(size_t depth) const {
     return (static_cast<double>(total_bid_volume) - static_cast<double>(total_ask_volume)) / total_volume;
 }
 
+OrderFlowImbalance OrderBook::getEventOrderFlowImbalance() const {
+    auto lock = readLock();
+    
+    OrderFlowImbalance result;
+    result.window = order_flow_.windowSum();
+    result.total = order_flow_.total();
+    result.events = order_flow_.events();
+    return result;
+}
+
 std::vector<Order> OrderBook::getAllOrders() const {
-    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto lock = readLock();
     
     std::vector<Order> all_orders;
+    all_orders.reserve(order_lookup_.size());
     
-    for (const auto& [price, level] : bids_) {
-        all_orders.insert(all_orders.end(), level.orders.begin(), level.orders.end());
-    }
+    auto collect = [&all_orders](const BookLevel& level) {
+        for (auto* node = level.head; node != nullptr; node = node->next) {
+            all_orders.push_back(node->order);
+        }
+        return true;
+    };
     
-    for (const auto& [price, level] : asks_) {
-        all_orders.insert(all_orders.end(), level.orders.begin(), level.orders.end());
-    }
+    bids_.forEachLevel(collect);
+    asks_.forEachLevel(collect);
+    buy_stops_.forEachLevel(collect);
+    sell_stops_.forEachLevel(collect);
     
     return all_orders;
 }
 
-void OrderBook::clear() {
-    std::unique_lock<std::shared_mutex> lock(mutex_);
+void OrderBook::saveSnapshot(std::string& out, uint64_t sequence) const {
+    auto lock = readLock();
     
-    bids_.clear();
-    asks_.clear();
-    order_lookup_.clear();
+    const BookSide* sides[4] = {&bids_, &asks_, &buy_stops_, &sell_stops_};
+    BookSnapshotHeader header{};
+    std::memcpy(header.magic, BookSnapshotHeader::kMagic, sizeof(header.magic));
+    header.version = BookSnapshotHeader::kVersion;
+    header.symbol_length = static_cast<uint32_t>(symbol_.size());
+    header.sequence = sequence;
     
-    lock.unlock();
+    // Counts come from the levels the records are written from, so the sizing matches the writes
+    std::vector<const BookLevel*> levels[4];
+    size_t level_count = 0;
+    size_t order_count = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        sides[i]->forEachLevel([&](const BookLevel& level) {
+            levels[i].push_back(&level);
+            order_count += level.order_count;
+            return true;
+        });
+        header.level_counts[i] = static_cast<uint32_t>(levels[i].size());
+        level_count += levels[i].size();
+    }
+    header.order_count = order_count;
+    header.next_trade_id = next_trade_id_;
+    header.last_trade_price = last_trade_price_;
+    header.last_trade_time = last_trade_time_.count();
+    header.has_last_trade = has_last_trade_;
     
-    notifyOrderBookUpdateCallback();
+    // Size for the worst case (every order a stop) and trim afterwards
+    size_t start = out.size();
+    out.resize(start + sizeof(header) + paddedLength(symbol_.size()) + level_count * sizeof(BookSnapshotLevel) +
+               order_count * sizeof(BookSnapshotStop));
+    char* cursor = &out[start];
+    auto write = [&cursor](const void* data, size_t size) {
+        std::memcpy(cursor, data, size);
+        cursor += size;
+    };
+    
+    write(&header, sizeof(header));
+    write(symbol_.data(), symbol_.size());
+    std::memset(cursor, 0, paddedLength(symbol_.size()) - symbol_.size());
+    cursor += paddedLength(symbol_.size()) - symbol_.size();
+    
+    // Queues are linked lists scattered over the pool, so several levels are
+    // walked at once, each writing at its own offset, to overlap their misses
+    for (size_t i = 0; i < 4; ++i) {
+        const bool stops = i >= 2;
+        const size_t record_size = stops ? sizeof(BookSnapshotStop) : sizeof(BookSnapshotOrder);
+        const auto& side_levels = levels[i];
+        for (size_t first = 0; first < side_levels.size(); first += kSnapshotLanes) {
+            size_t lanes = std::min(kSnapshotLanes, side_levels.size() - first);
+            const OrderNode* nodes[kSnapshotLanes];
+            char* at[kSnapshotLanes];
+            for (size_t l = 0; l < lanes; ++l) {
+                const auto& level = *side_levels[first + l];
+                BookSnapshotLevel record{level.price, static_cast<uint32_t>(level.order_count), 0};
+                write(&record, sizeof(record));
+                nodes[l] = level.head;
+                at[l] = cursor;
+                cursor += level.order_count * record_size;
+            }
+
+            for (bool active = true; active;) {
+                active = false;
+                for (size_t l = 0; l < lanes; ++l) {
+                    if (nodes[l] == nullptr) {
+                        continue;
+                    }
+                    const auto& order = nodes[l]->order;
+                    BookSnapshotStop stop{};
+                    stop.order = BookSnapshotOrder{order.getId(), order.getQuantity(),
+                                                   order.getRemainingQuantity(), order.getTimestamp().count()};
+                    if (stops) {
+                        stop.price = order.getPrice();
+                        stop.type = static_cast<uint8_t>(order.getType());
+                    }
+                    std::memcpy(at[l], &stop, record_size);
+                    at[l] += record_size;
+                    nodes[l] = nodes[l]->next;
+                    if (nodes[l] != nullptr) {
+                        __builtin_prefetch(nodes[l]);
+                    }
+                    active = true;
+                }
+            }
+        }
+    }
+    out.resize(cursor - out.data());
 }
 
-std::vector<Trade> OrderBook::matchOrder(const Order& order) {
-    std::vector<Trade> trades;
+uint64_t OrderBook::loadSnapshot(std::string_view data) {
+    BookUpdate update;
+    uint64_t sequence = 0;
     
-    if (order.getRemainingQuantity() == 0) {
-        return trades;
+    {
+        auto lock = writeLock();
+        // Not journaled, so a replay of the journal could not follow it
+        if (journal_) {
+            throw std::logic_error("Cannot load a snapshot into a journaled book; attach the journal afterwards");
+        }
+        clearLevels();
+        order_flow_.reset();
+        try {
+            sequence = readSnapshot(data);
+        } catch (...) {
+            clearLevels();
+            publish();
+            throw;
+        }
+        publish();
+        update = captureUpdate();
     }
     
-    std::unique_lock<std::shared_mutex> lock(mutex_);
+    notifyOrderBookUpdateCallback(update);
+    return sequence;
+}
+
+uint64_t OrderBook::readSnapshot(std::string_view data) {
+    SnapshotReader reader(data);
+    auto header = reader.read<BookSnapshotHeader>();
+    if (std::memcmp(header.magic, BookSnapshotHeader::kMagic, sizeof(header.magic)) != 0 ||
+        header.version != BookSnapshotHeader::kVersion) {
+        throw std::runtime_error("Not a compatible book snapshot");
+    }
+    std::string_view symbol(reader.skip(paddedLength(header.symbol_length)), header.symbol_length);
+    if (symbol != symbol_) {
+        throw std::invalid_argument("Book snapshot is for " + std::string(symbol) + ", not " + symbol_);
+    }
     
-    Order remaining_order = order;  // Working copy of the order
+    // The counts come from the file; every level and order takes at least one
+    // record, so counts that need more bytes than remain are corrupt
+    uint64_t levels = 0;
+    for (auto count : header.level_counts) {
+        levels += count;
+    }
+    const uint64_t space = reader.remaining();
+    if (levels > space / sizeof(BookSnapshotLevel) ||
+        header.order_count > (space - levels * sizeof(BookSnapshotLevel)) / sizeof(BookSnapshotOrder)) {
+        throw std::runtime_error("Book snapshot is truncated");
+    }
     
-    if (order.getSide() == Side::BUY) {
-        // Buy order matches against asks
-        while (remaining_order.getRemainingQuantity() > 0 && !asks_.empty()) {
-            auto& best_ask = asks_.begin()->second;
-            
-            // Check if the price is acceptable
-            if (remaining_order.getType() == OrderType::MARKET || 
-                remaining_order.getPrice() >= best_ask.price) {
-                
-                auto& ask_orders = best_ask.orders;
-                auto ask_it = ask_orders.begin();
-                
-                while (ask_it != ask_orders.end() && remaining_order.getRemainingQuantity() > 0) {
-                    auto& ask_order = *ask_it;
-                    
-                    // Calculate the trade quantity
-                    auto trade_quantity = std::min(remaining_order.getRemainingQuantity(), 
-                                                  ask_order.getRemainingQuantity());
-                    
-                    // Create a trade
-                    Trade trade(next_trade_id_++, symbol_, ask_order.getPrice(), 
-                                trade_quantity, ask_order.getId(), 
-                                remaining_order.getId(), remaining_order.getTimestamp());
-                    trades.push_back(trade);
-                    
-                    // Update remaining quantities
-                    ask_order.fill(trade_quantity);
-                    remaining_order.fill(trade_quantity);
-                    
-                    // Update the price level total quantity
-                    best_ask.total_quantity -= trade_quantity;
-                    
-                    // If the ask order is fully filled, remove it
-                    if (ask_order.getRemainingQuantity() == 0) {
-                        // Remove from lookup
-                        order_lookup_.erase(ask_order.getId());
-                        
-                        // Remove from orders list
-                        ask_it = ask_orders.erase(ask_it);
-                    } else {
-                        ++ask_it;
+    // Size the pool and index once instead of growing them order by order
+    order_pool_.reserve(header.order_count);
+    order_lookup_.reserve(header.order_count);
+    
+    BookSide* sides[4] = {&bids_, &asks_, &buy_stops_, &sell_stops_};
+    uint64_t orders = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        auto& side = *sides[i];
+        const bool stops = i >= 2;
+        const Side order_side = i == 0 || i == 2 ? Side::BUY : Side::SELL;
+        Order::Price previous = 0;
+
+        for (uint32_t l = 0; l < header.level_counts[i]; ++l) {
+            auto record = reader.read<BookSnapshotLevel>();
+            if (record.order_count == 0 || !side.isValidPrice(record.price)) {
+                throw std::runtime_error("Book snapshot has an invalid level");
+            }
+            if (l > 0 && (side.side() == Side::BUY ? record.price >= previous : record.price <= previous)) {
+                throw std::runtime_error("Book snapshot levels are out of order");
+            }
+            previous = record.price;
+
+            auto* level = side.appendLevel(record.price);
+            const size_t record_size = stops ? sizeof(BookSnapshotStop) : sizeof(BookSnapshotOrder);
+            for (uint32_t n = 0; n < record.order_count; ++n) {
+                // Index inserts are the random accesses; start them a few orders early
+                if (n + kSnapshotPrefetch < record.order_count) {
+                    order_lookup_.prefetch(reader.peek<uint64_t>(kSnapshotPrefetch * record_size));
+                }
+                BookSnapshotStop stop{};
+                if (stops) {
+                    stop = reader.read<BookSnapshotStop>();
+                    auto type = static_cast<OrderType>(stop.type);
+                    if (!isStop(type)) {
+                        throw std::runtime_error("Book snapshot has a stop of another order type");
                     }
+                } else {
+                    stop.order = reader.read<BookSnapshotOrder>();
+                    stop.price = record.price;
+                    stop.type = static_cast<uint8_t>(OrderType::LIMIT);
                 }
-                
-                // If the price level is empty, remove it
-                if (ask_orders.empty()) {
-                    asks_.erase(asks_.begin());
+                const auto& entry = stop.order;
+                if (entry.remaining == 0 || entry.remaining > entry.quantity) {
+                    throw std::runtime_error("Book snapshot has an invalid order quantity");
                 }
-            } else {
-                // Best ask price is higher than this limit buy order's price
-                break;
+                if (order_lookup_.find(entry.id) != nullptr) {
+                    throw std::runtime_error("Book snapshot repeats order " + std::to_string(entry.id));
+                }
+
+                auto* node = order_pool_.acquire();
+                node->order = Order(entry.id, symbol_id_, stop.price, entry.quantity, order_side,
+                                    static_cast<OrderType>(stop.type), Order::Timestamp(entry.timestamp),
+                                    stops ? record.price : 0);
+                node->sequence = 0;
+                if (entry.remaining < entry.quantity) {
+                    node->order.setRemainingQuantity(entry.remaining);
+                    node->order.setStatus(OrderStatus::PARTIALLY_FILLED);
+                }
+                level->pushBack(node);
+                order_lookup_.insert(entry.id, node);
             }
+            side.finishLevel(level);
+            orders += record.order_count;
         }
-    } else {
-        // Sell order matches against bids
-        while (remaining_order.getRemainingQuantity() > 0 && !bids_.empty()) {
-            auto& best_bid = bids_.begin()->second;
+    }
+    if (orders != header.order_count || !reader.done()) {
+        throw std::runtime_error("Book snapshot does not match its header");
+    }
+
+    next_trade_id_ = header.next_trade_id;
+    last_trade_price_ = header.last_trade_price;
+    last_trade_time_ = Order::Timestamp(header.last_trade_time);
+    has_last_trade_ = header.has_last_trade != 0;
+    return header.sequence;
+}
+
+void OrderBook::clear() {
+    BookUpdate update;
+    
+    {
+        auto lock = writeLock();
+        if (journal_) {
+            journal_->record(MarketDataEvent::snapshotOrder(symbol_id_, 0, 0, 0, Side::BUY,
+                                                            MarketDataEvent::kSnapshotBegin, last_event_time_));
+        }
+        clearLevels();
+        order_flow_.reset();
+        publish();
+        update = captureUpdate();
+    }
+    
+    notifyOrderBookUpdateCallback(update);
+}
+
+void OrderBook::setJournal(std::shared_ptr<BookJournal> journal) {
+    if (symbol_.size() > MarketDataEvent::SymbolName::kMaxLength) {
+        throw std::invalid_argument("Symbol is too long to journal");
+    }
+    auto lock = writeLock();
+    journal_ = std::move(journal);
+    if (journal_) {
+        journal_->record(MarketDataEvent::symbolName(symbol_id_, symbol_));
+    }
+}
+
+void OrderBook::clearLevels() {
+    auto release_orders = [this](BookLevel& level) {
+        for (auto* node = level.head; node != nullptr;) {
+            auto* next = node->next;
+            order_pool_.release(node);
+            node = next;
+        }
+        return true;
+    };
+    
+    for (auto* side : {&bids_, &asks_, &buy_stops_, &sell_stops_}) {
+        side->forEachLevel(release_orders);
+        side->clear();
+    }
+    order_lookup_.clear();
+}
+
+void OrderBook::matchOrder(Order& order, TradeSink& trades) {
+    // Buy orders match against asks, sell orders against bids
+    auto& opposite = sideFor(order.getSide() == Side::BUY ? Side::SELL : Side::BUY);
+    
+    while (order.getRemainingQuantity() > 0 && !trades.full()) {
+        auto* best = opposite.best();
+        if (best == nullptr) {
+            break;
+        }
+        
+        // Check if the price is acceptable
+        if (!crosses(order, best->price)) {
+            break;
+        }
+        
+        auto* node = best->head;
+        
+        while (node != nullptr && order.getRemainingQuantity() > 0 && !trades.full()) {
+            auto& resting_order = node->order;
             
-            // Check if the price is acceptable
-            if (remaining_order.getType() == OrderType::MARKET || 
-                remaining_order.getPrice() <= best_bid.price) {
-                
-                auto& bid_orders = best_bid.orders;
-                auto bid_it = bid_orders.begin();
-                
-                while (bid_it != bid_orders.end() && remaining_order.getRemainingQuantity() > 0) {
-                    auto& bid_order = *bid_it;
-                    
-                    // Calculate the trade quantity
-                    auto trade_quantity = std::min(remaining_order.getRemainingQuantity(), 
-                                                  bid_order.getRemainingQuantity());
-                    
-                    // Create a trade
-                    Trade trade(next_trade_id_++, symbol_, bid_order.getPrice(), 
-                                trade_quantity, bid_order.getId(), 
-                                remaining_order.getId(), remaining_order.getTimestamp());
-                    trades.push_back(trade);
-                    
-                    // Update remaining quantities
-                    bid_order.fill(trade_quantity);
-                    remaining_order.fill(trade_quantity);
-                    
-                    // Update the price level total quantity
-                    best_bid.total_quantity -= trade_quantity;
-                    
-                    // If the bid order is fully filled, remove it
-                    if (bid_order.getRemainingQuantity() == 0) {
-                        // Remove from lookup
-                        order_lookup_.erase(bid_order.getId());
-                        
-                        // Remove from orders list
-                        bid_it = bid_orders.erase(bid_it);
-                    } else {
-                        ++bid_it;
-                    }
-                }
-                
-                // If the price level is empty, remove it
-                if (bid_orders.empty()) {
-                    bids_.erase(bids_.begin());
-                }
-            } else {
-                // Best bid price is lower than this limit sell order's price
-                break;
+            // Calculate the trade quantity
+            auto trade_quantity = std::min(order.getRemainingQuantity(), 
+                                           resting_order.getRemainingQuantity());
+            
+            // Create a trade
+            trades.emplace(next_trade_id_++, symbol_id_, resting_order.getPrice(),
+                                trade_quantity, resting_order.getId(),
+                                order.getId(), order.getTimestamp(), order.getSide());
+            if (journal_) {
+                const bool buyer = order.getSide() == Side::BUY;
+                journal_->record(MarketDataEvent::tradePrint(symbol_id_, next_trade_id_ - 1, resting_order.getPrice(),
+                                                             trade_quantity, buyer ? order.getId() : resting_order.getId(),
+                                                             buyer ? resting_order.getId() : order.getId(),
+                                                             order.getTimestamp()));
+            }
+            
+            // Update remaining quantities
+            resting_order.fill(trade_quantity);
+            order.fill(trade_quantity);
+            
+            // Update the price level total quantity
+            opposite.reduce(best, trade_quantity);
+            
+            auto* next = node->next;
+            
+            // If the resting order is fully filled, remove it
+            if (resting_order.getRemainingQuantity() == 0) {
+                order_lookup_.erase(resting_order.getId());
+                opposite.unlink(node);
+                order_pool_.release(node);
             }
+            
+            node = next;
+        }
+        
+        // If the price level is empty, remove it
+        if (best->empty()) {
+            opposite.erase(best);
         }
     }
+}
+
+bool OrderBook::canRest(const Order& order, const TradeSink& sink) {
+    if (order.getRemainingQuantity() == 0 || order.getType() != OrderType::LIMIT) {
+        return false;
+    }
+    const auto* opposite_best = sideFor(order.getSide() == Side::BUY ? Side::SELL : Side::BUY).best();
+    return !sink.full() || opposite_best == nullptr || !crosses(order, opposite_best->price);
+}
+
+void OrderBook::triggerStops(Order::Price low, Order::Price high) {
+    size_t batch = triggered_.size();
     
-    lock.unlock();
+    // Buy stops fire when the price trades at or above the trigger, sell stops at or below
+    auto release = [this](BookSide& stops, BookLevel* level) {
+        while (!level->empty()) {
+            auto* node = level->head;
+            stops.unlink(node);
+            triggered_.push_back(node);
+        }
+        stops.erase(level);
+    };
+    for (auto* level = buy_stops_.best(); level && level->price <= high; level = buy_stops_.best()) {
+        release(buy_stops_, level);
+    }
+    for (auto* level = sell_stops_.best(); level && level->price >= low; level = sell_stops_.best()) {
+        release(sell_stops_, level);
+    }
     
-    // Notify listeners about the trades
-    for (const auto& trade : trades) {
-        notifyTradeCallback(trade);
+    // Stops released together go in the order they were placed or last modified.
+    // Stops loaded from a snapshot have no sequence and fall back to their timestamps.
+    std::sort(triggered_.begin() + batch, triggered_.end(), [](const OrderNode* a, const OrderNode* b) {
+        if (a->sequence != b->sequence) {
+            return a->sequence < b->sequence;
+        }
+        if (a->order.getTimestamp() != b->order.getTimestamp()) {
+            return a->order.getTimestamp() < b->order.getTimestamp();
+        }
+        return a->order.getId() < b->order.getId();
+    });
+}
+
+bool OrderBook::runStops(TradeSink& sink, size_t first_trade) {
+    bool rested = false;
+    size_t next = 0;
+    
+    // Stops parked again by an earlier call that ran out of trade buffer
+    if (has_last_trade_) {
+        triggerStops(last_trade_price_, last_trade_price_);
     }
     
-    if (!trades.empty()) {
-        notifyOrderBookUpdateCallback();
+    while (true) {
+        // Fold in trades we have not looked at yet; they may release more stops
+        if (first_trade < sink.size()) {
+            const Trade* trades = sink.data();
+            auto low = trades[first_trade].getPrice();
+            auto high = low;
+            for (size_t i = first_trade; i < sink.size(); ++i) {
+                low = std::min(low, trades[i].getPrice());
+                high = std::max(high, trades[i].getPrice());
+            }
+            last_trade_price_ = trades[sink.size() - 1].getPrice();
+            last_trade_time_ = trades[sink.size() - 1].getTimestamp();
+            has_last_trade_ = true;
+            first_trade = sink.size();
+            triggerStops(low, high);
+        }
+        
+        if (next == triggered_.size()) {
+            break;
+        }
+        
+        // With no room left for their trades, released stops go back to their
+        // trigger levels, to run on a later call once the buffer has room
+        if (sink.full()) {
+            while (next < triggered_.size()) {
+                linkOrder(triggered_[next++]);
+            }
+            break;
+        }
+        
+        // A released stop enters as a market or limit order at the time of the trade that released it
+        auto* node = triggered_[next++];
+        auto& order = node->order;
+        order.setType(order.getType() == OrderType::STOP ? OrderType::MARKET : OrderType::LIMIT);
+        order.setTimestamp(last_trade_time_);
+        matchOrder(order, sink);
+        
+        // A limit the book has since moved too far from cannot rest; its remainder is cancelled
+        if (canRest(order, sink) && sideOf(order).fits(order.getPrice())) {
+            linkOrder(node);
+            rested = true;
+        } else {
+            order_lookup_.erase(order.getId());
+            order_pool_.release(node);
+        }
     }
     
-    return trades;
+    triggered_.clear();
+    return rested;
+}
+
+bool OrderBook::fitsInSink(const BookSide& opposite, const Order& order, const TradeSink& sink) {
+    if (sink.unbounded()) {
+        return true;
+    }
+    
+    // Each resting order filled is one trade; count orders on the levels the sweep reaches
+    Order::Quantity quantity = 0;
+    size_t orders = 0;
+    opposite.forEachLevel([&](const BookLevel& level) {
+        quantity += level.total_quantity;
+        orders += level.order_count;
+        return quantity < order.getRemainingQuantity() && orders <= sink.remaining();
+    });
+    return orders <= sink.remaining();
+}
+
+bool OrderBook::crosses(const Order& order, Order::Price resting_price) {
+    if (order.getType() == OrderType::MARKET) {
+        return true;
+    }
+    return order.getSide() == Side::BUY ? order.getPrice() >= resting_price
+                                        : order.getPrice() <= resting_price;
+}
+
+void OrderBook::restOrder(const Order& order) {
+    auto* node = order_pool_.acquire();
+    node->order = order;
+    node->sequence = isStop(order.getType()) ? ++stop_sequence_ : 0;
+    linkOrder(node);
+    
+    // Add order to lookup map (addOrder has rejected IDs already resting)
+    bool inserted = order_lookup_.insert(order.getId(), node);
+    assert(inserted);
+    (void)inserted;
+}
+
+void OrderBook::linkOrder(OrderNode* node) {
+    const auto& order = node->order;
+    auto& side = sideOf(order);
+    side.pushBack(side.insert(isStop(order.getType()) ? order.getStopPrice() : order.getPrice()), node);
+}
+
+void OrderBook::unlinkOrder(OrderNode* node) {
+    auto& side = sideOf(node->order);
+    auto* level = node->level;
+    side.unlink(node);
+    
+    if (level->empty()) {
+        side.erase(level);
+    }
+}
+
+BookSide& OrderBook::sideOf(const Order& order) {
+    if (isStop(order.getType())) {
+        return order.getSide() == Side::BUY ? buy_stops_ : sell_stops_;
+    }
+    return sideFor(order.getSide());
+}
+
+void OrderBook::removeOrder(OrderNode* node) {
+    unlinkOrder(node);
+    order_lookup_.erase(node->order.getId());
+    order_pool_.release(node);
 }
 
 void OrderBook::notifyTradeCallback(const Trade& trade) {
@@ -442,9 +1108,52 @@ void OrderBook::notifyTradeCallback(const Trade& trade) {
     }
 }
 
-void OrderBook::notifyOrderBookUpdateCallback() {
+OrderBook::BookUpdate OrderBook::captureUpdate() {
+    BookUpdate update;
+    
+    if (config_.update_notification == UpdateNotification::EVERY_MUTATION) {
+        auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::high_resolution_clock::now().time_since_epoch());
+        if (update_callback_) {
+            update.top = buildTopOfBook();
+            update.top.timestamp = now;
+            update.top_changed = true;
+        }
+        if (depth_callback_) {
+            update.depth = buildDepthSnapshot();
+            update.depth.top.timestamp = now;
+            update.depth_changed = true;
+        }
+        return update;
+    }
+    
     if (update_callback_) {
-        update_callback_(getTopOfBook());
+        auto top = buildTopOfBook();
+        if (!sameTop(top, last_top_)) {
+            last_top_ = top;
+            update.top = top;
+            update.top.timestamp = last_event_time_;
+            update.top_changed = true;
+        }
+    }
+    if (depth_callback_) {
+        auto depth = buildDepthSnapshot();
+        if (!sameDepth(depth, last_depth_)) {
+            last_depth_ = depth;
+            update.depth = depth;
+            update.depth.top.timestamp = last_event_time_;
+            update.depth_changed = true;
+        }
+    }
+    return update;
+}
+
+void OrderBook::notifyOrderBookUpdateCallback(const BookUpdate& update) {
+    if (update.top_changed && update_callback_) {
+        update_callback_(update.top);
+    }
+    if (update.depth_changed && depth_callback_) {
+        depth_callback_(update.depth);
     }
 }
 
@@ -0,0 +1,70 @@
+#include "orderbook/order_flow.h"
+#include <algorithm>
+#include <limits>
+
+namespace orderbook {
+
+namespace {
+
+constexpr Order::Price kNoBid = std::numeric_limits<Order::Price>::min();
+constexpr Order::Price kNoAsk = std::numeric_limits<Order::Price>::max();
+
+} // namespace
+
+EventOrderFlow::EventOrderFlow(size_t window)
+    : ring_(std::max<size_t>(window, 1), 0) {
+    reset();
+}
+
+void EventOrderFlow::update(Order::Price bid_price, Order::Quantity bid_size,
+                            Order::Price ask_price, Order::Quantity ask_size) {
+    if (bid_size == 0) {
+        bid_price = kNoBid;
+    }
+    if (ask_size == 0) {
+        ask_price = kNoAsk;
+    }
+    if (bid_price == bid_price_ && bid_size == bid_size_ &&
+        ask_price == ask_price_ && ask_size == ask_size_) {
+        return;
+    }
+    
+    int64_t event = 0;
+    if (bid_price >= bid_price_) {
+        event += static_cast<int64_t>(bid_size);
+    }
+    if (bid_price <= bid_price_) {
+        event -= static_cast<int64_t>(bid_size_);
+    }
+    if (ask_price <= ask_price_) {
+        event -= static_cast<int64_t>(ask_size);
+    }
+    if (ask_price >= ask_price_) {
+        event += static_cast<int64_t>(ask_size_);
+    }
+    
+    window_sum_ += event - ring_[next_];
+    ring_[next_] = event;
+    next_ = (next_ + 1) % ring_.size();
+    total_ += event;
+    ++events_;
+    
+    bid_price_ = bid_price;
+    bid_size_ = bid_size;
+    ask_price_ = ask_price;
+    ask_size_ = ask_size;
+}
+
+void EventOrderFlow::reset() {
+    std::fill(ring_.begin(), ring_.end(), 0);
+    next_ = 0;
+    window_sum_ = 0;
+    total_ = 0;
+    events_ = 0;
+    bid_price_ = kNoBid;
+    bid_size_ = 0;
+    ask_price_ = kNoAsk;
+    ask_size_ = 0;
+}
+
+} // namespace orderbook
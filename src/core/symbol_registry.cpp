@@ -0,0 +1,87 @@
+#include "orderbook/symbol_registry.h"
+#include <mutex>
+
+namespace orderbook {
+
+SymbolRegistry& SymbolRegistry::instance() {
+    static SymbolRegistry registry;
+    return registry;
+}
+
+SymbolRegistry::SymbolRegistry() {
+    names_.emplace_back();
+    ids_.emplace(std::string(), 0);
+}
+
+SymbolId SymbolRegistry::intern(const std::string& name) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = ids_.find(name);
+        if (it != ids_.end()) {
+            return it->second;
+        }
+    }
+    
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto [it, inserted] = ids_.emplace(name, static_cast<SymbolId>(names_.size()));
+    if (inserted) {
+        names_.push_back(name);
+    }
+    return it->second;
+}
+
+bool SymbolRegistry::find(const std::string& name, SymbolId& id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(name);
+    if (it == ids_.end()) {
+        return false;
+    }
+    id = it->second;
+    return true;
+}
+
+const std::string& SymbolRegistry::name(SymbolId id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (id >= names_.size()) {
+        return names_.front();
+    }
+    return names_[id];
+}
+
+size_t SymbolRegistry::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return names_.size();
+}
+
+SymbolId SymbolCache::insert(uint64_t hash, std::string_view name) {
+    // Keep the table at most half full
+    if ((count_ + 1) * 2 > slots_.size()) {
+        std::vector<Slot> old(slots_.size() * 2);
+        old.swap(slots_);
+        size_t mask = slots_.size() - 1;
+        for (auto& slot : old) {
+            if (slot.used) {
+                size_t i = slot.hash & mask;
+                while (slots_[i].used) {
+                    i = (i + 1) & mask;
+                }
+                slots_[i] = std::move(slot);
+            }
+        }
+    }
+    
+    size_t mask = slots_.size() - 1;
+    size_t i = hash & mask;
+    while (slots_[i].used) {
+        i = (i + 1) & mask;
+    }
+    Slot& slot = slots_[i];
+    slot.hash = hash;
+    slot.name = std::string(name);
+    slot.id = SymbolRegistry::instance().intern(slot.name);
+    slot.used = true;
+    ++count_;
+    return slot.id;
+}
+
+} // namespace orderbook 
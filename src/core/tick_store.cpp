@@ -0,0 +1,527 @@
+#include "orderbook/tick_store.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace orderbook {
+
+namespace {
+
+constexpr int64_t kNanosPerDay = 86400LL * 1000000000LL;
+
+struct ColumnSpec {
+    const char* name;
+    uint32_t value_size;
+    bool per_level;   // One value per depth level
+};
+
+constexpr size_t kColumns = 5;
+
+constexpr ColumnSpec kTradeColumns[kColumns] = {
+    {"time", sizeof(int64_t), false},
+    {"price", sizeof(Order::Price), false},
+    {"size", sizeof(Order::Quantity), false},
+    {"side", sizeof(Side), false},
+    {"id", sizeof(Trade::TradeId), false},
+};
+
+constexpr ColumnSpec kQuoteColumns[kColumns] = {
+    {"time", sizeof(int64_t), false},
+    {"bid_price", sizeof(Order::Price), true},
+    {"bid_size", sizeof(Order::Quantity), true},
+    {"ask_price", sizeof(Order::Price), true},
+    {"ask_size", sizeof(Order::Quantity), true},
+};
+
+std::runtime_error fileError(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+TickColumnHeader makeHeader(uint32_t value_size, uint32_t width, uint64_t rows) {
+    TickColumnHeader header{};
+    std::memcpy(header.magic, TickColumnHeader::kMagic, sizeof(header.magic));
+    header.version = TickColumnHeader::kVersion;
+    header.value_size = value_size;
+    header.width = width;
+    header.row_count = rows;
+    return header;
+}
+
+bool validHeader(const TickColumnHeader& header) {
+    return std::memcmp(header.magic, TickColumnHeader::kMagic, sizeof(header.magic)) == 0 &&
+           header.version == TickColumnHeader::kVersion && header.value_size > 0 && header.width > 0;
+}
+
+bool writeAt(int fd, const void* data, size_t size, uint64_t offset) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t n = ::pwrite(fd, bytes, size, static_cast<off_t>(offset));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+int64_t floorDiv(int64_t value, int64_t divisor) {
+    int64_t quotient = value / divisor;
+    return (value % divisor < 0) ? quotient - 1 : quotient;
+}
+
+// Days since 1970-01-01 to yyyymmdd in the proleptic Gregorian calendar
+// (Howard Hinnant's civil_from_days)
+uint32_t civilDay(int64_t days) {
+    days += 719468;
+    const int64_t era = floorDiv(days, 146097);
+    const int64_t day_of_era = days - era * 146097;
+    const int64_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    const int64_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    const int64_t shifted_month = (5 * day_of_year + 2) / 153;
+    const int64_t day = day_of_year - (153 * shifted_month + 2) / 5 + 1;
+    const int64_t month = shifted_month < 10 ? shifted_month + 3 : shifted_month - 9;
+    const int64_t year = year_of_era + era * 400 + (month <= 2);
+    return static_cast<uint32_t>(year * 10000 + month * 100 + day);
+}
+
+std::string dayName(uint32_t day) {
+    char name[16];
+    std::snprintf(name, sizeof(name), "%08u", day);
+    return name;
+}
+
+} // namespace
+
+/**
+ * @brief One symbol's trades or quotes for one day: row buffers for its column files
+ */
+class TickStore::Table {
+public:
+    Table(const std::string& dir, const ColumnSpec* specs, size_t levels, size_t buffer_rows,
+          SymbolId symbol_id, int64_t begin)
+        : symbol_id_(symbol_id), begin_(begin), end_(begin + kNanosPerDay), buffer_rows_(buffer_rows) {
+        std::error_code error;
+        std::filesystem::create_directories(dir, error);
+        if (error) {
+            throw std::runtime_error("Cannot create tick store directory " + dir + ": " + error.message());
+        }
+
+        // Reopening a day: carry on after the rows every column has
+        bool existing = true;
+        uint64_t rows = UINT64_MAX;
+        for (size_t i = 0; i < kColumns; ++i) {
+            Column column;
+            column.path = dir + "/" + specs[i].name;
+            column.value_size = specs[i].value_size;
+            column.width = specs[i].per_level ? static_cast<uint32_t>(levels) : 1;
+            column.buffer.resize(buffer_rows * column.width * column.value_size);
+
+            int fd = ::open(column.path.c_str(), O_RDONLY);
+            TickColumnHeader header;
+            if (fd < 0) {
+                existing = false;
+            } else {
+                bool read = ::pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+                ::close(fd);
+                if (!read || !validHeader(header)) {
+                    throw std::runtime_error("Not a tick store column: " + column.path);
+                }
+                if (header.value_size != column.value_size || header.width != column.width) {
+                    throw std::runtime_error("Tick store column has another layout: " + column.path);
+                }
+                rows = std::min(rows, header.row_count);
+            }
+            columns_.push_back(std::move(column));
+        }
+        rows_ = existing ? rows : 0;
+
+        if (rows_ > 0) {
+            int fd = ::open(columns_[0].path.c_str(), O_RDONLY);
+            bool read = fd >= 0 && ::pread(fd, &last_time_, sizeof(last_time_),
+                                           sizeof(TickColumnHeader) + (rows_ - 1) * sizeof(int64_t)) ==
+                                       static_cast<ssize_t>(sizeof(last_time_));
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            if (!read) {
+                throw fileError("Cannot read tick store column", columns_[0].path);
+            }
+        }
+    }
+
+    SymbolId symbolId() const { return symbol_id_; }
+    int64_t begin() const { return begin_; }
+    bool covers(SymbolId symbol_id, int64_t time) const {
+        return symbol_id == symbol_id_ && time >= begin_ && time < end_;
+    }
+
+    // Keep times non-decreasing
+    int64_t stamp(int64_t time) {
+        last_time_ = std::max(last_time_, time);
+        return last_time_;
+    }
+
+    template <typename T>
+    void put(size_t column, T value, size_t level = 0) {
+        auto& target = columns_[column];
+        std::memcpy(target.buffer.data() + (buffered_ * target.width + level) * sizeof(T), &value, sizeof(T));
+    }
+
+    void endRow() {
+        if (++buffered_ == buffer_rows_) {
+            write();
+        }
+    }
+
+    // Append the buffered rows to each column file, then its row count
+    void write() {
+        if (buffered_ == 0) {
+            return;
+        }
+        for (auto& column : columns_) {
+            size_t row_bytes = static_cast<size_t>(column.width) * column.value_size;
+            int fd = ::open(column.path.c_str(), O_WRONLY | O_CREAT, 0644);
+            if (fd < 0) {
+                throw fileError("Cannot open tick store column", column.path);
+            }
+            uint64_t end = sizeof(TickColumnHeader) + (rows_ + buffered_) * row_bytes;
+            auto header = makeHeader(column.value_size, column.width, rows_ + buffered_);
+            bool ok = writeAt(fd, column.buffer.data(), buffered_ * row_bytes,
+                              sizeof(TickColumnHeader) + rows_ * row_bytes) &&
+                      writeAt(fd, &header, sizeof(header), 0) &&
+                      (!trim_ || ::ftruncate(fd, static_cast<off_t>(end)) == 0);
+            ::close(fd);
+            if (!ok) {
+                throw fileError("Cannot write tick store column", column.path);
+            }
+        }
+        trim_ = false;
+        rows_ += buffered_;
+        buffered_ = 0;
+    }
+
+private:
+    struct Column {
+        std::string path;
+        uint32_t value_size = 0;
+        uint32_t width = 1;
+        std::vector<char> buffer;
+    };
+
+    SymbolId symbol_id_;
+    int64_t begin_;
+    int64_t end_;
+    std::vector<Column> columns_;
+    size_t buffer_rows_;
+    size_t buffered_ = 0;
+    uint64_t rows_ = 0;
+    int64_t last_time_ = INT64_MIN;
+    bool trim_ = true;   // Drop any unfinished rows a previous writer left on the first write
+};
+
+TickStore::TickStore(const std::string& root, const TickStoreConfig& config) : root_(root), config_(config) {
+    if (config_.depth_levels == 0 || config_.depth_levels > DepthSnapshot::kMaxLevels) {
+        throw std::invalid_argument("Tick store depth levels must be between 1 and " +
+                                    std::to_string(DepthSnapshot::kMaxLevels));
+    }
+    config_.buffer_rows = std::max<size_t>(config_.buffer_rows, 1);
+    std::error_code error;
+    std::filesystem::create_directories(root, error);
+    if (error) {
+        throw std::runtime_error("Cannot create tick store " + root + ": " + error.message());
+    }
+}
+
+TickStore::~TickStore() {
+    try {
+        flush();
+    } catch (...) {
+        // Destructors must not throw; rows already written are kept
+    }
+}
+
+uint32_t TickStore::dayOf(std::chrono::nanoseconds timestamp) {
+    return civilDay(floorDiv(timestamp.count(), kNanosPerDay));
+}
+
+TickStore::Table& TickStore::tableFor(std::unordered_map<uint64_t, std::unique_ptr<Table>>& tables, Table*& last,
+                                      SymbolId symbol_id, int64_t time, bool quotes) {
+    if (last && last->covers(symbol_id, time)) {
+        return *last;
+    }
+
+    int64_t begin = floorDiv(time, kNanosPerDay) * kNanosPerDay;
+    uint32_t day = civilDay(begin / kNanosPerDay);
+    uint64_t key = (static_cast<uint64_t>(symbol_id) << 32) | day;
+    auto it = tables.find(key);
+    if (it == tables.end()) {
+        // A symbol's days come in order: write out and drop the ones before this one
+        for (auto older = tables.begin(); older != tables.end();) {
+            if (older->second->symbolId() == symbol_id && older->second->begin() < begin) {
+                older->second->write();
+                older = tables.erase(older);
+            } else {
+                ++older;
+            }
+        }
+        last = nullptr;
+
+        std::string dir = root_ + "/" + SymbolRegistry::instance().name(symbol_id) + "/" + dayName(day) +
+                          (quotes ? "/quotes" : "/trades");
+        auto table = std::make_unique<Table>(dir, quotes ? kQuoteColumns : kTradeColumns,
+                                             quotes ? config_.depth_levels : 1, config_.buffer_rows,
+                                             symbol_id, begin);
+        it = tables.emplace(key, std::move(table)).first;
+    }
+    last = it->second.get();
+    return *last;
+}
+
+void TickStore::recordTrade(const Trade& trade) {
+    int64_t time = trade.getTimestamp().count();
+    auto& table = tableFor(trades_, last_trades_, trade.getSymbolId(), time, false);
+    table.put(0, table.stamp(time));
+    table.put(1, trade.getPrice());
+    table.put(2, trade.getQuantity());
+    table.put(3, trade.getTakerSide());
+    table.put(4, trade.getId());
+    table.endRow();
+    ++trade_count_;
+}
+
+void TickStore::recordQuote(SymbolId symbol_id, const TopOfBook& top) {
+    int64_t time = top.timestamp.count();
+    auto& table = tableFor(quotes_, last_quotes_, symbol_id, time, true);
+    table.put(0, table.stamp(time));
+    for (size_t level = 0; level < config_.depth_levels; ++level) {
+        bool best = level == 0;
+        table.put(1, best ? top.bid_price : Order::Price(0), level);
+        table.put(2, best ? top.bid_size : Order::Quantity(0), level);
+        table.put(3, best ? top.ask_price : Order::Price(0), level);
+        table.put(4, best ? top.ask_size : Order::Quantity(0), level);
+    }
+    table.endRow();
+    ++quote_count_;
+}
+
+void TickStore::recordQuote(SymbolId symbol_id, const DepthSnapshot& depth) {
+    int64_t time = depth.top.timestamp.count();
+    auto& table = tableFor(quotes_, last_quotes_, symbol_id, time, true);
+    table.put(0, table.stamp(time));
+    for (size_t level = 0; level < config_.depth_levels; ++level) {
+        bool bid = level < depth.bid_count;
+        bool ask = level < depth.ask_count;
+        table.put(1, bid ? depth.bids[level].price : Order::Price(0), level);
+        table.put(2, bid ? depth.bids[level].total_quantity : Order::Quantity(0), level);
+        table.put(3, ask ? depth.asks[level].price : Order::Price(0), level);
+        table.put(4, ask ? depth.asks[level].total_quantity : Order::Quantity(0), level);
+    }
+    table.endRow();
+    ++quote_count_;
+}
+
+void TickStore::attach(OrderBook& book) {
+    book.registerTradeCallback([this](const Trade& trade) { recordTrade(trade); });
+    book.registerDepthUpdateCallback([this, symbol_id = book.getSymbolId()](const DepthSnapshot& depth) {
+        recordQuote(symbol_id, depth);
+    });
+}
+
+void TickStore::flush() {
+    for (auto* tables : {&trades_, &quotes_}) {
+        for (auto& entry : *tables) {
+            entry.second->write();
+        }
+    }
+}
+
+void TickStore::close() {
+    flush();
+    trades_.clear();
+    quotes_.clear();
+    last_trades_ = nullptr;
+    last_quotes_ = nullptr;
+}
+
+MappedColumn::MappedColumn(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw fileError("Cannot open tick store column", path);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw fileError("Cannot stat tick store column", path);
+    }
+    length_ = static_cast<size_t>(st.st_size);
+    if (length_ < sizeof(TickColumnHeader)) {
+        ::close(fd);
+        throw std::runtime_error("Not a tick store column: " + path);
+    }
+
+    mapping_ = ::mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping_ == MAP_FAILED) {
+        mapping_ = nullptr;
+        throw fileError("Cannot map tick store column", path);
+    }
+
+    const auto* header = static_cast<const TickColumnHeader*>(mapping_);
+    if (!validHeader(*header)) {
+        ::munmap(mapping_, length_);
+        mapping_ = nullptr;
+        throw std::runtime_error("Not a tick store column: " + path);
+    }
+
+    value_size_ = header->value_size;
+    width_ = header->width;
+    size_t available = (length_ - sizeof(TickColumnHeader)) / (value_size_ * width_);
+    rows_ = std::min<uint64_t>(header->row_count, available);
+    values_ = static_cast<const char*>(mapping_) + sizeof(TickColumnHeader);
+}
+
+MappedColumn::~MappedColumn() {
+    if (mapping_) {
+        ::munmap(mapping_, length_);
+    }
+}
+
+MappedColumn::MappedColumn(MappedColumn&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedColumn& MappedColumn::operator=(MappedColumn&& other) noexcept {
+    std::swap(mapping_, other.mapping_);
+    std::swap(length_, other.length_);
+    std::swap(values_, other.values_);
+    std::swap(rows_, other.rows_);
+    std::swap(width_, other.width_);
+    std::swap(value_size_, other.value_size_);
+    return *this;
+}
+
+TradeColumns TradeColumns::slice(size_t first, size_t last) const {
+    TradeColumns result;
+    if (first >= last) {
+        return result;
+    }
+    result.rows = last - first;
+    result.time = time + first;
+    result.price = price + first;
+    result.size = size + first;
+    result.side = side + first;
+    result.id = id + first;
+    return result;
+}
+
+QuoteColumns QuoteColumns::slice(size_t first, size_t last) const {
+    QuoteColumns result;
+    result.levels = levels;
+    if (first >= last) {
+        return result;
+    }
+    result.rows = last - first;
+    result.time = time + first;
+    result.bid_price = bid_price + first * levels;
+    result.bid_size = bid_size + first * levels;
+    result.ask_price = ask_price + first * levels;
+    result.ask_size = ask_size + first * levels;
+    return result;
+}
+
+namespace {
+
+// Map a table's columns; a table that was never written has no time column
+size_t mapTable(const std::string& dir, const ColumnSpec* specs, std::vector<MappedColumn>& columns,
+                size_t& levels) {
+    if (!std::filesystem::exists(dir + "/" + specs[0].name)) {
+        return 0;
+    }
+    size_t rows = SIZE_MAX;
+    levels = 1;
+    for (size_t i = 0; i < kColumns; ++i) {
+        MappedColumn column(dir + "/" + specs[i].name);
+        if (column.valueSize() != specs[i].value_size || (!specs[i].per_level && column.width() != 1) ||
+            (i > 1 && specs[i].per_level && column.width() != levels)) {
+            throw std::runtime_error("Tick store column has another layout: " + dir + "/" + specs[i].name);
+        }
+        if (specs[i].per_level) {
+            levels = column.width();
+        }
+        rows = std::min(rows, column.rows());
+        columns.push_back(std::move(column));
+    }
+    return rows;
+}
+
+size_t lowerBound(const int64_t* time, size_t rows, std::chrono::nanoseconds at) {
+    return static_cast<size_t>(std::lower_bound(time, time + rows, at.count()) - time);
+}
+
+} // namespace
+
+TickDay::TickDay(const std::string& root, const std::string& symbol, uint32_t day) {
+    std::string dir = root + "/" + symbol + "/" + dayName(day);
+    columns_.reserve(2 * kColumns);
+
+    size_t levels = 1;
+    size_t rows = mapTable(dir + "/trades", kTradeColumns, columns_, levels);
+    if (!columns_.empty()) {
+        trades_.rows = rows;
+        trades_.time = columns_[0].data<int64_t>();
+        trades_.price = columns_[1].data<Order::Price>();
+        trades_.size = columns_[2].data<Order::Quantity>();
+        trades_.side = columns_[3].data<Side>();
+        trades_.id = columns_[4].data<Trade::TradeId>();
+    }
+
+    size_t first = columns_.size();
+    rows = mapTable(dir + "/quotes", kQuoteColumns, columns_, levels);
+    if (columns_.size() > first) {
+        quotes_.rows = rows;
+        quotes_.levels = levels;
+        quotes_.time = columns_[first].data<int64_t>();
+        quotes_.bid_price = columns_[first + 1].data<Order::Price>();
+        quotes_.bid_size = columns_[first + 2].data<Order::Quantity>();
+        quotes_.ask_price = columns_[first + 3].data<Order::Price>();
+        quotes_.ask_size = columns_[first + 4].data<Order::Quantity>();
+    }
+}
+
+TradeColumns TickDay::trades(std::chrono::nanoseconds from, std::chrono::nanoseconds to) const {
+    return trades_.slice(lowerBound(trades_.time, trades_.rows, from), lowerBound(trades_.time, trades_.rows, to));
+}
+
+QuoteColumns TickDay::quotes(std::chrono::nanoseconds from, std::chrono::nanoseconds to) const {
+    return quotes_.slice(lowerBound(quotes_.time, quotes_.rows, from), lowerBound(quotes_.time, quotes_.rows, to));
+}
+
+std::vector<uint32_t> TickDay::days(const std::string& root, const std::string& symbol) {
+    std::vector<uint32_t> days;
+    std::error_code error;
+    for (std::filesystem::directory_iterator it(root + "/" + symbol, error), end; !error && it != end;
+         it.increment(error)) {
+        auto name = it->path().filename().string();
+        if (name.size() == 8 && std::all_of(name.begin(), name.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            days.push_back(static_cast<uint32_t>(std::stoul(name)));
+        }
+    }
+    std::sort(days.begin(), days.end());
+    return days;
+}
+
+} // namespace orderbook
@@ -2,14 +2,22 @@
 
 namespace orderbook {
 
-Trade::Trade(TradeId id, const std::string& symbol, Price price, Quantity quantity,
-             OrderId maker_order_id, OrderId taker_order_id, Timestamp timestamp)
+Trade::Trade(TradeId id, SymbolId symbol_id, Price price, Quantity quantity,
+             OrderId maker_order_id, OrderId taker_order_id, Timestamp timestamp,
+             Side taker_side)
     : id_(id),
-      symbol_(symbol),
       price_(price),
       quantity_(quantity),
       maker_order_id_(maker_order_id),
       taker_order_id_(taker_order_id),
-      timestamp_(timestamp) {}
+      timestamp_(timestamp),
+      symbol_id_(symbol_id),
+      taker_side_(taker_side) {}
+
+Trade::Trade(TradeId id, const std::string& symbol, Price price, Quantity quantity,
+             OrderId maker_order_id, OrderId taker_order_id, Timestamp timestamp,
+             Side taker_side)
+    : Trade(id, SymbolRegistry::instance().intern(symbol), price, quantity,
+            maker_order_id, taker_order_id, timestamp, taker_side) {}
 
 } // namespace orderbook 
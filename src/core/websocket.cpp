@@ -0,0 +1,521 @@
+#include "orderbook/websocket.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace orderbook {
+
+namespace {
+
+constexpr char kGuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+inline uint32_t rotl(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+// SHA-1, only used for the handshake
+void sha1(std::string_view data, unsigned char digest[20]) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+    std::string message(data);
+    uint64_t bits = static_cast<uint64_t>(data.size()) * 8;
+    message += static_cast<char>(0x80);
+    while (message.size() % 64 != 56) {
+        message += '\0';
+    }
+    for (int i = 7; i >= 0; --i) {
+        message += static_cast<char>((bits >> (i * 8)) & 0xFF);
+    }
+
+    for (size_t chunk = 0; chunk < message.size(); chunk += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i) {
+            const auto* p = reinterpret_cast<const unsigned char*>(message.data() + chunk + i * 4);
+            w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+        }
+        for (int i = 16; i < 80; ++i) {
+            w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            uint32_t t = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = t;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+    for (int i = 0; i < 5; ++i) {
+        digest[i * 4] = static_cast<unsigned char>(h[i] >> 24);
+        digest[i * 4 + 1] = static_cast<unsigned char>(h[i] >> 16);
+        digest[i * 4 + 2] = static_cast<unsigned char>(h[i] >> 8);
+        digest[i * 4 + 3] = static_cast<unsigned char>(h[i]);
+    }
+}
+
+std::string base64(const unsigned char* data, size_t size) {
+    static const char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < size; i += 3) {
+        uint32_t group = uint32_t(data[i]) << 16;
+        if (i + 1 < size) {
+            group |= uint32_t(data[i + 1]) << 8;
+        }
+        if (i + 2 < size) {
+            group |= data[i + 2];
+        }
+        out += kAlphabet[(group >> 18) & 0x3F];
+        out += kAlphabet[(group >> 12) & 0x3F];
+        out += i + 1 < size ? kAlphabet[(group >> 6) & 0x3F] : '=';
+        out += i + 2 < size ? kAlphabet[group & 0x3F] : '=';
+    }
+    return out;
+}
+
+// Value of a header in an HTTP message (names compared case-insensitively)
+std::string_view headerValue(std::string_view message, std::string_view name) {
+    size_t line = message.find("\r\n");
+    while (line != std::string_view::npos && line + 2 < message.size()) {
+        size_t start = line + 2;
+        size_t end = message.find("\r\n", start);
+        if (end == std::string_view::npos || end == start) {
+            break;
+        }
+        auto header = message.substr(start, end - start);
+        auto colon = header.find(':');
+        if (colon == name.size() &&
+            std::equal(name.begin(), name.end(), header.begin(), [](char a, char b) {
+                return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+            })) {
+            auto value = header.substr(colon + 1);
+            while (!value.empty() && value.front() == ' ') {
+                value.remove_prefix(1);
+            }
+            while (!value.empty() && value.back() == ' ') {
+                value.remove_suffix(1);
+            }
+            return value;
+        }
+        line = end;
+    }
+    return {};
+}
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+} // namespace
+
+WebSocketUrl parseWebSocketUrl(const std::string& url) {
+    const std::string scheme = "ws://";
+    if (url.compare(0, scheme.size(), scheme) != 0) {
+        throw std::invalid_argument("Only ws:// URLs are supported: " + url);
+    }
+
+    WebSocketUrl parsed;
+    auto rest = url.substr(scheme.size());
+    auto slash = rest.find('/');
+    auto authority = rest.substr(0, slash);
+    if (slash != std::string::npos) {
+        parsed.path = rest.substr(slash);
+    }
+    auto colon = authority.rfind(':');
+    parsed.host = authority.substr(0, colon);
+    if (colon != std::string::npos) {
+        unsigned long port = 0;
+        try {
+            port = std::stoul(authority.substr(colon + 1));
+        } catch (const std::exception&) {
+            port = 0;
+        }
+        if (port == 0 || port > 65535) {
+            throw std::invalid_argument("Invalid port in " + url);
+        }
+        parsed.port = static_cast<uint16_t>(port);
+    }
+    if (parsed.host.empty()) {
+        throw std::invalid_argument("Missing host in " + url);
+    }
+    return parsed;
+}
+
+std::string webSocketAccept(std::string_view key) {
+    std::string input(key);
+    input += kGuid;
+    unsigned char digest[20];
+    sha1(input, digest);
+    return base64(digest, sizeof(digest));
+}
+
+std::string webSocketRequest(const WebSocketUrl& url, std::string& key) {
+    static thread_local std::mt19937_64 rng(std::random_device{}());
+    unsigned char nonce[16];
+    for (auto& byte : nonce) {
+        byte = static_cast<unsigned char>(rng());
+    }
+    key = base64(nonce, sizeof(nonce));
+
+    std::string request = "GET " + url.path + " HTTP/1.1\r\n";
+    request += "Host: " + url.host + ":" + std::to_string(url.port) + "\r\n";
+    request += "Upgrade: websocket\r\n";
+    request += "Connection: Upgrade\r\n";
+    request += "Sec-WebSocket-Key: " + key + "\r\n";
+    request += "Sec-WebSocket-Version: 13\r\n\r\n";
+    return request;
+}
+
+size_t checkWebSocketResponse(std::string_view response, std::string_view key) {
+    auto end = response.find("\r\n\r\n");
+    if (end == std::string_view::npos) {
+        return 0;
+    }
+    auto headers = response.substr(0, end + 2);
+    auto status_end = headers.find("\r\n");
+    auto status = headers.substr(0, status_end);
+    if (status.find(" 101") == std::string_view::npos) {
+        throw std::runtime_error("WebSocket upgrade refused: " + std::string(status));
+    }
+    if (headerValue(headers, "Sec-WebSocket-Accept") != webSocketAccept(key)) {
+        throw std::runtime_error("WebSocket upgrade: wrong Sec-WebSocket-Accept");
+    }
+    return end + 4;
+}
+
+void appendFrame(std::string& out, WebSocketOpcode opcode, std::string_view payload, bool mask, uint32_t mask_key) {
+    out += static_cast<char>(0x80 | static_cast<uint8_t>(opcode));
+    char mask_bit = mask ? static_cast<char>(0x80) : 0;
+    size_t length = payload.size();
+    if (length < 126) {
+        out += static_cast<char>(mask_bit | static_cast<char>(length));
+    } else if (length <= 0xFFFF) {
+        out += static_cast<char>(mask_bit | 126);
+        out += static_cast<char>(length >> 8);
+        out += static_cast<char>(length & 0xFF);
+    } else {
+        out += static_cast<char>(mask_bit | 127);
+        for (int i = 7; i >= 0; --i) {
+            out += static_cast<char>((static_cast<uint64_t>(length) >> (i * 8)) & 0xFF);
+        }
+    }
+
+    if (!mask) {
+        out.append(payload);
+        return;
+    }
+    char key[4] = {static_cast<char>(mask_key >> 24), static_cast<char>(mask_key >> 16),
+                   static_cast<char>(mask_key >> 8), static_cast<char>(mask_key)};
+    out.append(key, 4);
+    size_t start = out.size();
+    out.append(payload);
+    for (size_t i = 0; i < length; ++i) {
+        out[start + i] ^= key[i & 3];
+    }
+}
+
+// Local WebSocket server
+struct WebSocketServer::Client {
+    explicit Client(int socket) : fd(socket), buffer(64 * 1024) {}
+
+    int fd;
+    std::atomic<bool> open{false};    // Handshake completed
+    std::vector<char> buffer;
+    size_t filled = 0;
+    WebSocketFrameParser parser;
+    std::mutex write_mutex;           // Serializes server-thread replies and send()/replay()
+
+    bool write(const std::string& data) {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        return fd >= 0 && writeAll(fd, data.data(), data.size());
+    }
+};
+
+WebSocketServer::WebSocketServer(uint16_t port, bool echo) : echo_(echo) {
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        throw std::runtime_error(std::string("Cannot create server socket: ") + std::strerror(errno));
+    }
+    int reuse = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    socklen_t length = sizeof(address);
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listen_fd_, 16) != 0 ||
+        ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &length) != 0 ||
+        ::pipe(wake_fds_) != 0) {
+        std::string error = std::string("Cannot listen: ") + std::strerror(errno);
+        ::close(listen_fd_);
+        throw std::runtime_error(error);
+    }
+    port_ = ntohs(address.sin_port);
+    thread_ = std::thread(&WebSocketServer::run, this);
+}
+
+WebSocketServer::~WebSocketServer() {
+    running_ = false;
+    wake();
+    thread_.join();
+    for (auto& client : clients_) {
+        ::close(client->fd);
+    }
+    ::close(listen_fd_);
+    ::close(wake_fds_[0]);
+    ::close(wake_fds_[1]);
+}
+
+std::string WebSocketServer::url(const std::string& path) const {
+    return "ws://127.0.0.1:" + std::to_string(port_) + path;
+}
+
+bool WebSocketServer::waitForClients(size_t count, std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (clients() < count) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+size_t WebSocketServer::clients() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<size_t>(std::count_if(clients_.begin(), clients_.end(),
+                                             [](const auto& client) { return client->open.load(); }));
+}
+
+void WebSocketServer::send(std::string_view text) {
+    std::string frame;
+    appendFrame(frame, WebSocketOpcode::TEXT, text, false);
+
+    std::vector<std::shared_ptr<Client>> clients;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        clients = clients_;
+    }
+    for (auto& client : clients) {
+        if (client->open) {
+            client->write(frame);
+        }
+    }
+}
+
+void WebSocketServer::replay(const std::vector<std::string>& messages, double rate) {
+    std::vector<std::shared_ptr<Client>> clients;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& client : clients_) {
+            if (client->open) {
+                clients.push_back(client);
+            }
+        }
+    }
+
+    // Unpaced, frames go out in large writes
+    constexpr size_t kChunk = 64 * 1024;
+    std::string chunk;
+    auto flush = [&] {
+        for (auto& client : clients) {
+            client->write(chunk);
+        }
+        chunk.clear();
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < messages.size(); ++i) {
+        if (rate > 0) {
+            auto due = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                   std::chrono::duration<double>(i / rate));
+            if (std::chrono::steady_clock::now() < due) {
+                flush();
+                std::this_thread::sleep_until(due);
+            }
+        }
+        appendFrame(chunk, WebSocketOpcode::TEXT, messages[i], false);
+        if (chunk.size() >= kChunk) {
+            flush();
+        }
+    }
+    flush();
+}
+
+void WebSocketServer::disconnectClients() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& client : clients_) {
+        ::shutdown(client->fd, SHUT_RDWR);
+    }
+}
+
+std::vector<std::string> WebSocketServer::received() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return received_;
+}
+
+void WebSocketServer::wake() {
+    char byte = 1;
+    (void)::write(wake_fds_[1], &byte, 1);
+}
+
+void WebSocketServer::run() {
+    std::vector<pollfd> polls;
+    std::vector<std::shared_ptr<Client>> clients;
+
+    while (running_.load(std::memory_order_relaxed)) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            clients = clients_;
+        }
+        polls.clear();
+        polls.push_back({listen_fd_, POLLIN, 0});
+        polls.push_back({wake_fds_[0], POLLIN, 0});
+        for (const auto& client : clients) {
+            polls.push_back({client->fd, POLLIN, 0});
+        }
+        if (::poll(polls.data(), polls.size(), 100) <= 0) {
+            continue;
+        }
+
+        if (polls[1].revents & POLLIN) {
+            char drain[64];
+            (void)::read(wake_fds_[0], drain, sizeof(drain));
+        }
+        if (polls[0].revents & POLLIN) {
+            int fd = ::accept(listen_fd_, nullptr, nullptr);
+            if (fd >= 0) {
+                int nodelay = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+                std::lock_guard<std::mutex> lock(mutex_);
+                clients_.push_back(std::make_shared<Client>(fd));
+            }
+        }
+
+        for (size_t i = 0; i < clients.size(); ++i) {
+            if (polls[i + 2].revents == 0 || serviceClient(*clients[i])) {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            clients_.erase(std::find(clients_.begin(), clients_.end(), clients[i]));
+            std::lock_guard<std::mutex> write_lock(clients[i]->write_mutex);
+            ::close(clients[i]->fd);
+            clients[i]->fd = -1;
+        }
+    }
+}
+
+bool WebSocketServer::serviceClient(Client& client) {
+    if (client.filled == client.buffer.size()) {
+        client.buffer.resize(client.buffer.size() * 2);
+    }
+    ssize_t received = ::recv(client.fd, client.buffer.data() + client.filled,
+                              client.buffer.size() - client.filled, 0);
+    if (received <= 0) {
+        return false;
+    }
+    client.filled += static_cast<size_t>(received);
+
+    size_t consumed = 0;
+    if (!client.open) {
+        std::string_view request(client.buffer.data(), client.filled);
+        auto end = request.find("\r\n\r\n");
+        if (end == std::string_view::npos) {
+            return true;
+        }
+        auto key = headerValue(request.substr(0, end + 2), "Sec-WebSocket-Key");
+        if (key.empty()) {
+            client.write("HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n");
+            return false;
+        }
+        std::string response = "HTTP/1.1 101 Switching Protocols\r\n"
+                               "Upgrade: websocket\r\n"
+                               "Connection: Upgrade\r\n"
+                               "Sec-WebSocket-Accept: " + webSocketAccept(key) + "\r\n\r\n";
+        if (!client.write(response)) {
+            return false;
+        }
+        consumed = end + 4;
+        client.open = true;
+    }
+
+    bool keep = true;
+    consumed += client.parser.parse(client.buffer.data() + consumed, client.filled - consumed,
+                                    [&](WebSocketOpcode opcode, std::string_view payload) {
+        std::string reply;
+        switch (opcode) {
+            case WebSocketOpcode::TEXT: {
+                std::lock_guard<std::mutex> lock(mutex_);
+                received_.emplace_back(payload);
+                if (echo_) {
+                    appendFrame(reply, WebSocketOpcode::TEXT, payload, false);
+                }
+                break;
+            }
+            case WebSocketOpcode::PING:
+                appendFrame(reply, WebSocketOpcode::PONG, payload, false);
+                break;
+            case WebSocketOpcode::CLOSE:
+                appendFrame(reply, WebSocketOpcode::CLOSE, payload.substr(0, 2), false);
+                keep = false;
+                break;
+            default:
+                break;
+        }
+        if (!reply.empty()) {
+            client.write(reply);
+        }
+    });
+    if (client.parser.failed()) {
+        return false;
+    }
+    std::memmove(client.buffer.data(), client.buffer.data() + consumed, client.filled - consumed);
+    client.filled -= consumed;
+    return keep;
+}
+
+} // namespace orderbook
@@ -2,15 +2,60 @@
 #include <pybind11/stl.h>
 #include <pybind11/chrono.h>
 #include <pybind11/functional.h>
+#include <pybind11/numpy.h>
+#include "orderbook/symbol_registry.h"
 #include "orderbook/order.h"
 #include "orderbook/trade.h"
 #include "orderbook/order_book.h"
 #include "orderbook/market_data_feed.h"
+#include "orderbook/market_data_file.h"
 #include "orderbook/market_data_handler.h"
+#include "orderbook/book_snapshot.h"
+#include "orderbook/journal.h"
+#include "orderbook/tick_store.h"
+#include "orderbook/flow_generator.h"
 
 namespace py = pybind11;
 using namespace orderbook;
 
+namespace {
+
+// Read-only numpy view of a mapped column, keeping its owner alive
+template <typename T>
+py::array columnArray(const T* data, size_t rows, size_t width, py::handle owner) {
+    std::vector<py::ssize_t> shape{static_cast<py::ssize_t>(rows)};
+    std::vector<py::ssize_t> strides{static_cast<py::ssize_t>(width * sizeof(T))};
+    if (width > 1) {
+        shape.push_back(static_cast<py::ssize_t>(width));
+        strides.push_back(sizeof(T));
+    }
+    py::array_t<T> array(shape, strides, data, owner);
+    array.attr("setflags")(py::arg("write") = false);
+    return std::move(array);
+}
+
+py::dict tradeArrays(const TradeColumns& trades, py::handle owner) {
+    py::dict columns;
+    columns["time"] = columnArray(trades.time, trades.rows, 1, owner);
+    columns["price"] = columnArray(trades.price, trades.rows, 1, owner);
+    columns["size"] = columnArray(trades.size, trades.rows, 1, owner);
+    columns["side"] = columnArray(reinterpret_cast<const uint8_t*>(trades.side), trades.rows, 1, owner);
+    columns["id"] = columnArray(trades.id, trades.rows, 1, owner);
+    return columns;
+}
+
+py::dict quoteArrays(const QuoteColumns& quotes, py::handle owner) {
+    py::dict columns;
+    columns["time"] = columnArray(quotes.time, quotes.rows, 1, owner);
+    columns["bid_price"] = columnArray(quotes.bid_price, quotes.rows, quotes.levels, owner);
+    columns["bid_size"] = columnArray(quotes.bid_size, quotes.rows, quotes.levels, owner);
+    columns["ask_price"] = columnArray(quotes.ask_price, quotes.rows, quotes.levels, owner);
+    columns["ask_size"] = columnArray(quotes.ask_size, quotes.rows, quotes.levels, owner);
+    return columns;
+}
+
+} // namespace
+
 PYBIND11_MODULE(core, m) {
     m.doc() = "OrderBook - Ultra-Low-Latency Market Data Analyzer";
 
@@ -38,14 +83,36 @@ PYBIND11_MODULE(core, m) {
         .value("EXPIRED", OrderStatus::EXPIRED)
         .export_values();
 
+    // SymbolRegistry class
+    py::class_<SymbolRegistry, std::unique_ptr<SymbolRegistry, py::nodelete>>(m, "SymbolRegistry")
+        .def_static("instance", &SymbolRegistry::instance, py::return_value_policy::reference)
+        .def("intern", &SymbolRegistry::intern)
+        .def("find", [](const SymbolRegistry& registry, const std::string& name) -> py::object {
+            SymbolId id;
+            if (!registry.find(name, id)) {
+                return py::none();
+            }
+            return py::cast(id);
+        })
+        .def("name", &SymbolRegistry::name)
+        .def("size", &SymbolRegistry::size);
+
     // Order class
     py::class_<Order>(m, "Order")
         .def(py::init<>())
         .def(py::init<Order::OrderId, const std::string&, Order::Price, Order::Quantity, 
                     Side, OrderType, Order::Timestamp>())
+        .def(py::init<Order::OrderId, SymbolId, Order::Price, Order::Quantity, 
+                    Side, OrderType, Order::Timestamp>())
+        .def(py::init<Order::OrderId, const std::string&, Order::Price, Order::Quantity, 
+                    Side, OrderType, Order::Timestamp, Order::Price>())
+        .def(py::init<Order::OrderId, SymbolId, Order::Price, Order::Quantity, 
+                    Side, OrderType, Order::Timestamp, Order::Price>())
         .def("get_id", &Order::getId)
         .def("get_symbol", &Order::getSymbol)
+        .def("get_symbol_id", &Order::getSymbolId)
         .def("get_price", &Order::getPrice)
+        .def("get_stop_price", &Order::getStopPrice)
         .def("get_quantity", &Order::getQuantity)
         .def("get_remaining_quantity", &Order::getRemainingQuantity)
         .def("get_side", &Order::getSide)
@@ -53,6 +120,7 @@ PYBIND11_MODULE(core, m) {
         .def("get_status", &Order::getStatus)
         .def("get_timestamp", &Order::getTimestamp)
         .def("set_price", &Order::setPrice)
+        .def("set_stop_price", &Order::setStopPrice)
         .def("set_quantity", &Order::setQuantity)
         .def("set_remaining_quantity", &Order::setRemainingQuantity)
         .def("set_status", &Order::setStatus)
@@ -64,13 +132,17 @@ PYBIND11_MODULE(core, m) {
         .def(py::init<>())
         .def(py::init<Trade::TradeId, const std::string&, Trade::Price, Trade::Quantity,
                     Trade::OrderId, Trade::OrderId, Trade::Timestamp>())
+        .def(py::init<Trade::TradeId, SymbolId, Trade::Price, Trade::Quantity,
+                    Trade::OrderId, Trade::OrderId, Trade::Timestamp>())
         .def("get_id", &Trade::getId)
         .def("get_symbol", &Trade::getSymbol)
+        .def("get_symbol_id", &Trade::getSymbolId)
         .def("get_price", &Trade::getPrice)
         .def("get_quantity", &Trade::getQuantity)
         .def("get_maker_order_id", &Trade::getMakerOrderId)
         .def("get_taker_order_id", &Trade::getTakerOrderId)
         .def("get_timestamp", &Trade::getTimestamp)
+        .def("get_taker_side", &Trade::getTakerSide)
         .def("get_value", &Trade::getValue);
 
     // TopOfBook struct
@@ -82,29 +154,209 @@ PYBIND11_MODULE(core, m) {
         .def_readwrite("ask_size", &TopOfBook::ask_size)
         .def_readwrite("timestamp", &TopOfBook::timestamp);
 
-    // PriceLevel struct
+    // PriceLevel struct (DepthLevel is the same type)
     py::class_<PriceLevel>(m, "PriceLevel")
         .def(py::init<>())
         .def_readwrite("price", &PriceLevel::price)
         .def_readwrite("total_quantity", &PriceLevel::total_quantity)
-        .def_property_readonly("orders", [](const PriceLevel& pl) {
-            return py::cast(pl.orders);
+        .def_readwrite("order_count", &PriceLevel::order_count);
+    m.attr("DepthLevel") = m.attr("PriceLevel");
+
+    // OrderFlowImbalance struct
+    py::class_<OrderFlowImbalance>(m, "OrderFlowImbalance")
+        .def(py::init<>())
+        .def_readwrite("window", &OrderFlowImbalance::window)
+        .def_readwrite("total", &OrderFlowImbalance::total)
+        .def_readwrite("events", &OrderFlowImbalance::events);
+
+    // DepthSnapshot struct
+    py::class_<DepthSnapshot>(m, "DepthSnapshot")
+        .def(py::init<>())
+        .def_readwrite("top", &DepthSnapshot::top)
+        .def_property_readonly("bids", [](const DepthSnapshot& snapshot) {
+            return std::vector<DepthLevel>(snapshot.bids, snapshot.bids + snapshot.bid_count);
+        })
+        .def_property_readonly("asks", [](const DepthSnapshot& snapshot) {
+            return std::vector<DepthLevel>(snapshot.asks, snapshot.asks + snapshot.ask_count);
         });
 
+    py::enum_<BookStorage>(m, "BookStorage")
+        .value("MAP", BookStorage::MAP)
+        .value("ARRAY", BookStorage::ARRAY)
+        .export_values();
+
+    py::enum_<UpdateNotification>(m, "UpdateNotification")
+        .value("EVERY_MUTATION", UpdateNotification::EVERY_MUTATION)
+        .value("ON_CHANGE", UpdateNotification::ON_CHANGE)
+        .export_values();
+
+    // OrderBookConfig struct
+    py::class_<OrderBookConfig>(m, "OrderBookConfig")
+        .def(py::init<>())
+        .def_readwrite("storage", &OrderBookConfig::storage)
+        .def_readwrite("tick_size", &OrderBookConfig::tick_size)
+        .def_readwrite("ladder_levels", &OrderBookConfig::ladder_levels)
+        .def_readwrite("order_capacity", &OrderBookConfig::order_capacity)
+        .def_readwrite("level_capacity", &OrderBookConfig::level_capacity)
+        .def_readwrite("single_writer", &OrderBookConfig::single_writer)
+        .def_readwrite("published_levels", &OrderBookConfig::published_levels)
+        .def_readwrite("depth_levels", &OrderBookConfig::depth_levels)
+        .def_readwrite("ofi_window", &OrderBookConfig::ofi_window)
+        .def_readwrite("update_notification", &OrderBookConfig::update_notification);
+
     // OrderBook class
     py::class_<OrderBook>(m, "OrderBook")
         .def(py::init<const std::string&>())
+        .def(py::init<const std::string&, const OrderBookConfig&>())
         .def("get_symbol", &OrderBook::getSymbol)
-        .def("add_order", &OrderBook::addOrder)
-        .def("cancel_order", &OrderBook::cancelOrder)
-        .def("modify_order", &OrderBook::modifyOrder)
+        .def("get_symbol_id", &OrderBook::getSymbolId)
+        .def("get_config", &OrderBook::getConfig)
+        .def("add_order", static_cast<std::vector<Trade> (OrderBook::*)(const Order&)>(&OrderBook::addOrder))
+        .def("cancel_order", static_cast<bool (OrderBook::*)(Order::OrderId)>(&OrderBook::cancelOrder))
+        .def("cancel_order", static_cast<bool (OrderBook::*)(Order::OrderId, Order::Timestamp)>(&OrderBook::cancelOrder))
+        .def("execute_order", static_cast<bool (OrderBook::*)(Order::OrderId, Order::Quantity)>(&OrderBook::executeOrder))
+        .def("execute_order", static_cast<bool (OrderBook::*)(Order::OrderId, Order::Quantity, Order::Timestamp)>(&OrderBook::executeOrder))
+        .def("modify_order", static_cast<bool (OrderBook::*)(Order::OrderId, Order::Price, Order::Quantity)>(&OrderBook::modifyOrder))
+        .def("modify_order", static_cast<bool (OrderBook::*)(Order::OrderId, Order::Price, Order::Quantity, Order::Timestamp)>(&OrderBook::modifyOrder))
         .def("get_top_of_book", &OrderBook::getTopOfBook)
-        .def("get_depth", &OrderBook::getDepth)
+        .def("get_depth_snapshot", &OrderBook::getDepthSnapshot)
+        .def("get_depth", static_cast<std::pair<std::vector<PriceLevel>, std::vector<PriceLevel>> (OrderBook::*)(size_t) const>(&OrderBook::getDepth))
         .def("register_trade_callback", &OrderBook::registerTradeCallback)
         .def("register_order_book_update_callback", &OrderBook::registerOrderBookUpdateCallback)
+        .def("register_depth_update_callback", &OrderBook::registerDepthUpdateCallback)
         .def("calculate_order_flow_imbalance", &OrderBook::calculateOrderFlowImbalance)
+        .def("get_event_order_flow_imbalance", &OrderBook::getEventOrderFlowImbalance)
         .def("get_all_orders", &OrderBook::getAllOrders)
-        .def("clear", &OrderBook::clear);
+        .def("save_snapshot", [](const OrderBook& book, uint64_t sequence) {
+            std::string data;
+            book.saveSnapshot(data, sequence);
+            return py::bytes(data);
+        }, py::arg("sequence") = 0)
+        .def("load_snapshot", [](OrderBook& book, const py::bytes& data) {
+            return book.loadSnapshot(std::string(data));
+        })
+        .def("clear", &OrderBook::clear)
+        .def("set_journal", &OrderBook::setJournal);
+
+    m.def("write_book_snapshot", &writeBookSnapshot, py::arg("path"), py::arg("book"), py::arg("sequence") = 0);
+    m.def("read_book_snapshot", &readBookSnapshot, py::arg("path"), py::arg("book"));
+
+    // Journal
+    py::class_<JournalConfig>(m, "JournalConfig")
+        .def(py::init<>())
+        .def_readwrite("queue_capacity", &JournalConfig::queue_capacity)
+        .def_readwrite("commit_events", &JournalConfig::commit_events)
+        .def_readwrite("commit_interval", &JournalConfig::commit_interval)
+        .def_readwrite("preallocate", &JournalConfig::preallocate)
+        .def_readwrite("poll_interval", &JournalConfig::poll_interval);
+
+    py::class_<JournalStats>(m, "JournalStats")
+        .def(py::init<>())
+        .def_readonly("recorded", &JournalStats::recorded)
+        .def_readonly("written", &JournalStats::written)
+        .def_readonly("durable", &JournalStats::durable)
+        .def_readonly("commits", &JournalStats::commits)
+        .def_readonly("full_waits", &JournalStats::full_waits);
+
+    py::class_<BookJournal, std::shared_ptr<BookJournal>>(m, "BookJournal")
+        .def(py::init<const std::string&, const JournalConfig&>(), py::arg("path"), py::arg("config") = JournalConfig())
+        .def("flush", &BookJournal::flush, py::call_guard<py::gil_scoped_release>())
+        .def("close", &BookJournal::close, py::call_guard<py::gil_scoped_release>())
+        .def("get_stats", &BookJournal::getStats)
+        .def("path", &BookJournal::path);
+
+    py::class_<JournalReplayer>(m, "JournalReplayer")
+        .def(py::init<const OrderBookConfig&>(), py::arg("config") = OrderBookConfig())
+        .def("add_book", &JournalReplayer::addBook)
+        .def("apply_file", &JournalReplayer::applyFile)
+        .def("get_order_book", &JournalReplayer::getOrderBook)
+        .def("get_order_books", &JournalReplayer::getOrderBooks)
+        .def("records", &JournalReplayer::records)
+        .def("trades", &JournalReplayer::trades)
+        .def("mismatches", &JournalReplayer::mismatches)
+        .def("truncated", &JournalReplayer::truncated);
+
+    // Tick store
+    py::class_<TickStoreConfig>(m, "TickStoreConfig")
+        .def(py::init<>())
+        .def_readwrite("depth_levels", &TickStoreConfig::depth_levels)
+        .def_readwrite("buffer_rows", &TickStoreConfig::buffer_rows);
+
+    py::class_<TickStore>(m, "TickStore")
+        .def(py::init<const std::string&, const TickStoreConfig&>(), py::arg("root"), py::arg("config") = TickStoreConfig())
+        .def("record_trade", &TickStore::recordTrade)
+        .def("record_quote", static_cast<void (TickStore::*)(SymbolId, const TopOfBook&)>(&TickStore::recordQuote))
+        .def("record_quote", static_cast<void (TickStore::*)(SymbolId, const DepthSnapshot&)>(&TickStore::recordQuote))
+        .def("attach", &TickStore::attach, py::keep_alive<2, 1>())
+        .def("flush", &TickStore::flush)
+        .def("close", &TickStore::close)
+        .def("root", &TickStore::root)
+        .def("trade_count", &TickStore::tradeCount)
+        .def("quote_count", &TickStore::quoteCount)
+        .def_static("day_of", [](int64_t nanoseconds) { return TickStore::dayOf(std::chrono::nanoseconds(nanoseconds)); });
+
+    // Columns come back as read-only numpy arrays over the mapped files (time in nanoseconds)
+    py::class_<TickDay>(m, "TickDay")
+        .def(py::init<const std::string&, const std::string&, uint32_t>(), py::arg("root"), py::arg("symbol"), py::arg("day"))
+        .def("trades", [](py::object self, int64_t from, int64_t to) {
+            const auto& day = self.cast<const TickDay&>();
+            return tradeArrays(day.trades(std::chrono::nanoseconds(from), std::chrono::nanoseconds(to)), self);
+        }, py::arg("start") = INT64_MIN, py::arg("end") = INT64_MAX)
+        .def("quotes", [](py::object self, int64_t from, int64_t to) {
+            const auto& day = self.cast<const TickDay&>();
+            return quoteArrays(day.quotes(std::chrono::nanoseconds(from), std::chrono::nanoseconds(to)), self);
+        }, py::arg("start") = INT64_MIN, py::arg("end") = INT64_MAX)
+        .def_static("days", &TickDay::days, py::arg("root"), py::arg("symbol"));
+
+    // OrderFlowConfig class
+    py::class_<OrderFlowConfig>(m, "OrderFlowConfig")
+        .def(py::init<>())
+        .def_readwrite("seed", &OrderFlowConfig::seed)
+        .def_readwrite("symbols", &OrderFlowConfig::symbols)
+        .def_readwrite("symbol_names", &OrderFlowConfig::symbol_names)
+        .def_readwrite("symbol_skew", &OrderFlowConfig::symbol_skew)
+        .def_readwrite("base_rate", &OrderFlowConfig::base_rate)
+        .def_readwrite("branching_ratio", &OrderFlowConfig::branching_ratio)
+        .def_readwrite("decay_rate", &OrderFlowConfig::decay_rate)
+        .def_readwrite("start_time", &OrderFlowConfig::start_time)
+        .def_readwrite("add_weight", &OrderFlowConfig::add_weight)
+        .def_readwrite("cancel_weight", &OrderFlowConfig::cancel_weight)
+        .def_readwrite("modify_weight", &OrderFlowConfig::modify_weight)
+        .def_readwrite("execute_weight", &OrderFlowConfig::execute_weight)
+        .def_readwrite("target_orders_per_symbol", &OrderFlowConfig::target_orders_per_symbol)
+        .def_readwrite("marketable_fraction", &OrderFlowConfig::marketable_fraction)
+        .def_readwrite("price_change_fraction", &OrderFlowConfig::price_change_fraction)
+        .def_readwrite("start_price", &OrderFlowConfig::start_price)
+        .def_readwrite("tick_size", &OrderFlowConfig::tick_size)
+        .def_readwrite("touch_weight", &OrderFlowConfig::touch_weight)
+        .def_readwrite("max_distance", &OrderFlowConfig::max_distance)
+        .def_readwrite("price_move", &OrderFlowConfig::price_move)
+        .def_readwrite("size_alpha", &OrderFlowConfig::size_alpha)
+        .def_readwrite("min_size", &OrderFlowConfig::min_size)
+        .def_readwrite("max_size", &OrderFlowConfig::max_size)
+        .def_readwrite("lot_size", &OrderFlowConfig::lot_size);
+
+    py::class_<OrderFlowStats>(m, "OrderFlowStats")
+        .def(py::init<>())
+        .def_readonly("events", &OrderFlowStats::events)
+        .def_readonly("adds", &OrderFlowStats::adds)
+        .def_readonly("marketable_adds", &OrderFlowStats::marketable_adds)
+        .def_readonly("cancels", &OrderFlowStats::cancels)
+        .def_readonly("modifies", &OrderFlowStats::modifies)
+        .def_readonly("executes", &OrderFlowStats::executes)
+        .def_readonly("price_moves", &OrderFlowStats::price_moves)
+        .def_readonly("triggered", &OrderFlowStats::triggered)
+        .def_readonly("live_orders", &OrderFlowStats::live_orders);
+
+    // Flow goes to event files, which replay through JournalReplayer or FileReplayFeed
+    py::class_<OrderFlowGenerator>(m, "OrderFlowGenerator")
+        .def(py::init<const OrderFlowConfig&>(), py::arg("config") = OrderFlowConfig())
+        .def("write_file", &OrderFlowGenerator::writeFile, py::arg("path"), py::arg("count"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("next", &OrderFlowGenerator::next)
+        .def("symbol_ids", &OrderFlowGenerator::symbolIds)
+        .def("get_stats", &OrderFlowGenerator::getStats)
+        .def("get_config", &OrderFlowGenerator::getConfig);
 
     // MarketDataMessage class
     py::class_<MarketDataMessage> market_data_message(m, "MarketDataMessage");
@@ -117,8 +369,40 @@ PYBIND11_MODULE(core, m) {
         .value("SNAPSHOT", MarketDataMessage::Type::SNAPSHOT)
         .export_values();
 
+    // MarketDataEvent record
+    py::class_<MarketDataEvent> market_data_event(m, "MarketDataEvent");
+    py::enum_<MarketDataEvent::Type>(market_data_event, "Type")
+        .value("ORDER_ADD", MarketDataEvent::Type::ORDER_ADD)
+        .value("ORDER_MODIFY", MarketDataEvent::Type::ORDER_MODIFY)
+        .value("ORDER_CANCEL", MarketDataEvent::Type::ORDER_CANCEL)
+        .value("ORDER_EXECUTE", MarketDataEvent::Type::ORDER_EXECUTE)
+        .value("TRADE", MarketDataEvent::Type::TRADE)
+        .value("HEARTBEAT", MarketDataEvent::Type::HEARTBEAT)
+        .value("SNAPSHOT", MarketDataEvent::Type::SNAPSHOT)
+        .value("SYMBOL", MarketDataEvent::Type::SYMBOL)
+        .export_values();
+    market_data_event
+        .def(py::init<>())
+        .def_readwrite("type", &MarketDataEvent::type)
+        .def_readwrite("flags", &MarketDataEvent::flags)
+        .def_readwrite("symbol_id", &MarketDataEvent::symbol_id)
+        .def_readwrite("sequence", &MarketDataEvent::sequence)
+        .def_readwrite("timestamp", &MarketDataEvent::timestamp)
+        .def_readonly_static("SNAPSHOT_BEGIN", &MarketDataEvent::kSnapshotBegin)
+        .def_readonly_static("SNAPSHOT_END", &MarketDataEvent::kSnapshotEnd)
+        .def_static("order_add", &MarketDataEvent::orderAdd,
+                    py::arg("symbol_id"), py::arg("order_id"), py::arg("price"), py::arg("quantity"),
+                    py::arg("side"), py::arg("order_type"), py::arg("timestamp"), py::arg("stop_price") = 0)
+        .def_static("order_modify", &MarketDataEvent::orderModify)
+        .def_static("order_cancel", &MarketDataEvent::orderCancel)
+        .def_static("order_execute", &MarketDataEvent::orderExecute)
+        .def_static("trade_print", &MarketDataEvent::tradePrint)
+        .def_static("heartbeat", &MarketDataEvent::heartbeat)
+        .def_static("snapshot_order", &MarketDataEvent::snapshotOrder);
+
     // MarketDataHandler class
     py::class_<MarketDataHandler, std::shared_ptr<MarketDataHandler>>(m, "MarketDataHandler")
+        .def("handle_event", &MarketDataHandler::handleEvent)
         .def("handle_message", &MarketDataHandler::handleMessage);
 
     // MarketDataHandlerImpl class
@@ -126,7 +410,43 @@ PYBIND11_MODULE(core, m) {
         .def(py::init<>())
         .def("register_order_book", &MarketDataHandlerImpl::registerOrderBook)
         .def("unregister_order_book", &MarketDataHandlerImpl::unregisterOrderBook)
-        .def("get_order_book", &MarketDataHandlerImpl::getOrderBook);
+        .def("get_order_book", static_cast<std::shared_ptr<OrderBook> (MarketDataHandlerImpl::*)(const std::string&)>(&MarketDataHandlerImpl::getOrderBook))
+        .def("get_order_book", static_cast<std::shared_ptr<OrderBook> (MarketDataHandlerImpl::*)(SymbolId)>(&MarketDataHandlerImpl::getOrderBook))
+        .def("begin_recovery", &MarketDataHandlerImpl::beginRecovery)
+        .def("complete_recovery", [](MarketDataHandlerImpl& handler, SymbolId symbol_id, const py::bytes& snapshot) {
+            return handler.completeRecovery(symbol_id, std::string(snapshot));
+        });
+
+    // WaitStrategy enum
+    py::enum_<WaitStrategy>(m, "WaitStrategy")
+        .value("BUSY_SPIN", WaitStrategy::BUSY_SPIN)
+        .value("SPIN_YIELD", WaitStrategy::SPIN_YIELD)
+        .value("BLOCKING", WaitStrategy::BLOCKING)
+        .export_values();
+
+    // FeedConfig struct
+    py::class_<FeedConfig>(m, "FeedConfig")
+        .def(py::init<>())
+        .def_readwrite("queue_capacity", &FeedConfig::queue_capacity)
+        .def_readwrite("wait_strategy", &FeedConfig::wait_strategy)
+        .def_readwrite("spin_iterations", &FeedConfig::spin_iterations)
+        .def_readwrite("drop_when_full", &FeedConfig::drop_when_full);
+
+    // HandlerMode enum
+    py::enum_<HandlerMode>(m, "HandlerMode")
+        .value("INLINE", HandlerMode::INLINE)
+        .value("ASYNC", HandlerMode::ASYNC)
+        .export_values();
+
+    // FeedStats struct
+    py::class_<FeedStats>(m, "FeedStats")
+        .def(py::init<>())
+        .def_readonly("published", &FeedStats::published)
+        .def_readonly("dispatched", &FeedStats::dispatched)
+        .def_readonly("backpressure_waits", &FeedStats::backpressure_waits)
+        .def_readonly("overflows", &FeedStats::overflows)
+        .def_readonly("queue_depth", &FeedStats::queue_depth)
+        .def_readonly("async_dropped", &FeedStats::async_dropped);
 
     // MarketDataFeed class
     py::class_<MarketDataFeed, std::shared_ptr<MarketDataFeed>>(m, "MarketDataFeed")
@@ -135,14 +455,219 @@ PYBIND11_MODULE(core, m) {
         .def("subscribe", &MarketDataFeed::subscribe)
         .def("unsubscribe", &MarketDataFeed::unsubscribe)
         .def("register_handler", &MarketDataFeed::registerHandler)
+        .def("unregister_handler", &MarketDataFeed::unregisterHandler)
         .def_static("create", &MarketDataFeed::create);
 
     // BaseMarketDataFeed class
-    py::class_<BaseMarketDataFeed, MarketDataFeed, std::shared_ptr<BaseMarketDataFeed>>(m, "BaseMarketDataFeed");
+    py::class_<BaseMarketDataFeed, MarketDataFeed, std::shared_ptr<BaseMarketDataFeed>>(m, "BaseMarketDataFeed")
+        .def("register_handler", static_cast<void (BaseMarketDataFeed::*)(MarketDataHandler*, HandlerMode, size_t)>(&BaseMarketDataFeed::registerHandler),
+             py::arg("handler"), py::arg("mode") = HandlerMode::INLINE, py::arg("queue_capacity") = 0)
+        .def("get_stats", &BaseMarketDataFeed::getStats)
+        .def("get_config", &BaseMarketDataFeed::getConfig);
+
+    // WebSocketConfig struct
+    py::class_<WebSocketConfig>(m, "WebSocketConfig")
+        .def(py::init<>())
+        .def_readwrite("price_decimals", &WebSocketConfig::price_decimals)
+        .def_readwrite("receive_buffer", &WebSocketConfig::receive_buffer)
+        .def_readwrite("max_message", &WebSocketConfig::max_message)
+        .def_readwrite("connect_timeout", &WebSocketConfig::connect_timeout)
+        .def_readwrite("reconnect_delay", &WebSocketConfig::reconnect_delay);
+
+    // WebSocketStats struct
+    py::class_<WebSocketStats>(m, "WebSocketStats")
+        .def(py::init<>())
+        .def_readonly("connects", &WebSocketStats::connects)
+        .def_readonly("disconnects", &WebSocketStats::disconnects)
+        .def_readonly("bytes", &WebSocketStats::bytes)
+        .def_readonly("messages", &WebSocketStats::messages)
+        .def_readonly("events", &WebSocketStats::events)
+        .def_readonly("decode_errors", &WebSocketStats::decode_errors)
+        .def_readonly("pings", &WebSocketStats::pings);
 
     // WebSocketMarketDataFeed class
     py::class_<WebSocketMarketDataFeed, BaseMarketDataFeed, std::shared_ptr<WebSocketMarketDataFeed>>(m, "WebSocketMarketDataFeed")
-        .def(py::init<const std::string&>());
+        .def(py::init<const std::string&>())
+        .def(py::init<const std::string&, const FeedConfig&>())
+        .def(py::init<const std::string&, const WebSocketConfig&, const FeedConfig&>(),
+             py::arg("url"), py::arg("websocket"), py::arg("config") = FeedConfig())
+        .def("connected", &WebSocketMarketDataFeed::connected)
+        .def("get_websocket_stats", &WebSocketMarketDataFeed::getWebSocketStats);
+
+    // WebSocketServer class
+    py::class_<WebSocketServer>(m, "WebSocketServer")
+        .def(py::init<uint16_t, bool>(), py::arg("port") = 0, py::arg("echo") = false)
+        .def("port", &WebSocketServer::port)
+        .def("url", &WebSocketServer::url, py::arg("path") = "/")
+        .def("wait_for_clients", &WebSocketServer::waitForClients,
+             py::call_guard<py::gil_scoped_release>())
+        .def("clients", &WebSocketServer::clients)
+        .def("send", [](WebSocketServer& server, const std::string& text) { server.send(text); })
+        .def("replay", &WebSocketServer::replay, py::arg("messages"), py::arg("rate") = 0.0,
+             py::call_guard<py::gil_scoped_release>())
+        .def("disconnect_clients", &WebSocketServer::disconnectClients)
+        .def("received", &WebSocketServer::received);
+
+    // FixIsa enum
+    py::enum_<FixIsa>(m, "FixIsa")
+        .value("SCALAR", FixIsa::SCALAR)
+        .value("SSE2", FixIsa::SSE2)
+        .value("AVX2", FixIsa::AVX2)
+        .export_values();
+    m.def("best_fix_isa", &bestFixIsa);
+
+    // FixConfig struct
+    py::class_<FixConfig>(m, "FixConfig")
+        .def(py::init<>())
+        .def_readwrite("endpoint", &FixConfig::endpoint)
+        .def_readwrite("price_decimals", &FixConfig::price_decimals)
+        .def_readwrite("validate_checksum", &FixConfig::validate_checksum)
+        .def_readwrite("sender_comp_id", &FixConfig::sender_comp_id)
+        .def_readwrite("target_comp_id", &FixConfig::target_comp_id)
+        .def_readwrite("heartbeat_interval", &FixConfig::heartbeat_interval)
+        .def_readwrite("receive_buffer", &FixConfig::receive_buffer)
+        .def_readwrite("connect_timeout", &FixConfig::connect_timeout)
+        .def_readwrite("reconnect_delay", &FixConfig::reconnect_delay)
+        .def_readwrite("isa", &FixConfig::isa);
+
+    // FixStats struct
+    py::class_<FixStats>(m, "FixStats")
+        .def(py::init<>())
+        .def_readonly("connects", &FixStats::connects)
+        .def_readonly("disconnects", &FixStats::disconnects)
+        .def_readonly("bytes", &FixStats::bytes)
+        .def_readonly("messages", &FixStats::messages)
+        .def_readonly("events", &FixStats::events)
+        .def_readonly("checksum_errors", &FixStats::checksum_errors)
+        .def_readonly("malformed", &FixStats::malformed)
+        .def_readonly("decode_errors", &FixStats::decode_errors)
+        .def_readonly("test_requests", &FixStats::test_requests);
+
+    // FixMarketDataFeed class
+    py::class_<FixMarketDataFeed, BaseMarketDataFeed, std::shared_ptr<FixMarketDataFeed>>(m, "FixMarketDataFeed")
+        .def(py::init<const FixConfig&>())
+        .def(py::init<const FixConfig&, const FeedConfig&>())
+        .def("connected", &FixMarketDataFeed::connected)
+        .def("get_fix_stats", &FixMarketDataFeed::getFixStats);
+
+    // ReplayConfig struct
+    py::class_<ReplayConfig>(m, "ReplayConfig")
+        .def(py::init<>())
+        .def_readwrite("speed", &ReplayConfig::speed)
+        .def_readwrite("through_queue", &ReplayConfig::through_queue);
+
+    // FileReplayFeed class
+    py::class_<FileReplayFeed, BaseMarketDataFeed, std::shared_ptr<FileReplayFeed>>(m, "FileReplayFeed")
+        .def(py::init<const std::string&>())
+        .def(py::init<const std::string&, const ReplayConfig&>())
+        .def(py::init<const std::string&, const ReplayConfig&, const FeedConfig&>())
+        .def("finished", &FileReplayFeed::finished)
+        .def("replayed", &FileReplayFeed::replayed)
+        .def("size", &FileReplayFeed::size);
+
+    // MulticastConfig struct
+    py::class_<MulticastConfig>(m, "MulticastConfig")
+        .def(py::init<>())
+        .def_readwrite("line_a", &MulticastConfig::line_a)
+        .def_readwrite("line_b", &MulticastConfig::line_b)
+        .def_readwrite("interface", &MulticastConfig::interface)
+        .def_readwrite("batch", &MulticastConfig::batch)
+        .def_readwrite("receive_buffer", &MulticastConfig::receive_buffer)
+        .def_readwrite("first_sequence", &MulticastConfig::first_sequence)
+        .def_readwrite("gap_timeout", &MulticastConfig::gap_timeout);
+
+    // MulticastStats struct
+    py::class_<MulticastStats>(m, "MulticastStats")
+        .def(py::init<>())
+        .def_readonly("packets_a", &MulticastStats::packets_a)
+        .def_readonly("packets_b", &MulticastStats::packets_b)
+        .def_readonly("won_a", &MulticastStats::won_a)
+        .def_readonly("won_b", &MulticastStats::won_b)
+        .def_readonly("duplicates", &MulticastStats::duplicates)
+        .def_readonly("gaps", &MulticastStats::gaps)
+        .def_readonly("missed", &MulticastStats::missed)
+        .def_readonly("malformed", &MulticastStats::malformed)
+        .def_readonly("receive_calls", &MulticastStats::receive_calls)
+        .def_readonly("next_sequence", &MulticastStats::next_sequence);
+
+    // MulticastMarketDataFeed class
+    py::class_<MulticastMarketDataFeed, BaseMarketDataFeed, std::shared_ptr<MulticastMarketDataFeed>>(m, "MulticastMarketDataFeed")
+        .def(py::init<const MulticastConfig&>())
+        .def(py::init<const MulticastConfig&, const FeedConfig&>())
+        .def("set_gap_callback", &MulticastMarketDataFeed::setGapCallback)
+        .def("get_multicast_stats", &MulticastMarketDataFeed::getMulticastStats);
+
+    // PublisherConfig struct
+    py::class_<PublisherConfig>(m, "PublisherConfig")
+        .def(py::init<>())
+        .def_readwrite("line_a", &PublisherConfig::line_a)
+        .def_readwrite("line_b", &PublisherConfig::line_b)
+        .def_readwrite("interface", &PublisherConfig::interface)
+        .def_readwrite("events_per_packet", &PublisherConfig::events_per_packet)
+        .def_readwrite("rate", &PublisherConfig::rate)
+        .def_readwrite("batch", &PublisherConfig::batch)
+        .def_readwrite("first_sequence", &PublisherConfig::first_sequence)
+        .def_readwrite("drop_a_every", &PublisherConfig::drop_a_every)
+        .def_readwrite("drop_b_every", &PublisherConfig::drop_b_every);
+
+    // MulticastPublisher class
+    py::class_<MulticastPublisher>(m, "MulticastPublisher")
+        .def(py::init<const PublisherConfig&>())
+        .def("send", [](MulticastPublisher& publisher, const std::vector<MarketDataEvent>& events) {
+            publisher.send(events.data(), events.size());
+        })
+        .def("heartbeat", &MulticastPublisher::heartbeat)
+        .def("next_sequence", &MulticastPublisher::nextSequence)
+        .def("packets_sent", &MulticastPublisher::packetsSent);
+
+    // EventFileWriter class
+    py::class_<EventFileWriter>(m, "EventFileWriter")
+        .def(py::init<const std::string&>())
+        .def("write", static_cast<void (EventFileWriter::*)(const MarketDataEvent&)>(&EventFileWriter::write))
+        .def("close", &EventFileWriter::close)
+        .def("count", &EventFileWriter::count);
+
+    // ShardedHandlerConfig struct
+    py::class_<ShardedHandlerConfig>(m, "ShardedHandlerConfig")
+        .def(py::init<>())
+        .def_readwrite("shards", &ShardedHandlerConfig::shards)
+        .def_readwrite("cpus", &ShardedHandlerConfig::cpus)
+        .def_readwrite("queue_capacity", &ShardedHandlerConfig::queue_capacity)
+        .def_readwrite("wait_strategy", &ShardedHandlerConfig::wait_strategy)
+        .def_readwrite("spin_iterations", &ShardedHandlerConfig::spin_iterations)
+        .def_readwrite("book_config", &ShardedHandlerConfig::book_config);
+
+    // ShardLoad struct
+    py::class_<ShardLoad>(m, "ShardLoad")
+        .def_readonly("shard", &ShardLoad::shard)
+        .def_readonly("cpu", &ShardLoad::cpu)
+        .def_readonly("symbols", &ShardLoad::symbols)
+        .def_readonly("events", &ShardLoad::events)
+        .def_readonly("backpressure_waits", &ShardLoad::backpressure_waits)
+        .def_readonly("queue_depth", &ShardLoad::queue_depth);
+
+    // SymbolLoad struct
+    py::class_<SymbolLoad>(m, "SymbolLoad")
+        .def_readonly("symbol_id", &SymbolLoad::symbol_id)
+        .def_readonly("shard", &SymbolLoad::shard)
+        .def_readonly("events", &SymbolLoad::events);
+
+    // ShardedMarketDataHandler class
+    py::class_<ShardedMarketDataHandler, MarketDataHandler, std::shared_ptr<ShardedMarketDataHandler>>(m, "ShardedMarketDataHandler")
+        .def(py::init<>())
+        .def(py::init<const ShardedHandlerConfig&>())
+        .def("add_symbol", static_cast<std::shared_ptr<OrderBook> (ShardedMarketDataHandler::*)(const std::string&)>(&ShardedMarketDataHandler::addSymbol))
+        .def("add_symbol", static_cast<std::shared_ptr<OrderBook> (ShardedMarketDataHandler::*)(const std::string&, size_t)>(&ShardedMarketDataHandler::addSymbol))
+        .def("get_order_book", static_cast<std::shared_ptr<OrderBook> (ShardedMarketDataHandler::*)(const std::string&) const>(&ShardedMarketDataHandler::getOrderBook))
+        .def("get_order_book", static_cast<std::shared_ptr<OrderBook> (ShardedMarketDataHandler::*)(SymbolId) const>(&ShardedMarketDataHandler::getOrderBook))
+        .def("shard_of", &ShardedMarketDataHandler::shardOf)
+        .def("shard_count", &ShardedMarketDataHandler::shardCount)
+        .def("drain", &ShardedMarketDataHandler::drain)
+        .def("get_shard_load", &ShardedMarketDataHandler::getShardLoad)
+        .def("get_symbol_load", &ShardedMarketDataHandler::getSymbolLoad)
+        .def("reset_load", &ShardedMarketDataHandler::resetLoad)
+        .def("move_symbol", &ShardedMarketDataHandler::moveSymbol)
+        .def("rebalance", &ShardedMarketDataHandler::rebalance);
 
     // MarketDataHandlerFactory class
     py::class_<MarketDataHandlerFactory>(m, "MarketDataHandlerFactory")
@@ -0,0 +1,180 @@
+#include "orderbook/order_book.h"
+#include <cstdlib>
+#include <iostream>
+#include <chrono>
+#include <new>
+
+using namespace orderbook;
+using namespace std::chrono;
+
+// Count every heap allocation made while counting is switched on
+static size_t allocation_count = 0;
+static bool counting = false;
+
+void* operator new(std::size_t size) {
+    if (counting) {
+        ++allocation_count;
+    }
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// Simple test framework. Checks stay on in release builds, where the
+// allocation counts matter most.
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        std::cerr << "\n" << __FILE__ << ":" << __LINE__ << ": check failed: " << #cond << std::endl; \
+        std::exit(1); \
+    } \
+} while(0)
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running test: " << #name << "... "; \
+    test_##name(); \
+    std::cout << "PASSED" << std::endl; \
+} while(0)
+
+namespace {
+
+constexpr BookStorage kStorages[] = {BookStorage::MAP, BookStorage::ARRAY};
+
+OrderBookConfig allocConfig(BookStorage storage) {
+    OrderBookConfig config;
+    config.storage = storage;
+    config.order_capacity = 1024;
+    config.level_capacity = 256;
+    return config;
+}
+
+// One round of steady-state flow: rest a ladder of asks, then sweep it
+template <typename Add>
+void runRound(OrderBook& book, Order::OrderId& id, Add add) {
+    for (int level = 0; level < 8; ++level) {
+        for (int i = 0; i < 4; ++i) {
+            add(Order(id++, book.getSymbolId(), 100 + level, 10, Side::SELL, OrderType::LIMIT, nanoseconds(id)));
+        }
+    }
+    add(Order(id++, book.getSymbolId(), 100, 5, Side::BUY, OrderType::LIMIT, nanoseconds(id)));
+    book.modifyOrder(id - 2, 104, 5);
+    book.cancelOrder(id - 3);
+    add(Order(id++, book.getSymbolId(), 107, 400, Side::BUY, OrderType::LIMIT, nanoseconds(id)));
+    book.cancelOrder(id - 1);
+}
+
+} // namespace
+
+TEST(caller_buffer_match_does_not_allocate) {
+    for (auto storage : kStorages) {
+        OrderBook book("ALLOC", allocConfig(storage));
+        Trade trades[64];
+        size_t total_trades = 0;
+        auto add = [&](const Order& order) { total_trades += book.addOrder(order, trades, 64); };
+    
+        Order::OrderId id = 1;
+        runRound(book, id, add);  // Warm up
+    
+        allocation_count = 0;
+        total_trades = 0;
+        counting = true;
+        for (int round = 0; round < 100; ++round) {
+            runRound(book, id, add);
+        }
+        counting = false;
+    
+        CHECK(total_trades > 0);
+        CHECK(allocation_count == 0);
+    }
+}
+
+TEST(span_match_does_not_allocate) {
+    for (auto storage : kStorages) {
+        OrderBook book("ALLOC", allocConfig(storage));
+        size_t total_trades = 0;
+        size_t callback_trades = 0;
+        book.registerTradeCallback([&callback_trades](const Trade&) { ++callback_trades; });
+        auto add = [&](const Order& order) { total_trades += book.addOrderSpan(order).size; };
+    
+        Order::OrderId id = 1;
+        runRound(book, id, add);  // Warm up
+    
+        allocation_count = 0;
+        total_trades = 0;
+        callback_trades = 0;
+        counting = true;
+        for (int round = 0; round < 100; ++round) {
+            runRound(book, id, add);
+        }
+        counting = false;
+    
+        CHECK(total_trades > 0);
+        CHECK(callback_trades >= total_trades);
+        CHECK(allocation_count == 0);
+    }
+}
+
+TEST(depth_read_does_not_allocate) {
+    for (auto storage : kStorages) {
+        OrderBook book("ALLOC", allocConfig(storage));
+        PriceLevel levels[10];
+        size_t total_levels = 0;
+        auto add = [&](const Order& order) {
+            Trade trades[64];
+            book.addOrder(order, trades, 64);
+            total_levels += book.getDepth(Side::SELL, levels, 10);
+        };
+    
+        Order::OrderId id = 1;
+        runRound(book, id, add);  // Warm up
+    
+        allocation_count = 0;
+        total_levels = 0;
+        counting = true;
+        for (int round = 0; round < 100; ++round) {
+            runRound(book, id, add);
+        }
+        counting = false;
+    
+        CHECK(total_levels > 0);
+        CHECK(allocation_count == 0);
+    }
+}
+
+TEST(caller_buffer_capacity_limits_fills) {
+    OrderBook book("ALLOC");
+    for (Order::OrderId id = 1; id <= 5; ++id) {
+        book.addOrder(Order(id, "ALLOC", 100, 10, Side::SELL, OrderType::LIMIT, nanoseconds(id)));
+    }
+    
+    // Only two fills fit, and the rest of the buy order is dropped rather than crossing the book
+    Trade trades[2];
+    size_t count = book.addOrder(Order(6, "ALLOC", 100, 50, Side::BUY, OrderType::LIMIT, nanoseconds(6)),
+                                 trades, 2);
+    CHECK(count == 2);
+    CHECK(trades[0].getMakerOrderId() == 1 && trades[1].getMakerOrderId() == 2);
+    
+    auto tob = book.getTopOfBook();
+    CHECK(tob.ask_size == 30);
+    CHECK(tob.bid_price == 0);
+    
+    auto span = book.addOrderSpan(Order(7, "ALLOC", 100, 30, Side::BUY, OrderType::LIMIT, nanoseconds(7)));
+    CHECK(span.size == 3);
+    CHECK(span[0].getMakerOrderId() == 3 && span[2].getMakerOrderId() == 5);
+}
+
+int main() {
+    std::cout << "Running Allocation Tests" << std::endl;
+    std::cout << "========================" << std::endl;
+    
+    RUN_TEST(caller_buffer_match_does_not_allocate);
+    RUN_TEST(span_match_does_not_allocate);
+    RUN_TEST(depth_read_does_not_allocate);
+    RUN_TEST(caller_buffer_capacity_limits_fills);
+    
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
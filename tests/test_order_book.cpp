@@ -1,8 +1,28 @@
 #include "orderbook/order_book.h"
+#include "orderbook/market_data_handler.h"
+#include "orderbook/spsc_queue.h"
+#include "orderbook/market_data_file.h"
+#include "orderbook/market_data_json.h"
+#include "orderbook/websocket.h"
+#include "orderbook/fix_parser.h"
+#include "orderbook/book_snapshot.h"
+#include "orderbook/journal.h"
+#include "orderbook/tick_store.h"
+#include "orderbook/flow_generator.h"
 #include <cassert>
 #include <iostream>
 #include <chrono>
 #include <string>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <limits>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 using namespace orderbook;
 using namespace std::chrono;
@@ -143,6 +163,2086 @@ TEST(order_flow_imbalance) {
     assert(std::abs(ofi - 0.333333) < 0.001);
 }
 
+TEST(array_storage_matching) {
+    OrderBookConfig config;
+    config.storage = BookStorage::ARRAY;
+    config.tick_size = 5;
+    OrderBook book("AAPL", config);
+    
+    book.addOrder(Order(1, "AAPL", 150'00, 100, Side::SELL, OrderType::LIMIT, nanoseconds(1)));
+    book.addOrder(Order(2, "AAPL", 150'05, 200, Side::SELL, OrderType::LIMIT, nanoseconds(2)));
+    book.addOrder(Order(3, "AAPL", 149'95, 300, Side::BUY, OrderType::LIMIT, nanoseconds(3)));
+    
+    auto tob = book.getTopOfBook();
+    assert(tob.bid_price == 149'95 && tob.bid_size == 300);
+    assert(tob.ask_price == 150'00 && tob.ask_size == 100);
+    
+    // Sweep the first ask level and part of the second
+    auto trades = book.addOrder(Order(4, "AAPL", 150'05, 150, Side::BUY, OrderType::LIMIT, nanoseconds(4)));
+    assert(trades.size() == 2);
+    assert(trades[0].getPrice() == 150'00 && trades[0].getQuantity() == 100);
+    assert(trades[1].getPrice() == 150'05 && trades[1].getQuantity() == 50);
+    
+    tob = book.getTopOfBook();
+    assert(tob.ask_price == 150'05 && tob.ask_size == 150);
+    assert(tob.bid_price == 149'95);
+    
+    // Prices off the tick grid are rejected
+    bool exception_thrown = false;
+    try {
+        book.addOrder(Order(5, "AAPL", 150'01, 10, Side::BUY, OrderType::LIMIT, nanoseconds(5)));
+    } catch (const std::invalid_argument&) {
+        exception_thrown = true;
+    }
+    assert(exception_thrown);
+}
+
+TEST(map_storage_matching) {
+    // ARRAY is the default; MAP needs no tick grid and no ladder span
+    OrderBookConfig config;
+    config.storage = BookStorage::MAP;
+    config.tick_size = 5;
+    OrderBook book("AAPL", config);
+    
+    book.addOrder(Order(1, "AAPL", 150'01, 100, Side::SELL, OrderType::LIMIT, nanoseconds(1)));
+    book.addOrder(Order(2, "AAPL", 150'00'000'000, 200, Side::SELL, OrderType::LIMIT, nanoseconds(2)));
+    book.addOrder(Order(3, "AAPL", 149'99, 300, Side::BUY, OrderType::LIMIT, nanoseconds(3)));
+    
+    auto trades = book.addOrder(Order(4, "AAPL", 150'00'000'000, 150, Side::BUY, OrderType::LIMIT, nanoseconds(4)));
+    assert(trades.size() == 2);
+    assert(trades[0].getPrice() == 150'01 && trades[0].getQuantity() == 100);
+    assert(trades[1].getPrice() == 150'00'000'000 && trades[1].getQuantity() == 50);
+    
+    bool cancelled = book.cancelOrder(2);
+    assert(cancelled);
+    auto tob = book.getTopOfBook();
+    assert(tob.ask_price == 0 && tob.bid_price == 149'99);
+}
+
+TEST(array_storage_recentre) {
+    OrderBookConfig config;
+    config.storage = BookStorage::ARRAY;
+    config.ladder_levels = 64;
+    OrderBook book("AAPL", config);
+    
+    // Levels far outside the initial window force a re-centre and then a grow
+    book.addOrder(Order(1, "AAPL", 1000, 10, Side::BUY, OrderType::LIMIT, nanoseconds(1)));
+    book.addOrder(Order(2, "AAPL", 1040, 20, Side::BUY, OrderType::LIMIT, nanoseconds(2)));
+    book.addOrder(Order(3, "AAPL", 800, 30, Side::BUY, OrderType::LIMIT, nanoseconds(3)));
+    book.addOrder(Order(4, "AAPL", 1100, 40, Side::SELL, OrderType::LIMIT, nanoseconds(4)));
+    
+    auto [bids, asks] = book.getDepth(5);
+    assert(bids.size() == 3);
+    assert(bids[0].price == 1040 && bids[0].total_quantity == 20);
+    assert(bids[1].price == 1000 && bids[1].total_quantity == 10);
+    assert(bids[2].price == 800 && bids[2].total_quantity == 30);
+    assert(asks.size() == 1 && asks[0].price == 1100);
+    
+    bool cancelled = book.cancelOrder(2);
+    assert(cancelled && book.getTopOfBook().bid_price == 1000);
+    cancelled = book.cancelOrder(1);
+    assert(cancelled && book.getTopOfBook().bid_price == 800);
+    
+    // Matching walks the ladder down through the remaining bids
+    auto trades = book.addOrder(Order(5, "AAPL", 0, 30, Side::SELL, OrderType::MARKET, nanoseconds(5)));
+    assert(trades.size() == 1 && trades[0].getPrice() == 800);
+    assert(book.getTopOfBook().bid_price == 0);
+}
+
+TEST(array_storage_span_limit) {
+    OrderBookConfig config;
+    config.storage = BookStorage::ARRAY;
+    config.ladder_levels = 0;
+    bool exception_thrown = false;
+    try {
+        OrderBook book("AAPL", config);
+    } catch (const std::invalid_argument&) {
+        exception_thrown = true;
+    }
+    assert(exception_thrown);
+    
+    config.ladder_levels = 64;
+    config.max_ladder_levels = 1000;
+    OrderBook book("AAPL", config);
+    book.addOrder(Order(1, "AAPL", 10'000, 10, Side::BUY, OrderType::LIMIT, nanoseconds(1)));
+    book.addOrder(Order(2, "AAPL", 10'999, 10, Side::BUY, OrderType::LIMIT, nanoseconds(2)));
+    
+    // A price the ladder would have to grow past its span for is rejected, on add and
+    // on modify, without touching the book
+    exception_thrown = false;
+    try {
+        book.addOrder(Order(3, "AAPL", 8'000, 10, Side::BUY, OrderType::LIMIT, nanoseconds(3)));
+    } catch (const std::invalid_argument&) {
+        exception_thrown = true;
+    }
+    assert(exception_thrown);
+    exception_thrown = false;
+    try {
+        book.modifyOrder(2, 1'000'000'000, 10);
+    } catch (const std::invalid_argument&) {
+        exception_thrown = true;
+    }
+    assert(exception_thrown);
+    assert(book.getAllOrders().size() == 2 && book.getTopOfBook().bid_price == 10'999);
+    
+    // The other side has its own ladder
+    book.addOrder(Order(4, "AAPL", 1'000'000, 10, Side::SELL, OrderType::LIMIT, nanoseconds(4)));
+    assert(book.getTopOfBook().ask_price == 1'000'000);
+}
+
+TEST(cancel_from_queue_middle) {
+    OrderBookConfig config;
+    config.order_capacity = 4;  // Force the pool to grow
+    OrderBook book("AAPL", config);
+    
+    for (Order::OrderId id = 1; id <= 6; ++id) {
+        book.addOrder(Order(id, "AAPL", 150'00, 10 * id, Side::BUY, OrderType::LIMIT, nanoseconds(id)));
+    }
+    assert(book.getTopOfBook().bid_size == 210);
+    
+    // Cancel from the middle, the front and the back of the queue
+    bool middle = book.cancelOrder(3);
+    bool front = book.cancelOrder(1);
+    bool back = book.cancelOrder(6);
+    bool again = book.cancelOrder(3);
+    assert(middle && front && back && !again);
+    assert(book.getTopOfBook().bid_size == 20 + 40 + 50);
+    
+    // The remaining orders keep their time priority
+    auto trades = book.addOrder(Order(7, "AAPL", 150'00, 110, Side::SELL, OrderType::LIMIT, nanoseconds(7)));
+    assert(trades.size() == 3);
+    assert(trades[0].getMakerOrderId() == 2);
+    assert(trades[1].getMakerOrderId() == 4);
+    assert(trades[2].getMakerOrderId() == 5);
+    assert(book.getAllOrders().empty());
+    assert(book.getTopOfBook().bid_price == 0);
+}
+
+TEST(duplicate_order_ids) {
+    OrderBook book("AAPL");
+    book.addOrder(Order(7, "AAPL", 100, 10, Side::BUY, OrderType::LIMIT, nanoseconds(1)));
+    
+    // An ID already resting is rejected and leaves the book as it was
+    for (auto side : {Side::BUY, Side::SELL}) {
+        try {
+            book.addOrder(Order(7, "AAPL", side == Side::BUY ? 101 : 102, 5, side, OrderType::LIMIT, nanoseconds(2)));
+            assert(false);
+        } catch (const std::invalid_argument&) {
+        }
+    }
+    try {
+        book.addOrder(Order(std::numeric_limits<Order::OrderId>::max(), "AAPL", 99, 5, Side::BUY,
+                            OrderType::LIMIT, nanoseconds(3)));
+        assert(false);
+    } catch (const std::invalid_argument&) {
+    }
+    assert(book.getAllOrders().size() == 1);
+    assert(book.getTopOfBook().bid_price == 100 && book.getTopOfBook().bid_size == 10);
+    assert(book.getTopOfBook().ask_price == 0);
+    
+    // Once the order has gone its ID can be used again
+    bool cancelled = book.cancelOrder(7);
+    assert(cancelled && book.getAllOrders().empty());
+    book.addOrder(Order(7, "AAPL", 101, 5, Side::BUY, OrderType::LIMIT, nanoseconds(4)));
+    cancelled = book.cancelOrder(7);
+    assert(cancelled && book.getAllOrders().empty());
+}
+
+TEST(symbol_interning) {
+    auto& registry = SymbolRegistry::instance();
+    SymbolId id = registry.intern("MSFT");
+    SymbolId again = registry.intern("MSFT");
+    assert(again == id);
+    assert(registry.name(id) == "MSFT");
+    
+    SymbolId found = 0;
+    assert(registry.find("MSFT", found) && found == id);
+    assert(!registry.find("NOT-A-SYMBOL", found));
+    
+    OrderBook book("MSFT");
+    assert(book.getSymbolId() == id);
+    
+    // Orders built from the ID or the name are interchangeable
+    book.addOrder(Order(1, id, 300'00, 10, Side::SELL, OrderType::LIMIT, nanoseconds(1)));
+    auto trades = book.addOrder(Order(2, "MSFT", 300'00, 10, Side::BUY, OrderType::LIMIT, nanoseconds(2)));
+    assert(trades.size() == 1);
+    assert(trades[0].getSymbolId() == id);
+    assert(trades[0].getSymbol() == "MSFT");
+    
+    // An order for another symbol is rejected
+    bool exception_thrown = false;
+    try {
+        book.addOrder(Order(3, "AAPL", 300'00, 10, Side::BUY, OrderType::LIMIT, nanoseconds(3)));
+    } catch (const std::invalid_argument&) {
+        exception_thrown = true;
+    }
+    assert(exception_thrown);
+}
+
+TEST(modify_priority) {
+    OrderBook book("AAPL");
+    
+    book.addOrder(Order(1, "AAPL", 150'00, 100, Side::BUY, OrderType::LIMIT, nanoseconds(1)));
+    book.addOrder(Order(2, "AAPL", 150'00, 100, Side::BUY, OrderType::LIMIT, nanoseconds(2)));
+    book.addOrder(Order(3, "AAPL", 150'00, 100, Side::BUY, OrderType::LIMIT, nanoseconds(3)));
+    
+    // A size reduction keeps order 1 at the front of the queue
+    bool modified = book.modifyOrder(1, 150'00, 40);
+    assert(modified && book.getTopOfBook().bid_size == 240);
+    
+    // A size increase sends order 2 to the back
+    modified = book.modifyOrder(2, 150'00, 150);
+    assert(modified && book.getTopOfBook().bid_size == 290);
+    
+    auto trades = book.addOrder(Order(4, "AAPL", 150'00, 290, Side::SELL, OrderType::LIMIT, nanoseconds(4)));
+    assert(trades.size() == 3);
+    assert(trades[0].getMakerOrderId() == 1 && trades[0].getQuantity() == 40);
+    assert(trades[1].getMakerOrderId() == 3 && trades[1].getQuantity() == 100);
+    assert(trades[2].getMakerOrderId() == 2 && trades[2].getQuantity() == 150);
+    
+    // A price change that crosses the spread matches immediately
+    book.addOrder(Order(5, "AAPL", 151'00, 50, Side::SELL, OrderType::LIMIT, nanoseconds(5)));
+    book.addOrder(Order(6, "AAPL", 149'00, 80, Side::BUY, OrderType::LIMIT, nanoseconds(6)));
+    std::vector<Trade> modify_trades;
+    book.registerTradeCallback([&modify_trades](const Trade& trade) { modify_trades.push_back(trade); });
+    modified = book.modifyOrder(6, 151'00, 80);
+    assert(modified && modify_trades.size() == 1);
+    assert(modify_trades[0].getMakerOrderId() == 5 && modify_trades[0].getTakerOrderId() == 6);
+    
+    auto tob = book.getTopOfBook();
+    assert(tob.bid_price == 151'00 && tob.bid_size == 30);
+    assert(tob.ask_price == 0);
+    
+    // A zero quantity cancels, and unknown orders are reported
+    modified = book.modifyOrder(6, 151'00, 0);
+    assert(modified && book.getTopOfBook().bid_price == 0);
+    modified = book.modifyOrder(6, 151'00, 10);
+    assert(!modified);
+}
+
+TEST(single_writer_snapshots) {
+    OrderBookConfig config;
+    config.single_writer = true;
+    config.published_levels = 3;
+    OrderBook book("AAPL", config);
+    
+    // Every order's size is derived from its price, so a torn snapshot that
+    // mixes two versions of a level shows up as a size that doesn't fit
+    const Order::Price base = 149'00;
+    auto size_for = [base](Order::Price price) { return static_cast<Order::Quantity>(price - base); };
+    
+    std::atomic<bool> done{false};
+    std::atomic<size_t> inconsistent{0};
+    std::atomic<size_t> snapshots{0};
+    
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&] {
+            while (!done.load(std::memory_order_acquire)) {
+                auto snapshot = book.getDepthSnapshot();
+                ++snapshots;
+                for (uint32_t i = 0; i < snapshot.bid_count; ++i) {
+                    const auto& level = snapshot.bids[i];
+                    if (level.total_quantity != size_for(level.price) * level.order_count) {
+                        ++inconsistent;
+                    }
+                }
+                if (snapshot.bid_count > 0 &&
+                    (snapshot.top.bid_price != snapshot.bids[0].price ||
+                     snapshot.top.bid_size != snapshot.bids[0].total_quantity)) {
+                    ++inconsistent;
+                }
+                if (snapshot.bid_count > 0 && snapshot.ask_count > 0 &&
+                    snapshot.bids[0].price >= snapshot.asks[0].price) {
+                    ++inconsistent;
+                }
+            }
+        });
+    }
+    
+    // The writer churns the bid side without taking any lock
+    for (Order::OrderId id = 1; id <= 50000; ++id) {
+        Order::Price price = base + 1 + static_cast<Order::Price>(id % 40);
+        book.addOrder(Order(id, "AAPL", price, size_for(price), Side::BUY, OrderType::LIMIT, nanoseconds(id)));
+        if (id > 20) {
+            book.cancelOrder(id - 20);
+        }
+    }
+    book.addOrder(Order(60000, "AAPL", 151'00, 5, Side::SELL, OrderType::LIMIT, nanoseconds(60000)));
+    
+    done.store(true, std::memory_order_release);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    assert(snapshots > 0);
+    assert(inconsistent == 0);
+    
+    auto snapshot = book.getDepthSnapshot();
+    assert(snapshot.bid_count == 3 && snapshot.ask_count == 1);
+    assert(snapshot.asks[0].price == 151'00 && snapshot.asks[0].total_quantity == 5);
+    assert(snapshot.top.bid_price == snapshot.bids[0].price);
+    assert(book.getTopOfBook().ask_size == 5);
+}
+
+TEST(ioc_and_fok) {
+    for (auto storage : {BookStorage::MAP, BookStorage::ARRAY}) {
+        OrderBookConfig config;
+        config.storage = storage;
+        OrderBook book("AAPL", config);
+        
+        book.addOrder(Order(1, "AAPL", 100, 50, Side::SELL, OrderType::LIMIT, nanoseconds(1)));
+        book.addOrder(Order(2, "AAPL", 101, 50, Side::SELL, OrderType::LIMIT, nanoseconds(2)));
+        book.addOrder(Order(3, "AAPL", 103, 50, Side::SELL, OrderType::LIMIT, nanoseconds(3)));
+        
+        // IOC fills what it can up to its limit and never rests
+        auto trades = book.addOrder(Order(4, "AAPL", 100, 80, Side::BUY, OrderType::IOC, nanoseconds(4)));
+        assert(trades.size() == 1 && trades[0].getQuantity() == 50);
+        auto tob = book.getTopOfBook();
+        assert(tob.bid_price == 0 && tob.ask_price == 101);
+        
+        // FOK that the levels within its limit cannot cover leaves the book untouched
+        trades = book.addOrder(Order(5, "AAPL", 102, 60, Side::BUY, OrderType::FOK, nanoseconds(5)));
+        assert(trades.empty());
+        tob = book.getTopOfBook();
+        assert(tob.ask_price == 101 && tob.ask_size == 50 && tob.bid_price == 0);
+        
+        // More than the whole side is rejected as well
+        trades = book.addOrder(Order(6, "AAPL", 0, 500, Side::BUY, OrderType::FOK, nanoseconds(6)));
+        assert(trades.empty());
+        
+        // A fillable FOK sweeps across levels
+        trades = book.addOrder(Order(7, "AAPL", 103, 60, Side::BUY, OrderType::FOK, nanoseconds(7)));
+        assert(trades.size() == 2);
+        assert(trades[0].getPrice() == 101 && trades[1].getPrice() == 103 && trades[1].getQuantity() == 10);
+        tob = book.getTopOfBook();
+        assert(tob.ask_price == 103 && tob.ask_size == 40 && tob.bid_price == 0);
+        
+        // Sell side, and a FOK that needs more trades than the caller's buffer holds
+        book.addOrder(Order(8, "AAPL", 90, 10, Side::BUY, OrderType::LIMIT, nanoseconds(8)));
+        book.addOrder(Order(9, "AAPL", 90, 10, Side::BUY, OrderType::LIMIT, nanoseconds(9)));
+        Trade buffer[1];
+        size_t count = book.addOrder(Order(10, "AAPL", 90, 20, Side::SELL, OrderType::FOK, nanoseconds(10)),
+                                     buffer, 1);
+        assert(count == 0);
+        assert(book.getTopOfBook().bid_size == 20);
+        trades = book.addOrder(Order(11, "AAPL", 90, 20, Side::SELL, OrderType::FOK, nanoseconds(11)));
+        assert(trades.size() == 2);
+        assert(book.getTopOfBook().bid_price == 0);
+    }
+}
+
+TEST(stop_orders) {
+    for (auto storage : {BookStorage::MAP, BookStorage::ARRAY}) {
+        OrderBookConfig config;
+        config.storage = storage;
+        OrderBook book("AAPL", config);
+        
+        // Asks at 100..104; stops park without touching the book
+        for (int i = 0; i < 5; ++i) {
+            book.addOrder(Order(1 + i, "AAPL", 100 + i, 10, Side::SELL, OrderType::LIMIT, nanoseconds(1 + i)));
+        }
+        book.addOrder(Order(10, "AAPL", 0, 10, Side::BUY, OrderType::STOP, nanoseconds(10), 102));
+        book.addOrder(Order(11, "AAPL", 0, 10, Side::BUY, OrderType::STOP, nanoseconds(11), 101));
+        book.addOrder(Order(12, "AAPL", 103, 10, Side::BUY, OrderType::STOP_LIMIT, nanoseconds(12), 103));
+        book.addOrder(Order(13, "AAPL", 0, 10, Side::BUY, OrderType::STOP, nanoseconds(13), 120));
+        book.addOrder(Order(14, "AAPL", 0, 10, Side::SELL, OrderType::STOP, nanoseconds(14), 90));
+        assert(book.getAllOrders().size() == 10);
+        assert(book.getTopOfBook().ask_price == 100);
+        
+        // A cancelled stop never fires
+        bool cancelled = book.cancelOrder(13);
+        assert(cancelled);
+        
+        // Trading through 101 releases stop 11, whose fills at 101-102 release 10,
+        // which in turn reaches 103 and releases the stop-limit
+        auto trades = book.addOrder(Order(20, "AAPL", 101, 15, Side::BUY, OrderType::LIMIT, nanoseconds(20)));
+        std::vector<Order::OrderId> takers;
+        for (const auto& trade : trades) {
+            takers.push_back(trade.getTakerOrderId());
+        }
+        assert((takers == std::vector<Order::OrderId>{20, 20, 11, 11, 10, 10, 12}));
+        assert(trades[6].getPrice() == 103 && trades[6].getQuantity() == 5);
+        
+        // The stop-limit rests its remainder at its limit; the sell stop is still parked
+        auto tob = book.getTopOfBook();
+        assert(tob.bid_price == 103 && tob.bid_size == 5);
+        assert(tob.ask_price == 104);
+        assert(book.getAllOrders().size() == 3);
+        
+        // A stop already crossed by the last trade fires on arrival
+        trades = book.addOrder(Order(21, "AAPL", 0, 5, Side::SELL, OrderType::STOP, nanoseconds(21), 103));
+        assert(trades.size() == 1 && trades[0].getTakerOrderId() == 21);
+        assert(book.getTopOfBook().bid_price == 0);
+    }
+}
+
+TEST(stops_survive_full_trade_buffer) {
+    OrderBook book("AAPL");
+    book.addOrder(Order(1, "AAPL", 101, 10, Side::SELL, OrderType::LIMIT, nanoseconds(1)));
+    book.addOrder(Order(2, "AAPL", 0, 5, Side::BUY, OrderType::STOP, nanoseconds(2), 101));
+    
+    // The one-trade buffer fills at 101, which releases the stop with no room to run it
+    Trade trades[1];
+    size_t count = book.addOrder(Order(3, "AAPL", 101, 1, Side::BUY, OrderType::LIMIT, nanoseconds(3)), trades, 1);
+    assert(count == 1 && trades[0].getPrice() == 101);
+    auto orders = book.getAllOrders();
+    assert(orders.size() == 2);
+    
+    // It runs on the next call that has room
+    auto stop_trades = book.addOrder(Order(4, "AAPL", 90, 1, Side::BUY, OrderType::LIMIT, nanoseconds(4)));
+    assert(stop_trades.size() == 1);
+    assert(stop_trades[0].getTakerOrderId() == 2 && stop_trades[0].getQuantity() == 5);
+    assert(book.getTopOfBook().ask_size == 4);
+}
+
+TEST(modified_stop_priority) {
+    OrderBook book("AAPL");
+    book.addOrder(Order(1, "AAPL", 101, 100, Side::SELL, OrderType::LIMIT, nanoseconds(1)));
+    book.addOrder(Order(10, "AAPL", 0, 10, Side::BUY, OrderType::STOP, nanoseconds(10), 101));
+    book.addOrder(Order(11, "AAPL", 0, 10, Side::BUY, OrderType::STOP, nanoseconds(11), 101));
+    
+    // Modifying stop 10 puts it behind 11, even though 10 was placed first
+    bool modified = book.modifyOrder(10, 0, 20);
+    assert(modified);
+    auto trades = book.addOrder(Order(20, "AAPL", 101, 5, Side::BUY, OrderType::LIMIT, nanoseconds(20)));
+    std::vector<Order::OrderId> takers;
+    for (const auto& trade : trades) {
+        takers.push_back(trade.getTakerOrderId());
+    }
+    assert((takers == std::vector<Order::OrderId>{20, 11, 10}));
+    assert(trades[2].getQuantity() == 20);
+    
+    // A stop with nothing to trade is rejected
+    bool exception_thrown = false;
+    try {
+        book.addOrder(Order(21, "AAPL", 0, 0, Side::SELL, OrderType::STOP, nanoseconds(21), 90));
+    } catch (const std::invalid_argument&) {
+        exception_thrown = true;
+    }
+    assert(exception_thrown);
+    assert(book.getAllOrders().size() == 1);
+}
+
+TEST(depth_cache) {
+    OrderBookConfig config;
+    config.depth_levels = 3;
+    OrderBook book("AAPL", config);
+    
+    book.addOrder(Order(1, "AAPL", 100, 10, Side::BUY, OrderType::LIMIT, nanoseconds(1)));
+    book.addOrder(Order(2, "AAPL", 100, 20, Side::BUY, OrderType::LIMIT, nanoseconds(2)));
+    book.addOrder(Order(3, "AAPL", 99, 30, Side::BUY, OrderType::LIMIT, nanoseconds(3)));
+    book.addOrder(Order(4, "AAPL", 97, 40, Side::BUY, OrderType::LIMIT, nanoseconds(4)));
+    book.addOrder(Order(5, "AAPL", 96, 50, Side::BUY, OrderType::LIMIT, nanoseconds(5)));
+    
+    PriceLevel levels[3];
+    assert(book.getDepth(Side::BUY, levels, 3) == 3);
+    assert(levels[0].price == 100 && levels[0].total_quantity == 30 && levels[0].order_count == 2);
+    assert(levels[2].price == 97 && levels[2].order_count == 1);
+    assert(book.getDepth(Side::SELL, levels, 3) == 0);
+    
+    // In-place change, a new level inside the cached range, and a removal that pulls a deeper level in
+    book.modifyOrder(1, 100, 5);
+    book.addOrder(Order(6, "AAPL", 98, 60, Side::BUY, OrderType::LIMIT, nanoseconds(6)));
+    book.cancelOrder(3);
+    book.addOrder(Order(7, "AAPL", 100, 25, Side::SELL, OrderType::LIMIT, nanoseconds(7)));
+    
+    auto [bids, asks] = book.getDepth(3);
+    assert(asks.empty() && bids.size() == 3);
+    assert(bids[0].price == 98 && bids[0].total_quantity == 60);
+    assert(bids[1].price == 97 && bids[2].price == 96);
+    
+    // Deeper than the cache walks the book
+    std::tie(bids, asks) = book.getDepth(10);
+    assert(bids.size() == 3);
+}
+
+TEST(event_order_flow_imbalance) {
+    OrderBookConfig config;
+    config.ofi_window = 2;
+    config.depth_levels = 1;
+    OrderBook book("AAPL", config);
+    
+    book.addOrder(Order(1, "AAPL", 100, 10, Side::BUY, OrderType::LIMIT, nanoseconds(1)));   // New bid: +10
+    book.addOrder(Order(2, "AAPL", 102, 5, Side::SELL, OrderType::LIMIT, nanoseconds(2)));   // New ask: -5
+    book.addOrder(Order(3, "AAPL", 100, 4, Side::BUY, OrderType::LIMIT, nanoseconds(3)));    // Bid grows: +4
+    book.addOrder(Order(4, "AAPL", 90, 20, Side::BUY, OrderType::LIMIT, nanoseconds(4)));    // Below the touch: no event
+    
+    auto ofi = book.getEventOrderFlowImbalance();
+    assert(ofi.events == 3 && ofi.total == 9 && ofi.window == -1);
+    
+    // Depth imbalance inside and beyond the cached levels
+    assert(std::abs(book.calculateOrderFlowImbalance(1) - 9.0 / 19.0) < 1e-9);
+    assert(std::abs(book.calculateOrderFlowImbalance(5) - 29.0 / 39.0) < 1e-9);
+    
+    book.addOrder(Order(5, "AAPL", 0, 14, Side::SELL, OrderType::MARKET, nanoseconds(5)));   // Bid drops a level: -14
+    book.cancelOrder(2);                                                                     // Ask side empties: +5
+    ofi = book.getEventOrderFlowImbalance();
+    assert(ofi.events == 5 && ofi.total == 0 && ofi.window == -9);
+    
+    book.clear();
+    ofi = book.getEventOrderFlowImbalance();
+    assert(ofi.events == 0 && ofi.total == 0 && ofi.window == 0);
+}
+
+TEST(update_notifications_on_change) {
+    OrderBookConfig config;
+    config.update_notification = UpdateNotification::ON_CHANGE;
+    config.published_levels = 2;
+    OrderBook book("AAPL", config);
+    
+    std::vector<TopOfBook> tops;
+    std::vector<DepthSnapshot> depths;
+    book.registerOrderBookUpdateCallback([&tops](const TopOfBook& top) { tops.push_back(top); });
+    book.registerDepthUpdateCallback([&depths](const DepthSnapshot& depth) { depths.push_back(depth); });
+    
+    book.addOrder(Order(1, "AAPL", 100, 10, Side::BUY, OrderType::LIMIT, nanoseconds(1)));
+    assert(tops.size() == 1 && tops[0].bid_price == 100 && tops[0].timestamp == nanoseconds(1));
+    assert(depths.size() == 1 && depths[0].bid_count == 1);
+    
+    // Second level: depth changes, top does not
+    book.addOrder(Order(2, "AAPL", 99, 10, Side::BUY, OrderType::LIMIT, nanoseconds(2)));
+    assert(tops.size() == 1 && depths.size() == 2);
+    
+    // Beyond the published levels: neither changes
+    book.addOrder(Order(3, "AAPL", 98, 10, Side::BUY, OrderType::LIMIT, nanoseconds(3)));
+    assert(tops.size() == 1 && depths.size() == 2);
+    
+    // A sweep that also fires a stop is a single event stamped with the order's time
+    for (int i = 0; i < 3; ++i) {
+        book.addOrder(Order(10 + i, "AAPL", 101 + i, 5, Side::SELL, OrderType::LIMIT, nanoseconds(10 + i)));
+    }
+    book.addOrder(Order(20, "AAPL", 0, 5, Side::BUY, OrderType::STOP, nanoseconds(20), 102));
+    size_t before = tops.size();
+    auto trades = book.addOrder(Order(21, "AAPL", 102, 10, Side::BUY, OrderType::LIMIT, nanoseconds(21)));
+    assert(trades.size() == 3);
+    assert(tops.size() == before + 1);
+    assert(tops.back().ask_price == 0 && tops.back().timestamp == nanoseconds(21));
+    
+    // Cancelling an order that is not at the touch leaves the top alone
+    before = tops.size();
+    book.cancelOrder(3);
+    assert(tops.size() == before);
+    
+    // Events from a feed are stamped with their own time, not the last add's
+    applyEvent(book, MarketDataEvent::orderExecute(book.getSymbolId(), 1, 4, 0, nanoseconds(30)));
+    assert(tops.back().bid_size == 6 && tops.back().timestamp == nanoseconds(30));
+    applyEvent(book, MarketDataEvent::orderModify(book.getSymbolId(), 1, 100, 3, nanoseconds(31)));
+    assert(tops.back().bid_size == 3 && tops.back().timestamp == nanoseconds(31));
+    applyEvent(book, MarketDataEvent::orderCancel(book.getSymbolId(), 1, nanoseconds(32)));
+    assert(tops.back().bid_price == 99 && tops.back().timestamp == nanoseconds(32));
+}
+
+TEST(market_data_events) {
+    auto book = std::make_shared<OrderBook>("AAPL");
+    MarketDataHandlerImpl handler;
+    handler.registerOrderBook("AAPL", book);
+    auto aapl = book->getSymbolId();
+    assert(handler.getOrderBook(aapl) == book);
+    
+    handler.handleEvent(MarketDataEvent::orderAdd(aapl, 1, 100, 10, Side::BUY, OrderType::LIMIT, nanoseconds(5)));
+    handler.handleEvent(MarketDataEvent::orderAdd(aapl, 2, 101, 20, Side::SELL, OrderType::LIMIT, nanoseconds(6)));
+    auto top = book->getTopOfBook();
+    assert(top.bid_price == 100 && top.ask_price == 101);
+    
+    handler.handleEvent(MarketDataEvent::orderModify(aapl, 1, 99, 15, nanoseconds(7)));
+    handler.handleEvent(MarketDataEvent::orderExecute(aapl, 2, 5, 1, nanoseconds(8)));
+    top = book->getTopOfBook();
+    assert(top.bid_price == 99 && top.bid_size == 15);
+    assert(top.ask_price == 101 && top.ask_size == 15);
+    
+    // Executing the rest removes the order
+    handler.handleEvent(MarketDataEvent::orderExecute(aapl, 2, 15, 2, nanoseconds(9)));
+    assert(book->getTopOfBook().ask_price == 0);
+    handler.handleEvent(MarketDataEvent::orderCancel(aapl, 1, nanoseconds(10)));
+    handler.handleEvent(MarketDataEvent::heartbeat(nanoseconds(11)));
+    assert(book->getAllOrders().empty());
+    
+    // A snapshot replaces the book
+    handler.handleEvent(MarketDataEvent::orderAdd(aapl, 3, 90, 10, Side::BUY, OrderType::LIMIT, nanoseconds(12)));
+    handler.handleEvent(MarketDataEvent::snapshotOrder(aapl, 10, 95, 30, Side::BUY,
+                                                       MarketDataEvent::kSnapshotBegin, nanoseconds(13)));
+    handler.handleEvent(MarketDataEvent::snapshotOrder(aapl, 11, 96, 40, Side::SELL,
+                                                       MarketDataEvent::kSnapshotEnd, nanoseconds(13)));
+    top = book->getTopOfBook();
+    assert(top.bid_price == 95 && top.bid_size == 30);
+    assert(top.ask_price == 96 && top.ask_size == 40);
+    assert(book->getAllOrders().size() == 2);
+    
+    // Handlers written against the polymorphic interface still receive messages
+    struct LegacyHandler : MarketDataHandler {
+        std::vector<MarketDataMessage::Type> types;
+        Order::OrderId last_id = 0;
+        void handleMessage(const MarketDataMessage& message) override {
+            types.push_back(message.getType());
+            if (message.getType() == MarketDataMessage::Type::ORDER_ADD) {
+                const auto& add = static_cast<const OrderAddMessage&>(message);
+                assert(add.getSymbol() == "AAPL");
+                last_id = add.getId();
+            }
+        }
+    } legacy;
+    legacy.handleEvent(MarketDataEvent::orderAdd(aapl, 42, 100, 1, Side::BUY, OrderType::LIMIT, nanoseconds(1)));
+    legacy.handleEvent(MarketDataEvent::orderCancel(aapl, 42, nanoseconds(2)));
+    assert(legacy.types.size() == 2 && legacy.last_id == 42);
+    assert(legacy.types[1] == MarketDataMessage::Type::ORDER_CANCEL);
+}
+
+TEST(spsc_queue) {
+    SpscQueue<uint64_t> queue(5);
+    assert(queue.capacity() == 8);
+    
+    uint64_t value = 0;
+    bool popped = queue.tryPop(value);
+    assert(!popped);
+    for (uint64_t i = 0; i < 8; ++i) {
+        bool pushed = queue.tryPush(i);
+        assert(pushed);
+    }
+    bool overflowed = queue.tryPush(8);
+    assert(!overflowed && queue.size() == 8);
+    
+    // Wrap around the end of the ring
+    uint64_t batch[4];
+    size_t taken = queue.popBatch(batch, 4);
+    assert(taken == 4 && batch[0] == 0 && batch[3] == 3);
+    for (uint64_t i = 8; i < 12; ++i) {
+        bool pushed = queue.tryPush(i);
+        assert(pushed);
+    }
+    for (uint64_t i = 4; i < 12; ++i) {
+        popped = queue.tryPop(value);
+        assert(popped && value == i);
+    }
+    assert(queue.empty());
+    
+    // One producer and one consumer see every item in order
+    constexpr uint64_t kItems = 200000;
+    std::thread producer([&queue] {
+        for (uint64_t i = 0; i < kItems; ++i) {
+            while (!queue.tryPush(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    uint64_t expected = 0;
+    while (expected < kItems) {
+        size_t count = queue.popBatch(batch, 4);
+        for (size_t i = 0; i < count; ++i, ++expected) {
+            assert(batch[i] == expected);
+        }
+        if (count == 0) {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+}
+
+namespace {
+
+// Publishes a fixed list of events from the ingest thread
+class ListFeed : public BaseMarketDataFeed {
+public:
+    ListFeed(const FeedConfig& config, std::vector<MarketDataEvent> events)
+        : BaseMarketDataFeed(config), events_(std::move(events)) {}
+    ~ListFeed() override { stop(); }
+    
+    std::atomic<bool> published_all{false};
+
+protected:
+    void processMessages() override {
+        for (const auto& event : events_) {
+            publish(event);
+        }
+        published_all = true;
+        while (running_) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+private:
+    std::vector<MarketDataEvent> events_;
+};
+
+struct SequenceRecorder : MarketDataHandler {
+    std::vector<uint64_t> sequences;
+    std::atomic<bool>* gate = nullptr;
+    void handleEvent(const MarketDataEvent& event) override {
+        while (gate && !gate->load()) {
+            std::this_thread::yield();
+        }
+        sequences.push_back(event.sequence);
+    }
+};
+
+std::vector<MarketDataEvent> heartbeats(size_t count) {
+    std::vector<MarketDataEvent> events;
+    for (size_t i = 0; i < count; ++i) {
+        events.push_back(MarketDataEvent::heartbeat(nanoseconds(i)));
+        events.back().sequence = i;
+    }
+    return events;
+}
+
+} // namespace
+
+TEST(feed_event_queue) {
+    constexpr size_t kEvents = 20000;
+    
+    for (auto strategy : {WaitStrategy::BUSY_SPIN, WaitStrategy::SPIN_YIELD, WaitStrategy::BLOCKING}) {
+        FeedConfig config;
+        config.queue_capacity = 256;
+        config.wait_strategy = strategy;
+        config.spin_iterations = 16;
+        
+        SequenceRecorder recorder;
+        ListFeed feed(config, heartbeats(kEvents));
+        feed.registerHandler(&recorder);
+        feed.start();
+        while (!feed.published_all) {
+            std::this_thread::yield();
+        }
+        feed.stop();
+        
+        // Waiting for space loses nothing
+        auto stats = feed.getStats();
+        assert(stats.published == kEvents && stats.dispatched == kEvents);
+        assert(stats.overflows == 0 && stats.queue_depth == 0);
+        assert(recorder.sequences.size() == kEvents);
+        for (size_t i = 0; i < kEvents; ++i) {
+            assert(recorder.sequences[i] == i);
+        }
+    }
+    
+    // With a stalled handler and drop_when_full, the queue overflows instead of blocking
+    FeedConfig config;
+    config.queue_capacity = 4;
+    config.drop_when_full = true;
+    
+    std::atomic<bool> gate{false};
+    SequenceRecorder recorder;
+    recorder.gate = &gate;
+    ListFeed feed(config, heartbeats(100));
+    feed.registerHandler(&recorder);
+    feed.start();
+    while (!feed.published_all) {
+        std::this_thread::yield();
+    }
+    gate = true;
+    feed.stop();
+    
+    auto stats = feed.getStats();
+    assert(stats.published + stats.overflows == 100);
+    assert(stats.overflows > 0 && stats.backpressure_waits == 0);
+    assert(stats.dispatched == stats.published);
+    assert(recorder.sequences.size() == stats.published);
+    for (size_t i = 1; i < recorder.sequences.size(); ++i) {
+        assert(recorder.sequences[i] > recorder.sequences[i - 1]);
+    }
+}
+
+TEST(feed_handler_registration) {
+    FeedConfig config;
+    config.queue_capacity = 256;
+    
+    // An async handler that stalls drops its own events without holding up inline handlers
+    {
+        std::atomic<bool> gate{false};
+        SequenceRecorder book_builder;
+        SequenceRecorder slow;
+        slow.gate = &gate;
+        ListFeed feed(config, heartbeats(5000));
+        feed.registerHandler(&book_builder);
+        feed.registerHandler(&slow, HandlerMode::ASYNC, 16);
+        feed.start();
+        while (!feed.published_all) {
+            std::this_thread::yield();
+        }
+        feed.stop();
+        assert(book_builder.sequences.size() == 5000);
+        
+        gate = true;
+        bool removed = feed.unregisterHandler(&slow);
+        assert(removed);
+        auto stats = feed.getStats();
+        assert(stats.async_dropped > 0);
+        assert(slow.sequences.size() + stats.async_dropped == 5000);
+        removed = feed.unregisterHandler(&slow);
+        assert(!removed);
+    }
+    
+    // Handlers come and go while events flow; none is called after unregisterHandler returns
+    {
+        struct Counter : MarketDataHandler {
+            std::atomic<uint64_t> count{0};
+            void handleEvent(const MarketDataEvent&) override { ++count; }
+        };
+        
+        SequenceRecorder book_builder;
+        Counter transient;
+        ListFeed feed(config, heartbeats(100000));
+        feed.registerHandler(&book_builder);
+        feed.start();
+        for (int i = 0; i < 50; ++i) {
+            feed.registerHandler(&transient, i % 2 ? HandlerMode::ASYNC : HandlerMode::INLINE);
+            std::this_thread::yield();
+            bool removed = feed.unregisterHandler(&transient);
+            assert(removed);
+            uint64_t seen = transient.count;
+            std::this_thread::yield();
+            assert(transient.count == seen);
+        }
+        while (!feed.published_all) {
+            std::this_thread::yield();
+        }
+        feed.stop();
+        assert(book_builder.sequences.size() == 100000);
+        for (size_t i = 0; i < book_builder.sequences.size(); ++i) {
+            assert(book_builder.sequences[i] == i);
+        }
+    }
+    
+    // A handler can unregister itself from the dispatch thread
+    {
+        struct OneShot : MarketDataHandler {
+            BaseMarketDataFeed* feed = nullptr;
+            size_t calls = 0;
+            void handleEvent(const MarketDataEvent&) override {
+                if (++calls == 10) {
+                    feed->unregisterHandler(this);
+                }
+            }
+        };
+        
+        OneShot one_shot;
+        ListFeed feed(config, heartbeats(1000));
+        one_shot.feed = &feed;
+        feed.registerHandler(&one_shot);
+        feed.start();
+        while (!feed.published_all) {
+            std::this_thread::yield();
+        }
+        feed.stop();
+        assert(one_shot.calls == 10);
+    }
+}
+
+TEST(sharded_handler) {
+    ShardedHandlerConfig config;
+    config.shards = 2;
+    config.cpus = {0};
+    config.queue_capacity = 64;
+    ShardedMarketDataHandler sharded(config);
+    MarketDataHandlerImpl reference;
+    
+    const std::vector<std::string> symbols = {"SH_A", "SH_B", "SH_C", "SH_D"};
+    std::vector<SymbolId> ids;
+    for (const auto& symbol : symbols) {
+        sharded.addSymbol(symbol);
+        reference.registerOrderBook(symbol, std::make_shared<OrderBook>(symbol));
+        ids.push_back(SymbolRegistry::instance().intern(symbol));
+    }
+    assert(sharded.shardOf(ids[0]) == 0 && sharded.shardOf(ids[1]) == 1);
+    assert(sharded.getShardLoad()[0].symbols == 2 && sharded.getShardLoad()[1].symbols == 2);
+    assert(sharded.getShardLoad()[0].cpu == 0 || sharded.getShardLoad()[0].cpu == -1);
+    assert(sharded.getShardLoad()[1].cpu == -1);
+    
+    // SH_A is ten times busier than the others
+    Order::OrderId next_id = 1;
+    auto session = [&](int rounds) {
+        for (int round = 0; round < rounds; ++round) {
+            for (size_t s = 0; s < ids.size(); ++s) {
+                int repeats = s == 0 ? 10 : 1;
+                for (int r = 0; r < repeats; ++r) {
+                    auto side = next_id % 2 ? Side::BUY : Side::SELL;
+                    Order::Price price = side == Side::BUY ? 100 - next_id % 7 : 98 + next_id % 7;
+                    Order::Quantity quantity = 1 + next_id % 5;
+                    auto event = MarketDataEvent::orderAdd(ids[s], next_id, price, quantity, side,
+                                                           OrderType::LIMIT, nanoseconds(next_id));
+                    ++next_id;
+                    sharded.handleEvent(event);
+                    reference.handleEvent(event);
+                }
+            }
+        }
+        sharded.drain();
+    };
+    auto same_books = [&] {
+        for (size_t s = 0; s < ids.size(); ++s) {
+            auto a = sharded.getOrderBook(ids[s])->getTopOfBook();
+            auto b = reference.getOrderBook(ids[s])->getTopOfBook();
+            assert(a.bid_price == b.bid_price && a.bid_size == b.bid_size);
+            assert(a.ask_price == b.ask_price && a.ask_size == b.ask_size);
+        }
+    };
+    
+    session(20);
+    same_books();
+    auto loads = sharded.getSymbolLoad();
+    assert(loads.size() == 4 && loads[0].symbol_id == ids[0] && loads[0].events == 200);
+    auto shard_load = sharded.getShardLoad();
+    assert(shard_load[0].events + shard_load[1].events == 260);
+    assert(shard_load[0].queue_depth == 0 && shard_load[1].queue_depth == 0);
+    
+    // Between sessions the busy symbol gets a shard to itself, books intact
+    size_t moved = sharded.rebalance();
+    assert(moved > 0);
+    size_t busy = sharded.shardOf(ids[0]);
+    for (size_t s = 1; s < ids.size(); ++s) {
+        assert(sharded.shardOf(ids[s]) != busy);
+    }
+    same_books();
+    
+    sharded.resetLoad();
+    assert(sharded.getShardLoad()[busy].events == 0);
+    session(5);
+    same_books();
+    assert(sharded.getShardLoad()[busy].events == 50);
+    
+    bool moved_symbol = sharded.moveSymbol(ids[1], busy);
+    assert(moved_symbol && sharded.shardOf(ids[1]) == busy);
+    session(5);
+    same_books();
+}
+
+TEST(symbol_routing_table) {
+    EpochDomain epoch;
+    SymbolTable<int> table(epoch, 4);
+    int a = 1, b = 2;
+    assert(table.find(3) == nullptr && table.find(1000) == nullptr);
+    auto* previous = table.set(3, &a);
+    assert(previous == nullptr);
+    previous = table.set(1000, &b);
+    assert(previous == nullptr);
+    assert(table.capacity() >= 1001);
+    {
+        auto guard = epoch.read();
+        assert(table.find(3) == &a && table.find(1000) == &b);
+    }
+    previous = table.set(3, &b);
+    assert(previous == &a);
+    auto* erased = table.erase(3);
+    assert(erased == &b && table.find(3) == nullptr);
+    
+    // Books are swapped and unregistered while another thread applies events to them
+    MarketDataHandlerImpl handler;
+    std::vector<SymbolId> ids;
+    for (int i = 0; i < 4; ++i) {
+        auto symbol = "RT_" + std::to_string(i);
+        handler.registerOrderBook(symbol, std::make_shared<OrderBook>(symbol));
+        ids.push_back(SymbolRegistry::instance().intern(symbol));
+    }
+    
+    std::atomic<bool> running{true};
+    std::thread feed([&] {
+        Order::OrderId id = 1;
+        while (running) {
+            for (auto symbol_id : ids) {
+                handler.handleEvent(MarketDataEvent::orderAdd(symbol_id, id, 100, 1, Side::BUY,
+                                                              OrderType::LIMIT, nanoseconds(id)));
+                handler.handleEvent(MarketDataEvent::orderCancel(symbol_id, id, nanoseconds(id)));
+                ++id;
+            }
+        }
+    });
+    for (int i = 0; i < 200; ++i) {
+        auto symbol = "RT_" + std::to_string(i % 4);
+        if (i % 3 == 0) {
+            handler.unregisterOrderBook(symbol);
+        } else {
+            handler.registerOrderBook(symbol, std::make_shared<OrderBook>(symbol));
+        }
+        std::this_thread::yield();
+    }
+    running = false;
+    feed.join();
+    
+    // Once no event is in flight, an unregistered book is released
+    std::weak_ptr<OrderBook> weak = handler.getOrderBook("RT_1");
+    if (weak.expired()) {
+        handler.registerOrderBook("RT_1", std::make_shared<OrderBook>("RT_1"));
+        weak = handler.getOrderBook("RT_1");
+    }
+    handler.unregisterOrderBook("RT_1");
+    handler.registerOrderBook("RT_2", std::make_shared<OrderBook>("RT_2"));
+    assert(weak.expired());
+    assert(handler.getOrderBook("RT_1") == nullptr);
+}
+
+TEST(file_replay_feed) {
+    auto path = (std::filesystem::temp_directory_path() / "orderbook_replay_test.events").string();
+    auto symbol_id = SymbolRegistry::instance().intern("REPLAY");
+    
+    // 2000 events over 20 ms of recorded time
+    std::vector<MarketDataEvent> recorded;
+    for (Order::OrderId id = 1; id <= 1000; ++id) {
+        auto side = id % 2 ? Side::BUY : Side::SELL;
+        Order::Price price = side == Side::BUY ? 100 - id % 10 : 101 + id % 10;
+        recorded.push_back(MarketDataEvent::orderAdd(symbol_id, id, price, id % 7 + 1, side, OrderType::LIMIT,
+                                                     nanoseconds(20000 * id)));
+        if (id % 3 == 0) {
+            recorded.push_back(MarketDataEvent::orderCancel(symbol_id, id - 1, nanoseconds(20000 * id + 1)));
+        }
+    }
+    {
+        EventFileWriter writer(path);
+        writer.write(recorded.data(), recorded.size());
+        assert(writer.count() == recorded.size());
+    }
+    
+    {
+        MappedEventFile file(path);
+        assert(file.size() == recorded.size());
+        assert(std::memcmp(file.data(), recorded.data(), recorded.size() * sizeof(MarketDataEvent)) == 0);
+    }
+    
+    MarketDataHandlerImpl reference;
+    auto expected = std::make_shared<OrderBook>("REPLAY");
+    reference.registerOrderBook("REPLAY", expected);
+    for (const auto& event : recorded) {
+        reference.handleEvent(event);
+    }
+    
+    auto replay = [&](const ReplayConfig& config) {
+        MarketDataHandlerImpl handler;
+        auto book = std::make_shared<OrderBook>("REPLAY");
+        handler.registerOrderBook("REPLAY", book);
+        FileReplayFeed feed(path, config);
+        feed.registerHandler(&handler);
+        
+        auto start = std::chrono::steady_clock::now();
+        feed.start();
+        while (!feed.finished()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        feed.stop();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        
+        assert(feed.replayed() == recorded.size());
+        assert(feed.getStats().dispatched == recorded.size());
+        auto a = book->getTopOfBook();
+        auto b = expected->getTopOfBook();
+        assert(a.bid_price == b.bid_price && a.bid_size == b.bid_size);
+        assert(a.ask_price == b.ask_price && a.ask_size == b.ask_size);
+        assert(book->getAllOrders().size() == expected->getAllOrders().size());
+        return elapsed;
+    };
+    
+    replay(ReplayConfig());
+    ReplayConfig queued;
+    queued.through_queue = true;
+    replay(queued);
+    
+    // Paced at 2x, 20 ms of recorded time takes at least 10 ms
+    ReplayConfig paced;
+    paced.speed = 2.0;
+    auto paced_time = replay(paced);
+    assert(paced_time >= std::chrono::milliseconds(10));
+    
+    // stop() does not wait out a gap in the recording, and a restart resumes after it
+    {
+        auto gap_path = path + ".gap";
+        {
+            EventFileWriter writer(gap_path);
+            writer.write(recorded.data(), 1);
+            auto later = recorded[1];
+            later.timestamp = recorded[0].timestamp + std::chrono::hours(1);
+            writer.write(&later, 1);
+        }
+        MarketDataHandlerImpl handler;
+        FileReplayFeed feed(gap_path, paced);
+        feed.registerHandler(&handler);
+        feed.start();
+        while (feed.replayed() < 1) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));  // Waiting on the second event
+        auto stopping = std::chrono::steady_clock::now();
+        feed.stop();
+        assert(std::chrono::steady_clock::now() - stopping < std::chrono::seconds(5));
+        assert(feed.replayed() == 1 && !feed.finished());
+        feed.start();
+        while (!feed.finished()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        feed.stop();
+        assert(feed.replayed() == 2);
+        std::filesystem::remove(gap_path);
+    }
+    
+    // The factory parses the path and options
+    auto feed = MarketDataFeed::create("file", path + "?speed=1000&queue=1");
+    auto* file_feed = dynamic_cast<FileReplayFeed*>(feed.get());
+    assert(file_feed && file_feed->size() == recorded.size());
+    
+    std::filesystem::remove(path);
+    bool threw = false;
+    try {
+        MappedEventFile missing(path);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+TEST(multicast_feed) {
+    // Arbitration alone, on two lines; event i has sequence number i
+    auto stream = heartbeats(20);
+    std::vector<uint64_t> delivered;
+    std::vector<std::pair<uint64_t, uint64_t>> lost;
+    auto deliver = [&delivered](size_t, const MarketDataEvent* events, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            delivered.push_back(events[i].sequence);
+        }
+    };
+    auto gap = [&lost](uint64_t first, uint64_t count) { lost.emplace_back(first, count); };
+    
+    PacketArbiter arbiter(2);
+    arbiter.offer(0, 1, &stream[1], 5, deliver, gap);   // 1-5 from A
+    arbiter.offer(1, 1, &stream[1], 5, deliver, gap);   // B's copy
+    arbiter.offer(0, 9, &stream[9], 3, deliver, gap);   // A skipped 6-8, so 9-11 is held
+    assert(arbiter.holding() && delivered.size() == 5);
+    arbiter.offer(1, 4, &stream[4], 4, deliver, gap);   // B fills 6-7
+    assert(arbiter.holding() && delivered.size() == 7);
+    arbiter.offer(1, 9, &stream[9], 3, deliver, gap);   // B skipped 8 too: lost on both lines
+    assert(!arbiter.holding() && delivered.size() == 10);
+    assert(lost.size() == 1 && lost[0] == std::make_pair(uint64_t(8), uint64_t(1)));
+    
+    arbiter.offer(0, 14, &stream[14], 2, deliver, gap);  // A skipped 12-13 and B has gone quiet
+    arbiter.expire(deliver, gap);
+    assert(lost.size() == 2 && lost[1] == std::make_pair(uint64_t(12), uint64_t(2)) && delivered.size() == 12);
+    
+    arbiter.offer(0, 18, nullptr, 0, deliver, gap);      // Heartbeats on both lines reveal 16-17 lost
+    arbiter.offer(1, 18, nullptr, 0, deliver, gap);
+    assert(lost.size() == 3 && lost[2] == std::make_pair(uint64_t(16), uint64_t(2)));
+    assert(arbiter.expected() == 18 && arbiter.gaps() == 3 && arbiter.missed() == 5);
+    assert(arbiter.duplicates() == 2);
+    for (size_t i = 1; i < delivered.size(); ++i) {
+        assert(delivered[i] > delivered[i - 1]);
+    }
+    
+    // A and B lines over loopback: A loses every 2nd packet, B every 3rd, so every 6th is lost on both
+    constexpr size_t kEvents = 2000;
+    constexpr size_t kPerPacket = 10;
+    
+    MulticastConfig multicast;
+    multicast.line_a = "127.0.0.1:39411";
+    multicast.line_b = "127.0.0.1:39412";
+    FeedConfig config;
+    multicast.gap_timeout = std::chrono::seconds(1);  // Gaps come from both lines passing them, not the timer
+    config.queue_capacity = 4096;
+    MulticastMarketDataFeed feed(multicast, config);
+    
+    SequenceRecorder recorder;
+    std::vector<std::pair<uint64_t, uint64_t>> gaps;
+    feed.registerHandler(&recorder);
+    feed.setGapCallback([&gaps](uint64_t first, uint64_t count) { gaps.emplace_back(first, count); });
+    feed.start();
+    
+    PublisherConfig publisher_config;
+    publisher_config.line_a = multicast.line_a;
+    publisher_config.line_b = multicast.line_b;
+    publisher_config.events_per_packet = kPerPacket;
+    publisher_config.rate = 200000;
+    publisher_config.drop_a_every = 2;
+    publisher_config.drop_b_every = 3;
+    MulticastPublisher publisher(publisher_config);
+    auto events = heartbeats(kEvents);
+    publisher.send(events.data(), events.size());
+    publisher.heartbeat();
+    assert(publisher.packetsSent() == kEvents / kPerPacket);
+    assert(publisher.nextSequence() == kEvents + 1);
+    
+    constexpr size_t kLost = kEvents / kPerPacket / 6;
+    constexpr size_t kDelivered = kEvents - kLost * kPerPacket;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while ((feed.getMulticastStats().next_sequence != kEvents + 1 || feed.getStats().dispatched < kDelivered) &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    feed.stop();
+    
+    auto stats = feed.getMulticastStats();
+    assert(stats.packets_a == 101 && stats.packets_b == 135);  // Including the heartbeat
+    assert(stats.won_a == 100 && stats.won_b == 67 && stats.duplicates == 67);
+    assert(stats.gaps == kLost && stats.missed == kLost * kPerPacket && stats.malformed == 0);
+    assert(stats.receive_calls > 0);
+    
+    // Every event outside the lost packets, once and in order
+    assert(recorder.sequences.size() == kDelivered);
+    for (size_t i = 0; i < recorder.sequences.size(); ++i) {
+        assert(i == 0 || recorder.sequences[i] > recorder.sequences[i - 1]);
+        assert((recorder.sequences[i] / kPerPacket + 1) % 6 != 0);
+    }
+    assert(gaps.size() == kLost);
+    assert(gaps[0].first == 5 * kPerPacket + 1 && gaps[0].second == kPerPacket);
+    
+    // The factory parses both lines and the options
+    auto created = MarketDataFeed::create("multicast", "127.0.0.1:39413,127.0.0.1:39414?interface=127.0.0.1&batch=8");
+    assert(dynamic_cast<MulticastMarketDataFeed*>(created.get()) != nullptr);
+    bool threw = false;
+    try {
+        MarketDataFeed::create("multicast", "127.0.0.1:39415?bogus=1");
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+TEST(websocket_feed) {
+    // Frames: masked, fragmented and split at every byte, with a ping between fragments
+    std::string stream;
+    appendFrame(stream, WebSocketOpcode::TEXT, "hello", true, 0x12345678);
+    std::string fragment;
+    appendFrame(fragment, WebSocketOpcode::TEXT, "frag", false);
+    fragment[0] &= 0x7F;  // Clear FIN
+    stream += fragment;
+    appendFrame(stream, WebSocketOpcode::PING, "p", false);
+    appendFrame(stream, WebSocketOpcode::CONTINUATION, "mented", false);
+    appendFrame(stream, WebSocketOpcode::BINARY, std::string(70000, 'x'), true, 7);
+    
+    std::vector<std::pair<WebSocketOpcode, std::string>> messages;
+    auto collect = [&messages](WebSocketOpcode opcode, std::string_view payload) {
+        messages.emplace_back(opcode, std::string(payload));
+    };
+    WebSocketFrameParser parser;
+    std::string copy = stream;
+    size_t consumed = parser.parse(copy.data(), copy.size(), collect);
+    assert(consumed == copy.size() && messages.size() == 4 && !parser.failed());
+    assert(messages[0] == std::make_pair(WebSocketOpcode::TEXT, std::string("hello")));
+    assert(messages[1] == std::make_pair(WebSocketOpcode::PING, std::string("p")));
+    assert(messages[2] == std::make_pair(WebSocketOpcode::TEXT, std::string("fragmented")));
+    assert(messages[3].first == WebSocketOpcode::BINARY && messages[3].second == std::string(70000, 'x'));
+    
+    messages.clear();
+    parser.reset();
+    std::string pending;
+    for (char byte : stream) {
+        pending += byte;
+        pending.erase(0, parser.parse(pending.data(), pending.size(), collect));
+    }
+    assert(pending.empty() && messages.size() == 4 && messages[2].second == "fragmented");
+    
+    std::string oversized;
+    appendFrame(oversized, WebSocketOpcode::TEXT, std::string(100, 'x'), false);
+    WebSocketFrameParser small(64);
+    small.parse(oversized.data(), oversized.size(), collect);
+    assert(small.failed());
+    
+    assert(webSocketAccept("dGhlIHNhbXBsZSBub25jZQ==") == "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");  // RFC 6455 example
+    auto url = parseWebSocketUrl("ws://example.com:9000/feed?x=1");
+    assert(url.host == "example.com" && url.port == 9000 && url.path == "/feed?x=1");
+    bool threw = false;
+    try {
+        parseWebSocketUrl("wss://example.com/feed");
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    
+    // JSON: quoted and decimal prices, unknown keys, and bad objects skipped
+    auto symbol_id = SymbolRegistry::instance().intern("WSFEED");
+    JsonEventDecoder decoder(2);
+    std::vector<MarketDataEvent> decoded;
+    auto sink = [&decoded](const MarketDataEvent& event) { decoded.push_back(event); };
+    size_t count = decoder.decode(R"([{"type":"add","symbol":"WSFEED","id":1,"price":"101.5","qty":"10","side":"buy",)"
+                                  R"("venue":{"a":[1,"}"]},"seq":7,"ts":99},)"
+                                  R"( {"type":"bogus","symbol":"WSFEED"},)"
+                                  R"( {"type":"trade","symbol":"WSFEED","trade_id":3,"price":101.25,"qty":5,"buy_id":1,"sell_id":2}])",
+                                  sink);
+    assert(count == 2 && decoder.errors() == 1 && decoded.size() == 2);
+    assert(decoded[0].type == MarketDataEvent::Type::ORDER_ADD && decoded[0].symbol_id == symbol_id);
+    assert(decoded[0].add.price == 101'50 && decoded[0].add.quantity == 10 && decoded[0].add.side == Side::BUY);
+    assert(decoded[0].sequence == 7 && decoded[0].timestamp == nanoseconds(99));
+    assert(decoded[1].type == MarketDataEvent::Type::TRADE && decoded[1].trade.price == 101'25);
+    
+    // Numbers too long to hold, and negative IDs, quantities and sequence numbers, are malformed
+    decoded.clear();
+    for (const char* bad : {R"({"type":"cancel","symbol":"WSFEED","id":1234567890123456789})",
+                            R"({"type":"add","symbol":"WSFEED","id":1,"price":99999999999999999,"qty":1,"side":"buy"})",
+                            R"({"type":"add","symbol":"WSFEED","id":1,"price":1,"qty":-5,"side":"buy"})",
+                            R"({"type":"add","symbol":"WSFEED","id":1,"price":1,"qty":"-5","side":"buy"})",
+                            R"({"type":"cancel","symbol":"WSFEED","id":-1})",
+                            R"({"type":"heartbeat","seq":-7})"}) {
+        count = decoder.decode(bad, sink);
+        assert(count == 0);
+    }
+    assert(decoder.errors() == 7 && decoded.empty());
+    count = decoder.decode(R"({"type":"cancel","symbol":"WSFEED","id":123456789012345678,"seq":1})", sink);
+    assert(count == 1 && decoded[0].cancel.order_id == 123456789012345678ULL);
+    count = decoder.decode(R"({"type":"add","symbol":"WSFEED","id":2,"price":"-1.5","qty":1,"side":"sell"})", sink);
+    assert(count == 1 && decoded[1].add.price == -1'50);
+    decoded.clear();
+    
+    std::string json;
+    appendJson(json, MarketDataEvent::orderAdd(symbol_id, 9, 99'05, 3, Side::SELL, OrderType::STOP_LIMIT,
+                                               nanoseconds(5), 99'10), 2);
+    MarketDataEvent event;
+    bool found = decoder.decodeOne(json, event);
+    assert(found && event.add.order_id == 9 && event.add.price == 99'05 && event.add.stop_price == 99'10);
+    assert(event.add.side == Side::SELL && event.add.order_type == OrderType::STOP_LIMIT);
+    
+    // A server pushing the same flow as file_replay_feed to the feed
+    std::vector<std::string> flow;
+    MarketDataHandlerImpl reference;
+    auto expected = std::make_shared<OrderBook>("WSFEED");
+    reference.registerOrderBook("WSFEED", expected);
+    for (Order::OrderId id = 1; id <= 1000; ++id) {
+        auto side = id % 2 ? Side::BUY : Side::SELL;
+        Order::Price price = side == Side::BUY ? 100 - id % 10 : 101 + id % 10;
+        auto add = MarketDataEvent::orderAdd(symbol_id, id, price, id % 7 + 1, side, OrderType::LIMIT,
+                                             nanoseconds(id));
+        reference.handleEvent(add);
+        flow.emplace_back();
+        appendJson(flow.back(), add);
+        if (id % 3 == 0) {
+            auto cancel = MarketDataEvent::orderCancel(symbol_id, id - 1, nanoseconds(id));
+            reference.handleEvent(cancel);
+            flow.back().insert(0, "[");
+            flow.back() += ',';
+            appendJson(flow.back(), cancel);
+            flow.back() += ']';
+        }
+    }
+    
+    WebSocketServer server;
+    WebSocketConfig websocket;
+    websocket.receive_buffer = 4096;  // Frames straddle reads
+    websocket.reconnect_delay = std::chrono::milliseconds(10);
+    WebSocketMarketDataFeed feed(server.url("/md"), websocket);
+    MarketDataHandlerImpl handler;
+    auto book = std::make_shared<OrderBook>("WSFEED");
+    handler.registerOrderBook("WSFEED", book);
+    feed.registerHandler(&handler);
+    feed.subscribe("WSFEED");
+    feed.start();
+    bool connected = server.waitForClients(1, std::chrono::seconds(5));
+    assert(connected);
+    
+    server.replay(flow);
+    const size_t total = 1000 + 333;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (feed.getStats().dispatched < total && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto a = book->getTopOfBook();
+    auto b = expected->getTopOfBook();
+    assert(feed.getStats().dispatched == total);
+    assert(a.bid_price == b.bid_price && a.bid_size == b.bid_size);
+    assert(a.ask_price == b.ask_price && a.ask_size == b.ask_size);
+    assert(book->getAllOrders().size() == expected->getAllOrders().size());
+    
+    // Subscriptions reach the server; after a disconnect the feed reconnects and subscribes again
+    feed.subscribe("WSFEED2");
+    deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (server.received().size() < 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    server.disconnectClients();
+    while ((feed.getWebSocketStats().connects < 2 || server.received().size() < 3) &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    server.send(R"({"type":"heartbeat","seq":1})");
+    server.send("not json");
+    while (feed.getWebSocketStats().messages < flow.size() + 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    feed.stop();
+    
+    auto received = server.received();
+    assert(received.size() == 3);
+    assert(received[0] == R"({"op":"subscribe","symbols":["WSFEED"]})");
+    assert(received[1] == R"({"op":"subscribe","symbols":["WSFEED2"]})");
+    assert(received[2] == R"({"op":"subscribe","symbols":["WSFEED","WSFEED2"]})");
+    auto stats = feed.getWebSocketStats();
+    assert(stats.connects == 2 && stats.disconnects == 1 && !feed.connected());
+    assert(stats.messages == flow.size() + 2 && stats.events == total + 1 && stats.decode_errors == 1);
+}
+
+TEST(fix_feed) {
+    // Fields: '=' inside a value, a field with no '=', and a message long enough to span blocks
+    std::string text = "8=FIX.4.4\x01" "58=a=b\x01" "junk\x01" "55=";
+    text += std::string(100, 'Z');
+    text += "\x01" "10=000\x01" "trailing";
+    std::vector<FixField> expected(8);
+    size_t n = splitFixFields(text.data(), text.size(), expected.data(), expected.size(), FixIsa::SCALAR);
+    assert(n == 4);
+    assert(expected[0].tag == 8 && expected[0].value == "FIX.4.4");
+    assert(expected[1].tag == 58 && expected[1].value == "a=b");
+    assert(expected[2].tag == 55 && expected[2].value == std::string(100, 'Z'));
+    assert(expected[3].tag == 10 && expected[3].value == "000");
+    for (FixIsa isa : {FixIsa::SSE2, FixIsa::AVX2}) {
+        if (isa > bestFixIsa()) {
+            continue;
+        }
+        std::vector<FixField> fields(8);
+        size_t split = splitFixFields(text.data(), text.size(), fields.data(), fields.size(), isa);
+        assert(split == n);
+        for (size_t i = 0; i < n; ++i) {
+            assert(fields[i].tag == expected[i].tag && fields[i].value == expected[i].value);
+        }
+        split = splitFixFields(text.data(), text.size(), fields.data(), 2, isa);
+        assert(split == 2);
+        assert(fixChecksum(text.data(), text.size(), isa) == fixChecksum(text.data(), text.size(), FixIsa::SCALAR));
+    }
+    
+    // Numbers, prices and times without strtol
+    uint64_t number = 0;
+    assert(parseFixUnsigned("12345678901234567", number) && number == 12345678901234567ULL);
+    assert(!parseFixUnsigned("1234567x", number) && !parseFixUnsigned("", number));
+    int64_t price = 0;
+    assert(parseFixPrice("101.255", 2, price) && price == 101'25);
+    assert(parseFixPrice("-0.5", 2, price) && price == -50);
+    assert(parseFixPrice("7", 2, price) && price == 700);
+    assert(!parseFixPrice("1.2.3", 2, price) && !parseFixPrice("abc", 2, price));
+    assert(parseFixPrice("922337203685477580.7", 1, price) && price == INT64_MAX);
+    assert(!parseFixPrice("922337203685477580.8", 1, price) && !parseFixPrice("999999999999999999", 4, price));
+    int64_t time = 0;
+    assert(parseFixTime("20240102-03:04:05.123", time) && time == 1704164645123000000LL);
+    assert(formatFixTime(time) == "20240102-03:04:05.123000000");
+    assert(!parseFixTime("20241302-03:04:05", time));
+    
+    // Incremental refreshes round trip through the framing, checksum and decoder with every scanner
+    auto symbol_id = SymbolRegistry::instance().intern("FIXFEED");
+    std::vector<MarketDataEvent> events = {
+        MarketDataEvent::orderAdd(symbol_id, 1, 100'25, 10, Side::BUY, OrderType::LIMIT, nanoseconds(1'000'000'001)),
+        MarketDataEvent::orderAdd(symbol_id, 2, 100'75, 5, Side::SELL, OrderType::LIMIT, nanoseconds(2'000'000'000)),
+        MarketDataEvent::orderModify(symbol_id, 1, 100'50, 8, nanoseconds(3'000'000'000)),
+        MarketDataEvent::tradePrint(symbol_id, 9, 100'75, 5, 0, 0, nanoseconds(4'000'000'000)),
+        MarketDataEvent::orderCancel(symbol_id, 2, nanoseconds(5'000'000'000)),
+    };
+    for (size_t i = 0; i < events.size(); ++i) {
+        events[i].sequence = 100 + i;
+    }
+    std::string message;
+    appendFixIncrementalRefresh(message, events.data(), events.size(), 7, 2);
+    assert(fixMessageLength(message) == message.size());
+    assert(fixMessageLength(std::string_view(message).substr(0, message.size() - 1)) == 0);
+    assert(fixMessageLength("9=5\x01") == kFixMalformed);
+    assert(checkFixChecksum(message, FixIsa::SCALAR));
+    for (FixIsa isa : {FixIsa::SCALAR, FixIsa::SSE2, FixIsa::AVX2}) {
+        if (isa > bestFixIsa()) {
+            continue;
+        }
+        FixDecoder decoder(2, isa);
+        std::vector<MarketDataEvent> decoded;
+        FixHeader header;
+        size_t count = decoder.decode(message, [&decoded](const MarketDataEvent& event) { decoded.push_back(event); },
+                                      &header);
+        assert(count == events.size());
+        assert(header.msg_type == "X" && header.seq_num == 7 && decoder.errors() == 0);
+        for (size_t i = 0; i < events.size(); ++i) {
+            assert(decoded[i].type == events[i].type && decoded[i].symbol_id == symbol_id);
+            assert(decoded[i].sequence == events[i].sequence && decoded[i].timestamp == events[i].timestamp);
+        }
+        assert(decoded[0].add.price == 100'25 && decoded[0].add.quantity == 10 && decoded[0].add.side == Side::BUY);
+        assert(decoded[1].add.side == Side::SELL && decoded[2].modify.price == 100'50);
+        assert(decoded[3].trade.trade_id == 9 && decoded[3].trade.quantity == 5 && decoded[4].cancel.order_id == 2);
+    }
+    
+    // A change to a negative size or an out-of-range price is an error, not a wrapped value
+    std::string bad;
+    appendFixMessage(bad, "X", "34=8\x01" "268=2\x01"
+                               "279=1\x01" "269=0\x01" "278=5\x01" "55=FIX\x01" "270=100\x01" "271=-5\x01"
+                               "279=1\x01" "269=0\x01" "278=6\x01" "270=999999999999999999\x01" "271=1\x01");
+    FixDecoder strict(4);
+    size_t bad_count = strict.decode(bad, [](const MarketDataEvent&) {});
+    assert(bad_count == 0 && strict.errors() == 2);
+    
+    // A feed logging on to a local server, which sends the file_replay_feed flow in awkward pieces
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    int bound = ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    int listening = ::listen(listener, 1);
+    int named = ::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length);
+    assert(bound == 0 && listening == 0 && named == 0);
+    
+    FixConfig fix;
+    fix.endpoint = "127.0.0.1:" + std::to_string(ntohs(address.sin_port));
+    fix.sender_comp_id = "CLIENT";
+    fix.target_comp_id = "VENUE";
+    fix.price_decimals = 2;
+    fix.receive_buffer = 4096;  // Messages straddle reads and the buffer grows
+    FixMarketDataFeed feed(fix);
+    MarketDataHandlerImpl handler;
+    auto book = std::make_shared<OrderBook>("FIXFEED");
+    handler.registerOrderBook("FIXFEED", book);
+    feed.registerHandler(&handler);
+    feed.start();
+    
+    int server = ::accept(listener, nullptr, nullptr);
+    assert(server >= 0);
+    auto readMessage = [&server] {
+        std::string received;
+        while (fixMessageLength(received) == 0) {
+            char byte = 0;
+            if (::recv(server, &byte, 1, 0) != 1) {
+                assert(false);
+                break;
+            }
+            received += byte;
+        }
+        assert(checkFixChecksum(received, FixIsa::SCALAR));
+        return received;
+    };
+    auto logon = readMessage();
+    assert(logon.find("\x01" "35=A\x01") != std::string::npos && logon.find("\x01" "49=CLIENT\x01") != std::string::npos);
+    
+    std::string stream;
+    appendFixMessage(stream, "A", "49=VENUE\x01" "56=CLIENT\x01" "34=1\x01" "98=0\x01" "108=30\x01");
+    MarketDataHandlerImpl reference;
+    auto reference_book = std::make_shared<OrderBook>("FIXFEED");
+    reference.registerOrderBook("FIXFEED", reference_book);
+    uint64_t seq_num = 2;
+    size_t total = 0;
+    for (Order::OrderId id = 1; id <= 1000; id += 4) {
+        std::vector<MarketDataEvent> batch;
+        for (Order::OrderId i = id; i < id + 4; ++i) {
+            auto side = i % 2 ? Side::BUY : Side::SELL;
+            Order::Price level = side == Side::BUY ? 100 - i % 10 : 101 + i % 10;
+            batch.push_back(MarketDataEvent::orderAdd(symbol_id, i, level * 100, i % 7 + 1, side, OrderType::LIMIT,
+                                                      nanoseconds(i)));
+            if (i % 3 == 0) {
+                batch.push_back(MarketDataEvent::orderCancel(symbol_id, i - 1, nanoseconds(i)));
+            }
+        }
+        for (const auto& event : batch) {
+            reference.handleEvent(event);
+        }
+        total += batch.size();
+        appendFixIncrementalRefresh(stream, batch.data(), batch.size(), seq_num++, 2);
+    }
+    std::string corrupt;
+    appendFixIncrementalRefresh(corrupt, events.data(), 1, seq_num++, 2);
+    corrupt[corrupt.size() - 2] = corrupt[corrupt.size() - 2] == '0' ? '1' : '0';
+    stream += corrupt;
+    stream += "garbage";
+    appendFixMessage(stream, "1", "49=VENUE\x01" "56=CLIENT\x01" "34=999\x01" "112=PING7\x01");
+    for (size_t offset = 0; offset < stream.size();) {
+        size_t piece = std::min<size_t>(stream.size() - offset, 1 + offset % 3001);
+        auto sent = ::send(server, stream.data() + offset, piece, MSG_NOSIGNAL);
+        assert(sent == static_cast<ssize_t>(piece));
+        offset += piece;
+    }
+    
+    auto reply = readMessage();
+    assert(reply.find("\x01" "35=0\x01") != std::string::npos && reply.find("\x01" "112=PING7\x01") != std::string::npos);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (feed.getStats().dispatched < total && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    assert(feed.connected());
+    
+    auto a = book->getTopOfBook();
+    auto b = reference_book->getTopOfBook();
+    assert(feed.getStats().dispatched == total);
+    assert(a.bid_price == b.bid_price && a.bid_size == b.bid_size);
+    assert(a.ask_price == b.ask_price && a.ask_size == b.ask_size);
+    assert(book->getAllOrders().size() == reference_book->getAllOrders().size());
+    
+    // The server going away is a disconnect, and the feed comes back
+    ::close(server);
+    server = ::accept(listener, nullptr, nullptr);
+    assert(server >= 0);
+    readMessage();
+    feed.stop();
+    ::close(server);
+    ::close(listener);
+    
+    auto stats = feed.getFixStats();
+    assert(stats.connects == 2 && stats.disconnects == 1 && !feed.connected());
+    assert(stats.messages == 2 + 250 && stats.events == total);
+    assert(stats.checksum_errors == 1 && stats.malformed >= 1 && stats.decode_errors == 0 && stats.test_requests == 1);
+    
+    auto created = MarketDataFeed::create("fix", "127.0.0.1:1?decimals=2&isa=scalar&checksum=0");
+    assert(dynamic_cast<FixMarketDataFeed*>(created.get()) != nullptr);
+    bool threw = false;
+    try {
+        MarketDataFeed::create("fix", "127.0.0.1");
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+TEST(book_snapshot) {
+    auto same_orders = [](const OrderBook& a, const OrderBook& b) {
+        auto x = a.getAllOrders();
+        auto y = b.getAllOrders();
+        assert(x.size() == y.size());
+        for (size_t i = 0; i < x.size(); ++i) {
+            assert(x[i].getId() == y[i].getId() && x[i].getPrice() == y[i].getPrice());
+            assert(x[i].getStopPrice() == y[i].getStopPrice() && x[i].getType() == y[i].getType());
+            assert(x[i].getQuantity() == y[i].getQuantity());
+            assert(x[i].getRemainingQuantity() == y[i].getRemainingQuantity());
+            assert(x[i].getSide() == y[i].getSide() && x[i].getStatus() == y[i].getStatus());
+            assert(x[i].getTimestamp() == y[i].getTimestamp());
+        }
+        auto dx = a.getDepth(100);
+        auto dy = b.getDepth(100);
+        assert(dx.first.size() == dy.first.size() && dx.second.size() == dy.second.size());
+        for (size_t i = 0; i < dx.first.size(); ++i) {
+            assert(dx.first[i].price == dy.first[i].price);
+            assert(dx.first[i].total_quantity == dy.first[i].total_quantity);
+            assert(dx.first[i].order_count == dy.first[i].order_count);
+        }
+    };
+    
+    for (auto storage : {BookStorage::MAP, BookStorage::ARRAY}) {
+        OrderBookConfig config;
+        config.storage = storage;
+        OrderBook book("AAPL", config);
+        for (int i = 0; i < 20; ++i) {
+            book.addOrder(Order(1 + i, "AAPL", 100 - i % 5, 10 + i, Side::BUY, OrderType::LIMIT, nanoseconds(1 + i)));
+            book.addOrder(Order(101 + i, "AAPL", 105 + i % 4, 10 + i, Side::SELL, OrderType::LIMIT, nanoseconds(1 + i)));
+        }
+        // A partial fill, a trade price for the stops and some parked stops
+        book.addOrder(Order(200, "AAPL", 105, 5, Side::BUY, OrderType::LIMIT, nanoseconds(30)));
+        book.addOrder(Order(201, "AAPL", 0, 10, Side::BUY, OrderType::STOP, nanoseconds(31), 107));
+        book.addOrder(Order(202, "AAPL", 108, 10, Side::BUY, OrderType::STOP_LIMIT, nanoseconds(32), 107));
+        book.addOrder(Order(203, "AAPL", 0, 10, Side::SELL, OrderType::STOP, nanoseconds(33), 97));
+        
+        std::string data;
+        book.saveSnapshot(data, 7);
+        OrderBook restored("AAPL", config);
+        restored.addOrder(Order(999, "AAPL", 50, 1, Side::BUY, OrderType::LIMIT, nanoseconds(1)));
+        uint64_t sequence = restored.loadSnapshot(data);
+        assert(sequence == 7);
+        same_orders(book, restored);
+        auto top = restored.getTopOfBook();
+        assert(top.bid_price == 100 && top.ask_price == 105);
+        assert(top.ask_size == book.getTopOfBook().ask_size);
+        
+        // Queue priority, trade IDs and the stops carry over: the same sweep trades identically
+        auto expected = book.addOrder(Order(300, "AAPL", 96, 200, Side::SELL, OrderType::LIMIT, nanoseconds(40)));
+        auto trades = restored.addOrder(Order(300, "AAPL", 96, 200, Side::SELL, OrderType::LIMIT, nanoseconds(40)));
+        assert(!expected.empty() && trades.size() == expected.size());
+        for (size_t i = 0; i < trades.size(); ++i) {
+            assert(trades[i].getId() == expected[i].getId());
+            assert(trades[i].getMakerOrderId() == expected[i].getMakerOrderId());
+            assert(trades[i].getTakerOrderId() == expected[i].getTakerOrderId());
+            assert(trades[i].getQuantity() == expected[i].getQuantity());
+        }
+        same_orders(book, restored);
+        
+        // A snapshot of another symbol is refused; a damaged one leaves the book empty
+        OrderBook other("MSFT", config);
+        try {
+            other.loadSnapshot(data);
+            assert(false);
+        } catch (const std::invalid_argument&) {}
+        try {
+            restored.loadSnapshot(std::string_view(data).substr(0, data.size() - 8));
+            assert(false);
+        } catch (const std::runtime_error&) {}
+        assert(restored.getAllOrders().empty() && restored.getTopOfBook().bid_price == 0);
+        
+        // Counts larger than the data are refused before anything is sized from them
+        std::string inflated = data;
+        uint64_t huge_orders = uint64_t(1) << 40;
+        std::memcpy(&inflated[offsetof(BookSnapshotHeader, order_count)], &huge_orders, sizeof(huge_orders));
+        try {
+            restored.loadSnapshot(inflated);
+            assert(false);
+        } catch (const std::runtime_error&) {}
+        inflated = data;
+        uint32_t huge_levels = UINT32_MAX;
+        std::memcpy(&inflated[offsetof(BookSnapshotHeader, level_counts)], &huge_levels, sizeof(huge_levels));
+        try {
+            restored.loadSnapshot(inflated);
+            assert(false);
+        } catch (const std::runtime_error&) {}
+        
+        // Through a file
+        auto path = (std::filesystem::temp_directory_path() / "orderbook_test.snapshot").string();
+        writeBookSnapshot(path, book, 9);
+        sequence = readBookSnapshot(path, restored);
+        assert(sequence == 9);
+        same_orders(book, restored);
+        std::filesystem::remove(path);
+    }
+    
+    // Recovery: events are held back while the snapshot is fetched, then the
+    // ones it does not cover are applied on top of it
+    auto source = std::make_shared<OrderBook>("AAPL");
+    auto book = std::make_shared<OrderBook>("AAPL");
+    MarketDataHandlerImpl handler;
+    handler.registerOrderBook("AAPL", book);
+    auto aapl = book->getSymbolId();
+    auto numbered = [](MarketDataEvent event, uint64_t sequence) {
+        event.sequence = sequence;
+        return event;
+    };
+    
+    handler.beginRecovery(aapl);
+    source->addOrder(Order(1, "AAPL", 100, 10, Side::BUY, OrderType::LIMIT, nanoseconds(1)));
+    source->addOrder(Order(2, "AAPL", 101, 10, Side::SELL, OrderType::LIMIT, nanoseconds(2)));
+    handler.handleEvent(numbered(MarketDataEvent::orderAdd(aapl, 2, 101, 10, Side::SELL, OrderType::LIMIT,
+                                                           nanoseconds(2)), 2));
+    std::string data;
+    source->saveSnapshot(data, 2);
+    handler.handleEvent(numbered(MarketDataEvent::orderAdd(aapl, 3, 99, 5, Side::BUY, OrderType::LIMIT,
+                                                           nanoseconds(3)), 3));
+    handler.handleEvent(numbered(MarketDataEvent::orderCancel(aapl, 1, nanoseconds(4)), 4));
+    assert(book->getAllOrders().empty());
+    
+    uint64_t recovered = handler.completeRecovery(aapl, data);
+    assert(recovered == 2);
+    auto top = book->getTopOfBook();
+    assert(top.bid_price == 99 && top.bid_size == 5 && top.ask_price == 101);
+    assert(book->getAllOrders().size() == 2);
+    
+    // Live again
+    handler.handleEvent(numbered(MarketDataEvent::orderCancel(aapl, 3, nanoseconds(5)), 5));
+    assert(book->getAllOrders().size() == 1);
+    try {
+        handler.completeRecovery(aapl, data);
+        assert(false);
+    } catch (const std::invalid_argument&) {}
+    
+    // A rejected duplicate ID leaves nothing behind for the snapshot to write
+    OrderBook reused("MSFT");
+    reused.addOrder(Order(7, "MSFT", 100, 10, Side::BUY, OrderType::LIMIT, nanoseconds(1)));
+    try {
+        reused.addOrder(Order(7, "MSFT", 101, 10, Side::BUY, OrderType::LIMIT, nanoseconds(2)));
+        assert(false);
+    } catch (const std::invalid_argument&) {}
+    bool cancelled = reused.cancelOrder(7);
+    assert(cancelled);
+    std::string empty;
+    reused.saveSnapshot(empty, 9);
+    OrderBook reloaded("MSFT");
+    reloaded.addOrder(Order(1, "MSFT", 100, 10, Side::SELL, OrderType::LIMIT, nanoseconds(1)));
+    uint64_t sequence = reloaded.loadSnapshot(empty);
+    assert(sequence == 9 && reloaded.getAllOrders().empty());
+}
+
+TEST(book_journal) {
+    auto path = (std::filesystem::temp_directory_path() / "orderbook_test.journal").string();
+    JournalConfig journal_config;
+    journal_config.queue_capacity = 64;   // Small enough for the book to wait on the writer
+    journal_config.commit_events = 100;
+    journal_config.preallocate = 4096;    // Grown several times
+    auto journal = std::make_shared<BookJournal>(path, journal_config);
+    
+    OrderBook book("AAPL");
+    OrderBook other("MSFT");
+    book.setJournal(journal);
+    other.setJournal(journal);
+    std::vector<Trade> made;
+    book.registerTradeCallback([&](const Trade& trade) { made.push_back(trade); });
+    other.registerTradeCallback([&](const Trade& trade) { made.push_back(trade); });
+    
+    // A deterministic mix of every journaled call
+    uint64_t seed = 12345;
+    auto next = [&](uint64_t range) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (seed >> 33) % range;
+    };
+    Trade buffer[2];
+    Order::OrderId id = 1;
+    for (int i = 0; i < 3000; ++i) {
+        auto side = next(2) ? Side::BUY : Side::SELL;
+        auto price = static_cast<Order::Price>(95 + next(11));
+        auto quantity = 1 + next(20);
+        auto time = nanoseconds(i);
+        switch (next(8)) {
+            case 0:
+                book.addOrder(Order(id++, "AAPL", price, quantity * 5, side, OrderType::LIMIT, time), buffer, 2);
+                break;
+            case 1:
+                book.modifyOrder(1 + next(id), price, next(4) ? quantity : 0);
+                break;
+            case 2:
+                book.cancelOrder(1 + next(id));
+                break;
+            case 3:
+                book.executeOrder(1 + next(id), quantity);
+                break;
+            case 4:
+                book.addOrder(Order(id++, "AAPL", price + 1, quantity, side, OrderType::STOP_LIMIT, time, price));
+                break;
+            default:
+                book.addOrder(Order(id++, "AAPL", price, quantity, side, OrderType::LIMIT, time));
+                break;
+        }
+        if (i == 1500) {
+            book.clear();
+        }
+        if (i % 100 == 0) {
+            other.addOrder(Order(id++, "MSFT", price, quantity, side, OrderType::LIMIT, time));
+        }
+    }
+    // Rejected calls change nothing and are not recorded
+    try {
+        book.addOrder(Order(id++, "MSFT", 100, 1, Side::BUY, OrderType::LIMIT, nanoseconds(5000)));
+        assert(false);
+    } catch (const std::invalid_argument&) {}
+    
+    // A snapshot load cannot be journaled, so it is refused while the journal is attached
+    std::string image;
+    book.saveSnapshot(image);
+    size_t resting = book.getAllOrders().size();
+    bool refused = false;
+    try {
+        book.loadSnapshot(image);
+    } catch (const std::logic_error&) {
+        refused = true;
+    }
+    assert(refused && book.getAllOrders().size() == resting);
+    journal->flush();
+    auto stats = journal->getStats();
+    assert(stats.durable == stats.recorded && stats.commits > 0);
+    journal->close();
+    assert(journal->getStats().written == stats.recorded);
+    assert(std::filesystem::file_size(path) == sizeof(EventFileHeader) + stats.recorded * sizeof(MarketDataEvent));
+    assert(made.size() > 100);
+    
+    // Replay rebuilds the same books and trades
+    JournalReplayer replayer;
+    size_t applied = replayer.applyFile(path);
+    assert(applied == stats.recorded);
+    assert(replayer.records() == stats.recorded && !replayer.truncated());
+    assert(replayer.trades() == made.size() && replayer.mismatches() == 0);
+    for (auto* original : {&book, &other}) {
+        auto replayed = replayer.getOrderBook(original->getSymbolId());
+        assert(replayed != nullptr);
+        auto x = original->getAllOrders();
+        auto y = replayed->getAllOrders();
+        assert(x.size() == y.size());
+        for (size_t i = 0; i < x.size(); ++i) {
+            assert(x[i].getId() == y[i].getId() && x[i].getPrice() == y[i].getPrice());
+            assert(x[i].getRemainingQuantity() == y[i].getRemainingQuantity());
+            assert(x[i].getType() == y[i].getType());
+        }
+    }
+    // The trade ID sequence carries on from the same point
+    auto sweep = [&](OrderBook& target) {
+        return target.addOrder(Order(id, "AAPL", 0, 1000, Side::BUY, OrderType::MARKET, nanoseconds(6000)));
+    };
+    book.setJournal(nullptr);
+    auto expected = sweep(book);
+    auto replayed = sweep(*replayer.getOrderBook(book.getSymbolId()));
+    assert(!expected.empty() && expected.size() == replayed.size());
+    assert(expected.back().getId() == replayed.back().getId());
+    
+    // A crash leaves zeroed reserved space after the last record written: replay stops there
+    MappedEventFile file(path);
+    std::vector<MarketDataEvent> records(file.data(), file.data() + file.size());
+    records.resize(records.size() + 4);
+    JournalReplayer partial;
+    applied = partial.apply(records.data(), records.size());
+    assert(applied == stats.recorded);
+    assert(partial.truncated() && partial.mismatches() == 0);
+    
+    // A trade the replay does not reproduce is reported
+    records.resize(stats.recorded);
+    for (auto& record : records) {
+        if (record.type == MarketDataEvent::Type::TRADE) {
+            record.trade.quantity += 1;
+            break;
+        }
+    }
+    JournalReplayer altered;
+    altered.apply(records.data(), records.size());
+    assert(altered.mismatches() == 1);
+    std::filesystem::remove(path);
+}
+
+TEST(tick_store) {
+    assert(TickStore::dayOf(nanoseconds(0)) == 19700101);
+    assert(TickStore::dayOf(nanoseconds(-1)) == 19691231);
+    assert(TickStore::dayOf(std::chrono::seconds(1709164800)) == 20240229);
+    
+    auto root = (std::filesystem::temp_directory_path() / "orderbook_test_ticks").string();
+    std::filesystem::remove_all(root);
+    const int64_t day = 86400LL * 1000000000LL;
+    const int64_t march1 = 1709251200LL * 1000000000LL;  // 2024-03-01 00:00 UTC
+    
+    TickStoreConfig config;
+    config.depth_levels = 3;
+    config.buffer_rows = 16;  // Several writes per day
+    std::vector<Trade> made;
+    {
+        TickStore store(root, config);
+        OrderBookConfig book_config;
+        book_config.update_notification = UpdateNotification::ON_CHANGE;
+        OrderBook book("AAPL", book_config);
+        store.attach(book);
+        // Two days of resting orders and crossing orders
+        for (int i = 0; i < 200; ++i) {
+            auto time = nanoseconds(march1 + day - 100 * 1000000000LL + i * 1000000000LL);
+            auto side = i % 2 ? Side::BUY : Side::SELL;
+            auto price = static_cast<Order::Price>(100 + (i % 7) - 3);
+            auto trades = book.addOrder(Order(i + 1, "AAPL", price, 10, side, OrderType::LIMIT, time));
+            made.insert(made.end(), trades.begin(), trades.end());
+        }
+        store.recordTrade(Trade(1, "MSFT", 300, 5, 1, 2, nanoseconds(march1), Side::SELL));
+        assert(store.tradeCount() == made.size() + 1 && store.quoteCount() > 0);
+    }
+    assert(!made.empty());
+    
+    auto days = TickDay::days(root, "AAPL");
+    assert(days.size() == 2 && days[0] == 20240301 && days[1] == 20240302);
+    
+    size_t found = 0;
+    for (auto date : days) {
+        TickDay ticks(root, "AAPL", date);
+        auto trades = ticks.trades();
+        for (size_t i = 0; i < trades.rows; ++i, ++found) {
+            const auto& trade = made[found];
+            assert(trades.time[i] == trade.getTimestamp().count());
+            assert(trades.price[i] == trade.getPrice() && trades.size[i] == trade.getQuantity());
+            assert(trades.side[i] == trade.getTakerSide() && trades.id[i] == trade.getId());
+            assert(TickStore::dayOf(nanoseconds(trades.time[i])) == date);
+        }
+        
+        // Quote rows hold three levels a side, zeros past the last one
+        auto quotes = ticks.quotes();
+        assert(quotes.rows > 0 && quotes.levels == 3);
+        for (size_t i = 0; i < quotes.rows; ++i) {
+            const auto* bids = quotes.bid_price + i * quotes.levels;
+            assert(bids[0] >= bids[1] || bids[1] == 0);
+            assert(i == 0 || quotes.time[i] >= quotes.time[i - 1]);
+        }
+    }
+    assert(found == made.size());
+    
+    // Time ranges are found by binary search: [from, to)
+    TickDay second(root, "AAPL", 20240302);
+    auto all = second.trades();
+    auto from = nanoseconds(all.time[all.rows / 2]);
+    auto range = second.trades(from, nanoseconds(march1 + 2 * day));
+    assert(range.rows > 0 && range.time[0] == from.count() && range.time + range.rows == all.time + all.rows);
+    assert(second.trades(nanoseconds(0), nanoseconds(march1)).rows == 0);
+    auto quotes = second.quotes(nanoseconds(march1 + day), nanoseconds(march1 + day + 50 * 1000000000LL));
+    assert(quotes.rows > 0 && quotes.rows < second.quotes().rows);
+    assert(quotes.bid_price == second.quotes().bid_price);
+    
+    // Other symbols have their own files; a day with no quotes reads as empty
+    TickDay msft(root, "MSFT", 20240301);
+    assert(msft.trades().rows == 1 && msft.trades().side[0] == Side::SELL && msft.quotes().rows == 0);
+    assert(TickDay(root, "MSFT", 20240302).trades().rows == 0);
+    
+    // Reopening a day appends to it; an out-of-order time is raised to the one before it.
+    // Bytes an unfinished write left after the counted rows are not read, and are dropped.
+    auto price_file = root + "/MSFT/20240301/trades/price";
+    {
+        std::FILE* file = std::fopen(price_file.c_str(), "ab");
+        std::fwrite("unfinished", 1, 10, file);
+        std::fclose(file);
+        assert(TickDay(root, "MSFT", 20240301).trades().rows == 1);
+        
+        TickStore store(root, config);
+        store.recordTrade(Trade(2, "MSFT", 301, 6, 3, 4, nanoseconds(march1 + 10), Side::BUY));
+        store.recordTrade(Trade(3, "MSFT", 302, 7, 5, 6, nanoseconds(march1 + 5), Side::BUY));
+        store.flush();
+        TickDay reopened(root, "MSFT", 20240301);
+        assert(reopened.trades().rows == 3 && reopened.trades().price[1] == 301);
+        assert(reopened.trades().time[2] == march1 + 10);
+        assert(std::filesystem::file_size(price_file) == sizeof(TickColumnHeader) + 3 * sizeof(Order::Price));
+        
+        // A day written with a different number of levels is not appended to
+        TickStoreConfig wider = config;
+        wider.depth_levels = 5;
+        TickStore other(root, wider);
+        try {
+            other.recordQuote(SymbolRegistry::instance().intern("AAPL"), TopOfBook{100, 1, 101, 1, nanoseconds(march1)});
+            assert(false);
+        } catch (const std::runtime_error&) {}
+    }
+    std::filesystem::remove_all(root);
+}
+
+TEST(order_flow_generator) {
+    OrderFlowConfig config;
+    config.seed = 42;
+    config.symbols = 20;
+    const size_t count = 50000;
+    
+    // The same seed gives the same events; another seed does not
+    OrderFlowGenerator generator(config);
+    OrderFlowGenerator same(config);
+    config.seed = 43;
+    OrderFlowGenerator other(config);
+    std::vector<MarketDataEvent> events(count);
+    generator.generate(events.data(), count);
+    auto equal = [](const MarketDataEvent& a, const MarketDataEvent& b) {
+        return a.type == b.type && a.symbol_id == b.symbol_id && a.sequence == b.sequence &&
+               a.timestamp == b.timestamp && a.add.order_id == b.add.order_id &&
+               (a.type != MarketDataEvent::Type::ORDER_ADD ||
+                (a.add.price == b.add.price && a.add.quantity == b.add.quantity && a.add.side == b.add.side));
+    };
+    size_t differ = 0;
+    for (size_t i = 0; i < count; ++i) {
+        auto repeated = same.next();
+        assert(equal(events[i], repeated));
+        differ += !equal(events[i], other.next());
+    }
+    assert(differ > count / 2);
+    
+    // Numbered in order, stamped in time order, and sized in lots within range
+    const auto& stats = generator.getStats();
+    assert(stats.events == count && stats.adds + stats.cancels + stats.modifies + stats.executes == count);
+    assert(stats.cancels > 0 && stats.modifies > 0 && stats.executes > 0 && stats.marketable_adds == 0);
+    assert(stats.triggered > count / 2);  // Branching ratio 0.7: most arrivals are triggered
+    for (size_t i = 0; i < count; ++i) {
+        assert(events[i].sequence == i + 1);
+        assert(i == 0 || events[i].timestamp >= events[i - 1].timestamp);
+        if (events[i].type == MarketDataEvent::Type::ORDER_ADD) {
+            auto quantity = events[i].add.quantity;
+            assert(quantity % 100 == 0 && quantity >= 100 && quantity <= 100000);
+        }
+    }
+    
+    // Applied to books, the flow never crosses and leaves the orders the generator holds
+    MarketDataHandlerImpl handler;
+    std::vector<std::shared_ptr<OrderBook>> books;
+    size_t trades = 0;
+    for (auto symbol_id : generator.symbolIds()) {
+        auto book = std::make_shared<OrderBook>(SymbolRegistry::instance().name(symbol_id));
+        book->registerTradeCallback([&](const Trade&) { ++trades; });
+        handler.registerOrderBook(book->getSymbol(), book);
+        books.push_back(book);
+    }
+    for (const auto& event : events) {
+        handler.handleEvent(event);
+    }
+    size_t resting = 0;
+    for (const auto& book : books) {
+        resting += book->getAllOrders().size();
+        auto top = book->getTopOfBook();
+        assert(top.bid_price == 0 || top.ask_price == 0 || top.bid_price < top.ask_price);
+    }
+    assert(trades == 0 && resting == stats.live_orders && resting > 0);
+    
+    // An event file replays in a fresh set of books
+    auto path = (std::filesystem::temp_directory_path() / "orderbook_test.flow").string();
+    OrderFlowGenerator writer(OrderFlowConfig{});
+    writer.writeFile(path, count);
+    JournalReplayer replayer;
+    size_t applied = replayer.applyFile(path);
+    assert(applied == writer.symbolIds().size() + count);
+    assert(!replayer.truncated() && replayer.mismatches() == 0);
+    size_t replayed = 0;
+    for (const auto& book : replayer.getOrderBooks()) {
+        replayed += book->getAllOrders().size();
+    }
+    assert(replayed == writer.getStats().live_orders);
+    std::filesystem::remove(path);
+    
+    OrderFlowConfig bad;
+    bad.branching_ratio = 1.0;
+    try {
+        OrderFlowGenerator invalid(bad);
+        assert(false);
+    } catch (const std::invalid_argument&) {
+    }
+}
+
 int main() {
     std::cout << "Running OrderBook Tests" << std::endl;
     std::cout << "=======================" << std::endl;
@@ -153,6 +2253,36 @@ int main() {
     RUN_TEST(order_book_basic);
     RUN_TEST(order_book_matching);
     RUN_TEST(order_flow_imbalance);
+    RUN_TEST(array_storage_matching);
+    RUN_TEST(map_storage_matching);
+    RUN_TEST(array_storage_recentre);
+    RUN_TEST(array_storage_span_limit);
+    RUN_TEST(cancel_from_queue_middle);
+    RUN_TEST(duplicate_order_ids);
+    RUN_TEST(symbol_interning);
+    RUN_TEST(modify_priority);
+    RUN_TEST(single_writer_snapshots);
+    RUN_TEST(ioc_and_fok);
+    RUN_TEST(stop_orders);
+    RUN_TEST(stops_survive_full_trade_buffer);
+    RUN_TEST(modified_stop_priority);
+    RUN_TEST(depth_cache);
+    RUN_TEST(event_order_flow_imbalance);
+    RUN_TEST(update_notifications_on_change);
+    RUN_TEST(market_data_events);
+    RUN_TEST(spsc_queue);
+    RUN_TEST(feed_event_queue);
+    RUN_TEST(feed_handler_registration);
+    RUN_TEST(sharded_handler);
+    RUN_TEST(symbol_routing_table);
+    RUN_TEST(file_replay_feed);
+    RUN_TEST(multicast_feed);
+    RUN_TEST(websocket_feed);
+    RUN_TEST(fix_feed);
+    RUN_TEST(book_snapshot);
+    RUN_TEST(book_journal);
+    RUN_TEST(tick_store);
+    RUN_TEST(order_flow_generator);
     
     std::cout << "\nAll tests passed!" << std::endl;
     return 0;